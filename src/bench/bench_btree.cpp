@@ -0,0 +1,124 @@
+// C++ Includes
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// C Includes
+#include <unistd.h>
+
+// Local Includes
+#include "exception/file_exception.h"
+#include "file/bufferpool.h"
+#include "storage/btree.h"
+#include "storage/pager.h"
+
+#define LOOKUPS 1000000
+#define SCANS 100000
+#define SCAN_LENGTH 100
+
+static uint64_t Next(uint64_t& state) {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return state >> 17;
+}
+
+static double Since(std::chrono::steady_clock::time_point start) {
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+static std::string CustomerKey(uint64_t id) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "customer-%010lu", static_cast<unsigned long>(id));
+    return buffer;
+}
+
+/**
+ * @brief Time point lookups of keys in the tree and range scans starting at them
+ */
+template <typename MakeKey>
+static void Probe(const BTree& tree, const std::vector<uint64_t>& ids, MakeKey make_key) {
+    std::vector<uint8_t> value;
+    uint64_t state = 11;
+    size_t found = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < LOOKUPS; ++i)
+        found += tree.Find(make_key(ids[Next(state) % ids.size()]), value);
+    double seconds = Since(start);
+    printf("  point lookups  %8.1f ns/lookup  %zu of %d found\n", seconds * 1e9 / LOOKUPS, found, LOOKUPS);
+
+    size_t rows = 0;
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < SCANS; ++i) {
+        BTreeCursor cursor = tree.Seek(make_key(ids[Next(state) % ids.size()]));
+        for (int j = 0; j < SCAN_LENGTH && cursor.Valid(); ++j, cursor.Next())
+            rows += cursor.ValueSize();
+    }
+    seconds = Since(start);
+    printf("  range scans    %8.1f ns/scan of %d  %6.1f ns/row\n", seconds * 1e9 / SCANS, SCAN_LENGTH,
+           seconds * 1e9 / (rows / sizeof(int64_t)));
+}
+
+int main(int argc, char* argv[]) {
+    size_t keys = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 10000000;
+    const char* file_path = (argc > 2) ? argv[2] : "bench_btree.tmp";
+
+    try {
+        Pager pager;
+        pager.Create(file_path, PagerOptions{4096});
+        // Large enough to hold every tree, the benchmark measures the nodes, not the disk
+        BufferPool pool(pager, 1 << 18);
+
+        std::vector<uint64_t> ids(keys);
+        uint64_t state = 3;
+        for (uint64_t& id : ids)
+            id = Next(state);
+
+        for (bool sequential : {true, false}) {
+            uint32_t root = BTree::Create(pool, KeyType::kINTEGER);
+            BTree tree(pool, root, KeyType::kINTEGER);
+            std::vector<uint64_t> order(ids);
+            if (sequential)
+                std::sort(order.begin(), order.end());
+            auto start = std::chrono::steady_clock::now();
+            for (uint64_t id : order) {
+                int64_t value = static_cast<int64_t>(id);
+                tree.Insert(value, reinterpret_cast<const uint8_t*>(&value), sizeof(value));
+            }
+            double seconds = Since(start);
+            printf("%zu %s long keys  %8.1f ns/insert  height %u  %lu splits\n", keys,
+                   sequential ? "sequential" : "random", seconds * 1e9 / keys, tree.Height(),
+                   static_cast<unsigned long>(tree.Splits()));
+            Probe(tree, ids, [](uint64_t id) { return BTreeKey(static_cast<int64_t>(id)); });
+        }
+
+        {
+            uint32_t root = BTree::Create(pool, KeyType::kSTRING);
+            BTree tree(pool, root, KeyType::kSTRING);
+            auto start = std::chrono::steady_clock::now();
+            for (uint64_t id : ids) {
+                int64_t value = static_cast<int64_t>(id);
+                tree.Insert(CustomerKey(id % 10000000000ULL), reinterpret_cast<const uint8_t*>(&value), sizeof(value));
+            }
+            double seconds = Since(start);
+            printf("%zu random string keys  %8.1f ns/insert  height %u  %lu splits\n", keys, seconds * 1e9 / keys,
+                   tree.Height(), static_cast<unsigned long>(tree.Splits()));
+            std::string key;
+            Probe(tree, ids, [&key](uint64_t id) {
+                key = CustomerKey(id % 10000000000ULL);
+                return BTreeKey(key);
+            });
+        }
+        pool.FlushAll();
+        printf("%u pages of %u bytes in the file\n", pager.PageCount(), pager.PageSize());
+    } catch (const FileException& e) {
+        printf("FileException: %s\n", e.what());
+        unlink(file_path);
+        return -1;
+    }
+    unlink(file_path);
+    return 0;
+}
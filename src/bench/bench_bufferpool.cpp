@@ -0,0 +1,95 @@
+// C++ Includes
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// C Includes
+#include <unistd.h>
+
+// Local Includes
+#include "exception/file_exception.h"
+#include "file/bufferpool.h"
+#include "storage/pager.h"
+
+/**
+ * @brief Page numbers to visit, uniform or with 80% of the visits going to 20% of the pages
+ */
+static std::vector<uint32_t> AccessPattern(uint32_t pages, size_t count, bool skewed) {
+    std::vector<uint32_t> pattern(count);
+    uint64_t state = 7;
+    uint32_t hot = pages / 5;
+    for (size_t i = 0; i < count; ++i) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        uint32_t pick = static_cast<uint32_t>(state >> 33);
+        if (skewed && pick % 10 < 8)
+            pattern[i] = 1 + (pick / 10) % hot;
+        else
+            pattern[i] = 1 + (pick / 10) % pages;
+    }
+    return pattern;
+}
+
+int main(int argc, char* argv[]) {
+    uint32_t pages = (argc > 1) ? static_cast<uint32_t>(strtoul(argv[1], nullptr, 10)) : 16384;
+    const char* file_path = (argc > 2) ? argv[2] : "bench_bufferpool.tmp";
+    const size_t visits = 1000000;
+
+    try {
+        Pager pager;
+        pager.Create(file_path, PagerOptions{4096});
+        {
+            BufferPool pool(pager, 1024);
+            for (uint32_t i = 0; i < pages; ++i)
+                pool.PinNew(PageType::kDATA);
+            pool.FlushAll();
+            printf("%u pages of %u bytes, %lu written in %lu batches\n", pages, pager.PageSize(),
+                   static_cast<unsigned long>(pool.PagesWritten()), static_cast<unsigned long>(pool.WriteBatches()));
+        }
+
+        for (bool skewed : {false, true}) {
+            std::vector<uint32_t> pattern = AccessPattern(pages, visits, skewed);
+            printf("%s reads\n", skewed ? "80/20 skewed" : "uniform");
+            for (uint32_t divisor : {16, 8, 4, 2, 1}) {
+                BufferPool pool(pager, pages / divisor);
+                // Warm the pool once, then measure
+                for (uint32_t page_no : pattern)
+                    pool.Pin(page_no);
+                uint64_t hits = pool.Hits(), misses = pool.Misses(), evictions = pool.Evictions();
+                auto start = std::chrono::steady_clock::now();
+                for (uint32_t page_no : pattern)
+                    pool.Pin(page_no);
+                std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+                hits = pool.Hits() - hits;
+                misses = pool.Misses() - misses;
+                printf("  pool 1/%-3u %6zu frames  hit ratio %6.2f%%  %8.1f ns/pin  %8lu evictions\n", divisor,
+                       pool.Capacity(), 100.0 * hits / (hits + misses), elapsed.count() * 1e9 / visits,
+                       static_cast<unsigned long>(pool.Evictions() - evictions));
+            }
+        }
+
+        // Updates, every dirty eviction cleans a sorted batch ahead of the clock hand
+        {
+            std::vector<uint32_t> pattern = AccessPattern(pages, visits / 10, true);
+            BufferPool pool(pager, pages / 8);
+            auto start = std::chrono::steady_clock::now();
+            for (uint32_t page_no : pattern)
+                pool.Pin(page_no).MarkDirty();
+            pool.FlushAll();
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            printf("80/20 updates, pool 1/8  %8.1f ns/update  %lu pages written in %lu batches, %lu write calls\n",
+                   elapsed.count() * 1e9 / pattern.size(), static_cast<unsigned long>(pool.PagesWritten()),
+                   static_cast<unsigned long>(pool.WriteBatches()),
+                   static_cast<unsigned long>(pager.File().WriteCalls()));
+        }
+        pager.Close();
+    } catch (const FileException& e) {
+        printf("FileException: %s\n", e.what());
+        unlink(file_path);
+        return -1;
+    }
+    unlink(file_path);
+    return 0;
+}
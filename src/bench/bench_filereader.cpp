@@ -0,0 +1,189 @@
+// C++ Includes
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+
+// C Includes
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+// Local Includes
+#include "file/filereader.h"
+
+/**
+ * @brief The original FileReader loops, kept here as the baseline to measure against
+ */
+class BaselineReader {
+public:
+    explicit BaselineReader(const char* file_path)
+    : eof_(false), fd_(open(file_path, O_RDONLY)), buffer_(std::make_unique<uint8_t[]>(4096)), buffer_start_(0), buffer_end_(0) {}
+
+    ~BaselineReader() { close(fd_); }
+
+    size_t ReadBuffer(uint8_t* buffer, size_t buffer_size) {
+        size_t bytes_read = 0;
+        while(!eof_ && bytes_read < buffer_size) {
+            size_t transfer = buffer_end_ - buffer_start_;
+            if (buffer_start_ == buffer_end_)
+                transfer = FillBuffer();
+            transfer = (transfer < (buffer_size-bytes_read)) ? transfer : (buffer_size-bytes_read);
+            memcpy(buffer+bytes_read, buffer_.get()+buffer_start_, transfer);
+            buffer_start_ += transfer;
+            bytes_read += transfer;
+        }
+        return bytes_read;
+    }
+
+    size_t ReadLine(uint8_t* buffer, size_t buffer_size, uint8_t end) {
+        size_t bytes_read = 0;
+        while(!eof_ && bytes_read < buffer_size) {
+            if (buffer_start_ == buffer_end_)
+                FillBuffer();
+            while(buffer_start_ < buffer_end_ && bytes_read < buffer_size) {
+                buffer[bytes_read++] = buffer_[buffer_start_];
+                if (buffer_[buffer_start_++] == end)
+                    return bytes_read;
+            }
+        }
+        return bytes_read;
+    }
+
+private:
+    size_t FillBuffer() {
+        buffer_start_ = 0;
+        ssize_t ret_val = read(fd_, buffer_.get(), 4096);
+        buffer_end_ = (ret_val > 0) ? static_cast<size_t>(ret_val) : 0;
+        if (buffer_end_ == 0)
+            eof_ = true;
+        return buffer_end_;
+    }
+
+    bool eof_;
+    int fd_;
+    std::unique_ptr<uint8_t[]> buffer_;
+    size_t buffer_start_;
+    size_t buffer_end_;
+};
+
+/**
+ * @brief Time fn, which returns the number of bytes it consumed, and print the throughput
+ */
+template <typename Fn>
+static void Measure(const char* name, Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    size_t bytes = fn();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    printf("%-32s %10.1f MB/s  (%zu bytes)\n", name, bytes / elapsed.count() / (1024.0 * 1024.0), bytes);
+}
+
+/**
+ * @brief Ask the kernel to drop the cached pages of file_path so the next read goes to the device
+ */
+static void DropPageCache(const char* file_path) {
+    int fd = open(file_path, O_RDONLY);
+    if (fd == -1)
+        return;
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+}
+
+/**
+ * @brief Consume the file a byte at a time with a little work per byte, like the tokenizer does
+ */
+static size_t ConsumeBytes(const char* file_path, ReadMode mode, uint64_t& checksum) {
+    FileReader reader(file_path, mode);
+    size_t total = 0;
+    while (true) {
+        uint8_t byte = reader.ReadByte();
+        if (reader.End())
+            break;
+        checksum = (checksum ^ byte) * 0x100000001b3ULL;
+        ++total;
+    }
+    return total;
+}
+
+int main(int argc, char* argv[]) {
+    size_t file_mb = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 256;
+    const char* file_path = (argc > 2) ? argv[2] : "bench_filereader.tmp";
+
+    // Generate a bulk data file of ~80 byte lines
+    {
+        FILE* file = fopen(file_path, "w");
+        if (file == nullptr) {
+            perror("fopen");
+            return -1;
+        }
+        std::string line(79, 'x');
+        line += '\n';
+        for (size_t i = 0; i < file_mb * 1024 * 1024 / line.size(); ++i)
+            fwrite(line.data(), 1, line.size(), file);
+        fclose(file);
+    }
+
+    const size_t kLineSize = 1024;
+    const size_t kBlockSize = 1 << 20;
+    auto line = std::make_unique<uint8_t[]>(kLineSize);
+    auto block = std::make_unique<uint8_t[]>(kBlockSize);
+
+    Measure("baseline ReadLine", [&]() {
+        BaselineReader reader(file_path);
+        size_t total = 0, bytes_read;
+        while ((bytes_read = reader.ReadLine(line.get(), kLineSize, '\n')) != 0)
+            total += bytes_read;
+        return total;
+    });
+    Measure("FileReader::ReadLine", [&]() {
+        FileReader reader(file_path);
+        size_t total = 0, bytes_read;
+        while ((bytes_read = reader.ReadLine(line.get(), kLineSize, '\n')) != 0)
+            total += bytes_read;
+        return total;
+    });
+    Measure("FileReader::ReadLine (mmap)", [&]() {
+        FileReader reader(file_path, ReadMode::kMMAP);
+        size_t total = 0, bytes_read;
+        while ((bytes_read = reader.ReadLine(line.get(), kLineSize, '\n')) != 0)
+            total += bytes_read;
+        return total;
+    });
+    Measure("baseline ReadBuffer (1 MB)", [&]() {
+        BaselineReader reader(file_path);
+        size_t total = 0, bytes_read;
+        while ((bytes_read = reader.ReadBuffer(block.get(), kBlockSize)) != 0)
+            total += bytes_read;
+        return total;
+    });
+    Measure("FileReader::ReadBuffer (1 MB)", [&]() {
+        FileReader reader(file_path);
+        size_t total = 0, bytes_read;
+        while ((bytes_read = reader.ReadBuffer(block.get(), kBlockSize)) != 0)
+            total += bytes_read;
+        return total;
+    });
+
+    uint64_t checksum = 0xcbf29ce484222325ULL;
+    const std::pair<const char*, ReadMode> kModes[] = {
+        {"sync", ReadMode::kBUFFERED},
+        {"read-ahead", ReadMode::kREAD_AHEAD}
+    };
+    for (bool cold : {true, false}) {
+        for (const auto& mode : kModes) {
+            std::string name = std::string("ReadByte ") + mode.first + (cold ? " (cold)" : " (warm)");
+            if (cold)
+                DropPageCache(file_path);
+            Measure(name.c_str(), [&]() { return ConsumeBytes(file_path, mode.second, checksum); });
+        }
+    }
+    printf("checksum %016llx\n", static_cast<unsigned long long>(checksum));
+
+    unlink(file_path);
+    return 0;
+}
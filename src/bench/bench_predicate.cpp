@@ -0,0 +1,124 @@
+// C++ Includes
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Local Includes
+#include "exception/vm_exception.h"
+#include "parser/arena.h"
+#include "parser/optimizer.h"
+#include "parser/parser.h"
+#include "parser/tokenbuffer.h"
+#include "parser/tokenizer.h"
+#include "schema/catalog.h"
+#include "schema/record.h"
+#include "vm/predicate.h"
+
+static const char* mSchema = "struct Order {\n"
+                             "    primary long id;\n"
+                             "    int quantity;\n"
+                             "    double price;\n"
+                             "    float discount;\n"
+                             "    short region;\n"
+                             "    bool shipped;\n"
+                             "    string customer;\n"
+                             "};\n";
+
+static const char* mPredicates[] = {
+    "quantity > 50;",
+    "quantity >= 10 && quantity < 90 && price > 250.0;",
+    "price * quantity > 10000.0 && !shipped;",
+    "region == 3 || region == 7 || (discount > 0.25 && quantity < 20);",
+    "customer == \"acme\" && quantity > 10;",
+};
+
+static const char* mModeName[] = {"interpret", "closure", "native"};
+
+int main(int argc, char* argv[]) {
+    uint64_t rows = (argc > 1) ? strtoull(argv[1], nullptr, 10) : 1000000;
+    int32_t passes = 5;
+
+    Tokenizer tokenizer;
+    TokenBuffer tokens;
+    Parser parser;
+    Arena arena;
+    SchemaCatalog catalog;
+    tokenizer.OpenString(mSchema);
+    tokenizer.Tokenize(tokens);
+    catalog.AddProgram(parser.Parse(tokens, arena));
+    const RecordLayout& layout = *catalog.Find("Order");
+
+    // Records packed back to back like a heap page, every tenth field left null
+    std::vector<uint8_t> heap;
+    std::vector<size_t> offsets;
+    RecordBuilder builder(layout);
+    const char* customers[] = {"acme", "globex", "initech", "umbrella"};
+    uint64_t state = 1;
+    for (uint64_t i = 0; i < rows; ++i) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        uint32_t pick = static_cast<uint32_t>(state >> 33);
+        builder.Reset();
+        builder.SetInteger(layout.Field(0), static_cast<int64_t>(i));
+        if (pick % 10 != 0)
+            builder.SetInteger(layout.Field(1), pick % 100);
+        builder.SetReal(layout.Field(2), static_cast<double>(pick % 50000) / 100.0);
+        builder.SetReal(layout.Field(3), static_cast<double>(pick % 64) / 128.0);
+        builder.SetInteger(layout.Field(4), (pick >> 8) % 12);
+        builder.SetBool(layout.Field(5), (pick >> 12) % 3 == 0);
+        builder.SetString(layout.Field(6), customers[(pick >> 16) % 4]);
+        std::vector<uint8_t> record = builder.Finish();
+        // Keep every record 8 byte aligned like a page would
+        offsets.push_back(heap.size());
+        heap.insert(heap.end(), record.begin(), record.end());
+        heap.resize((heap.size() + 7) / 8 * 8);
+    }
+    std::vector<const uint8_t*> records;
+    for (size_t offset : offsets)
+        records.push_back(heap.data() + offset);
+    printf("%lu records, %zu bytes\n", static_cast<unsigned long>(rows), heap.size());
+
+    try {
+        for (const char* text : mPredicates) {
+            Arena expression_arena;
+            Optimizer optimizer;
+            tokenizer.OpenString(text);
+            tokenizer.Tokenize(tokens);
+            const AstNode* root = optimizer.Optimize(parser.Parse(tokens, expression_arena), expression_arena);
+            printf("%s\n", text);
+
+            double interpreted = 0.0;
+            for (int32_t mode = 0; mode < 3; ++mode) {
+                Predicate predicate;
+                predicate.Compile(root->first_child->first_child, catalog, layout.TypeId(),
+                                  static_cast<PredicateMode>(mode));
+                double best = 1e300;
+                size_t matches = 0;
+                for (int32_t pass = 0; pass < passes; ++pass) {
+                    auto start = std::chrono::steady_clock::now();
+                    matches = predicate.Count(records.data(), records.size());
+                    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+                    if (elapsed.count() < best)
+                        best = elapsed.count();
+                }
+                if (mode == 0)
+                    interpreted = best;
+                char name[32];
+                snprintf(name, sizeof(name), "  %s%s", mModeName[mode],
+                         (static_cast<int32_t>(predicate.Mode()) != mode) ? " (closure)" : "");
+                printf("%-22s %8.2f ns/row %8.1f M rows/s %6.2fx  (%zu matches", name, best * 1e9 / rows,
+                       rows / best / 1e6, interpreted / best, matches);
+                if (predicate.CodeSize() > 0)
+                    printf(", %zu bytes of code", predicate.CodeSize());
+                printf(")\n");
+            }
+        }
+    } catch (const VmException& e) {
+        printf("VmException: %s\n", e.what());
+        return -1;
+    }
+    return 0;
+}
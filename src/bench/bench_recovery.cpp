@@ -0,0 +1,105 @@
+// C++ Includes
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// C Includes
+#include <unistd.h>
+
+// Local Includes
+#include "exception/file_exception.h"
+#include "storage/pager.h"
+#include "storage/wal.h"
+
+#define PAGE_SIZE 4096
+#define DATABASE_PAGES 65536
+#define PAGES_PER_COMMIT 4
+
+static uint64_t Next(uint64_t& state) {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return state >> 17;
+}
+
+static double Since(std::chrono::steady_clock::time_point start) {
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+static void CopyFile(const std::string& from, const std::string& to) {
+    std::ifstream in(from, std::ios::binary);
+    std::ofstream out(to, std::ios::binary | std::ios::trunc);
+    out << in.rdbuf();
+}
+
+/**
+ * @brief Leave a log of at least log_bytes behind, as a crash would, commits of random pages of the database
+ */
+static void WriteLog(const std::string& file_path, uint64_t log_bytes) {
+    WalOptions options;
+    options.durability = Durability::kNONE;
+    options.buffer_size = 8 << 20;
+    WriteAheadLog log(file_path, PAGE_SIZE, options);
+    std::vector<uint8_t> images(PAGES_PER_COMMIT * PAGE_SIZE);
+    uint32_t page_nos[PAGES_PER_COMMIT];
+    uint8_t* pages[PAGES_PER_COMMIT];
+    uint64_t state = 5;
+    while (log.Size() < log_bytes) {
+        for (size_t i = 0; i < PAGES_PER_COMMIT; ++i) {
+            page_nos[i] = 1 + static_cast<uint32_t>(Next(state) % (DATABASE_PAGES - 1));
+            pages[i] = images.data() + i * PAGE_SIZE;
+            pages[i][sizeof(PageHeader)] = static_cast<uint8_t>(state);
+        }
+        log.Commit(page_nos, pages, PAGES_PER_COMMIT);
+    }
+    log.Close();
+}
+
+int main(int argc, char* argv[]) {
+    uint64_t max_mib = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 256;
+    const char* file_path = (argc > 2) ? argv[2] : "bench_recovery.tmp";
+    std::string log_path = WriteAheadLog::PathFor(file_path);
+    std::string saved_path = log_path + ".saved";
+    uint32_t cores = (std::thread::hardware_concurrency() != 0) ? std::thread::hardware_concurrency() : 1;
+
+    try {
+        {
+            Pager pager;
+            pager.Create(file_path, PagerOptions{PAGE_SIZE});
+        }
+        printf("%d pages of %d bytes, %d pages per commit, %u cores\n", DATABASE_PAGES, PAGE_SIZE, PAGES_PER_COMMIT,
+               cores);
+        for (uint64_t mib = 16; mib <= max_mib; mib *= 4) {
+            WriteLog(file_path, mib << 20);
+            CopyFile(log_path, saved_path);
+            for (uint32_t threads : {1u, cores}) {
+                // The same log each run, read from the page cache like the log of a host that just restarted
+                CopyFile(saved_path, log_path);
+                auto start = std::chrono::steady_clock::now();
+                RecoveryStats stats = WriteAheadLog::Recover(file_path, PAGE_SIZE, threads);
+                double seconds = Since(start);
+                printf("%5lu MiB log  %2u threads  %8.1f ms  %7.1f MiB/s  %lu records  %lu commits  %lu pages\n",
+                       static_cast<unsigned long>(mib), stats.threads, seconds * 1e3,
+                       static_cast<double>(stats.log_bytes) / (1 << 20) / seconds,
+                       static_cast<unsigned long>(stats.records), static_cast<unsigned long>(stats.commits),
+                       static_cast<unsigned long>(stats.pages));
+                if (threads == cores)
+                    break;
+            }
+        }
+    } catch (const FileException& e) {
+        printf("FileException: %s\n", e.what());
+        unlink(file_path);
+        unlink(log_path.c_str());
+        unlink(saved_path.c_str());
+        return -1;
+    }
+    unlink(file_path);
+    unlink(log_path.c_str());
+    unlink(saved_path.c_str());
+    return 0;
+}
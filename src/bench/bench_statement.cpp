@@ -0,0 +1,124 @@
+// C++ Includes
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+
+// Local Includes
+#include "exception/vm_exception.h"
+#include "parser/arena.h"
+#include "parser/parser.h"
+#include "parser/tokenbuffer.h"
+#include "parser/tokenizer.h"
+#include "schema/catalog.h"
+#include "vm/compiler.h"
+#include "vm/statement.h"
+#include "vm/statementcache.h"
+#include "vm/vm.h"
+
+static const char* mSchema = "struct Account {\n"
+                             "    primary long id;\n"
+                             "    string owner;\n"
+                             "    double balance = 0.0;\n"
+                             "    int deposits;\n"
+                             "};\n";
+
+// The same statement with its values spliced into the text, as a client without placeholders would send it
+static std::string Literal(uint64_t i) {
+    return "Account a = Account(id=" + std::to_string(i) + ", owner=\"user" + std::to_string(i % 100) +
+           "\", deposits=1);\n"
+           "a.balance += " + std::to_string(i % 1000) + ".5;\n"
+           "if (a.balance > 500.0)\n"
+           "    a.deposits += 1;\n"
+           "print(a.id, a.deposits);\n";
+}
+
+static const char* mPrepared = "Account a = Account(id=$id, owner=$owner, deposits=1);\n"
+                               "a.balance += $amount;\n"
+                               "if (a.balance > 500.0)\n"
+                               "    a.deposits += 1;\n"
+                               "print(a.id, a.deposits);\n";
+
+static void Report(const char* name, double seconds, uint64_t executions, size_t bytes) {
+    printf("%-24s %8.3f s %8.2f us/statement %10.0f statements/s  (%zu bytes of output)\n", name, seconds,
+           seconds * 1e6 / executions, executions / seconds, bytes);
+}
+
+int main(int argc, char* argv[]) {
+    uint64_t executions = (argc > 1) ? strtoull(argv[1], nullptr, 10) : 200000;
+
+    Tokenizer tokenizer;
+    TokenBuffer tokens;
+    Parser parser;
+    Arena schema_arena;
+    SchemaCatalog catalog;
+    tokenizer.OpenString(mSchema);
+    tokenizer.Tokenize(tokens);
+    catalog.AddProgram(parser.Parse(tokens, schema_arena));
+
+    try {
+        // Lex, parse and compile every statement from scratch
+        {
+            std::ostringstream out;
+            Vm vm(out);
+            Arena arena;
+            Compiler compiler;
+            auto start = std::chrono::steady_clock::now();
+            for (uint64_t i = 0; i < executions; ++i) {
+                std::string text = Literal(i);
+                tokenizer.OpenView(text);
+                tokenizer.Tokenize(tokens);
+                arena.Reset();
+                Program program = compiler.Compile(parser.Parse(tokens, arena), catalog);
+                vm.Run(program);
+            }
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            Report("reparse every time", elapsed.count(), executions, out.str().size());
+        }
+
+        // Look the text up in the cache every time, then bind
+        {
+            std::ostringstream out;
+            Vm vm(out);
+            StatementCache cache(catalog);
+            auto start = std::chrono::steady_clock::now();
+            for (uint64_t i = 0; i < executions; ++i) {
+                PreparedStatement statement = cache.Prepare(mPrepared);
+                statement.BindInteger(0, static_cast<int64_t>(i));
+                statement.BindString(1, "user" + std::to_string(i % 100));
+                statement.BindReal(2, static_cast<double>(i % 1000) + 0.5);
+                statement.Execute(vm);
+            }
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            Report("cache lookup and bind", elapsed.count(), executions, out.str().size());
+            printf("%-24s hits=%lu misses=%lu\n", "", static_cast<unsigned long>(cache.Hits()),
+                   static_cast<unsigned long>(cache.Misses()));
+        }
+
+        // Prepare once, only bind and run in the loop
+        {
+            std::ostringstream out;
+            Vm vm(out);
+            StatementCache cache(catalog);
+            PreparedStatement statement = cache.Prepare(mPrepared);
+            size_t id = statement.ParameterIndex("id");
+            size_t owner = statement.ParameterIndex("owner");
+            size_t amount = statement.ParameterIndex("amount");
+            auto start = std::chrono::steady_clock::now();
+            for (uint64_t i = 0; i < executions; ++i) {
+                statement.BindInteger(id, static_cast<int64_t>(i));
+                statement.BindString(owner, "user" + std::to_string(i % 100));
+                statement.BindReal(amount, static_cast<double>(i % 1000) + 0.5);
+                statement.Execute(vm);
+            }
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            Report("prepared once", elapsed.count(), executions, out.str().size());
+        }
+    } catch (const VmException& e) {
+        printf("VmException: %s\n", e.what());
+        return -1;
+    }
+    return 0;
+}
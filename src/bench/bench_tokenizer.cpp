@@ -0,0 +1,125 @@
+// C++ Includes
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+
+// C Includes
+#include <unistd.h>
+
+// Local Includes
+#include "parser/charscan.h"
+#include "parser/paralleltokenizer.h"
+#include "parser/tokenbuffer.h"
+#include "parser/tokenizer.h"
+
+/**
+ * @brief Generate a bulk-load style script of struct declarations and insert statements
+ */
+static std::string GenerateScript(size_t target_bytes) {
+    std::mt19937 rng(42);
+    std::string script;
+    script.reserve(target_bytes + 1024);
+    script += "// Generated benchmark input\n"
+              "struct Student {\n"
+              "    primary int uid;\n"
+              "    secondary notnull string name;\n"
+              "    float gpa = 4.0;\n"
+              "    string[] classes;\n"
+              "};\n\n";
+    for (size_t i = 0; script.size() < target_bytes; ++i) {
+        script += "Student s" + std::to_string(i) + " = Student(uid=" + std::to_string(rng() % 1000000) +
+                  ", name=\"student name " + std::to_string(rng()) + "\", gpa=" + std::to_string(rng() % 4) + "." +
+                  std::to_string(rng() % 100) + ");\n";
+        script += "trunk.insert(s" + std::to_string(i) + "); // row " + std::to_string(i) + "\n";
+        if (i % 16 == 0)
+            script += "while (count < 100 && done != true) { count += 1; }\n";
+    }
+    return script;
+}
+
+/**
+ * @brief Run the tokenizer to the end of its input and print the throughput
+ */
+static void Measure(const char* name, Tokenizer& tokenizer, size_t input_bytes) {
+    auto start = std::chrono::steady_clock::now();
+    size_t tokens = 0;
+    size_t value_bytes = 0;
+    while (tokenizer.NextToken() != TokenType::kEOF) {
+        value_bytes += tokenizer.CurrTokenView().size();
+        ++tokens;
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    printf("%-24s %8.2f M tokens/s %9.1f MB/s  (%zu tokens, %zu value bytes)\n", name,
+           tokens / elapsed.count() / 1e6, input_bytes / elapsed.count() / (1024.0 * 1024.0), tokens, value_bytes);
+}
+
+int main(int argc, char* argv[]) {
+    size_t input_mb = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 64;
+    const char* file_path = (argc > 2) ? argv[2] : "bench_tokenizer.tmp";
+
+    std::string script = GenerateScript(input_mb * 1024 * 1024);
+    FILE* file = fopen(file_path, "w");
+    if (file == nullptr) {
+        perror("fopen");
+        return -1;
+    }
+    fwrite(script.data(), 1, script.size(), file);
+    fclose(file);
+
+    // Run scanning kernels, in memory so only the lexer is measured
+    static const char* level_names[] = {"OpenString (scalar)", "OpenString (sse2)", "OpenString (avx2)"};
+    ScanLevel supported = SupportedScanLevel();
+    for (uint8_t level = 0; level <= static_cast<uint8_t>(supported); ++level) {
+        SetScanLevel(static_cast<ScanLevel>(level));
+        Tokenizer tokenizer;
+        tokenizer.OpenString(script);
+        Measure(level_names[level], tokenizer, script.size());
+    }
+    SetScanLevel(supported);
+
+    {
+        // Batch mode, includes copying every value into the buffer
+        Tokenizer tokenizer;
+        TokenBuffer buffer;
+        tokenizer.OpenString(script);
+        auto start = std::chrono::steady_clock::now();
+        tokenizer.Tokenize(buffer);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        printf("%-24s %8.2f M tokens/s %9.1f MB/s  (%zu tokens, %zu value bytes)\n", "Tokenize (batch)",
+               buffer.Size() / elapsed.count() / 1e6, script.size() / elapsed.count() / (1024.0 * 1024.0), buffer.Size(),
+               buffer.Text().size());
+    }
+    {
+        Tokenizer tokenizer(ReadMode::kMMAP);
+        tokenizer.OpenFile(file_path);
+        Measure("OpenFile (mmap)", tokenizer, script.size());
+    }
+    {
+        Tokenizer tokenizer(ReadMode::kBUFFERED);
+        tokenizer.OpenFile(file_path);
+        Measure("OpenFile (buffered)", tokenizer, script.size());
+    }
+    {
+        Tokenizer tokenizer(ReadMode::kREAD_AHEAD);
+        tokenizer.OpenFile(file_path);
+        Measure("OpenFile (read-ahead)", tokenizer, script.size());
+    }
+
+    {
+        // Chunked over every hardware thread, mapped and stitched into one buffer
+        ParallelTokenizer tokenizer;
+        TokenBuffer buffer;
+        auto start = std::chrono::steady_clock::now();
+        tokenizer.TokenizeFile(file_path, buffer);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        printf("Parallel (%2u threads)    %8.2f M tokens/s %9.1f MB/s  (%zu tokens, %zu value bytes)\n", tokenizer.Threads(),
+               buffer.Size() / elapsed.count() / 1e6, script.size() / elapsed.count() / (1024.0 * 1024.0), buffer.Size(),
+               buffer.Text().size());
+    }
+
+    unlink(file_path);
+    return 0;
+}
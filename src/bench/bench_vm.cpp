@@ -0,0 +1,122 @@
+// C++ Includes
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+
+// Local Includes
+#include "exception/vm_exception.h"
+#include "parser/arena.h"
+#include "parser/optimizer.h"
+#include "parser/parser.h"
+#include "parser/tokenbuffer.h"
+#include "parser/tokenizer.h"
+#include "schema/catalog.h"
+#include "vm/bytecode.h"
+#include "vm/compiler.h"
+#include "vm/vm.h"
+
+/**
+ * @brief Compile a script and print the best of a few runs, per loop iteration
+ */
+static void Measure(const char* name, const std::string& script, uint64_t iterations) {
+    Tokenizer tokenizer;
+    TokenBuffer tokens;
+    tokenizer.OpenString(script);
+    tokenizer.Tokenize(tokens);
+    Parser parser;
+    Arena arena;
+    Optimizer optimizer;
+    const AstNode* root = optimizer.Optimize(parser.Parse(tokens, arena), arena);
+    SchemaCatalog catalog;
+    catalog.AddProgram(root);
+    Compiler compiler;
+    Program program = compiler.Compile(root, catalog);
+
+    double best = 1e300;
+    std::string output;
+    uint64_t calls = 0;
+    for (int32_t round = 0; round < 3; ++round) {
+        std::ostringstream out;
+        Vm vm(out);
+        auto start = std::chrono::steady_clock::now();
+        vm.Run(program);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if (elapsed.count() < best)
+            best = elapsed.count();
+        output = out.str();
+        calls = vm.Calls();
+    }
+    if (!output.empty() && output.back() == '\n')
+        output.pop_back();
+    printf("%-20s %8.3f s %8.2f ns/iteration %8.1f M iterations/s  (%lu calls, result %s)\n", name, best,
+           best * 1e9 / iterations, iterations / best / 1e6, static_cast<unsigned long>(calls), output.c_str());
+}
+
+int main(int argc, char* argv[]) {
+    uint64_t iterations = (argc > 1) ? strtoull(argv[1], nullptr, 10) : 10000000;
+    std::string n = std::to_string(iterations);
+
+    try {
+        // Integer arithmetic with a data dependent branch
+        Measure("arithmetic", "main() {\n"
+                              "    long sum = 0;\n"
+                              "    long n = " + n + ";\n"
+                              "    for (long i = 0; i < n; i += 1) {\n"
+                              "        sum += i * 3 % 7;\n"
+                              "        if (sum % 2 == 0)\n"
+                              "            sum -= 1;\n"
+                              "    }\n"
+                              "    print(sum);\n"
+                              "}\n", iterations);
+
+        // Mixed integer and real math
+        Measure("real", "main() {\n"
+                        "    double x = 0.0;\n"
+                        "    int i = 0;\n"
+                        "    int n = " + n + ";\n"
+                        "    while (i < n) {\n"
+                        "        x = x * 0.5 + i / 3.0;\n"
+                        "        i += 1;\n"
+                        "    }\n"
+                        "    print(x);\n"
+                        "}\n", iterations);
+
+        // Batch update style field reads and writes on one record
+        Measure("field updates", "struct Account {\n"
+                                 "    primary long id;\n"
+                                 "    double balance = 0.0;\n"
+                                 "    int deposits;\n"
+                                 "    short tier = 1;\n"
+                                 "};\n"
+                                 "main() {\n"
+                                 "    Account a = Account(id=1, deposits=0);\n"
+                                 "    long n = " + n + ";\n"
+                                 "    for (long i = 0; i < n; i += 1) {\n"
+                                 "        a.balance += 1.5;\n"
+                                 "        a.deposits += 1;\n"
+                                 "        if (a.deposits % 1000 == 0)\n"
+                                 "            a.tier = a.deposits / 1000 % 100;\n"
+                                 "    }\n"
+                                 "    print(a.balance, a.deposits, a.tier);\n"
+                                 "}\n", iterations);
+
+        // Call and return, one call per iteration
+        Measure("calls", "int step(int x, int y) {\n"
+                         "    return x + y % 3;\n"
+                         "}\n"
+                         "main() {\n"
+                         "    int x = 0;\n"
+                         "    long n = " + n + ";\n"
+                         "    for (long i = 0; i < n; i += 1)\n"
+                         "        x = step(x, 7) % 1000;\n"
+                         "    print(x);\n"
+                         "}\n", iterations);
+    } catch (const VmException& e) {
+        printf("VmException: %s\n", e.what());
+        return -1;
+    }
+    return 0;
+}
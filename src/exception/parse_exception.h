@@ -0,0 +1,22 @@
+#ifndef DT_SRC_EXCEPTION_PARSE_EXCEPTION_H
+#define DT_SRC_EXCEPTION_PARSE_EXCEPTION_H
+
+#include <exception>
+#include <string>
+
+class ParseException : public std::exception {
+public:
+    explicit ParseException(const char* msg) : msg_(msg) {}
+    explicit ParseException(const std::string& msg) : msg_(msg) {}
+
+    virtual ~ParseException() noexcept {}
+
+    virtual const char* what() const noexcept {
+        return msg_.c_str();
+    }
+
+private:
+    std::string msg_;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,22 @@
+#ifndef DT_SRC_EXCEPTION_SCHEMA_EXCEPTION_H
+#define DT_SRC_EXCEPTION_SCHEMA_EXCEPTION_H
+
+#include <exception>
+#include <string>
+
+class SchemaException : public std::exception {
+public:
+    explicit SchemaException(const char* msg) : msg_(msg) {}
+    explicit SchemaException(const std::string& msg) : msg_(msg) {}
+
+    virtual ~SchemaException() noexcept {}
+
+    virtual const char* what() const noexcept {
+        return msg_.c_str();
+    }
+
+private:
+    std::string msg_;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,22 @@
+#ifndef DT_SRC_EXCEPTION_VM_EXCEPTION_H
+#define DT_SRC_EXCEPTION_VM_EXCEPTION_H
+
+#include <exception>
+#include <string>
+
+class VmException : public std::exception {
+public:
+    explicit VmException(const char* msg) : msg_(msg) {}
+    explicit VmException(const std::string& msg) : msg_(msg) {}
+
+    virtual ~VmException() noexcept {}
+
+    virtual const char* what() const noexcept {
+        return msg_.c_str();
+    }
+
+private:
+    std::string msg_;
+};
+
+#endif
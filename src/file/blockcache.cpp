@@ -0,0 +1,122 @@
+// C++ Includes
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+
+// C Includes
+#include <string.h>
+
+// Local Includes
+#include "exception/file_exception.h"
+#include "blockcache.h"
+
+/**
+ * BlockCache
+ */
+BlockCache::BlockCache(const FileReader& reader, size_t capacity, size_t block_size)
+: reader_(reader), capacity_(capacity), block_size_(block_size), blocks_(nullptr),
+  frame_block_(capacity), frame_valid_(capacity, 0), frame_ref_(capacity, 0),
+  clock_hand_(0), frames_used_(0), hits_(0), misses_(0)
+{
+    if (capacity_ == 0)
+        throw FileException("BlockCache capacity must be at least one block");
+    if (block_size_ < 512 || (block_size_ & (block_size_ - 1)) != 0)
+        throw FileException("BlockCache block size must be a power of two of at least 512 bytes");
+    blocks_ = static_cast<uint8_t*>(aligned_alloc(block_size_, capacity_ * block_size_));
+    if (blocks_ == nullptr)
+        throw FileException(std::string("Failed to allocate block cache: ") + strerror(errno));
+    block_table_.reserve(capacity_);
+}
+
+BlockCache::~BlockCache() {
+    free(blocks_);
+}
+
+size_t BlockCache::ReadAt(uint64_t offset, uint8_t* buffer, size_t buffer_size) {
+    size_t bytes_read = 0;
+    while (bytes_read < buffer_size) {
+        uint64_t block_no = offset / block_size_;
+        size_t block_offset = static_cast<size_t>(offset % block_size_);
+        size_t frame = LoadBlock(block_no);
+        if (block_offset >= frame_valid_[frame])
+            break;
+        size_t transfer = frame_valid_[frame] - block_offset;
+        transfer = (transfer < buffer_size - bytes_read) ? transfer : buffer_size - bytes_read;
+        memcpy(buffer + bytes_read, blocks_ + frame * block_size_ + block_offset, transfer);
+        bytes_read += transfer;
+        offset += transfer;
+        // A short block is the end of the file
+        if (frame_valid_[frame] != block_size_)
+            break;
+    }
+    return bytes_read;
+}
+
+void BlockCache::Invalidate() noexcept {
+    block_table_.clear();
+    frames_used_ = 0;
+    clock_hand_ = 0;
+    for (size_t i = 0; i < capacity_; ++i)
+        frame_ref_[i] = 0;
+}
+
+uint64_t BlockCache::Hits() const noexcept {
+    return hits_;
+}
+
+uint64_t BlockCache::Misses() const noexcept {
+    return misses_;
+}
+
+size_t BlockCache::BlockSize() const noexcept {
+    return block_size_;
+}
+
+size_t BlockCache::Capacity() const noexcept {
+    return capacity_;
+}
+
+size_t BlockCache::LoadBlock(uint64_t block_no) {
+    auto it = block_table_.find(block_no);
+    if (it != block_table_.end()) {
+        ++hits_;
+        frame_ref_[it->second] = 1;
+        return it->second;
+    }
+
+    ++misses_;
+    size_t frame;
+    if (frames_used_ < capacity_) {
+        frame = frames_used_++;
+    } else {
+        frame = EvictFrame();
+        block_table_.erase(frame_block_[frame]);
+    }
+
+    uint8_t* dest = blocks_ + frame * block_size_;
+    size_t valid = 0;
+    try {
+        valid = reader_.ReadFile(block_no * block_size_, dest, block_size_);
+    } catch (...) {
+        // Leave the frame unused so a failed read is never served as data
+        frame_ref_[frame] = 0;
+        frame_block_[frame] = UINT64_MAX;
+        frame_valid_[frame] = 0;
+        throw;
+    }
+    frame_block_[frame] = block_no;
+    frame_valid_[frame] = static_cast<uint32_t>(valid);
+    frame_ref_[frame] = 1;
+    block_table_.emplace(block_no, frame);
+    return frame;
+}
+
+size_t BlockCache::EvictFrame() noexcept {
+    while (frame_ref_[clock_hand_]) {
+        frame_ref_[clock_hand_] = 0;
+        clock_hand_ = (clock_hand_ + 1) % capacity_;
+    }
+    size_t frame = clock_hand_;
+    clock_hand_ = (clock_hand_ + 1) % capacity_;
+    return frame;
+}
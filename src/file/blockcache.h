@@ -0,0 +1,114 @@
+#ifndef DT_SRC_FILE_BLOCKCACHE_H
+#define DT_SRC_FILE_BLOCKCACHE_H
+
+// C++ Includes
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// Local Includes
+#include "file/filereader.h"
+
+/**
+ * @brief Read-only cache of fixed size, page aligned file blocks with CLOCK eviction
+ *
+ * FileReader::ReadAt() goes through one when FileReaderOptions::cache_blocks is set,
+ * blocks are always loaded from the file itself, never from the reader's own cache.
+ */
+class BlockCache {
+public:
+    /**
+     * Tors
+     */
+
+    /**
+     * @brief Construct a cache over reader holding up to capacity blocks
+     * @param reader The open FileReader blocks are read from, must outlive the cache
+     * @param capacity The number of blocks kept in memory
+     * @param block_size The size of each block, a power of two of at least 512 bytes
+     */
+    BlockCache(const FileReader& reader, size_t capacity, size_t block_size = 4096);
+
+    /**
+     * @brief Release the cached blocks
+     */
+    ~BlockCache();
+
+    /**
+     * NON-COPYABLE
+     */
+    BlockCache(const BlockCache&) = delete;
+    BlockCache(BlockCache&&) = delete;
+    BlockCache& operator=(const BlockCache&) = delete;
+
+    /**
+     * Read Functions
+     */
+
+    /**
+     * @brief Read up to buffer_size bytes starting at offset, going to the file only on a miss
+     * @param offset Absolute file offset of the first byte to read
+     * @param buffer Destination buffer of at least size buffer_size
+     * @param buffer_size The maximum number of bytes to read
+     * @return The number of bytes read, short only at the end of the file
+     */
+    size_t ReadAt(uint64_t offset, uint8_t* buffer, size_t buffer_size);
+
+    /**
+     * @brief Drop every cached block, e.g. after the file was changed on disk
+     */
+    void Invalidate() noexcept;
+
+    /**
+     * Stats
+     */
+    uint64_t Hits() const noexcept;
+    uint64_t Misses() const noexcept;
+    size_t BlockSize() const noexcept;
+    size_t Capacity() const noexcept;
+
+private:
+    /**
+     * Internal Functions
+     */
+
+    /**
+     * @brief Find the frame holding block_no, loading it on a miss
+     * @param block_no The block number within the file
+     * @return The frame index holding the block
+     */
+    size_t LoadBlock(uint64_t block_no);
+
+    /**
+     * @brief Advance the clock hand until a frame without its reference bit is found
+     * @return The frame index to reuse
+     */
+    size_t EvictFrame() noexcept;
+
+    /**
+     * Cache Items
+     */
+    const FileReader& reader_;
+    const size_t capacity_;
+    const size_t block_size_;
+    uint8_t* blocks_;
+
+    /**
+     * Frame Items
+     */
+    std::vector<uint64_t> frame_block_;
+    std::vector<uint32_t> frame_valid_;
+    std::vector<uint8_t> frame_ref_;
+    std::unordered_map<uint64_t, size_t> block_table_;
+    size_t clock_hand_;
+    size_t frames_used_;
+
+    /**
+     * Stats Items
+     */
+    uint64_t hits_;
+    uint64_t misses_;
+};
+
+#endif
@@ -0,0 +1,353 @@
+// C++ Includes
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Local Includes
+#include "exception/file_exception.h"
+#include "storage/wal.h"
+#include "bufferpool.h"
+
+/**
+ * PinnedPage
+ */
+PinnedPage::PinnedPage() noexcept
+: pool_(nullptr), page_no_(Pager::NO_PAGE), data_(nullptr), dirty_(false)
+{}
+
+PinnedPage::PinnedPage(BufferPool* pool, uint32_t page_no, uint8_t* data) noexcept
+: pool_(pool), page_no_(page_no), data_(data), dirty_(false)
+{}
+
+PinnedPage::PinnedPage(PinnedPage&& other) noexcept
+: pool_(other.pool_), page_no_(other.page_no_), data_(other.data_), dirty_(other.dirty_)
+{
+    other.pool_ = nullptr;
+    other.data_ = nullptr;
+}
+
+PinnedPage& PinnedPage::operator=(PinnedPage&& other) noexcept {
+    if (this != &other) {
+        Release();
+        pool_ = other.pool_;
+        page_no_ = other.page_no_;
+        data_ = other.data_;
+        dirty_ = other.dirty_;
+        other.pool_ = nullptr;
+        other.data_ = nullptr;
+    }
+    return *this;
+}
+
+PinnedPage::~PinnedPage() {
+    Release();
+}
+
+void PinnedPage::MarkDirty() noexcept {
+    dirty_ = true;
+}
+
+void PinnedPage::Release() noexcept {
+    if (pool_ != nullptr)
+        pool_->Unpin(page_no_, dirty_);
+    pool_ = nullptr;
+    data_ = nullptr;
+    dirty_ = false;
+}
+
+uint8_t* PinnedPage::Data() const noexcept {
+    return data_;
+}
+
+uint32_t PinnedPage::PageNo() const noexcept {
+    return page_no_;
+}
+
+PinnedPage::operator bool() const noexcept {
+    return data_ != nullptr;
+}
+
+/**
+ * BufferPool
+ */
+BufferPool::BufferPool(Pager& pager, size_t capacity, WriteAheadLog* log)
+: pager_(pager), log_(log), capacity_(capacity), page_size_(pager.PageSize()), frames_(nullptr),
+  frame_page_(capacity, NO_FRAME_PAGE), frame_pins_(capacity, 0), frame_ref_(capacity, 0), frame_dirty_(capacity, 0),
+  frame_uncommitted_(capacity, 0), frame_lsn_(capacity, 0), clock_hand_(0), pinned_(0), dirty_(0),
+  uncommitted_count_(0), hits_(0), misses_(0), evictions_(0), pages_written_(0), write_batches_(0)
+{
+    if (capacity_ == 0)
+        throw FileException("BufferPool capacity must be at least one page");
+    if (!pager_.IsOpen())
+        throw FileException("BufferPool needs an open pager");
+    frames_ = pager_.AllocatePageBuffer(capacity_);
+    // Hand out low frames first
+    free_frames_.reserve(capacity_);
+    for (size_t i = capacity_; i > 0; --i)
+        free_frames_.push_back(i - 1);
+    page_table_.reserve(capacity_);
+    // Each frame is listed once at most, so MarkUncommitted() never allocates
+    if (log_ != nullptr)
+        uncommitted_.reserve(capacity_);
+}
+
+BufferPool::~BufferPool() {
+    try {
+        if (pager_.IsOpen())
+            FlushAll();
+    } catch (const FileException&) {
+    }
+}
+
+PinnedPage BufferPool::Pin(uint32_t page_no) {
+    auto it = page_table_.find(page_no);
+    if (it != page_table_.end()) {
+        ++hits_;
+        size_t frame = it->second;
+        if (frame_pins_[frame]++ == 0)
+            ++pinned_;
+        frame_ref_[frame] = 1;
+        return PinnedPage(this, page_no, frames_.get() + frame * page_size_);
+    }
+
+    ++misses_;
+    size_t frame = TakeFrame();
+    uint8_t* data = frames_.get() + frame * page_size_;
+    try {
+        pager_.ReadPage(page_no, data);
+    } catch (...) {
+        // Leave the frame unused so a failed read is never served as data
+        free_frames_.push_back(frame);
+        throw;
+    }
+    frame_page_[frame] = page_no;
+    frame_pins_[frame] = 1;
+    frame_ref_[frame] = 1;
+    ++pinned_;
+    page_table_.emplace(page_no, frame);
+    return PinnedPage(this, page_no, data);
+}
+
+PinnedPage BufferPool::PinNew(PageType type) {
+    size_t frame = TakeFrame();
+    uint32_t page_no;
+    try {
+        page_no = pager_.Allocate();
+    } catch (...) {
+        free_frames_.push_back(frame);
+        throw;
+    }
+    uint8_t* data = frames_.get() + frame * page_size_;
+    pager_.InitPage(data, type);
+    frame_page_[frame] = page_no;
+    frame_pins_[frame] = 1;
+    frame_ref_[frame] = 1;
+    frame_dirty_[frame] = 1;
+    ++pinned_;
+    ++dirty_;
+    MarkUncommitted(frame);
+    page_table_.emplace(page_no, frame);
+    return PinnedPage(this, page_no, data);
+}
+
+void BufferPool::Unpin(uint32_t page_no, bool dirty) noexcept {
+    auto it = page_table_.find(page_no);
+    if (it == page_table_.end() || frame_pins_[it->second] == 0)
+        return;
+    size_t frame = it->second;
+    if (dirty && !frame_dirty_[frame]) {
+        frame_dirty_[frame] = 1;
+        ++dirty_;
+    }
+    if (dirty)
+        MarkUncommitted(frame);
+    if (--frame_pins_[frame] == 0)
+        --pinned_;
+}
+
+void BufferPool::Free(uint32_t page_no) {
+    auto it = page_table_.find(page_no);
+    if (it != page_table_.end()) {
+        size_t frame = it->second;
+        if (frame_pins_[frame] != 0)
+            throw FileException("Cannot free pinned page " + std::to_string(page_no));
+        if (frame_dirty_[frame])
+            --dirty_;
+        if (frame_uncommitted_[frame]) {
+            --uncommitted_count_;
+            uncommitted_.erase(std::find(uncommitted_.begin(), uncommitted_.end(), frame));
+        }
+        frame_dirty_[frame] = 0;
+        frame_uncommitted_[frame] = 0;
+        frame_ref_[frame] = 0;
+        frame_page_[frame] = NO_FRAME_PAGE;
+        page_table_.erase(it);
+        free_frames_.push_back(frame);
+    }
+    pager_.Free(page_no);
+}
+
+void BufferPool::FlushAll() {
+    if (log_ != nullptr)
+        Commit();
+    std::vector<size_t> frames;
+    frames.reserve(dirty_);
+    for (size_t frame = 0; frame < capacity_; ++frame)
+        if (frame_dirty_[frame])
+            frames.push_back(frame);
+    if (!frames.empty())
+        WriteFrames(frames);
+    pager_.Flush();
+    if (log_ != nullptr)
+        log_->Truncate();
+}
+
+uint64_t BufferPool::Commit() {
+    if (log_ == nullptr)
+        throw FileException("BufferPool has no write-ahead log to commit to");
+    std::vector<uint32_t> page_nos;
+    std::vector<uint8_t*> pages;
+    std::vector<size_t> frames;
+    for (size_t frame : uncommitted_) {
+        frame_uncommitted_[frame] = 0;
+        frames.push_back(frame);
+        page_nos.push_back(frame_page_[frame]);
+        pages.push_back(frames_.get() + frame * page_size_);
+    }
+    uncommitted_.clear();
+    uncommitted_count_ = 0;
+    pager_.ChangedMeta(page_nos, pages);
+    if (pages.empty())
+        return 0;
+
+    uint64_t lsn = log_->Commit(page_nos.data(), pages.data(), pages.size());
+    for (size_t frame : frames)
+        frame_lsn_[frame] = lsn;
+    if (log_->Size() >= log_->Options().checkpoint_size)
+        FlushAll();
+    return lsn;
+}
+
+uint64_t BufferPool::Hits() const noexcept {
+    return hits_;
+}
+
+uint64_t BufferPool::Misses() const noexcept {
+    return misses_;
+}
+
+uint64_t BufferPool::Evictions() const noexcept {
+    return evictions_;
+}
+
+uint64_t BufferPool::PagesWritten() const noexcept {
+    return pages_written_;
+}
+
+uint64_t BufferPool::WriteBatches() const noexcept {
+    return write_batches_;
+}
+
+size_t BufferPool::Capacity() const noexcept {
+    return capacity_;
+}
+
+size_t BufferPool::PinnedCount() const noexcept {
+    return pinned_;
+}
+
+size_t BufferPool::DirtyCount() const noexcept {
+    return dirty_;
+}
+
+size_t BufferPool::UncommittedCount() const noexcept {
+    return uncommitted_count_;
+}
+
+Pager& BufferPool::GetPager() const noexcept {
+    return pager_;
+}
+
+WriteAheadLog* BufferPool::Log() const noexcept {
+    return log_;
+}
+
+size_t BufferPool::TakeFrame() {
+    if (!free_frames_.empty()) {
+        size_t frame = free_frames_.back();
+        free_frames_.pop_back();
+        return frame;
+    }
+
+    size_t frame = EvictFrame();
+    if (frame_dirty_[frame]) {
+        // Clean the victim together with the dirty frames the hand reaches next
+        std::vector<size_t> frames{frame};
+        for (size_t step = 1; step < capacity_ && frames.size() < WRITE_BACK_BATCH; ++step) {
+            size_t next = (frame + step) % capacity_;
+            if (frame_dirty_[next] && Evictable(next))
+                frames.push_back(next);
+        }
+        WriteFrames(frames);
+    }
+    ++evictions_;
+    page_table_.erase(frame_page_[frame]);
+    frame_page_[frame] = NO_FRAME_PAGE;
+    frame_ref_[frame] = 0;
+    return frame;
+}
+
+size_t BufferPool::EvictFrame() {
+    // Two sweeps clear every reference bit, a third finding nothing means every frame is pinned
+    for (size_t step = 0; step < 3 * capacity_; ++step) {
+        size_t frame = clock_hand_;
+        clock_hand_ = (clock_hand_ + 1) % capacity_;
+        if (!Evictable(frame))
+            continue;
+        if (frame_ref_[frame]) {
+            frame_ref_[frame] = 0;
+            continue;
+        }
+        return frame;
+    }
+    if (uncommitted_count_ > 0)
+        throw FileException("Every buffer pool frame is pinned or holds uncommitted changes, " +
+                            std::to_string(capacity_) + " frames");
+    throw FileException("Every buffer pool frame is pinned, " + std::to_string(capacity_) + " frames");
+}
+
+void BufferPool::WriteFrames(std::vector<size_t>& frames) {
+    std::sort(frames.begin(), frames.end(), [this](size_t lhs, size_t rhs) {
+        return frame_page_[lhs] < frame_page_[rhs];
+    });
+    std::vector<uint32_t> page_nos(frames.size());
+    std::vector<uint8_t*> pages(frames.size());
+    uint64_t lsn = 0;
+    for (size_t i = 0; i < frames.size(); ++i) {
+        page_nos[i] = frame_page_[frames[i]];
+        pages[i] = frames_.get() + frames[i] * page_size_;
+        lsn = std::max(lsn, frame_lsn_[frames[i]]);
+    }
+    // Write-ahead: the log reaches the disk before the pages it describes
+    if (log_ != nullptr && lsn > 0)
+        log_->Flush(lsn);
+    pager_.WritePages(page_nos.data(), pages.data(), frames.size());
+    for (size_t frame : frames)
+        frame_dirty_[frame] = 0;
+    dirty_ -= frames.size();
+    pages_written_ += frames.size();
+    ++write_batches_;
+}
+
+bool BufferPool::Evictable(size_t frame) const noexcept {
+    return frame_pins_[frame] == 0 && !frame_uncommitted_[frame];
+}
+
+void BufferPool::MarkUncommitted(size_t frame) noexcept {
+    if (log_ == nullptr || frame_uncommitted_[frame])
+        return;
+    frame_uncommitted_[frame] = 1;
+    ++uncommitted_count_;
+    uncommitted_.push_back(frame);
+}
@@ -0,0 +1,232 @@
+#ifndef DT_SRC_FILE_BUFFERPOOL_H
+#define DT_SRC_FILE_BUFFERPOOL_H
+
+// C++ Includes
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// Local Includes
+#include "file/filereader.h"
+#include "storage/pager.h"
+
+class BufferPool;
+class WriteAheadLog;
+
+/**
+ * @brief A pin on one buffered page, unpinned when it goes out of scope
+ */
+class PinnedPage {
+public:
+    /**
+     * Tors
+     */
+    PinnedPage() noexcept;
+    PinnedPage(BufferPool* pool, uint32_t page_no, uint8_t* data) noexcept;
+    PinnedPage(PinnedPage&& other) noexcept;
+    PinnedPage& operator=(PinnedPage&& other) noexcept;
+    ~PinnedPage();
+
+    /**
+     * NON-COPYABLE
+     */
+    PinnedPage(const PinnedPage&) = delete;
+    PinnedPage& operator=(const PinnedPage&) = delete;
+
+    /**
+     * @brief Flag the page as changed so it is written back before its frame is reused
+     */
+    void MarkDirty() noexcept;
+
+    /**
+     * @brief Unpin now instead of at the end of the scope
+     */
+    void Release() noexcept;
+
+    uint8_t* Data() const noexcept;
+    uint32_t PageNo() const noexcept;
+    explicit operator bool() const noexcept;
+
+private:
+    BufferPool* pool_;
+    uint32_t page_no_;
+    uint8_t* data_;
+    bool dirty_;
+};
+
+/**
+ * @brief Caches pages of a Pager in a fixed set of frames with CLOCK eviction
+ *
+ * A pinned page stays in its frame until every pin is released. Unpinned
+ * frames are reused in CLOCK order, with pinned frames skipped. A dirty victim
+ * is not written alone: the next dirty, unpinned frames in the clock's path are
+ * written with it in one batch sorted by page number, so later evictions find
+ * clean frames and adjacent pages share a system call.
+ *
+ * With a WriteAheadLog, pages changed since the last Commit() stay in the
+ * pool like pinned ones, and a committed page is written back only after the
+ * log's records for it are durable. FlushAll() is then a checkpoint.
+ *
+ * Not thread safe, like the single connection it serves.
+ */
+class BufferPool {
+public:
+    /**
+     * @brief Dirty frames written back together when a dirty page is evicted
+     */
+    static constexpr size_t WRITE_BACK_BATCH = 32;
+
+    /**
+     * Tors
+     */
+
+    /**
+     * @brief Construct a pool of capacity frames over an open pager
+     * @param pager Must outlive the pool
+     * @param log The pager's log, must outlive the pool, nullptr to write changes back without one
+     */
+    BufferPool(Pager& pager, size_t capacity, WriteAheadLog* log = nullptr);
+
+    /**
+     * @brief Write back dirty pages, errors are lost, call FlushAll() to see them
+     */
+    ~BufferPool();
+
+    /**
+     * NON-COPYABLE
+     */
+    BufferPool(const BufferPool&) = delete;
+    BufferPool(BufferPool&&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    /**
+     * Pages
+     */
+
+    /**
+     * @brief Pin a page, reading it on a miss
+     * @throws FileException if every frame is pinned or the read fails
+     */
+    PinnedPage Pin(uint32_t page_no);
+
+    /**
+     * @brief Allocate a page from the pager and pin it, initialized and dirty, without reading it
+     */
+    PinnedPage PinNew(PageType type);
+
+    /**
+     * @brief Release one pin on a page, PinnedPage calls this
+     * @param dirty Whether the holder changed the page
+     */
+    void Unpin(uint32_t page_no, bool dirty) noexcept;
+
+    /**
+     * @brief Drop an unpinned page from the pool and return it to the pager's free list
+     */
+    void Free(uint32_t page_no);
+
+    /**
+     * @brief Write every dirty page in page order in batches, then flush the pager
+     *
+     * With a log, a checkpoint: changes are committed first and the log is
+     * truncated once the pages are synced.
+     */
+    void FlushAll();
+
+    /**
+     * Log
+     */
+
+    /**
+     * @brief Log the pages changed since the last commit, with the pager's superblock and free list
+     *
+     * Returns once the commit is as durable as the log's Durability asks, and
+     * checkpoints when the log has grown past WalOptions::checkpoint_size.
+     * @return The commit's LSN, 0 if nothing changed
+     * @throws FileException if the pool has no log or the log failed
+     */
+    uint64_t Commit();
+
+    /**
+     * Stats
+     */
+    uint64_t Hits() const noexcept;
+    uint64_t Misses() const noexcept;
+    uint64_t Evictions() const noexcept;
+    uint64_t PagesWritten() const noexcept;
+    uint64_t WriteBatches() const noexcept;
+    size_t Capacity() const noexcept;
+    size_t PinnedCount() const noexcept;
+    size_t DirtyCount() const noexcept;
+
+    /**
+     * @brief Frames changed since the last Commit(), they cannot be evicted
+     */
+    size_t UncommittedCount() const noexcept;
+    Pager& GetPager() const noexcept;
+    WriteAheadLog* Log() const noexcept;
+
+private:
+    /**
+     * Internal Functions
+     */
+
+    /**
+     * @brief A frame to load a page into, evicting (and writing back) if the pool is full
+     */
+    size_t TakeFrame();
+
+    /**
+     * @brief Advance the clock hand to an unpinned frame without its reference bit
+     * @throws FileException if every frame is pinned
+     */
+    size_t EvictFrame();
+
+    /**
+     * @brief Write the given frames in one batch and mark them clean, after the log records they need
+     */
+    void WriteFrames(std::vector<size_t>& frames);
+
+    /**
+     * @brief Whether a frame can be evicted or written back
+     */
+    bool Evictable(size_t frame) const noexcept;
+    void MarkUncommitted(size_t frame) noexcept;
+
+    static constexpr uint32_t NO_FRAME_PAGE = UINT32_MAX;
+
+    Pager& pager_;
+    WriteAheadLog* const log_;
+    const size_t capacity_;
+    const size_t page_size_;
+    std::unique_ptr<uint8_t[], AlignedDeleter> frames_;
+
+    /**
+     * Frame Items
+     */
+    std::vector<uint32_t> frame_page_;
+    std::vector<uint32_t> frame_pins_;
+    std::vector<uint8_t> frame_ref_;
+    std::vector<uint8_t> frame_dirty_;
+    std::vector<uint8_t> frame_uncommitted_;
+    std::vector<uint64_t> frame_lsn_;       // The commit that logged the frame's page last
+    std::vector<size_t> free_frames_;
+    std::vector<size_t> uncommitted_;       // Frames changed since the last commit
+    std::unordered_map<uint32_t, size_t> page_table_;
+    size_t clock_hand_;
+    size_t pinned_;
+    size_t dirty_;
+    size_t uncommitted_count_;
+
+    /**
+     * Stats Items
+     */
+    uint64_t hits_;
+    uint64_t misses_;
+    uint64_t evictions_;
+    uint64_t pages_written_;
+    uint64_t write_batches_;
+};
+
+#endif
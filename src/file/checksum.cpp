@@ -0,0 +1,88 @@
+// C++ Includes
+#include <cstdint>
+#include <cstring>
+
+// C Includes
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#define DT_HAVE_X86_CRC32 1
+#endif
+
+// Local Includes
+#include "checksum.h"
+
+/**
+ * Software Kernel, slicing by 8 over the reflected polynomial
+ */
+struct Crc32cTable {
+    uint32_t rows[8][256];
+
+    constexpr Crc32cTable() : rows() {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; ++bit)
+                crc = (crc >> 1) ^ ((crc & 1) ? 0x82F63B78u : 0);
+            rows[0][i] = crc;
+        }
+        for (uint32_t i = 0; i < 256; ++i)
+            for (int row = 1; row < 8; ++row)
+                rows[row][i] = (rows[row - 1][i] >> 8) ^ rows[0][rows[row - 1][i] & 0xFF];
+    }
+};
+
+static constexpr Crc32cTable mTable;
+
+static uint32_t Crc32cSoftware(const uint8_t* data, size_t size, uint32_t crc) noexcept {
+    while (size >= 8) {
+        uint64_t word;
+        memcpy(&word, data, sizeof(word));
+        word ^= crc;
+        crc = mTable.rows[7][word & 0xFF] ^ mTable.rows[6][(word >> 8) & 0xFF] ^
+              mTable.rows[5][(word >> 16) & 0xFF] ^ mTable.rows[4][(word >> 24) & 0xFF] ^
+              mTable.rows[3][(word >> 32) & 0xFF] ^ mTable.rows[2][(word >> 40) & 0xFF] ^
+              mTable.rows[1][(word >> 48) & 0xFF] ^ mTable.rows[0][word >> 56];
+        data += 8;
+        size -= 8;
+    }
+    while (size-- > 0)
+        crc = (crc >> 8) ^ mTable.rows[0][(crc ^ *data++) & 0xFF];
+    return crc;
+}
+
+#ifdef DT_HAVE_X86_CRC32
+/**
+ * SSE4.2 Kernel, compiled for the instruction and only called after checking the CPU
+ */
+__attribute__((target("sse4.2")))
+static uint32_t Crc32cHardware(const uint8_t* data, size_t size, uint32_t crc) noexcept {
+    uint64_t crc64 = crc;
+    while (size >= 8) {
+        uint64_t word;
+        memcpy(&word, data, sizeof(word));
+        crc64 = _mm_crc32_u64(crc64, word);
+        data += 8;
+        size -= 8;
+    }
+    crc = static_cast<uint32_t>(crc64);
+    while (size-- > 0)
+        crc = _mm_crc32_u8(crc, *data++);
+    return crc;
+}
+
+static bool HaveSse42() noexcept {
+    // May run from a static initializer, before the runtime has probed the CPU
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse4.2");
+}
+
+static const bool mHaveHardware = HaveSse42();
+#endif
+
+uint32_t Crc32c(const uint8_t* data, size_t size, uint32_t crc) noexcept {
+    crc = ~crc;
+#ifdef DT_HAVE_X86_CRC32
+    if (mHaveHardware)
+        return ~Crc32cHardware(data, size, crc);
+#endif
+    return ~Crc32cSoftware(data, size, crc);
+}
@@ -0,0 +1,17 @@
+#ifndef DT_SRC_FILE_CHECKSUM_H
+#define DT_SRC_FILE_CHECKSUM_H
+
+// C++ Includes
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief CRC-32C (Castagnoli) of size bytes, the SSE4.2 instruction when the CPU has it
+ * @param data The bytes to checksum
+ * @param size The number of bytes
+ * @param crc The checksum of the bytes before data, to continue a running checksum
+ * @return The checksum of everything so far
+ */
+uint32_t Crc32c(const uint8_t* data, size_t size, uint32_t crc = 0) noexcept;
+
+#endif
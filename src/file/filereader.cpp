@@ -1,66 +1,129 @@
 // C++ Includes
 #include <memory>
 #include <cstdint>
+#include <cstdlib>
 #include <string>
 
 // C Includes
 #include <unistd.h>
 #include <fcntl.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 // Local Includes
 #include "exception/file_exception.h"
+#include "blockcache.h"
 #include "filereader.h"
+#include "readahead.h"
 
-#define MAX_BUFFER_SIZE 4096
+#define BUFFER_ALIGNMENT 4096
+#define MAX_BUFFER_LIMIT (64u * 1024 * 1024)
+
+static_assert(sizeof(off_t) == 8, "FileReader requires a 64-bit off_t, build with _FILE_OFFSET_BITS=64");
+
+/**
+ * Helpers
+ */
+static size_t AlignedBufferSize(uint32_t requested) {
+    if (requested == 0 || requested > MAX_BUFFER_LIMIT)
+        throw FileException("FileReader buffer size must be between 1 byte and 64 MiB");
+    return (static_cast<size_t>(requested) + BUFFER_ALIGNMENT - 1) & ~static_cast<size_t>(BUFFER_ALIGNMENT - 1);
+}
+
+static uint8_t* AllocateBuffer(size_t buffer_size) {
+    uint8_t* buffer = static_cast<uint8_t*>(aligned_alloc(BUFFER_ALIGNMENT, buffer_size));
+    if (buffer == nullptr)
+        throw FileException(std::string("Failed to allocate read buffer: ") + strerror(errno));
+    return buffer;
+}
 
 /**
  * FileReader 
  */
 FileReader::FileReader() 
-: eof_(true), fd_(-1), buffer_(nullptr), buffer_start_(0), buffer_end_(0), max_buffer_size_(MAX_BUFFER_SIZE)
+: FileReader(FileReaderOptions())
+{}
+
+FileReader::FileReader(ReadMode mode)
+: FileReader(FileReaderOptions{mode})
+{}
+
+FileReader::FileReader(const FileReaderOptions& options)
+: eof_(true), fd_(-1), mode_(options.mode), direct_(options.direct), buffer_(nullptr), data_(nullptr), 
+  buffer_start_(0), buffer_end_(0), file_pos_(0), max_buffer_size_(AlignedBufferSize(options.buffer_size)), 
+  bounce_(nullptr), map_(nullptr), map_size_(0), mapped_(false), read_ahead_depth_(options.read_ahead_depth)
 {
-    buffer_ = std::make_unique<uint8_t[]>(max_buffer_size_);
+    buffer_.reset(AllocateBuffer(max_buffer_size_));
+    data_ = buffer_.get();
+    if (options.cache_blocks != 0)
+        cache_ = std::make_unique<BlockCache>(*this, options.cache_blocks, BUFFER_ALIGNMENT);
 }
 
 FileReader::FileReader(const std::string& file_path)
-: eof_(false), buffer_start_(0), buffer_end_(0), max_buffer_size_(MAX_BUFFER_SIZE)
-{
-    buffer_ = std::make_unique<uint8_t[]>(max_buffer_size_);
-    Open(file_path.c_str());
-}
+: FileReader(file_path, FileReaderOptions())
+{}
 
 FileReader::FileReader(const char* file_path)
-: eof_(false), buffer_start_(0), buffer_end_(0), max_buffer_size_(MAX_BUFFER_SIZE)
+: FileReader(FileReaderOptions())
 {
-    buffer_ = std::make_unique<uint8_t[]>(max_buffer_size_);
     Open(file_path);
 }
 
+FileReader::FileReader(const std::string& file_path, ReadMode mode)
+: FileReader(file_path, FileReaderOptions{mode})
+{}
+
+FileReader::FileReader(const std::string& file_path, const FileReaderOptions& options)
+: FileReader(options)
+{
+    Open(file_path.c_str());
+}
+
 FileReader::~FileReader() {
     Close();
 }
 
 void FileReader::Open(const std::string& file_path) {
-    eof_ = false;
-    if (fd_ != -1) Close();
-    if ((fd_ = open(file_path.c_str(), O_RDONLY)) == -1) {
-        throw FileException((std::string("Failed to open file: ") + file_path).c_str());
-    }
+    Open(file_path.c_str());
 }
 
 void FileReader::Open(const char* file_path) {
-    eof_ = false;
     if (fd_ != -1) Close();
-    if ((fd_ = open(file_path, O_RDONLY)) == -1) {
+    eof_ = false;
+    if ((fd_ = open(file_path, O_RDONLY | (direct_ ? O_DIRECT : 0))) == -1 && direct_ && errno == EINVAL) {
+        // The file system does not support O_DIRECT, go through the page cache instead
+        direct_ = false;
+        fd_ = open(file_path, O_RDONLY);
+    }
+    if (fd_ == -1) {
         throw FileException((std::string("Failed to open file: ") + file_path).c_str());
     }
+    if (mode_ == ReadMode::kMMAP)
+        MapFile();
+    else if (mode_ == ReadMode::kREAD_AHEAD)
+        StartReadAhead();
 }
 
 void FileReader::Close() {
     eof_ = true;
-    if (fd_ != -1 && close(fd_) == -1) {
-        throw FileException(strerror(errno));
+    buffer_start_ = buffer_end_ = 0;
+    file_pos_ = 0;
+    if (map_ != nullptr) {
+        munmap(map_, map_size_);
+        map_ = nullptr;
+    }
+    map_size_ = 0;
+    mapped_ = false;
+    read_ahead_.reset();
+    if (cache_)
+        cache_->Invalidate();
+    data_ = buffer_.get();
+    if (fd_ != -1) {
+        int32_t fd = fd_;
+        fd_ = -1;
+        if (close(fd) == -1)
+            throw FileException(strerror(errno));
     }
 }
 
@@ -71,61 +134,322 @@ bool FileReader::End() noexcept {
 uint8_t FileReader::PeekByte() {
     if (buffer_end_ == buffer_start_ && FillBuffer() == 0)
         return '\0';
-    return buffer_[buffer_start_];
+    return data_[buffer_start_];
 }
 
 uint8_t FileReader::ReadByte() {
     uint8_t ret_char = '\0';
     if (buffer_end_ == buffer_start_ && FillBuffer() == 0)
         return ret_char;
-    ret_char = buffer_[buffer_start_++];
+    ret_char = data_[buffer_start_++];
     return ret_char;
 }
 
-uint32_t FileReader::ReadBuffer(uint8_t* buffer, uint32_t buffer_size) {
-    uint32_t bytes_read = 0;
+size_t FileReader::ReadBuffer(uint8_t* buffer, size_t buffer_size) {
+    // Drain whatever is already buffered (or mapped)
+    size_t bytes_read = buffer_end_ - buffer_start_;
+    bytes_read = (bytes_read < buffer_size) ? bytes_read : buffer_size;
+    memcpy(buffer, data_+buffer_start_, bytes_read);
+    buffer_start_ += bytes_read;
+
     while(!eof_ && bytes_read < buffer_size) {
-        uint32_t transfer = buffer_end_ - buffer_start_;
-        if (buffer_start_ == buffer_end_)
-            transfer = FillBuffer();
-        transfer = (transfer < (buffer_size-bytes_read)) ? transfer : (buffer_size-bytes_read);
-        memcpy(buffer+bytes_read, buffer_.get()+buffer_start_, transfer);
-        bytes_read += transfer;
+        size_t remaining = buffer_size - bytes_read;
+        if (mapped_ || read_ahead_ || direct_ || remaining < max_buffer_size_) {
+            size_t transfer = FillBuffer();
+            transfer = (transfer < remaining) ? transfer : remaining;
+            memcpy(buffer+bytes_read, data_+buffer_start_, transfer);
+            buffer_start_ += transfer;
+            bytes_read += transfer;
+            continue;
+        }
+
+        // Large requests skip the staging buffer and read straight into the caller's memory
+        ssize_t ret_val = read(fd_, buffer+bytes_read, remaining);
+        if (ret_val == -1) {
+            if (errno == EINTR)
+                continue;
+            throw FileException(strerror(errno));
+        } else if (ret_val == 0) {
+            eof_ = true;
+        }
+        file_pos_ += buffer_end_ + static_cast<uint64_t>(ret_val);
+        buffer_start_ = buffer_end_ = 0;
+        bytes_read += static_cast<size_t>(ret_val);
     }
     return bytes_read;
 }
 
-uint32_t FileReader::ReadLine(uint8_t* buffer, uint32_t buffer_size, uint8_t end) {
-    uint32_t bytes_read = 0;
+size_t FileReader::ReadLine(uint8_t* buffer, size_t buffer_size, uint8_t end) {
+    size_t bytes_read = 0;
     while(!eof_ && bytes_read < buffer_size) {
-        uint32_t transfer = buffer_end_ - buffer_start_;
-        if (buffer_start_ == buffer_end_)
-            transfer = FillBuffer();
-        transfer = (transfer < (buffer_size - bytes_read)) ? transfer : (buffer_size-bytes_read);
-        while(buffer_start_ < buffer_end_ && bytes_read < buffer_size) {
-            buffer[bytes_read++] = buffer_[buffer_start_];
-            if (buffer_[buffer_start_++] == end) {
-                return bytes_read;
+        if (buffer_start_ == buffer_end_ && FillBuffer() == 0)
+            break;
+        size_t transfer = buffer_end_ - buffer_start_;
+        transfer = (transfer < (buffer_size - bytes_read)) ? transfer : (buffer_size - bytes_read);
+        const uint8_t* src = data_ + buffer_start_;
+        const uint8_t* found = static_cast<const uint8_t*>(memchr(src, end, transfer));
+        if (found != nullptr)
+            transfer = static_cast<size_t>(found - src) + 1;
+        memcpy(buffer + bytes_read, src, transfer);
+        buffer_start_ += transfer;
+        bytes_read += transfer;
+        if (found != nullptr)
+            return bytes_read;
+    }
+    return bytes_read;
+}
+
+size_t FileReader::ReadAt(uint64_t offset, uint8_t* buffer, size_t buffer_size) const {
+    if (mapped_) {
+        if (offset >= map_size_)
+            return 0;
+        size_t transfer = (buffer_size < map_size_ - offset) ? buffer_size : static_cast<size_t>(map_size_ - offset);
+        memcpy(buffer, map_ + offset, transfer);
+        return transfer;
+    }
+    if (cache_)
+        return cache_->ReadAt(offset, buffer, buffer_size);
+    return ReadFile(offset, buffer, buffer_size);
+}
+
+size_t FileReader::ReadFile(uint64_t offset, uint8_t* buffer, size_t buffer_size) const {
+    if (direct_) {
+        const uint64_t mask = BUFFER_ALIGNMENT - 1;
+        if (((reinterpret_cast<uintptr_t>(buffer) | offset | buffer_size) & mask) == 0) {
+            // Everything is aligned already, read straight into the caller's buffer
+            size_t bytes_read = 0;
+            while (bytes_read < buffer_size) {
+                ssize_t ret_val = pread(fd_, buffer + bytes_read, buffer_size - bytes_read, static_cast<off_t>(offset + bytes_read));
+                if (ret_val == -1) {
+                    if (errno == EINTR)
+                        continue;
+                    throw FileException(strerror(errno));
+                }
+                bytes_read += static_cast<size_t>(ret_val);
+                // A short read is the end of the file, and the next offset would not be aligned
+                if (ret_val == 0 || static_cast<size_t>(ret_val) % BUFFER_ALIGNMENT != 0)
+                    break;
             }
+            return bytes_read;
         }
+
+        // Read the aligned span covering the request through the bounce buffer, one buffer at a time
+        if (!bounce_)
+            bounce_.reset(AllocateBuffer(max_buffer_size_));
+        uint64_t position = offset & ~mask;
+        uint64_t span_end = (offset + buffer_size + mask) & ~mask;
+        size_t bytes_read = 0;
+        while (position < span_end) {
+            size_t span = (span_end - position < max_buffer_size_) ? static_cast<size_t>(span_end - position) : max_buffer_size_;
+            ssize_t ret_val = pread(fd_, bounce_.get(), span, static_cast<off_t>(position));
+            if (ret_val == -1) {
+                if (errno == EINTR)
+                    continue;
+                throw FileException(strerror(errno));
+            }
+            size_t skip = (position < offset) ? static_cast<size_t>(offset - position) : 0;
+            if (static_cast<size_t>(ret_val) <= skip)
+                break;
+            size_t transfer = static_cast<size_t>(ret_val) - skip;
+            transfer = (transfer < buffer_size - bytes_read) ? transfer : buffer_size - bytes_read;
+            memcpy(buffer + bytes_read, bounce_.get() + skip, transfer);
+            bytes_read += transfer;
+            if (static_cast<size_t>(ret_val) < span)
+                break;
+            position += span;
+        }
+        return bytes_read;
+    }
+
+    size_t bytes_read = 0;
+    while (bytes_read < buffer_size) {
+        ssize_t ret_val = pread(fd_, buffer + bytes_read, buffer_size - bytes_read, static_cast<off_t>(offset + bytes_read));
+        if (ret_val == -1) {
+            if (errno == EINTR)
+                continue;
+            throw FileException(strerror(errno));
+        } else if (ret_val == 0) {
+            break;
+        }
+        bytes_read += static_cast<size_t>(ret_val);
     }
     return bytes_read;
 }
 
-uint32_t FileReader::Seek(uint32_t offset, SeekStart whence) {
-    int32_t ret_val = 0;
+uint64_t FileReader::Seek(int64_t offset, SeekStart whence) {
+    off_t ret_val = 0;
+    if (mapped_) {
+        switch(whence) {
+            case SeekStart::kSEEK_SET: ret_val = offset; break;
+            case SeekStart::kSEEK_CUR: ret_val = static_cast<off_t>(Tell()) + offset; break;
+            case SeekStart::kSEEK_END: ret_val = static_cast<off_t>(map_size_) + offset; break;
+            default: {
+                if ((ret_val = lseek(fd_, offset, (uint32_t)whence)) == -1)
+                    throw FileException(strerror(errno));
+            }
+        }
+        if (ret_val < 0)
+            throw FileException(strerror(EINVAL));
+        // Past the end of the map reads return nothing, but Tell() still reports the target
+        buffer_start_ = (static_cast<uint64_t>(ret_val) < map_size_) ? static_cast<size_t>(ret_val) : map_size_;
+        file_pos_ = static_cast<uint64_t>(ret_val) - buffer_start_;
+        eof_ = false;
+        return static_cast<uint64_t>(ret_val);
+    }
+
+    // Targets inside the buffered window only move the read position
+    int64_t target = -1;
+    if (whence == SeekStart::kSEEK_SET)
+        target = offset;
+    else if (whence == SeekStart::kSEEK_CUR)
+        target = static_cast<int64_t>(file_pos_ + buffer_start_) + offset;
+    if (target >= static_cast<int64_t>(file_pos_) && target < static_cast<int64_t>(file_pos_ + buffer_end_)) {
+        buffer_start_ = static_cast<size_t>(target - static_cast<int64_t>(file_pos_));
+        eof_ = false;
+        return static_cast<uint64_t>(target);
+    }
+
+    // Positional readers never rely on the kernel offset
+    if (read_ahead_ || direct_) {
+        if (whence == SeekStart::kSEEK_END)
+            target = static_cast<int64_t>(Size()) + offset;
+        else if (target == -1 && (target = lseek(fd_, offset, (uint32_t)whence)) == -1)
+            throw FileException(strerror(errno));
+        if (target < 0)
+            throw FileException(strerror(EINVAL));
+        if (read_ahead_)
+            read_ahead_->Start(static_cast<uint64_t>(target));
+        file_pos_ = static_cast<uint64_t>(target);
+        buffer_start_ = buffer_end_ = 0;
+        eof_ = false;
+        return static_cast<uint64_t>(target);
+    }
+
+    // The kernel offset is ahead of the caller by whatever is still buffered
+    if (whence == SeekStart::kSEEK_CUR)
+        offset -= static_cast<int64_t>(buffer_end_ - buffer_start_);
     if ((ret_val = lseek(fd_, offset, (uint32_t)whence)) == -1)
         throw FileException(strerror(errno));
-    FillBuffer();
-    return static_cast<uint32_t>(ret_val);
+
+    // The buffer is refilled lazily by the next read
+    file_pos_ = static_cast<uint64_t>(ret_val);
+    buffer_start_ = buffer_end_ = 0;
+    eof_ = false;
+    return static_cast<uint64_t>(ret_val);
+}
+
+uint64_t FileReader::Tell() const noexcept {
+    return file_pos_ + buffer_start_;
+}
+
+uint64_t FileReader::Size() const {
+    if (mapped_)
+        return map_size_;
+    struct stat file_stat;
+    if (fstat(fd_, &file_stat) == -1)
+        throw FileException(strerror(errno));
+    return static_cast<uint64_t>(file_stat.st_size);
 }
 
-uint32_t FileReader::FillBuffer() {
+bool FileReader::Mapped() const noexcept {
+    return mapped_;
+}
+
+const uint8_t* FileReader::MappedData() const noexcept {
+    return map_;
+}
+
+size_t FileReader::MappedSize() const noexcept {
+    return map_size_;
+}
+
+const BlockCache* FileReader::Cache() const noexcept {
+    return cache_.get();
+}
+
+size_t FileReader::FillBuffer() {
+    if (mapped_) {
+        // The whole file is already in the window
+        buffer_start_ = buffer_end_;
+        eof_ = true;
+        return 0;
+    }
+    file_pos_ += buffer_end_;
     buffer_start_ = 0;
-    if ((buffer_end_ = read(fd_, buffer_.get(), max_buffer_size_)) == -1) {
+    if (read_ahead_) {
+        size_t block_bytes = 0;
+        const uint8_t* block = read_ahead_->Next(block_bytes);
+        data_ = (block != nullptr) ? block : buffer_.get();
+        buffer_end_ = block_bytes;
+        if (block_bytes == 0)
+            eof_ = true;
+        return buffer_end_;
+    }
+    if (direct_) {
+        // O_DIRECT reads must start on an aligned offset, skip over the head of the block
+        uint64_t aligned = file_pos_ & ~static_cast<uint64_t>(BUFFER_ALIGNMENT - 1);
+        size_t skip = static_cast<size_t>(file_pos_ - aligned);
+        ssize_t bytes_read;
+        while ((bytes_read = pread(fd_, buffer_.get(), max_buffer_size_, static_cast<off_t>(aligned))) == -1 && errno == EINTR) {}
+        if (bytes_read == -1) {
+            buffer_end_ = 0;
+            throw FileException(strerror(errno));
+        } else if (static_cast<size_t>(bytes_read) <= skip) {
+            buffer_end_ = 0;
+            eof_ = true;
+            return 0;
+        }
+        file_pos_ = aligned;
+        buffer_start_ = skip;
+        buffer_end_ = static_cast<size_t>(bytes_read);
+        return buffer_end_ - buffer_start_;
+    }
+    ssize_t bytes_read = read(fd_, buffer_.get(), max_buffer_size_);
+    if (bytes_read == -1) {
+        buffer_end_ = 0;
         throw FileException(strerror(errno));
-    } else if (buffer_end_ == 0) {
+    } else if (bytes_read == 0) {
         eof_ = true;
     }
+    buffer_end_ = static_cast<size_t>(bytes_read);
     return buffer_end_;
 }
+
+void FileReader::MapFile() {
+    struct stat file_stat;
+    if (fstat(fd_, &file_stat) == -1)
+        throw FileException(strerror(errno));
+
+    // Pipes, sockets and devices cannot be mapped, keep reading them through the buffer
+    if (!S_ISREG(file_stat.st_mode))
+        return;
+
+    map_size_ = static_cast<size_t>(file_stat.st_size);
+    if (map_size_ != 0) {
+        void* map = mmap(nullptr, map_size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+        if (map == MAP_FAILED) {
+            map_size_ = 0;
+            return;
+        }
+        map_ = static_cast<uint8_t*>(map);
+        madvise(map_, map_size_, MADV_SEQUENTIAL);
+    }
+    mapped_ = true;
+    // An empty file has no mapping, the buffer keeps data_ valid for zero length copies
+    data_ = (map_ != nullptr) ? map_ : buffer_.get();
+    buffer_start_ = 0;
+    buffer_end_ = map_size_;
+}
+
+void FileReader::StartReadAhead() {
+    struct stat file_stat;
+    if (fstat(fd_, &file_stat) == -1)
+        throw FileException(strerror(errno));
+
+    // Positional reads need a regular file, anything else keeps the synchronous path
+    if (!S_ISREG(file_stat.st_mode))
+        return;
+
+    read_ahead_ = std::make_unique<ReadAhead>(fd_, max_buffer_size_, read_ahead_depth_, direct_ ? BUFFER_ALIGNMENT : 1);
+    read_ahead_->Start(0);
+}
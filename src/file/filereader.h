@@ -4,6 +4,7 @@
 // C++ Includes
 #include <memory>
 #include <cstdint>
+#include <cstdlib>
 #include <string>
 
 enum class SeekStart : uint8_t {
@@ -14,6 +15,33 @@ enum class SeekStart : uint8_t {
     kSEEK_HOLE = SEEK_HOLE
 };
 
+enum class ReadMode : uint8_t {
+    kBUFFERED,  // read() through the internal buffer
+    kMMAP,      // map the whole file, falls back to kBUFFERED for pipes and devices
+    kREAD_AHEAD // keep the next blocks in flight while the current one is consumed, falls back like kMMAP
+};
+
+class BlockCache;
+class ReadAhead;
+
+/**
+ * @brief Construction time settings for a FileReader
+ */
+struct FileReaderOptions {
+    ReadMode mode = ReadMode::kBUFFERED;
+    uint32_t buffer_size = 4096;        // rounded up to a multiple of 4 KiB, at most 64 MiB
+    bool direct = false;                // O_DIRECT, bypass the page cache if the file system allows it
+    uint32_t read_ahead_depth = 4;      // blocks kept in flight by kREAD_AHEAD
+    uint32_t cache_blocks = 0;          // 4 KiB blocks ReadAt() keeps in a BlockCache, 0 reads the file every time
+};
+
+/**
+ * @brief Releases buffers obtained from aligned_alloc
+ */
+struct AlignedDeleter {
+    void operator()(uint8_t* ptr) const noexcept { free(ptr); }
+};
+
 /**
  * @brief Responsible for buffered file reading
  */
@@ -28,6 +56,18 @@ public:
      */
     FileReader();
 
+    /**
+     * @brief Construct an empty FileReader that will open files using mode
+     * @param mode ReadMode
+     */
+    explicit FileReader(ReadMode mode);
+
+    /**
+     * @brief Construct an empty FileReader that will open files using options
+     * @param options const FileReaderOptions&
+     */
+    explicit FileReader(const FileReaderOptions& options);
+
     /**
      * @brief Construct a FileReader from the given file_path
      * @param file_path const std::string&
@@ -40,6 +80,20 @@ public:
      */
     FileReader(const char* file_path);
 
+    /**
+     * @brief Construct a FileReader from the given file_path using mode
+     * @param file_path const std::string&
+     * @param mode ReadMode
+     */
+    FileReader(const std::string& file_path, ReadMode mode);
+
+    /**
+     * @brief Construct a FileReader from the given file_path using options
+     * @param file_path const std::string&
+     * @param options const FileReaderOptions&
+     */
+    FileReader(const std::string& file_path, const FileReaderOptions& options);
+
     /**
      * @brief Close the file and clean up memory
      */
@@ -97,7 +151,7 @@ public:
      * @param buffer_size The maximum number of bytes to read
      * @return The number of bytes read
      */
-    uint32_t ReadBuffer(uint8_t* buffer, uint32_t buffer_size);
+    size_t ReadBuffer(uint8_t* buffer, size_t buffer_size);
 
     /**
      * @brief Read up to, and including, the char at end or buffer_size bytes, whichever comes first
@@ -106,7 +160,19 @@ public:
      * @param end The terminating char to be read
      * @return Number of bytes read into buffer
      */
-    uint32_t ReadLine(uint8_t* buffer, uint32_t buffer_size, uint8_t end);
+    size_t ReadLine(uint8_t* buffer, size_t buffer_size, uint8_t end);
+
+    /**
+     * @brief Read up to buffer_size bytes starting at offset without moving the file pointer
+     *
+     * Served from the block cache when the reader has one. Not thread safe with a
+     * cache or direct reads, unaligned direct requests share one bounce buffer.
+     * @param offset Absolute file offset of the first byte to read
+     * @param buffer Destination buffer of at least size buffer_size
+     * @param buffer_size The maximum number of bytes to read
+     * @return The number of bytes read, short only at the end of the file
+     */
+    size_t ReadAt(uint64_t offset, uint8_t* buffer, size_t buffer_size) const;
 
     /**
      * @brief Move the file pointer location in the file
@@ -114,9 +180,51 @@ public:
      * @param whence Where the offset should be calculated from
      * @return The updated file offset
      */
-    uint32_t Seek(uint32_t offset, SeekStart whence);
+    uint64_t Seek(int64_t offset, SeekStart whence);
+
+    /**
+     * @brief Get the current file pointer location
+     * @return The offset of the next byte to be read
+     */
+    uint64_t Tell() const noexcept;
+
+    /**
+     * @brief Get the size of the open file
+     * @return The file size in bytes
+     */
+    uint64_t Size() const;
+
+    /**
+     * Mapped Access
+     */
+
+    /**
+     * @brief Check if the open file is memory mapped
+     * @return True if the file contents are available through MappedData()
+     */
+    bool Mapped() const noexcept;
+
+    /**
+     * @brief Get the contiguous contents of a mapped file
+     * @return Pointer to the first byte of the file, nullptr if not mapped or empty
+     */
+    const uint8_t* MappedData() const noexcept;
+
+    /**
+     * @brief Get the size of a mapped file
+     * @return The number of bytes available through MappedData()
+     */
+    size_t MappedSize() const noexcept;
+
+    /**
+     * @brief Get the block cache behind ReadAt()
+     * @return The cache, nullptr when the reader was built without cache_blocks
+     */
+    const BlockCache* Cache() const noexcept;
 
 private:
+    friend class BlockCache;
+
     /**
      * Internal Functions 
      */
@@ -125,21 +233,59 @@ private:
      * @brief Fill the buffer with new bytes from the file
      * @return The number of bytes read into the buffer
      */
-    uint32_t FillBuffer();
+    size_t FillBuffer();
+
+    /**
+     * @brief ReadAt() straight from the file, what the block cache loads its blocks with
+     */
+    size_t ReadFile(uint64_t offset, uint8_t* buffer, size_t buffer_size) const;
+
+    /**
+     * @brief Try to map the open file, leaving the reader buffered on failure
+     */
+    void MapFile();
+
+    /**
+     * @brief Start reading ahead on the open file, leaving the reader buffered for non-regular files
+     */
+    void StartReadAhead();
 
     /**
      * File Items
      */
     bool eof_;
     int32_t fd_;
+    ReadMode mode_;
+    bool direct_;
 
     /**
      * Buffer Items 
      */
-    std::unique_ptr<uint8_t[]> buffer_;
-    int32_t buffer_start_;
-    int32_t buffer_end_;
-    const uint32_t max_buffer_size_;
+    std::unique_ptr<uint8_t[], AlignedDeleter> buffer_;
+    const uint8_t* data_;
+    size_t buffer_start_;
+    size_t buffer_end_;
+    uint64_t file_pos_;
+    const size_t max_buffer_size_;
+    mutable std::unique_ptr<uint8_t[], AlignedDeleter> bounce_;    // Unaligned direct ReadAt() requests, allocated on first use
+
+    /**
+     * Mapping Items
+     */
+    uint8_t* map_;
+    size_t map_size_;
+    bool mapped_;
+
+    /**
+     * Read-Ahead Items
+     */
+    std::unique_ptr<ReadAhead> read_ahead_;
+    const uint32_t read_ahead_depth_;
+
+    /**
+     * Cache Items
+     */
+    mutable std::unique_ptr<BlockCache> cache_;
 };
 
 #endif
\ No newline at end of file
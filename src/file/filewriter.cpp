@@ -0,0 +1,242 @@
+// C++ Includes
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// C Includes
+#include <fcntl.h>
+#include <limits.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+// Local Includes
+#include "exception/file_exception.h"
+#include "filewriter.h"
+
+static_assert(sizeof(off_t) == 8, "FileWriter requires a 64-bit off_t, build with _FILE_OFFSET_BITS=64");
+
+/**
+ * @brief Adjacent transfers given to the kernel at once, IOV_MAX is the hard limit
+ */
+#define MAX_RUN_LENGTH ((IOV_MAX < 256) ? IOV_MAX : 256)
+
+/**
+ * Helpers
+ */
+static void SortBatch(std::vector<FileIo>& batch) {
+    std::sort(batch.begin(), batch.end(), [](const FileIo& lhs, const FileIo& rhs) {
+        return lhs.offset < rhs.offset;
+    });
+}
+
+/**
+ * @brief The length of the run of adjacent transfers starting at first
+ */
+static size_t RunLength(const std::vector<FileIo>& batch, size_t first) {
+    size_t last = first + 1;
+    while (last < batch.size() && last - first < MAX_RUN_LENGTH &&
+           batch[last].offset == batch[last - 1].offset + batch[last - 1].size)
+        ++last;
+    return last - first;
+}
+
+/**
+ * @brief Drop the first transferred bytes from an iovec array
+ * @return The index of the first iovec with bytes left
+ */
+static size_t Advance(struct iovec* iov, size_t count, size_t first, size_t transferred) {
+    while (first < count && transferred >= iov[first].iov_len) {
+        transferred -= iov[first].iov_len;
+        ++first;
+    }
+    if (first < count) {
+        iov[first].iov_base = static_cast<uint8_t*>(iov[first].iov_base) + transferred;
+        iov[first].iov_len -= transferred;
+    }
+    return first;
+}
+
+/**
+ * FileWriter
+ */
+FileWriter::FileWriter(const FileWriterOptions& options)
+: fd_(-1), options_(options), write_calls_(0), read_calls_(0), sync_calls_(0), bytes_written_(0)
+{}
+
+FileWriter::FileWriter(const std::string& file_path, const FileWriterOptions& options)
+: FileWriter(options)
+{
+    Open(file_path);
+}
+
+FileWriter::~FileWriter() {
+    if (fd_ != -1)
+        close(fd_);
+}
+
+void FileWriter::Open(const std::string& file_path) {
+    if (fd_ != -1) Close();
+    int32_t flags = O_RDWR | (options_.create ? O_CREAT : 0) | (options_.truncate ? O_TRUNC : 0);
+    if ((fd_ = open(file_path.c_str(), flags | (options_.direct ? O_DIRECT : 0), 0644)) == -1 &&
+        options_.direct && errno == EINVAL) {
+        // The file system does not support O_DIRECT, go through the page cache instead
+        fd_ = open(file_path.c_str(), flags, 0644);
+    }
+    if (fd_ == -1)
+        throw FileException("Failed to open file for writing: " + file_path + ": " + strerror(errno));
+}
+
+void FileWriter::Close() {
+    if (fd_ != -1) {
+        int32_t fd = fd_;
+        fd_ = -1;
+        if (close(fd) == -1)
+            throw FileException(strerror(errno));
+    }
+}
+
+bool FileWriter::IsOpen() const noexcept {
+    return fd_ != -1;
+}
+
+void FileWriter::WriteAt(uint64_t offset, const uint8_t* buffer, size_t buffer_size) {
+    FileIo io{offset, const_cast<uint8_t*>(buffer), buffer_size};
+    WriteRun(&io, 1);
+}
+
+size_t FileWriter::ReadAt(uint64_t offset, uint8_t* buffer, size_t buffer_size) const {
+    size_t bytes_read = 0;
+    while (bytes_read < buffer_size) {
+        ++read_calls_;
+        ssize_t ret_val = pread(fd_, buffer + bytes_read, buffer_size - bytes_read, static_cast<off_t>(offset + bytes_read));
+        if (ret_val == -1) {
+            if (errno == EINTR)
+                continue;
+            throw FileException(strerror(errno));
+        } else if (ret_val == 0) {
+            break;
+        }
+        bytes_read += static_cast<size_t>(ret_val);
+    }
+    return bytes_read;
+}
+
+void FileWriter::WriteBatch(std::vector<FileIo>& batch) {
+    SortBatch(batch);
+    for (size_t first = 0; first < batch.size();) {
+        size_t count = RunLength(batch, first);
+        WriteRun(batch.data() + first, count);
+        first += count;
+    }
+}
+
+size_t FileWriter::ReadBatch(std::vector<FileIo>& batch) const {
+    SortBatch(batch);
+    size_t bytes_read = 0;
+    for (size_t first = 0; first < batch.size();) {
+        size_t count = RunLength(batch, first);
+        bytes_read += ReadRun(batch.data() + first, count);
+        first += count;
+    }
+    return bytes_read;
+}
+
+void FileWriter::Sync() {
+    ++sync_calls_;
+    while (fdatasync(fd_) == -1) {
+        if (errno != EINTR)
+            throw FileException(std::string("Failed to sync file: ") + strerror(errno));
+    }
+}
+
+void FileWriter::Truncate(uint64_t size) {
+    while (ftruncate(fd_, static_cast<off_t>(size)) == -1) {
+        if (errno != EINTR)
+            throw FileException(std::string("Failed to resize file: ") + strerror(errno));
+    }
+}
+
+uint64_t FileWriter::Size() const {
+    struct stat file_stat;
+    if (fstat(fd_, &file_stat) == -1)
+        throw FileException(strerror(errno));
+    return static_cast<uint64_t>(file_stat.st_size);
+}
+
+uint64_t FileWriter::WriteCalls() const noexcept {
+    return write_calls_;
+}
+
+uint64_t FileWriter::ReadCalls() const noexcept {
+    return read_calls_;
+}
+
+uint64_t FileWriter::SyncCalls() const noexcept {
+    return sync_calls_;
+}
+
+uint64_t FileWriter::BytesWritten() const noexcept {
+    return bytes_written_;
+}
+
+void FileWriter::WriteRun(const FileIo* run, size_t count) {
+    struct iovec iov[MAX_RUN_LENGTH];
+    size_t remaining = 0;
+    for (size_t i = 0; i < count; ++i) {
+        iov[i].iov_base = run[i].buffer;
+        iov[i].iov_len = run[i].size;
+        remaining += run[i].size;
+    }
+    uint64_t offset = run[0].offset;
+    size_t first = 0;
+    while (remaining > 0) {
+        ++write_calls_;
+        ssize_t ret_val = pwritev(fd_, iov + first, static_cast<int>(count - first), static_cast<off_t>(offset));
+        if (ret_val == -1) {
+            if (errno == EINTR)
+                continue;
+            throw FileException(std::string("Failed to write file: ") + strerror(errno));
+        }
+        size_t written = static_cast<size_t>(ret_val);
+        bytes_written_ += written;
+        offset += written;
+        remaining -= written;
+        first = Advance(iov, count, first, written);
+    }
+}
+
+size_t FileWriter::ReadRun(const FileIo* run, size_t count) const {
+    struct iovec iov[MAX_RUN_LENGTH];
+    size_t remaining = 0;
+    for (size_t i = 0; i < count; ++i) {
+        iov[i].iov_base = run[i].buffer;
+        iov[i].iov_len = run[i].size;
+        remaining += run[i].size;
+    }
+    uint64_t offset = run[0].offset;
+    size_t first = 0;
+    size_t bytes_read = 0;
+    while (remaining > 0) {
+        ++read_calls_;
+        ssize_t ret_val = preadv(fd_, iov + first, static_cast<int>(count - first), static_cast<off_t>(offset));
+        if (ret_val == -1) {
+            if (errno == EINTR)
+                continue;
+            throw FileException(std::string("Failed to read file: ") + strerror(errno));
+        } else if (ret_val == 0) {
+            // The end of the file, whatever was not read is zero
+            for (size_t i = first; i < count; ++i)
+                memset(iov[i].iov_base, 0, iov[i].iov_len);
+            break;
+        }
+        size_t transfer = static_cast<size_t>(ret_val);
+        bytes_read += transfer;
+        offset += transfer;
+        remaining -= transfer;
+        first = Advance(iov, count, first, transfer);
+    }
+    return bytes_read;
+}
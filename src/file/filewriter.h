@@ -0,0 +1,164 @@
+#ifndef DT_SRC_FILE_FILEWRITER_H
+#define DT_SRC_FILE_FILEWRITER_H
+
+// C++ Includes
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Construction time settings for a FileWriter
+ */
+struct FileWriterOptions {
+    bool create = true;         // create the file if it does not exist
+    bool truncate = false;      // discard any existing contents
+    bool direct = false;        // O_DIRECT, every buffer, offset and size must then be 4 KiB aligned
+};
+
+/**
+ * @brief One positional transfer of a batch
+ */
+struct FileIo {
+    uint64_t offset;
+    uint8_t* buffer;
+    size_t size;
+};
+
+/**
+ * @brief Positional reads and writes of a file opened for update, the storage side of FileReader
+ *
+ * There is no file pointer: every transfer names its offset, so callers that
+ * own disjoint ranges never interfere. Batches are sorted by offset and every
+ * run of adjacent transfers goes to the kernel as one preadv or pwritev.
+ */
+class FileWriter {
+public:
+    /**
+     * Tors
+     */
+
+    /**
+     * @brief Construct a FileWriter with no open file
+     * @param options const FileWriterOptions&
+     */
+    explicit FileWriter(const FileWriterOptions& options = FileWriterOptions());
+
+    /**
+     * @brief Construct a FileWriter and open file_path
+     * @param file_path const std::string&
+     * @param options const FileWriterOptions&
+     */
+    FileWriter(const std::string& file_path, const FileWriterOptions& options = FileWriterOptions());
+
+    /**
+     * @brief Close the file
+     */
+    ~FileWriter();
+
+    /**
+     * NON-COPYABLE
+     */
+    FileWriter(const FileWriter&) = delete;
+    FileWriter(FileWriter&&) = delete;
+    FileWriter& operator=(const FileWriter&) = delete;
+
+    /**
+     * File Functions
+     */
+
+    /**
+     * @brief Open the file found at file_path for reading and writing
+     * @param file_path const std::string&
+     */
+    void Open(const std::string& file_path);
+
+    /**
+     * @brief Close the file if open, without syncing it
+     */
+    void Close();
+
+    /**
+     * @brief Check if a file is open
+     */
+    bool IsOpen() const noexcept;
+
+    /**
+     * @brief Write all of buffer at offset, growing the file as needed
+     * @param offset Absolute file offset of the first byte to write
+     * @param buffer The bytes to write
+     * @param buffer_size The number of bytes to write
+     */
+    void WriteAt(uint64_t offset, const uint8_t* buffer, size_t buffer_size);
+
+    /**
+     * @brief Read up to buffer_size bytes starting at offset
+     * @param offset Absolute file offset of the first byte to read
+     * @param buffer Destination buffer of at least size buffer_size
+     * @param buffer_size The maximum number of bytes to read
+     * @return The number of bytes read, short only at the end of the file
+     */
+    size_t ReadAt(uint64_t offset, uint8_t* buffer, size_t buffer_size) const;
+
+    /**
+     * @brief Write every transfer of batch, coalescing adjacent ones
+     * @param batch Transfers that must not overlap, sorted in place by offset
+     */
+    void WriteBatch(std::vector<FileIo>& batch);
+
+    /**
+     * @brief Read every transfer of batch, coalescing adjacent ones
+     * @param batch Transfers that must not overlap, sorted in place by offset
+     * @return Bytes read, transfers past the end of the file are zero filled
+     */
+    size_t ReadBatch(std::vector<FileIo>& batch) const;
+
+    /**
+     * @brief Flush written data to the device, fdatasync
+     */
+    void Sync();
+
+    /**
+     * @brief Set the size of the file, zero filling when it grows
+     * @param size The new size in bytes
+     */
+    void Truncate(uint64_t size);
+
+    /**
+     * @brief Get the size of the open file
+     * @return The file size in bytes
+     */
+    uint64_t Size() const;
+
+    /**
+     * Stats
+     */
+    uint64_t WriteCalls() const noexcept;
+    uint64_t ReadCalls() const noexcept;
+    uint64_t SyncCalls() const noexcept;
+    uint64_t BytesWritten() const noexcept;
+
+private:
+    /**
+     * Internal Functions
+     */
+
+    /**
+     * @brief Write one run of adjacent transfers with pwritev, resuming after short writes
+     */
+    void WriteRun(const FileIo* run, size_t count);
+
+    /**
+     * @brief Read one run of adjacent transfers with preadv, zero filling past the end of the file
+     * @return Bytes read
+     */
+    size_t ReadRun(const FileIo* run, size_t count) const;
+
+    int32_t fd_;
+    const FileWriterOptions options_;
+    uint64_t write_calls_;
+    mutable uint64_t read_calls_;
+    uint64_t sync_calls_;
+    uint64_t bytes_written_;
+};
+
+#endif
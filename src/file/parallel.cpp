@@ -0,0 +1,38 @@
+// C++ Includes
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Local Includes
+#include "parallel.h"
+
+void RunParallel(uint32_t threads, size_t count, const std::function<void(size_t)>& task) {
+    std::atomic<size_t> next(0);
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    auto worker = [&]() {
+        for (size_t index = next++; index < count; index = next++) {
+            try {
+                task(index);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!error)
+                    error = std::current_exception();
+                next = count;
+            }
+        }
+    };
+    size_t helpers = (count < threads) ? count : threads;
+    std::vector<std::thread> pool;
+    for (size_t i = 1; i < helpers; ++i)
+        pool.emplace_back(worker);
+    worker();
+    for (std::thread& thread : pool)
+        thread.join();
+    if (error)
+        std::rethrow_exception(error);
+}
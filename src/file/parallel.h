@@ -0,0 +1,20 @@
+#ifndef DT_SRC_FILE_PARALLEL_H
+#define DT_SRC_FILE_PARALLEL_H
+
+// C++ Includes
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+/**
+ * @brief Run task(0..count-1) on up to threads threads, the calling thread included, each index exactly once
+ *
+ * The first exception a task throws stops the indexes not yet started and is
+ * rethrown once every thread has finished.
+ * @param threads The most threads to run tasks on, at least one
+ * @param count The number of tasks
+ * @param task Called with each index, from any of the threads
+ */
+void RunParallel(uint32_t threads, size_t count, const std::function<void(size_t)>& task);
+
+#endif
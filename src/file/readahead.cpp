@@ -0,0 +1,295 @@
+// C++ Includes
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+
+// C Includes
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define DT_HAVE_IO_URING 1
+#endif
+
+// Local Includes
+#include "exception/file_exception.h"
+#include "readahead.h"
+
+/**
+ * ReadAhead
+ */
+ReadAhead::ReadAhead(int32_t fd, size_t block_size, uint32_t depth, size_t alignment)
+: fd_(fd), block_size_(block_size), depth_(depth), alignment_(alignment), blocks_(nullptr),
+  slot_state_(depth, SlotState::kIDLE), slot_offset_(depth, 0), slot_result_(depth, 0),
+  next_slot_(0), next_offset_(0), current_slot_(-1), skip_(0), restart_(false), end_(false),
+  ring_fd_(-1), sq_map_(nullptr), sq_map_size_(0), cq_map_(nullptr), cq_map_size_(0),
+  sqe_map_(nullptr), sqe_map_size_(0), sq_head_(nullptr), sq_tail_(nullptr), sq_mask_(nullptr),
+  sq_array_(nullptr), cq_head_(nullptr), cq_tail_(nullptr), cq_mask_(nullptr), cqes_(nullptr),
+  iovecs_(depth), stop_(false)
+{
+    if (depth_ < 2)
+        throw FileException("ReadAhead needs a depth of at least two blocks");
+    blocks_ = static_cast<uint8_t*>(aligned_alloc(4096, ((block_size_ + 4095) & ~static_cast<size_t>(4095)) * depth_));
+    if (blocks_ == nullptr)
+        throw FileException(std::string("Failed to allocate read-ahead ring: ") + strerror(errno));
+    for (uint32_t i = 0; i < depth_; ++i) {
+        iovecs_[i].iov_base = blocks_ + i * ((block_size_ + 4095) & ~static_cast<size_t>(4095));
+        iovecs_[i].iov_len = block_size_;
+    }
+    if (!SetupRing())
+        worker_ = std::thread(&ReadAhead::WorkerLoop, this);
+}
+
+ReadAhead::~ReadAhead() {
+    try {
+        Drain();
+    } catch (...) {}
+    if (worker_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        work_cv_.notify_one();
+        worker_.join();
+    }
+    TeardownRing();
+    free(blocks_);
+}
+
+void ReadAhead::Start(uint64_t offset) {
+    Drain();
+    skip_ = static_cast<size_t>(offset & (alignment_ - 1));
+    offset -= skip_;
+    for (uint32_t i = 0; i < depth_; ++i)
+        Submit(i, offset + i * block_size_);
+    next_slot_ = 0;
+    next_offset_ = offset + depth_ * block_size_;
+    current_slot_ = -1;
+    restart_ = false;
+    end_ = false;
+}
+
+const uint8_t* ReadAhead::Next(size_t& block_bytes) {
+    block_bytes = 0;
+    if (end_)
+        return nullptr;
+    if (restart_) {
+        Start(slot_offset_[current_slot_] + slot_result_[current_slot_]);
+    } else if (current_slot_ != -1) {
+        // Recycle the block handed out last time for the next offset in the file
+        Submit(static_cast<uint32_t>(current_slot_), next_offset_);
+        next_offset_ += block_size_;
+    }
+
+    uint32_t slot = next_slot_;
+    Wait(slot);
+    int64_t result = slot_result_[slot];
+    slot_state_[slot] = SlotState::kIDLE;
+    if (result < 0)
+        throw FileException(strerror(static_cast<int>(-result)));
+
+    current_slot_ = slot;
+    next_slot_ = (next_slot_ + 1) % depth_;
+    size_t skip = skip_;
+    skip_ = 0;
+    if (result <= static_cast<int64_t>(skip)) {
+        end_ = true;
+        return nullptr;
+    }
+    // A short block is usually the end of the file, restart from exactly where it stopped to be sure
+    if (static_cast<size_t>(result) < block_size_)
+        restart_ = true;
+    block_bytes = static_cast<size_t>(result) - skip;
+    return static_cast<const uint8_t*>(iovecs_[slot].iov_base) + skip;
+}
+
+bool ReadAhead::UsingIoUring() const noexcept {
+    return ring_fd_ != -1;
+}
+
+void ReadAhead::Submit(uint32_t slot, uint64_t offset) {
+    slot_offset_[slot] = offset;
+    slot_result_[slot] = 0;
+    slot_state_[slot] = SlotState::kPENDING;
+    if (ring_fd_ != -1) {
+        RingSubmit(slot);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(slot);
+    }
+    work_cv_.notify_one();
+}
+
+void ReadAhead::Wait(uint32_t slot) {
+    if (ring_fd_ != -1) {
+        while (slot_state_[slot] == SlotState::kPENDING)
+            RingReap(true);
+        return;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [&]() { return slot_state_[slot] != SlotState::kPENDING; });
+}
+
+void ReadAhead::Drain() {
+    for (uint32_t i = 0; i < depth_; ++i) {
+        Wait(i);
+        slot_state_[i] = SlotState::kIDLE;
+    }
+}
+
+#ifdef DT_HAVE_IO_URING
+
+bool ReadAhead::SetupRing() {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    int32_t ring_fd = static_cast<int32_t>(syscall(__NR_io_uring_setup, depth_, &params));
+    if (ring_fd < 0)
+        return false;
+    ring_fd_ = ring_fd;
+
+    sq_map_size_ = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    cq_map_size_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    bool single_map = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_map && cq_map_size_ > sq_map_size_)
+        sq_map_size_ = cq_map_size_;
+
+    sq_map_ = mmap(nullptr, sq_map_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+    if (sq_map_ == MAP_FAILED) {
+        sq_map_ = nullptr;
+        TeardownRing();
+        return false;
+    }
+    if (single_map) {
+        cq_map_ = sq_map_;
+    } else {
+        cq_map_ = mmap(nullptr, cq_map_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_CQ_RING);
+        if (cq_map_ == MAP_FAILED) {
+            cq_map_ = nullptr;
+            TeardownRing();
+            return false;
+        }
+    }
+    sqe_map_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+    sqe_map_ = mmap(nullptr, sqe_map_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+    if (sqe_map_ == MAP_FAILED) {
+        sqe_map_ = nullptr;
+        TeardownRing();
+        return false;
+    }
+
+    uint8_t* sq = static_cast<uint8_t*>(sq_map_);
+    uint8_t* cq = static_cast<uint8_t*>(cq_map_);
+    sq_head_ = reinterpret_cast<uint32_t*>(sq + params.sq_off.head);
+    sq_tail_ = reinterpret_cast<uint32_t*>(sq + params.sq_off.tail);
+    sq_mask_ = reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<uint32_t*>(sq + params.sq_off.array);
+    cq_head_ = reinterpret_cast<uint32_t*>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<uint32_t*>(cq + params.cq_off.tail);
+    cq_mask_ = reinterpret_cast<uint32_t*>(cq + params.cq_off.ring_mask);
+    cqes_ = cq + params.cq_off.cqes;
+    return true;
+}
+
+void ReadAhead::TeardownRing() noexcept {
+    if (sqe_map_ != nullptr)
+        munmap(sqe_map_, sqe_map_size_);
+    if (cq_map_ != nullptr && cq_map_ != sq_map_)
+        munmap(cq_map_, cq_map_size_);
+    if (sq_map_ != nullptr)
+        munmap(sq_map_, sq_map_size_);
+    sqe_map_ = cq_map_ = sq_map_ = nullptr;
+    if (ring_fd_ != -1)
+        close(ring_fd_);
+    ring_fd_ = -1;
+}
+
+void ReadAhead::RingSubmit(uint32_t slot) {
+    uint32_t tail = *sq_tail_;
+    uint32_t index = tail & *sq_mask_;
+    struct io_uring_sqe* sqe = static_cast<struct io_uring_sqe*>(sqe_map_) + index;
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_READV;
+    sqe->fd = fd_;
+    sqe->off = slot_offset_[slot];
+    sqe->addr = reinterpret_cast<uint64_t>(&iovecs_[slot]);
+    sqe->len = 1;
+    sqe->user_data = slot;
+    sq_array_[index] = index;
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+
+    while (syscall(__NR_io_uring_enter, ring_fd_, 1, 0, 0, nullptr, 0) < 0) {
+        if (errno != EINTR && errno != EAGAIN)
+            throw FileException(strerror(errno));
+    }
+}
+
+void ReadAhead::RingReap(bool wait) {
+    uint32_t head = *cq_head_;
+    if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+        if (!wait)
+            return;
+        if (syscall(__NR_io_uring_enter, ring_fd_, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0 && errno != EINTR)
+            throw FileException(strerror(errno));
+    }
+    uint32_t tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    for (; head != tail; ++head) {
+        struct io_uring_cqe* cqe = static_cast<struct io_uring_cqe*>(cqes_) + (head & *cq_mask_);
+        uint32_t slot = static_cast<uint32_t>(cqe->user_data);
+        slot_result_[slot] = cqe->res;
+        slot_state_[slot] = SlotState::kDONE;
+    }
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+}
+
+#else
+
+bool ReadAhead::SetupRing() {
+    return false;
+}
+
+void ReadAhead::TeardownRing() noexcept {}
+
+void ReadAhead::RingSubmit(uint32_t) {}
+
+void ReadAhead::RingReap(bool) {}
+
+#endif
+
+void ReadAhead::WorkerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        work_cv_.wait(lock, [&]() { return stop_ || !queue_.empty(); });
+        if (stop_)
+            return;
+        uint32_t slot = queue_.front();
+        queue_.pop_front();
+        uint64_t offset = slot_offset_[slot];
+        lock.unlock();
+
+        int64_t result = 0;
+        while (static_cast<size_t>(result) < block_size_) {
+            ssize_t ret_val = pread(fd_, static_cast<uint8_t*>(iovecs_[slot].iov_base) + result,
+                                    block_size_ - result, static_cast<off_t>(offset + result));
+            if (ret_val < 0) {
+                if (errno == EINTR)
+                    continue;
+                result = -errno;
+                break;
+            } else if (ret_val == 0) {
+                break;
+            }
+            result += ret_val;
+        }
+
+        lock.lock();
+        slot_result_[slot] = result;
+        slot_state_[slot] = SlotState::kDONE;
+        done_cv_.notify_all();
+    }
+}
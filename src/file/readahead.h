@@ -0,0 +1,147 @@
+#ifndef DT_SRC_FILE_READAHEAD_H
+#define DT_SRC_FILE_READAHEAD_H
+
+// C++ Includes
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// C Includes
+#include <sys/uio.h>
+
+/**
+ * @brief Keeps a ring of sequential block reads in flight ahead of the consumer
+ * 
+ * Reads are issued through io_uring when the kernel allows it, otherwise a
+ * background thread services them with pread.
+ */
+class ReadAhead {
+public:
+    /**
+     * Tors
+     */
+
+    /**
+     * @brief Construct a read-ahead ring over an open file descriptor
+     * @param fd The file to read, must refer to a regular file and outlive the ring
+     * @param block_size The size of each read
+     * @param depth The number of blocks kept in flight
+     * @param alignment Offsets handed to the kernel are rounded down to this power of two (O_DIRECT)
+     */
+    ReadAhead(int32_t fd, size_t block_size, uint32_t depth, size_t alignment = 1);
+
+    /**
+     * @brief Wait for outstanding reads and release the ring
+     */
+    ~ReadAhead();
+
+    /**
+     * NON-COPYABLE
+     */
+    ReadAhead(const ReadAhead&) = delete;
+    ReadAhead(ReadAhead&&) = delete;
+    ReadAhead& operator=(const ReadAhead&) = delete;
+
+    /**
+     * Read Functions
+     */
+
+    /**
+     * @brief Discard any outstanding blocks and start reading ahead from offset
+     * @param offset Absolute file offset of the next block returned by Next()
+     */
+    void Start(uint64_t offset);
+
+    /**
+     * @brief Wait for the next block in file order
+     * @param block_bytes Set to the number of valid bytes in the block, 0 at the end of the file
+     * @return The block, valid until the next call to Next() or Start()
+     */
+    const uint8_t* Next(size_t& block_bytes);
+
+    /**
+     * @brief Check which backend services the reads
+     * @return True if reads go through io_uring
+     */
+    bool UsingIoUring() const noexcept;
+
+private:
+    enum class SlotState : uint8_t {
+        kIDLE,
+        kPENDING,
+        kDONE
+    };
+
+    /**
+     * Internal Functions
+     */
+    void Submit(uint32_t slot, uint64_t offset);
+    void Wait(uint32_t slot);
+    void Drain();
+
+    /**
+     * io_uring Functions
+     */
+    bool SetupRing();
+    void TeardownRing() noexcept;
+    void RingSubmit(uint32_t slot);
+    void RingReap(bool wait);
+
+    /**
+     * Thread Functions
+     */
+    void WorkerLoop();
+
+    /**
+     * Ring Items
+     */
+    const int32_t fd_;
+    const size_t block_size_;
+    const uint32_t depth_;
+    const size_t alignment_;
+    uint8_t* blocks_;
+    std::vector<SlotState> slot_state_;
+    std::vector<uint64_t> slot_offset_;
+    std::vector<int64_t> slot_result_;
+    uint32_t next_slot_;
+    uint64_t next_offset_;
+    int64_t current_slot_;
+    size_t skip_;
+    bool restart_;
+    bool end_;
+
+    /**
+     * io_uring Items
+     */
+    int32_t ring_fd_;
+    void* sq_map_;
+    size_t sq_map_size_;
+    void* cq_map_;
+    size_t cq_map_size_;
+    void* sqe_map_;
+    size_t sqe_map_size_;
+    uint32_t* sq_head_;
+    uint32_t* sq_tail_;
+    uint32_t* sq_mask_;
+    uint32_t* sq_array_;
+    uint32_t* cq_head_;
+    uint32_t* cq_tail_;
+    uint32_t* cq_mask_;
+    void* cqes_;
+    std::vector<struct iovec> iovecs_;
+
+    /**
+     * Thread Items
+     */
+    std::thread worker_;
+    std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable done_cv_;
+    std::deque<uint32_t> queue_;
+    bool stop_;
+};
+
+#endif
@@ -0,0 +1,82 @@
+// C++ Includes
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+// Local Includes
+#include "arena.h"
+
+Arena::Arena(size_t block_size) noexcept
+: block_size_(block_size), head_(nullptr), cur_(0), end_(0), allocations_(0), heap_allocations_(0), bytes_used_(0)
+{}
+
+Arena::~Arena() noexcept {
+    while (head_ != nullptr) {
+        Block* prev = head_->prev;
+        free(head_);
+        head_ = prev;
+    }
+}
+
+void* Arena::Allocate(size_t size, size_t alignment) {
+    uintptr_t start = (cur_ + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+    if (head_ == nullptr || start + size > end_) {
+        NewBlock(size, alignment);
+        start = (cur_ + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+    }
+    bytes_used_ += start + size - cur_;
+    cur_ = start + size;
+    ++allocations_;
+    return reinterpret_cast<void*>(start);
+}
+
+std::string_view Arena::CopyString(std::string_view str) {
+    if (str.empty())
+        return std::string_view();
+    char* copy = static_cast<char*>(Allocate(str.size(), 1));
+    memcpy(copy, str.data(), str.size());
+    return std::string_view(copy, str.size());
+}
+
+void Arena::Reset() noexcept {
+    // Free back to the oldest block, which is kept for the next round of allocations
+    while (head_ != nullptr && head_->prev != nullptr) {
+        Block* prev = head_->prev;
+        free(head_);
+        head_ = prev;
+    }
+    if (head_ != nullptr) {
+        cur_ = reinterpret_cast<uintptr_t>(head_ + 1);
+        end_ = reinterpret_cast<uintptr_t>(head_) + head_->size;
+    }
+    allocations_ = 0;
+    bytes_used_ = 0;
+}
+
+void Arena::NewBlock(size_t size, size_t alignment) {
+    // Oversized requests get a block of their own
+    size_t needed = sizeof(Block) + size + alignment;
+    size_t block_size = (needed > block_size_) ? needed : block_size_;
+    Block* block = static_cast<Block*>(malloc(block_size));
+    if (block == nullptr)
+        throw std::bad_alloc();
+    block->prev = head_;
+    block->size = block_size;
+    head_ = block;
+    cur_ = reinterpret_cast<uintptr_t>(block + 1);
+    end_ = reinterpret_cast<uintptr_t>(block) + block_size;
+    ++heap_allocations_;
+}
+
+size_t Arena::Allocations() const noexcept {
+    return allocations_;
+}
+
+size_t Arena::HeapAllocations() const noexcept {
+    return heap_allocations_;
+}
+
+size_t Arena::BytesUsed() const noexcept {
+    return bytes_used_;
+}
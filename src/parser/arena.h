@@ -0,0 +1,113 @@
+#ifndef DT_SRC_PARSER_ARENA_H
+#define DT_SRC_PARSER_ARENA_H
+
+// C++ Includes
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief Bump allocator that hands out memory from large blocks and frees it all at once
+ * 
+ * Objects placed in an arena are never destroyed individually, so only trivially
+ * destructible types may be created with New().
+ */
+class Arena {
+public:
+    /**
+     * Tors
+     */
+
+    /**
+     * @brief Construct an empty arena
+     * @param block_size The size of each block requested from the heap
+     */
+    explicit Arena(size_t block_size = 64 * 1024) noexcept;
+
+    /**
+     * @brief Free every block
+     */
+    ~Arena() noexcept;
+
+    /**
+     * NON-COPYABLE
+     */
+    Arena(const Arena&) = delete;
+    Arena(Arena&&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    /**
+     * Allocation
+     */
+
+    /**
+     * @brief Allocate size bytes aligned to alignment, a power of two
+     * @throws std::bad_alloc when the heap is exhausted
+     */
+    void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    /**
+     * @brief Construct a T in the arena
+     */
+    template <typename T, typename... Args>
+    T* New(Args&&... args) {
+        static_assert(std::is_trivially_destructible<T>::value, "Arena objects are never destroyed");
+        return new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Copy str into the arena
+     */
+    std::string_view CopyString(std::string_view str);
+
+    /**
+     * @brief Release everything allocated so far, keeping the first block for reuse
+     */
+    void Reset() noexcept;
+
+    /**
+     * Stats
+     */
+
+    /**
+     * @brief Allocate() calls since the last Reset()
+     */
+    size_t Allocations() const noexcept;
+
+    /**
+     * @brief Blocks requested from the heap since construction
+     */
+    size_t HeapAllocations() const noexcept;
+
+    /**
+     * @brief Bytes handed out since the last Reset(), including alignment padding
+     */
+    size_t BytesUsed() const noexcept;
+
+private:
+    /**
+     * @brief Header in front of every block, blocks form a list from newest to oldest
+     */
+    struct Block {
+        Block* prev;
+        size_t size;
+    };
+
+    /**
+     * @brief Allocate a new block that fits size bytes at alignment and make it current
+     */
+    void NewBlock(size_t size, size_t alignment);
+
+    const size_t block_size_;
+    Block* head_;
+    uintptr_t cur_;
+    uintptr_t end_;
+    size_t allocations_;
+    size_t heap_allocations_;
+    size_t bytes_used_;
+};
+
+#endif
@@ -0,0 +1,109 @@
+// C++ Includes
+#include <cstdint>
+#include <string>
+
+// Local Includes
+#include "ast.h"
+
+static const char* mAstKindName[] = {
+    "PROGRAM",
+    "STRUCT_DECL",
+    "FUNCTION",
+    "BASE",
+    "VAR_DECL",
+    "TYPE",
+    "BLOCK",
+    "IF",
+    "WHILE",
+    "FOR",
+    "RETURN",
+    "DELETE",
+    "EXPR_STMT",
+    "EMPTY",
+    "ASSIGN",
+    "BINARY",
+    "UNARY",
+    "RANGE",
+    "CALL",
+    "CONSTRUCT",
+    "ARG",
+    "MEMBER",
+    "INDEX",
+    "NEW",
+    "IDENTIFIER",
+    "INTEGER",
+    "REAL",
+    "STRING",
+    "BOOL",
+    "PARAMETER"
+};
+
+static const char* mModifierName[] = {
+    "const", "signed", "unsigned", "notnull", "primary", "secondary"
+};
+
+const AstNode* AstNode::Child(uint32_t index) const noexcept {
+    const AstNode* child = first_child;
+    while (child != nullptr && index-- != 0)
+        child = child->next_sibling;
+    return child;
+}
+
+const char* AstKindName(AstKind kind) noexcept {
+    return mAstKindName[static_cast<uint8_t>(kind)];
+}
+
+static void AppendNode(std::string& out, const AstNode* node, uint32_t depth) {
+    out.append(depth * 2, ' ');
+    out += AstKindName(node->kind);
+    switch (node->kind) {
+        case AstKind::kASSIGN:
+        case AstKind::kBINARY:
+        case AstKind::kUNARY:
+        case AstKind::kBOOL:
+        case AstKind::kTYPE: {
+            out += ' ';
+            out += TokenTypeName(node->op);
+        } break;
+        default:
+            break;
+    }
+    if (!node->text.empty()) {
+        out += (node->kind == AstKind::kSTRING) ? " \"" : " ";
+        out += node->text;
+        if (node->kind == AstKind::kSTRING)
+            out += '"';
+    }
+    if (node->kind == AstKind::kVAR_DECL) {
+        for (uint32_t bit = 0; bit < 6; ++bit) {
+            if (node->flags & (1u << bit)) {
+                out += ' ';
+                out += mModifierName[bit];
+            }
+        }
+    } else if (node->kind == AstKind::kTYPE) {
+        out.append(node->flags & kAST_POINTER_MASK, '*');
+        if (node->flags & kAST_ARRAY)
+            out += "[]";
+    } else if (node->kind == AstKind::kSTRUCT_DECL && (node->flags & kAST_HAS_BODY)) {
+        out += " {}";
+    } else if (node->kind == AstKind::kRANGE) {
+        out += (node->flags & kAST_LOWER_INCLUSIVE) ? " [" : " (";
+        out += (node->flags & kAST_UPPER_INCLUSIVE) ? "]" : ")";
+    } else if (node->kind == AstKind::kPARAMETER) {
+        out += " #";
+        out += std::to_string(node->flags);
+    }
+    out += " @";
+    out += std::to_string(node->line);
+    out += '\n';
+    for (const AstNode* child = node->first_child; child != nullptr; child = child->next_sibling)
+        AppendNode(out, child, depth + 1);
+}
+
+std::string AstToString(const AstNode* node) {
+    std::string out;
+    if (node != nullptr)
+        AppendNode(out, node, 0);
+    return out;
+}
@@ -0,0 +1,106 @@
+#ifndef DT_SRC_PARSER_AST_H
+#define DT_SRC_PARSER_AST_H
+
+// C++ Includes
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Local Includes
+#include "parser/tokenizer.h"
+
+/**
+ * @brief The kind of an AST node, the comment lists what text and children hold
+ */
+enum class AstKind : uint8_t {
+    // STATEMENTS
+    kPROGRAM,       // children: statements
+    kSTRUCT_DECL,   // text: name, children: [kBASE] kVAR_DECL..., flags: kAST_HAS_BODY
+    kFUNCTION,      // text: name, children: return kTYPE or kEMPTY, parameter kVAR_DECL..., body kBLOCK
+    kBASE,          // text: base struct name
+    kVAR_DECL,      // text: name, children: kTYPE [initializer], flags: kMOD_*
+    kTYPE,          // op: type keyword or kIDENTIFIER, text: type name, children: [array size], flags: pointers, kAST_ARRAY
+    kBLOCK,         // children: statements
+    kIF,            // children: condition, then [else]
+    kWHILE,         // children: condition, body
+    kFOR,           // children: init, condition, step, body, omitted clauses are kEMPTY
+    kRETURN,        // children: [value]
+    kDELETE,        // children: target
+    kEXPR_STMT,     // children: expression
+    kEMPTY,         // an omitted for clause
+    // EXPRESSIONS
+    kASSIGN,        // op: kASSIGN or a compound assignment, children: target, value
+    kBINARY,        // op: operator, children: lhs, rhs
+    kUNARY,         // op: kNOT, kMINUS or kPLUS, children: operand
+    kRANGE,         // children: target, lower bound or kEMPTY, upper bound or kEMPTY, flags: kAST_*_INCLUSIVE
+    kCALL,          // children: callee, kARG...
+    kCONSTRUCT,     // children: kARG..., constructor style initializer "Type name(args)"
+    kARG,           // text: name for key=value arguments, children: value
+    kMEMBER,        // text: member name, children: object
+    kINDEX,         // children: object, index
+    kNEW,           // children: kTYPE, kARG...
+    kIDENTIFIER,    // text: name
+    kINTEGER,       // text: digits
+    kREAL,          // text: digits
+    kSTRING,        // text: decoded value
+    kBOOL,          // op: kTRUE or kFALSE
+    kPARAMETER      // text: name of a $name placeholder, empty for ?, flags: parameter index
+};
+
+/**
+ * @brief Flags of kSTRUCT_DECL, kTYPE and kRANGE nodes
+ */
+enum AstFlags : uint16_t {
+    kAST_POINTER_MASK = 0x00FF,     // Pointer depth of a kTYPE
+    kAST_ARRAY = 0x0100,            // kTYPE is an array, its child is the size if one was given
+    kAST_HAS_BODY = 0x0200,         // kSTRUCT_DECL has a { } body
+    kAST_LOWER_INCLUSIVE = 0x0400,  // kRANGE includes its lower bound
+    kAST_UPPER_INCLUSIVE = 0x0800   // kRANGE includes its upper bound
+};
+
+/**
+ * @brief Modifier flags of kVAR_DECL nodes
+ */
+enum ModifierFlags : uint16_t {
+    kMOD_CONST = 0x01,
+    kMOD_SIGNED = 0x02,
+    kMOD_UNSIGNED = 0x04,
+    kMOD_NOTNULL = 0x08,
+    kMOD_PRIMARY = 0x10,
+    kMOD_SECONDARY = 0x20
+};
+
+/**
+ * @brief A node of the syntax tree, one fixed size POD type for every kind
+ * 
+ * Nodes live in an Arena and link to their children through first_child and
+ * next_sibling, so building a tree never touches the heap per node. Strings
+ * are copied into the same arena.
+ */
+struct AstNode {
+    AstKind kind;
+    TokenType op;
+    uint16_t flags;
+    uint32_t line;
+    uint32_t child_count;
+    std::string_view text;
+    AstNode* first_child;
+    AstNode* next_sibling;
+
+    /**
+     * @brief The index'th child, walking the sibling list
+     */
+    const AstNode* Child(uint32_t index) const noexcept;
+};
+
+/**
+ * @brief Name of a node kind for debugging
+ */
+const char* AstKindName(AstKind kind) noexcept;
+
+/**
+ * @brief Render a tree as an indented outline, one node per line
+ */
+std::string AstToString(const AstNode* node);
+
+#endif
@@ -0,0 +1,237 @@
+// C++ Includes
+#include <cstdint>
+
+// C Includes
+#if defined(__SSE2__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define DT_HAVE_X86_SIMD 1
+#endif
+
+// Local Includes
+#include "charscan.h"
+
+/**
+ * Scalar Kernels, also finish the tail shorter than a vector for the SIMD kernels
+ */
+static inline bool IsSpaceByte(uint8_t c) noexcept {
+    return c == ' ' || static_cast<uint8_t>(c - '\t') <= '\r' - '\t';
+}
+
+static inline bool IsIdentifierByte(uint8_t c) noexcept {
+    return static_cast<uint8_t>((c | 0x20) - 'a') <= 'z' - 'a' || static_cast<uint8_t>(c - '0') <= 9 || c == '_';
+}
+
+static inline bool IsCommentByte(uint8_t c) noexcept {
+    return c != '\n' && c != '\0';
+}
+
+static inline bool IsStringByte(uint8_t c) noexcept {
+    return c != '"' && c != '\\' && c != '\n' && c != '\0';
+}
+
+static const uint8_t* ScanSpaceScalar(const uint8_t* p, const uint8_t* end) noexcept {
+    while (p < end && IsSpaceByte(*p))
+        ++p;
+    return p;
+}
+
+static const uint8_t* ScanIdentifierScalar(const uint8_t* p, const uint8_t* end) noexcept {
+    while (p < end && IsIdentifierByte(*p))
+        ++p;
+    return p;
+}
+
+static const uint8_t* ScanCommentScalar(const uint8_t* p, const uint8_t* end) noexcept {
+    while (p < end && IsCommentByte(*p))
+        ++p;
+    return p;
+}
+
+static const uint8_t* ScanStringScalar(const uint8_t* p, const uint8_t* end) noexcept {
+    while (p < end && IsStringByte(*p))
+        ++p;
+    return p;
+}
+
+#ifdef DT_HAVE_X86_SIMD
+/**
+ * SSE2 Kernels, each mask has a bit set for every byte that ends the run
+ */
+static inline __m128i InRange128(__m128i v, uint8_t low, uint8_t high) noexcept {
+    __m128i shifted = _mm_sub_epi8(v, _mm_set1_epi8(static_cast<char>(low)));
+    return _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8(static_cast<char>(high - low))), shifted);
+}
+
+static inline uint32_t SpaceStops128(__m128i v) noexcept {
+    __m128i space = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), InRange128(v, '\t', '\r'));
+    return ~static_cast<uint32_t>(_mm_movemask_epi8(space)) & 0xFFFF;
+}
+
+static inline uint32_t IdentifierStops128(__m128i v) noexcept {
+    __m128i alpha = InRange128(_mm_or_si128(v, _mm_set1_epi8(0x20)), 'a', 'z');
+    __m128i ident = _mm_or_si128(_mm_or_si128(alpha, InRange128(v, '0', '9')), _mm_cmpeq_epi8(v, _mm_set1_epi8('_')));
+    return ~static_cast<uint32_t>(_mm_movemask_epi8(ident)) & 0xFFFF;
+}
+
+static inline uint32_t CommentStops128(__m128i v) noexcept {
+    __m128i stop = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(v, _mm_setzero_si128()));
+    return static_cast<uint32_t>(_mm_movemask_epi8(stop));
+}
+
+static inline uint32_t StringStops128(__m128i v) noexcept {
+    __m128i quote = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\\')));
+    __m128i line = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(v, _mm_setzero_si128()));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_or_si128(quote, line)));
+}
+
+#define SSE2_KERNEL(NAME, STOPS, SCALAR) \
+static const uint8_t* NAME(const uint8_t* p, const uint8_t* end) noexcept { \
+    while (end - p >= 16) { \
+        uint32_t stops = STOPS(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))); \
+        if (stops != 0) \
+            return p + __builtin_ctz(stops); \
+        p += 16; \
+    } \
+    return SCALAR(p, end); \
+}
+
+SSE2_KERNEL(ScanSpaceSSE2, SpaceStops128, ScanSpaceScalar)
+SSE2_KERNEL(ScanIdentifierSSE2, IdentifierStops128, ScanIdentifierScalar)
+SSE2_KERNEL(ScanCommentSSE2, CommentStops128, ScanCommentScalar)
+SSE2_KERNEL(ScanStringSSE2, StringStops128, ScanStringScalar)
+
+/**
+ * AVX2 Kernels, compiled for AVX2 regardless of the build flags and only selected when the CPU has it
+ */
+#define DT_AVX2 __attribute__((target("avx2")))
+
+DT_AVX2 static inline __m256i InRange256(__m256i v, uint8_t low, uint8_t high) noexcept {
+    __m256i shifted = _mm256_sub_epi8(v, _mm256_set1_epi8(static_cast<char>(low)));
+    return _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, _mm256_set1_epi8(static_cast<char>(high - low))), shifted);
+}
+
+DT_AVX2 static inline uint32_t SpaceStops256(__m256i v) noexcept {
+    __m256i space = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')), InRange256(v, '\t', '\r'));
+    return ~static_cast<uint32_t>(_mm256_movemask_epi8(space));
+}
+
+DT_AVX2 static inline uint32_t IdentifierStops256(__m256i v) noexcept {
+    __m256i alpha = InRange256(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), 'a', 'z');
+    __m256i ident = _mm256_or_si256(_mm256_or_si256(alpha, InRange256(v, '0', '9')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_')));
+    return ~static_cast<uint32_t>(_mm256_movemask_epi8(ident));
+}
+
+DT_AVX2 static inline uint32_t CommentStops256(__m256i v) noexcept {
+    __m256i stop = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')), _mm256_cmpeq_epi8(v, _mm256_setzero_si256()));
+    return static_cast<uint32_t>(_mm256_movemask_epi8(stop));
+}
+
+DT_AVX2 static inline uint32_t StringStops256(__m256i v) noexcept {
+    __m256i quote = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\')));
+    __m256i line = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')), _mm256_cmpeq_epi8(v, _mm256_setzero_si256()));
+    return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(quote, line)));
+}
+
+// Runs are usually short, so the 16 byte kernel finishes what is left after the 32 byte loop
+#define AVX2_KERNEL(NAME, STOPS, SSE2) \
+DT_AVX2 static const uint8_t* NAME(const uint8_t* p, const uint8_t* end) noexcept { \
+    while (end - p >= 32) { \
+        uint32_t stops = STOPS(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p))); \
+        if (stops != 0) \
+            return p + __builtin_ctz(stops); \
+        p += 32; \
+    } \
+    return SSE2(p, end); \
+}
+
+AVX2_KERNEL(ScanSpaceAVX2, SpaceStops256, ScanSpaceSSE2)
+AVX2_KERNEL(ScanIdentifierAVX2, IdentifierStops256, ScanIdentifierSSE2)
+AVX2_KERNEL(ScanCommentAVX2, CommentStops256, ScanCommentSSE2)
+AVX2_KERNEL(ScanStringAVX2, StringStops256, ScanStringSSE2)
+#endif
+
+/**
+ * Dispatch
+ */
+typedef const uint8_t* (*ScanFn)(const uint8_t*, const uint8_t*) noexcept;
+
+struct ScanKernels {
+    ScanLevel level;
+    ScanFn space;
+    ScanFn identifier;
+    ScanFn comment;
+    ScanFn string;
+};
+
+static const ScanKernels mScalarKernels = {
+    ScanLevel::kSCALAR, ScanSpaceScalar, ScanIdentifierScalar, ScanCommentScalar, ScanStringScalar
+};
+
+#ifdef DT_HAVE_X86_SIMD
+static const ScanKernels mSSE2Kernels = {
+    ScanLevel::kSSE2, ScanSpaceSSE2, ScanIdentifierSSE2, ScanCommentSSE2, ScanStringSSE2
+};
+
+static const ScanKernels mAVX2Kernels = {
+    ScanLevel::kAVX2, ScanSpaceAVX2, ScanIdentifierAVX2, ScanCommentAVX2, ScanStringAVX2
+};
+#endif
+
+static const ScanKernels* KernelsFor(ScanLevel level) noexcept {
+    switch (level) {
+#ifdef DT_HAVE_X86_SIMD
+        case ScanLevel::kAVX2:
+            return &mAVX2Kernels;
+        case ScanLevel::kSSE2:
+            return &mSSE2Kernels;
+#endif
+        default:
+            return &mScalarKernels;
+    }
+}
+
+ScanLevel SupportedScanLevel() noexcept {
+#ifdef DT_HAVE_X86_SIMD
+    // May run from a static initializer, before the runtime has probed the CPU
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return ScanLevel::kAVX2;
+    return ScanLevel::kSSE2;
+#else
+    return ScanLevel::kSCALAR;
+#endif
+}
+
+// Chosen once at load time, SetScanLevel() is meant for tests and benchmarks
+static const ScanKernels* mKernels = KernelsFor(SupportedScanLevel());
+
+ScanLevel ActiveScanLevel() noexcept {
+    return mKernels->level;
+}
+
+ScanLevel SetScanLevel(ScanLevel level) noexcept {
+    ScanLevel supported = SupportedScanLevel();
+    if (static_cast<uint8_t>(level) > static_cast<uint8_t>(supported))
+        level = supported;
+    mKernels = KernelsFor(level);
+    return level;
+}
+
+/**
+ * Run Scanners
+ */
+const uint8_t* ScanSpace(const uint8_t* begin, const uint8_t* end) noexcept {
+    return mKernels->space(begin, end);
+}
+
+const uint8_t* ScanIdentifierRun(const uint8_t* begin, const uint8_t* end) noexcept {
+    return mKernels->identifier(begin, end);
+}
+
+const uint8_t* ScanCommentBody(const uint8_t* begin, const uint8_t* end) noexcept {
+    return mKernels->comment(begin, end);
+}
+
+const uint8_t* ScanStringBody(const uint8_t* begin, const uint8_t* end) noexcept {
+    return mKernels->string(begin, end);
+}
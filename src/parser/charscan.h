@@ -0,0 +1,63 @@
+#ifndef DT_SRC_PARSER_CHARSCAN_H
+#define DT_SRC_PARSER_CHARSCAN_H
+
+// C++ Includes
+#include <cstdint>
+
+/**
+ * @brief Instruction set used by the run scanning kernels
+ */
+enum class ScanLevel : uint8_t {
+    kSCALAR,
+    kSSE2,
+    kAVX2
+};
+
+/**
+ * Run Scanners
+ * 
+ * Each scanner returns the first byte in [begin, end) that does not belong to the
+ * run, or end when the whole range does. No byte at or past end is ever read.
+ */
+
+/**
+ * @brief Skip whitespace and newlines
+ */
+const uint8_t* ScanSpace(const uint8_t* begin, const uint8_t* end) noexcept;
+
+/**
+ * @brief Skip identifier characters [A-Za-z0-9_]
+ */
+const uint8_t* ScanIdentifierRun(const uint8_t* begin, const uint8_t* end) noexcept;
+
+/**
+ * @brief Skip a line comment body, stops at '\n' or '\0'
+ */
+const uint8_t* ScanCommentBody(const uint8_t* begin, const uint8_t* end) noexcept;
+
+/**
+ * @brief Skip an unescaped string literal body, stops at '"', '\\', '\n' or '\0'
+ */
+const uint8_t* ScanStringBody(const uint8_t* begin, const uint8_t* end) noexcept;
+
+/**
+ * Dispatch
+ */
+
+/**
+ * @brief The widest level the running CPU supports
+ */
+ScanLevel SupportedScanLevel() noexcept;
+
+/**
+ * @brief The level currently used by the scanners, the supported level by default
+ */
+ScanLevel ActiveScanLevel() noexcept;
+
+/**
+ * @brief Select the kernels used by the scanners, clamped to the supported level
+ * @return The level actually selected
+ */
+ScanLevel SetScanLevel(ScanLevel level) noexcept;
+
+#endif
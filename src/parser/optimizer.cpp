@@ -0,0 +1,577 @@
+// C++ Includes
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+// Local Includes
+#include "optimizer.h"
+
+static bool IsComparison(TokenType op) noexcept {
+    switch (op) {
+        case TokenType::kEQUALITY:
+        case TokenType::kDNE:
+        case TokenType::kLT:
+        case TokenType::kLTE:
+        case TokenType::kGT:
+        case TokenType::kGTE:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief The comparison with its operands swapped, 5 < x is x > 5
+ */
+static TokenType MirrorComparison(TokenType op) noexcept {
+    switch (op) {
+        case TokenType::kLT: return TokenType::kGT;
+        case TokenType::kLTE: return TokenType::kGTE;
+        case TokenType::kGT: return TokenType::kLT;
+        case TokenType::kGTE: return TokenType::kLTE;
+        default: return op;
+    }
+}
+
+static bool IsNumber(AstKind kind) noexcept {
+    return kind == AstKind::kINTEGER || kind == AstKind::kREAL;
+}
+
+Optimizer::Optimizer() noexcept
+: arena_(nullptr), folded_(0), normalized_(0), flattened_(0), ranges_(0)
+{}
+
+Optimizer::~Optimizer() noexcept {}
+
+AstNode* Optimizer::Optimize(AstNode* node, Arena& arena) {
+    arena_ = &arena;
+    folded_ = 0;
+    normalized_ = 0;
+    flattened_ = 0;
+    ranges_ = 0;
+    AstNode* result = Simplify(node);
+    arena_ = nullptr;
+    return result;
+}
+
+size_t Optimizer::Folded() const noexcept {
+    return folded_;
+}
+
+size_t Optimizer::Normalized() const noexcept {
+    return normalized_;
+}
+
+size_t Optimizer::Flattened() const noexcept {
+    return flattened_;
+}
+
+size_t Optimizer::Ranges() const noexcept {
+    return ranges_;
+}
+
+/**
+ * Rewrites
+ */
+AstNode* Optimizer::Simplify(AstNode* node) {
+    // Children first, so every operator sees its operands already folded
+    AstNode* prev = nullptr;
+    for (AstNode* child = node->first_child; child != nullptr;) {
+        AstNode* next = child->next_sibling;
+        AstNode* simple = Simplify(child);
+        simple->next_sibling = next;
+        if (prev == nullptr)
+            node->first_child = simple;
+        else
+            prev->next_sibling = simple;
+        prev = simple;
+        child = next;
+    }
+    switch (node->kind) {
+        case AstKind::kUNARY:
+            return SimplifyUnary(node);
+        case AstKind::kBINARY:
+            return SimplifyBinary(node);
+        default:
+            return node;
+    }
+}
+
+AstNode* Optimizer::SimplifyUnary(AstNode* node) {
+    AstNode* operand = node->first_child;
+    // A negative literal is already as simple as it gets
+    if (node->op == TokenType::kMINUS && IsNumber(operand->kind))
+        return node;
+    Constant value;
+    if (!ReadConstant(operand, value))
+        return node;
+    switch (node->op) {
+        case TokenType::kMINUS: {
+            if (value.kind == AstKind::kINTEGER)
+                value.integer = static_cast<int64_t>(0 - static_cast<uint64_t>(value.integer));
+            else if (value.kind == AstKind::kREAL)
+                value.real = -value.real;
+            else
+                return node;
+        } break;
+        case TokenType::kPLUS: {
+            if (!IsNumber(value.kind))
+                return node;
+        } break;
+        default: {
+            if (value.kind != AstKind::kBOOL && value.kind != AstKind::kINTEGER)
+                return node;
+            ++folded_;
+            return NewBool(value.integer == 0, node->line);
+        }
+    }
+    ++folded_;
+    return NewConstant(value, node->line);
+}
+
+AstNode* Optimizer::SimplifyBinary(AstNode* node) {
+    if (node->op == TokenType::kBOOL_AND || node->op == TokenType::kBOOL_OR)
+        return SimplifyLogical(node);
+
+    AstNode* lhs = node->first_child;
+    AstNode* rhs = lhs->next_sibling;
+    Constant lhs_value;
+    Constant rhs_value;
+    if (ReadConstant(lhs, lhs_value) && ReadConstant(rhs, rhs_value)) {
+        AstNode* folded = IsComparison(node->op) ? FoldComparison(node, lhs_value, rhs_value)
+                                                 : FoldArithmetic(node, lhs_value, rhs_value);
+        if (folded != nullptr) {
+            ++folded_;
+            return folded;
+        }
+        return node;
+    }
+    // Constants evaluate without side effects, so swapping the evaluation order is safe
+    if (IsComparison(node->op) && IsConstant(lhs) && !IsConstant(rhs)) {
+        node->first_child = rhs;
+        rhs->next_sibling = lhs;
+        lhs->next_sibling = nullptr;
+        node->op = MirrorComparison(node->op);
+        ++normalized_;
+    }
+    return node;
+}
+
+AstNode* Optimizer::SimplifyLogical(AstNode* node) {
+    // Operands are simplified already, so nested chains are flat and one level of merging is enough
+    std::vector<AstNode*> operands;
+    operands.reserve(node->child_count);
+    for (AstNode* child = node->first_child; child != nullptr; child = child->next_sibling) {
+        if (child->kind == AstKind::kBINARY && child->op == node->op) {
+            for (AstNode* grandchild = child->first_child; grandchild != nullptr; grandchild = grandchild->next_sibling)
+                operands.push_back(grandchild);
+            ++flattened_;
+        } else {
+            operands.push_back(child);
+        }
+    }
+
+    // Ranges only move operands within runs that can be evaluated in any order
+    if (node->op == TokenType::kBOOL_AND) {
+        size_t begin = 0;
+        for (size_t i = 0; i <= operands.size(); ++i) {
+            if (i == operands.size() || !IsPure(operands[i])) {
+                MergeRanges(operands, begin, i);
+                begin = i + 1;
+            }
+        }
+        operands.erase(std::remove(operands.begin(), operands.end(), nullptr), operands.end());
+    }
+
+    // true in && and false in || change nothing, the other value decides the chain
+    bool identity = node->op == TokenType::kBOOL_AND;
+    std::vector<AstNode*> kept;
+    bool pure_prefix = true;
+    for (AstNode* operand : operands) {
+        Constant value;
+        if (ReadConstant(operand, value) && (value.kind == AstKind::kBOOL || value.kind == AstKind::kINTEGER)) {
+            if ((value.integer != 0) == identity) {
+                ++folded_;
+                continue;
+            }
+            // Everything after it is skipped at run time, everything before it only matters for side effects
+            ++folded_;
+            if (pure_prefix)
+                return NewBool(!identity, node->line);
+            kept.push_back(operand);
+            break;
+        }
+        pure_prefix = pure_prefix && IsPure(operand);
+        kept.push_back(operand);
+    }
+    if (kept.empty())
+        return NewBool(identity, node->line);
+    // A lone integer keeps its chain, which still turns it into a bool
+    if (kept.size() == 1 && IsBoolean(kept[0]))
+        return kept[0];
+    SetChildren(node, kept);
+    return node;
+}
+
+AstNode* Optimizer::FoldArithmetic(AstNode* node, const Constant& lhs, const Constant& rhs) {
+    if (lhs.kind == AstKind::kSTRING && rhs.kind == AstKind::kSTRING) {
+        if (node->op != TokenType::kPLUS)
+            return nullptr;
+        std::string joined(lhs.string);
+        joined += rhs.string;
+        AstNode* result = NewNode(AstKind::kSTRING, node->line);
+        result->text = arena_->CopyString(joined);
+        return result;
+    }
+    if (!IsNumber(lhs.kind) || !IsNumber(rhs.kind))
+        return nullptr;
+
+    Constant result = {AstKind::kINTEGER, 0, 0.0, std::string_view()};
+    if (lhs.kind == AstKind::kINTEGER && rhs.kind == AstKind::kINTEGER) {
+        // Wrap around like the VM, and leave what fails at run time to fail there
+        uint64_t a = static_cast<uint64_t>(lhs.integer);
+        uint64_t b = static_cast<uint64_t>(rhs.integer);
+        switch (node->op) {
+            case TokenType::kPLUS: result.integer = static_cast<int64_t>(a + b); break;
+            case TokenType::kMINUS: result.integer = static_cast<int64_t>(a - b); break;
+            case TokenType::kASTERISK: result.integer = static_cast<int64_t>(a * b); break;
+            case TokenType::kDIVIDE: {
+                if (rhs.integer == 0)
+                    return nullptr;
+                result.integer = (rhs.integer == -1) ? static_cast<int64_t>(0 - a) : lhs.integer / rhs.integer;
+            } break;
+            case TokenType::kMODULO: {
+                if (rhs.integer == 0)
+                    return nullptr;
+                result.integer = (rhs.integer == -1) ? 0 : lhs.integer % rhs.integer;
+            } break;
+            default:
+                return nullptr;
+        }
+        return NewConstant(result, node->line);
+    }
+
+    double a = (lhs.kind == AstKind::kREAL) ? lhs.real : static_cast<double>(lhs.integer);
+    double b = (rhs.kind == AstKind::kREAL) ? rhs.real : static_cast<double>(rhs.integer);
+    result.kind = AstKind::kREAL;
+    switch (node->op) {
+        case TokenType::kPLUS: result.real = a + b; break;
+        case TokenType::kMINUS: result.real = a - b; break;
+        case TokenType::kASTERISK: result.real = a * b; break;
+        case TokenType::kDIVIDE: result.real = a / b; break;
+        default:
+            return nullptr;
+    }
+    // Infinities and NaN have no literal
+    if (!std::isfinite(result.real))
+        return nullptr;
+    return NewConstant(result, node->line);
+}
+
+AstNode* Optimizer::FoldComparison(AstNode* node, const Constant& lhs, const Constant& rhs) {
+    int32_t order;
+    if (lhs.kind == AstKind::kBOOL && rhs.kind == AstKind::kBOOL &&
+        (node->op == TokenType::kEQUALITY || node->op == TokenType::kDNE))
+        order = (lhs.integer == rhs.integer) ? 0 : 1;
+    else if (!Compare(lhs, rhs, order))
+        return nullptr;
+    bool result;
+    switch (node->op) {
+        case TokenType::kEQUALITY: result = order == 0; break;
+        case TokenType::kDNE: result = order != 0; break;
+        case TokenType::kLT: result = order < 0; break;
+        case TokenType::kLTE: result = order <= 0; break;
+        case TokenType::kGT: result = order > 0; break;
+        default: result = order >= 0; break;
+    }
+    return NewBool(result, node->line);
+}
+
+void Optimizer::MergeRanges(std::vector<AstNode*>& operands, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+        AstNode* first = operands[i];
+        AstNode* target;
+        Bound lower;
+        Bound upper;
+        if (first == nullptr || !ReadBounds(first, target, lower, upper))
+            continue;
+
+        // Fold in every later operand on the same target whose bounds order against these
+        bool merged = first->kind == AstKind::kRANGE;
+        for (size_t j = i + 1; j < end; ++j) {
+            AstNode* other_target;
+            Bound other_lower;
+            Bound other_upper;
+            if (operands[j] == nullptr || !ReadBounds(operands[j], other_target, other_lower, other_upper) ||
+                !SameTarget(target, other_target))
+                continue;
+            Bound new_lower = lower;
+            Bound new_upper = upper;
+            if (other_lower.value != nullptr) {
+                if (new_lower.value == nullptr)
+                    new_lower = other_lower;
+                else if (!Tighter(new_lower, other_lower, true))
+                    continue;
+            }
+            if (other_upper.value != nullptr) {
+                if (new_upper.value == nullptr)
+                    new_upper = other_upper;
+                else if (!Tighter(new_upper, other_upper, false))
+                    continue;
+            }
+            lower = new_lower;
+            upper = new_upper;
+            operands[j] = nullptr;
+            merged = true;
+        }
+        if (!merged)
+            continue;
+
+        if (lower.value != nullptr && upper.value != nullptr && IsEmptyRange(lower, upper)) {
+            ++folded_;
+            operands[i] = NewBool(false, first->line);
+            continue;
+        }
+        AstNode* range = NewNode(AstKind::kRANGE, first->line);
+        AstNode* low = (lower.value != nullptr) ? lower.value : NewNode(AstKind::kEMPTY, first->line);
+        AstNode* high = (upper.value != nullptr) ? upper.value : NewNode(AstKind::kEMPTY, first->line);
+        SetChildren(range, {target, low, high});
+        range->flags = static_cast<uint16_t>((lower.inclusive ? kAST_LOWER_INCLUSIVE : 0) |
+                                             (upper.inclusive ? kAST_UPPER_INCLUSIVE : 0));
+        ++ranges_;
+        operands[i] = range;
+    }
+}
+
+bool Optimizer::ReadBounds(AstNode* node, AstNode*& target, Bound& lower, Bound& upper) {
+    lower = {nullptr, false};
+    upper = {nullptr, false};
+    if (node->kind == AstKind::kRANGE) {
+        target = node->first_child;
+        AstNode* low = target->next_sibling;
+        AstNode* high = low->next_sibling;
+        if (low->kind != AstKind::kEMPTY)
+            lower = {low, (node->flags & kAST_LOWER_INCLUSIVE) != 0};
+        if (high->kind != AstKind::kEMPTY)
+            upper = {high, (node->flags & kAST_UPPER_INCLUSIVE) != 0};
+        return true;
+    }
+    if (node->kind != AstKind::kBINARY || !IsComparison(node->op) || node->op == TokenType::kDNE ||
+        !IsTarget(node->first_child) || !IsConstant(node->first_child->next_sibling))
+        return false;
+    target = node->first_child;
+    AstNode* value = target->next_sibling;
+    switch (node->op) {
+        case TokenType::kGT: lower = {value, false}; break;
+        case TokenType::kGTE: lower = {value, true}; break;
+        case TokenType::kLT: upper = {value, false}; break;
+        case TokenType::kLTE: upper = {value, true}; break;
+        default: {
+            // x == c is the range [c, c], the copy keeps every node in one place in the tree
+            AstNode* copy = NewNode(value->kind, value->line);
+            *copy = *value;
+            copy->next_sibling = nullptr;
+            if (value->first_child != nullptr) {
+                copy->first_child = NewNode(value->first_child->kind, value->line);
+                *copy->first_child = *value->first_child;
+            }
+            lower = {value, true};
+            upper = {copy, true};
+        }
+    }
+    return true;
+}
+
+bool Optimizer::Tighter(Bound& kept, const Bound& other, bool lower) noexcept {
+    Constant a;
+    Constant b;
+    int32_t order;
+    if (!ReadConstant(kept.value, a) || !ReadConstant(other.value, b) || !Compare(a, b, order))
+        return false;
+    // A lower bound tightens upwards and an upper one downwards, at a tie exclusive is tighter
+    if ((lower && order < 0) || (!lower && order > 0) || (order == 0 && !other.inclusive))
+        kept = other;
+    return true;
+}
+
+bool Optimizer::IsEmptyRange(const Bound& lower, const Bound& upper) noexcept {
+    Constant a;
+    Constant b;
+    int32_t order;
+    if (!ReadConstant(lower.value, a) || !ReadConstant(upper.value, b) || !Compare(a, b, order))
+        return false;
+    // Equal bounds hold exactly one value when both include it
+    return order > 0 || (order == 0 && !(lower.inclusive && upper.inclusive));
+}
+
+bool Optimizer::Compare(const Constant& lhs, const Constant& rhs, int32_t& order) noexcept {
+    if (lhs.kind == AstKind::kINTEGER && rhs.kind == AstKind::kINTEGER) {
+        order = (lhs.integer < rhs.integer) ? -1 : (lhs.integer > rhs.integer) ? 1 : 0;
+    } else if (IsNumber(lhs.kind) && IsNumber(rhs.kind)) {
+        // Mixed operands compare as reals, like the VM
+        double a = (lhs.kind == AstKind::kREAL) ? lhs.real : static_cast<double>(lhs.integer);
+        double b = (rhs.kind == AstKind::kREAL) ? rhs.real : static_cast<double>(rhs.integer);
+        order = (a < b) ? -1 : (a > b) ? 1 : 0;
+    } else if (lhs.kind == AstKind::kSTRING && rhs.kind == AstKind::kSTRING) {
+        int32_t compared = lhs.string.compare(rhs.string);
+        order = (compared < 0) ? -1 : (compared > 0) ? 1 : 0;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Node Helpers
+ */
+bool Optimizer::ReadConstant(const AstNode* node, Constant& value) {
+    value = {node->kind, 0, 0.0, std::string_view()};
+    bool negate = false;
+    if (node->kind == AstKind::kUNARY && node->op == TokenType::kMINUS && IsNumber(node->first_child->kind)) {
+        negate = true;
+        node = node->first_child;
+        value.kind = node->kind;
+    }
+    switch (node->kind) {
+        case AstKind::kINTEGER: {
+            std::string digits(node->text);
+            errno = 0;
+            unsigned long long magnitude = strtoull(digits.c_str(), nullptr, 10);
+            if (errno == ERANGE || magnitude > static_cast<unsigned long long>(INT64_MAX) + (negate ? 1 : 0))
+                return false;
+            value.integer = static_cast<int64_t>(negate ? 0 - magnitude : magnitude);
+            return true;
+        }
+        case AstKind::kREAL: {
+            std::string digits(node->text);
+            value.real = strtod(digits.c_str(), nullptr);
+            value.real = negate ? -value.real : value.real;
+            return std::isfinite(value.real);
+        }
+        case AstKind::kBOOL: {
+            value.integer = (node->op == TokenType::kTRUE) ? 1 : 0;
+            return true;
+        }
+        case AstKind::kSTRING: {
+            value.string = node->text;
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+bool Optimizer::IsConstant(const AstNode* node) noexcept {
+    Constant value;
+    return node->kind == AstKind::kPARAMETER || ReadConstant(node, value);
+}
+
+bool Optimizer::IsBoolean(const AstNode* node) noexcept {
+    switch (node->kind) {
+        case AstKind::kBOOL:
+        case AstKind::kRANGE:
+            return true;
+        case AstKind::kUNARY:
+            return node->op == TokenType::kNOT;
+        case AstKind::kBINARY:
+            return IsComparison(node->op) || node->op == TokenType::kBOOL_AND || node->op == TokenType::kBOOL_OR;
+        default:
+            return false;
+    }
+}
+
+bool Optimizer::IsPure(const AstNode* node) noexcept {
+    // No side effects and no run time errors, so it may be skipped or reordered. A member read
+    // fails in the VM when the field is null, and which fields are nullable is not known yet
+    switch (node->kind) {
+        case AstKind::kIDENTIFIER:
+        case AstKind::kINTEGER:
+        case AstKind::kREAL:
+        case AstKind::kSTRING:
+        case AstKind::kBOOL:
+        case AstKind::kPARAMETER:
+        case AstKind::kEMPTY:
+        case AstKind::kUNARY:
+        case AstKind::kRANGE:
+            break;
+        case AstKind::kBINARY: {
+            if (node->op == TokenType::kDIVIDE || node->op == TokenType::kMODULO)
+                return false;
+        } break;
+        default:
+            return false;
+    }
+    for (const AstNode* child = node->first_child; child != nullptr; child = child->next_sibling) {
+        if (!IsPure(child))
+            return false;
+    }
+    return true;
+}
+
+bool Optimizer::IsTarget(const AstNode* node) noexcept {
+    while (node->kind == AstKind::kMEMBER)
+        node = node->first_child;
+    return node->kind == AstKind::kIDENTIFIER;
+}
+
+bool Optimizer::SameTarget(const AstNode* lhs, const AstNode* rhs) noexcept {
+    while (lhs->kind == AstKind::kMEMBER && rhs->kind == AstKind::kMEMBER) {
+        if (lhs->text != rhs->text)
+            return false;
+        lhs = lhs->first_child;
+        rhs = rhs->first_child;
+    }
+    return lhs->kind == AstKind::kIDENTIFIER && rhs->kind == AstKind::kIDENTIFIER && lhs->text == rhs->text;
+}
+
+AstNode* Optimizer::NewNode(AstKind kind, uint32_t line) {
+    AstNode* node = arena_->New<AstNode>();
+    node->kind = kind;
+    node->op = TokenType::kEOF;
+    node->line = line;
+    return node;
+}
+
+AstNode* Optimizer::NewConstant(const Constant& value, uint32_t line) {
+    char text[32];
+    AstNode* literal;
+    bool negative;
+    if (value.kind == AstKind::kINTEGER) {
+        negative = value.integer < 0;
+        uint64_t magnitude = negative ? 0 - static_cast<uint64_t>(value.integer) : static_cast<uint64_t>(value.integer);
+        snprintf(text, sizeof(text), "%llu", static_cast<unsigned long long>(magnitude));
+        literal = NewNode(AstKind::kINTEGER, line);
+    } else {
+        negative = std::signbit(value.real);
+        double magnitude = std::fabs(value.real);
+        // The shortest text that reads back as the same double
+        snprintf(text, sizeof(text), "%.15g", magnitude);
+        if (strtod(text, nullptr) != magnitude)
+            snprintf(text, sizeof(text), "%.17g", magnitude);
+        literal = NewNode(AstKind::kREAL, line);
+    }
+    literal->text = arena_->CopyString(text);
+    if (!negative)
+        return literal;
+    AstNode* minus = NewNode(AstKind::kUNARY, line);
+    minus->op = TokenType::kMINUS;
+    SetChildren(minus, {literal});
+    return minus;
+}
+
+AstNode* Optimizer::NewBool(bool value, uint32_t line) {
+    AstNode* node = NewNode(AstKind::kBOOL, line);
+    node->op = value ? TokenType::kTRUE : TokenType::kFALSE;
+    return node;
+}
+
+void Optimizer::SetChildren(AstNode* parent, const std::vector<AstNode*>& children) noexcept {
+    parent->first_child = children.empty() ? nullptr : children[0];
+    for (size_t i = 0; i < children.size(); ++i)
+        children[i]->next_sibling = (i + 1 < children.size()) ? children[i + 1] : nullptr;
+    parent->child_count = static_cast<uint32_t>(children.size());
+}
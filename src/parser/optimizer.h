@@ -0,0 +1,148 @@
+#ifndef DT_SRC_PARSER_OPTIMIZER_H
+#define DT_SRC_PARSER_OPTIMIZER_H
+
+// C++ Includes
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// Local Includes
+#include "parser/arena.h"
+#include "parser/ast.h"
+
+/**
+ * @brief Rewrites the expressions of a parsed tree into simpler equivalent ones
+ *
+ * Runs between the parser and the compiler, in place on the arena tree:
+ *  - constant sub-expressions are folded with the VM's semantics, anything
+ *    that would fail at run time (division by zero, % on reals) is left alone
+ *  - comparisons get their constant on the right, "5 < x" becomes "x > 5"
+ *  - && and || chains become one n-ary node, constant operands are dropped
+ *    or decide the whole chain
+ *  - comparisons of one variable against constants in an && chain merge
+ *    into a kRANGE, "x >= 5 && x < 10" is x in [5, 10)
+ * Statement parameters count as constants for the last two, they are fixed
+ * for a whole execution. Operands with side effects or that may fail at run
+ * time, such as a member read of a null field, are never dropped or moved
+ * past each other.
+ */
+class Optimizer {
+public:
+    /**
+     * Tors
+     */
+    Optimizer() noexcept;
+    ~Optimizer() noexcept;
+
+    /**
+     * NON-COPYABLE
+     */
+    Optimizer(const Optimizer&) = delete;
+    Optimizer(Optimizer&&) = delete;
+    Optimizer& operator=(const Optimizer&) = delete;
+
+    /**
+     * @brief Optimize node and everything below it
+     * @param arena The arena of the tree, new nodes and folded strings go there
+     * @return node or the node replacing it
+     */
+    AstNode* Optimize(AstNode* node, Arena& arena);
+
+    /**
+     * Stats
+     */
+
+    /**
+     * @brief Operators replaced by their constant value by the last call to Optimize()
+     */
+    size_t Folded() const noexcept;
+
+    /**
+     * @brief Comparisons turned around to put their constant on the right
+     */
+    size_t Normalized() const noexcept;
+
+    /**
+     * @brief Nested && and || nodes merged into their parent
+     */
+    size_t Flattened() const noexcept;
+
+    /**
+     * @brief kRANGE nodes built, merging into an existing range builds a new one
+     */
+    size_t Ranges() const noexcept;
+
+private:
+    /**
+     * @brief The value of a literal, a negative number is a unary minus over its magnitude
+     */
+    struct Constant {
+        AstKind kind;       // kINTEGER, kREAL, kBOOL or kSTRING
+        int64_t integer;    // Also 0 or 1 for a kBOOL
+        double real;
+        std::string_view string;
+    };
+
+    /**
+     * @brief A bound of a range, value is a literal or a parameter
+     */
+    struct Bound {
+        AstNode* value;
+        bool inclusive;
+    };
+
+    /**
+     * Rewrites
+     */
+    AstNode* Simplify(AstNode* node);
+    AstNode* SimplifyUnary(AstNode* node);
+    AstNode* SimplifyBinary(AstNode* node);
+    AstNode* SimplifyLogical(AstNode* node);
+    AstNode* FoldArithmetic(AstNode* node, const Constant& lhs, const Constant& rhs);
+    AstNode* FoldComparison(AstNode* node, const Constant& lhs, const Constant& rhs);
+
+    /**
+     * @brief Merge the comparisons of each target in a run of side effect free && operands
+     *
+     * Merged operands are set to null for the caller to remove.
+     */
+    void MergeRanges(std::vector<AstNode*>& operands, size_t begin, size_t end);
+
+    /**
+     * @brief The target and bounds of a kRANGE or of a comparison against a constant
+     */
+    bool ReadBounds(AstNode* node, AstNode*& target, Bound& lower, Bound& upper);
+
+    /**
+     * @brief Keep the tighter of two bounds in kept, false when they cannot be ordered
+     */
+    static bool Tighter(Bound& kept, const Bound& other, bool lower) noexcept;
+    static bool IsEmptyRange(const Bound& lower, const Bound& upper) noexcept;
+
+    /**
+     * @brief Order two numbers or two strings, false for anything else
+     */
+    static bool Compare(const Constant& lhs, const Constant& rhs, int32_t& order) noexcept;
+
+    /**
+     * Node Helpers
+     */
+    static bool ReadConstant(const AstNode* node, Constant& value);
+    static bool IsConstant(const AstNode* node) noexcept;
+    static bool IsBoolean(const AstNode* node) noexcept;
+    static bool IsPure(const AstNode* node) noexcept;
+    static bool IsTarget(const AstNode* node) noexcept;
+    static bool SameTarget(const AstNode* lhs, const AstNode* rhs) noexcept;
+    AstNode* NewNode(AstKind kind, uint32_t line);
+    AstNode* NewConstant(const Constant& value, uint32_t line);
+    AstNode* NewBool(bool value, uint32_t line);
+    static void SetChildren(AstNode* parent, const std::vector<AstNode*>& children) noexcept;
+
+    Arena* arena_;
+    size_t folded_;
+    size_t normalized_;
+    size_t flattened_;
+    size_t ranges_;
+};
+
+#endif
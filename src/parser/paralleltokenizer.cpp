@@ -0,0 +1,126 @@
+// C++ Includes
+#include <cstdint>
+#include <exception>
+#include <thread>
+#include <vector>
+
+// C Includes
+#include <string.h>
+
+// Local Includes
+#include "exception/token_exception.h"
+#include "file/filereader.h"
+#include "file/parallel.h"
+#include "paralleltokenizer.h"
+#include "tokenizer.h"
+
+ParallelTokenizer::ParallelTokenizer(uint32_t threads, size_t chunk_size) noexcept
+: threads_((threads != 0) ? threads : ((std::thread::hardware_concurrency() != 0) ? std::thread::hardware_concurrency() : 1)),
+  chunk_size_((chunk_size != 0) ? chunk_size : 1)
+{}
+
+ParallelTokenizer::~ParallelTokenizer() noexcept {}
+
+uint32_t ParallelTokenizer::Threads() const noexcept {
+    return threads_;
+}
+
+size_t ParallelTokenizer::ChunkSize() const noexcept {
+    return chunk_size_;
+}
+
+void ParallelTokenizer::TokenizeFile(const std::string& file_name, TokenBuffer& buffer) {
+    TokenizeFile(file_name.c_str(), buffer);
+}
+
+void ParallelTokenizer::TokenizeFile(const char* file_name, TokenBuffer& buffer) {
+    FileReader reader(file_name, ReadMode::kMMAP);
+    if (!reader.Mapped()) {
+        reader.Close();
+        Tokenizer tokenizer(ReadMode::kBUFFERED);
+        tokenizer.OpenFile(file_name);
+        tokenizer.Tokenize(buffer);
+        return;
+    }
+    TokenizeString(std::string_view(reinterpret_cast<const char*>(reader.MappedData()), reader.MappedSize()), buffer);
+}
+
+std::vector<size_t> ParallelTokenizer::SplitChunks(std::string_view text) const noexcept {
+    std::vector<size_t> bounds(1, 0);
+    size_t pos = 0;
+    while (text.size() - pos > chunk_size_) {
+        const void* newline = memchr(text.data() + pos + chunk_size_, '\n', text.size() - pos - chunk_size_);
+        if (newline == nullptr)
+            break;
+        pos = static_cast<size_t>(static_cast<const char*>(newline) - text.data()) + 1;
+        bounds.push_back(pos);
+    }
+    bounds.push_back(text.size());
+    return bounds;
+}
+
+void ParallelTokenizer::TokenizeString(std::string_view text, TokenBuffer& buffer) {
+    std::vector<size_t> bounds = SplitChunks(text);
+    size_t chunks = bounds.size() - 1;
+    if (chunks == 1 || threads_ == 1) {
+        Tokenizer tokenizer;
+        tokenizer.OpenView(text);
+        tokenizer.Tokenize(buffer);
+        return;
+    }
+
+    // Pass one lexes every chunk on its own, lines counted from 1
+    std::vector<TokenBuffer> parts(chunks);
+    std::vector<std::exception_ptr> errors(chunks);
+    RunParallel(threads_, chunks, [&](size_t chunk) {
+        try {
+            Tokenizer tokenizer;
+            tokenizer.OpenView(text.substr(bounds[chunk], bounds[chunk + 1] - bounds[chunk]));
+            tokenizer.Tokenize(parts[chunk]);
+        } catch (...) {
+            errors[chunk] = std::current_exception();
+        }
+    });
+    // The earliest chunk's error is the one a sequential pass would have hit first
+    for (std::exception_ptr& error : errors) {
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    // Every part ends in kEOF, which sits on its last line, so it also counts the chunk's newlines
+    std::vector<size_t> token_base(chunks + 1, 0);
+    std::vector<uint64_t> text_base(chunks + 1, 0);
+    std::vector<uint32_t> line_base(chunks + 1, 0);
+    for (size_t chunk = 0; chunk < chunks; ++chunk) {
+        const TokenBuffer& part = parts[chunk];
+        token_base[chunk + 1] = token_base[chunk] + part.Size() - 1;
+        text_base[chunk + 1] = text_base[chunk] + part.text_.size();
+        line_base[chunk + 1] = line_base[chunk] + part.Line(part.Size() - 1) - 1;
+    }
+    if (text_base[chunks] > UINT32_MAX)
+        TokenBuffer::TextLimitExceeded();
+
+    // Pass two copies the parts into place with their offsets and lines rebased
+    size_t tokens = token_base[chunks];
+    buffer.Clear();
+    buffer.types_.resize(tokens);
+    buffer.offsets_.resize(tokens);
+    buffer.lengths_.resize(tokens);
+    buffer.lines_.resize(tokens);
+    buffer.text_.resize(text_base[chunks]);
+    RunParallel(threads_, chunks, [&](size_t chunk) {
+        const TokenBuffer& part = parts[chunk];
+        size_t count = part.Size() - 1;
+        size_t base = token_base[chunk];
+        uint32_t text_offset = static_cast<uint32_t>(text_base[chunk]);
+        uint32_t line_offset = line_base[chunk];
+        memcpy(buffer.types_.data() + base, part.types_.data(), count * sizeof(TokenType));
+        memcpy(buffer.lengths_.data() + base, part.lengths_.data(), count * sizeof(uint32_t));
+        for (size_t i = 0; i < count; ++i) {
+            buffer.offsets_[base + i] = part.offsets_[i] + text_offset;
+            buffer.lines_[base + i] = part.lines_[i] + line_offset;
+        }
+        memcpy(&buffer.text_[text_offset], part.text_.data(), part.text_.size());
+    });
+    buffer.Append(TokenType::kEOF, std::string_view(), line_base[chunks] + 1);
+}
@@ -0,0 +1,76 @@
+#ifndef DT_SRC_PARSER_PARALLELTOKENIZER_H
+#define DT_SRC_PARSER_PARALLELTOKENIZER_H
+
+// C++ Includes
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Local Includes
+#include "parser/tokenbuffer.h"
+
+/**
+ * @brief Tokenizes large inputs by lexing newline-aligned chunks on several threads
+ * 
+ * Neither string literals nor comments can span a newline, so the byte after any
+ * newline always starts a fresh token. Chunks therefore end on a newline and are
+ * lexed independently, then stitched into one TokenBuffer with line numbers and
+ * text offsets rebased. The result matches a single Tokenizer::Tokenize() over the
+ * same input, including which error is thrown first.
+ */
+class ParallelTokenizer {
+public:
+    /**
+     * Tors
+     */
+
+    /**
+     * @brief Construct a parallel tokenizer
+     * @param threads The number of worker threads, 0 uses every hardware thread
+     * @param chunk_size The target number of input bytes per chunk
+     */
+    explicit ParallelTokenizer(uint32_t threads = 0, size_t chunk_size = 4 * 1024 * 1024) noexcept;
+    ~ParallelTokenizer() noexcept;
+
+    /**
+     * NON-COPYABLE
+     */
+    ParallelTokenizer(const ParallelTokenizer&) = delete;
+    ParallelTokenizer(ParallelTokenizer&&) = delete;
+    ParallelTokenizer& operator=(const ParallelTokenizer&) = delete;
+
+    /**
+     * Tokenization
+     */
+
+    /**
+     * @brief Tokenize a file into buffer, mapping it when possible
+     * 
+     * Files that cannot be mapped, such as pipes, are tokenized by a single streaming Tokenizer.
+     */
+    void TokenizeFile(const std::string& file_name, TokenBuffer& buffer);
+    void TokenizeFile(const char* file_name, TokenBuffer& buffer);
+
+    /**
+     * @brief Tokenize text in place into buffer, text only has to outlive the call
+     */
+    void TokenizeString(std::string_view text, TokenBuffer& buffer);
+
+    /**
+     * Settings
+     */
+    uint32_t Threads() const noexcept;
+    size_t ChunkSize() const noexcept;
+
+private:
+    /**
+     * @brief The chunk boundaries of text, each chunk but the last ends just past a newline
+     */
+    std::vector<size_t> SplitChunks(std::string_view text) const noexcept;
+
+    const uint32_t threads_;
+    const size_t chunk_size_;
+};
+
+#endif
@@ -0,0 +1,662 @@
+// C++ Includes
+#include <cstdint>
+#include <string>
+
+// Local Includes
+#include "exception/parse_exception.h"
+#include "parser.h"
+
+// Deepest nesting of statements or expressions before the parser gives up instead of overflowing the stack
+#define MAX_NESTING 256
+
+Parser::Parser() noexcept
+: tokens_(nullptr), arena_(nullptr), pos_(0), depth_(0), statements_(0), nodes_(0)
+{}
+
+Parser::~Parser() noexcept {}
+
+AstNode* Parser::Parse(const TokenBuffer& tokens, Arena& arena) {
+    tokens_ = &tokens;
+    arena_ = &arena;
+    pos_ = 0;
+    depth_ = 0;
+    statements_ = 0;
+    nodes_ = 0;
+    parameters_.clear();
+
+    AstNode* program = NewNode(AstKind::kPROGRAM, Line());
+    AstNode* tail = nullptr;
+    while (Peek() != TokenType::kEOF) {
+        if (Peek() == TokenType::kSTRUCT)
+            AddChild(program, tail, ParseStructDecl());
+        else if (AtFunction())
+            AddChild(program, tail, ParseFunction());
+        else
+            AddChild(program, tail, ParseStatement());
+    }
+    return program;
+}
+
+size_t Parser::Statements() const noexcept {
+    return statements_;
+}
+
+size_t Parser::Nodes() const noexcept {
+    return nodes_;
+}
+
+const std::vector<std::string_view>& Parser::Parameters() const noexcept {
+    return parameters_;
+}
+
+/**
+ * Token Helpers
+ */
+TokenType Parser::Peek(size_t ahead) const noexcept {
+    size_t index = pos_ + ahead;
+    return (index < tokens_->Size()) ? tokens_->Type(index) : TokenType::kEOF;
+}
+
+uint32_t Parser::Line() const noexcept {
+    if (pos_ < tokens_->Size())
+        return tokens_->Line(pos_);
+    return tokens_->Empty() ? 1 : tokens_->Line(tokens_->Size() - 1);
+}
+
+bool Parser::Accept(TokenType type) noexcept {
+    if (Peek() != type)
+        return false;
+    ++pos_;
+    return true;
+}
+
+void Parser::Expect(TokenType type, const char* what) {
+    if (!Accept(type))
+        Error(std::string("Expected ") + what);
+}
+
+std::string_view Parser::ExpectIdentifier(const char* what) {
+    if (Peek() != TokenType::kIDENTIFIER)
+        Error(std::string("Expected ") + what);
+    return arena_->CopyString(tokens_->Value(pos_++));
+}
+
+void Parser::Error(const std::string& msg) const {
+    std::string found;
+    if (Peek() == TokenType::kEOF)
+        found = "end of input";
+    else if (tokens_->Value(pos_).empty())
+        found = TokenTypeName(Peek());
+    else
+        found = "'" + std::string(tokens_->Value(pos_)) + "'";
+    throw ParseException("Line " + std::to_string(Line()) + ": " + msg + ", found " + found);
+}
+
+/**
+ * Node Helpers
+ */
+AstNode* Parser::NewNode(AstKind kind, uint32_t line) {
+    AstNode* node = arena_->New<AstNode>();
+    node->kind = kind;
+    node->op = TokenType::kEOF;
+    node->line = line;
+    ++nodes_;
+    return node;
+}
+
+AstNode* Parser::NewBinary(TokenType op, AstNode* lhs, AstNode* rhs, uint32_t line) {
+    AstNode* node = NewNode(AstKind::kBINARY, line);
+    node->op = op;
+    node->first_child = lhs;
+    lhs->next_sibling = rhs;
+    node->child_count = 2;
+    return node;
+}
+
+void Parser::AddChild(AstNode* parent, AstNode*& tail, AstNode* child) noexcept {
+    if (tail == nullptr)
+        parent->first_child = child;
+    else
+        tail->next_sibling = child;
+    tail = child;
+    ++parent->child_count;
+}
+
+/**
+ * Statements
+ */
+AstNode* Parser::ParseStructDecl() {
+    uint32_t line = Line();
+    Expect(TokenType::kSTRUCT, "struct");
+    ++statements_;
+    AstNode* node = NewNode(AstKind::kSTRUCT_DECL, line);
+    AstNode* tail = nullptr;
+    node->text = ExpectIdentifier("a struct name");
+    if (Accept(TokenType::kCOLON)) {
+        AstNode* base = NewNode(AstKind::kBASE, Line());
+        base->text = ExpectIdentifier("a base struct name");
+        AddChild(node, tail, base);
+    }
+    if (Accept(TokenType::kLBRACE)) {
+        node->flags |= kAST_HAS_BODY;
+        while (!Accept(TokenType::kRBRACE)) {
+            if (Peek() == TokenType::kEOF)
+                Error("Expected }");
+            AddChild(node, tail, ParseVarDecl(kMOD_CONST | kMOD_SIGNED | kMOD_UNSIGNED | kMOD_NOTNULL | kMOD_PRIMARY | kMOD_SECONDARY));
+            Expect(TokenType::kSCOLON, ";");
+        }
+    }
+    Expect(TokenType::kSCOLON, ";");
+    return node;
+}
+
+bool Parser::AtFunction() const noexcept {
+    // "[Type] name(...) {", the return type is left out for main()
+    size_t ahead = 0;
+    while (true) {
+        TokenType type = Peek(ahead);
+        if (type == TokenType::kLPAREN)
+            break;
+        if (type == TokenType::kEOF || type == TokenType::kSCOLON || type == TokenType::kASSIGN ||
+            type == TokenType::kDOT || type == TokenType::kLBRACE)
+            return false;
+        ++ahead;
+    }
+    if (ahead == 0 || Peek(ahead - 1) != TokenType::kIDENTIFIER)
+        return false;
+    size_t depth = 0;
+    do {
+        TokenType type = Peek(ahead++);
+        if (type == TokenType::kLPAREN)
+            ++depth;
+        else if (type == TokenType::kRPAREN)
+            --depth;
+        else if (type == TokenType::kEOF)
+            return false;
+    } while (depth != 0);
+    return Peek(ahead) == TokenType::kLBRACE;
+}
+
+AstNode* Parser::ParseFunction() {
+    uint32_t line = Line();
+    ++statements_;
+    AstNode* node = NewNode(AstKind::kFUNCTION, line);
+    AstNode* tail = nullptr;
+    if (Peek() == TokenType::kIDENTIFIER && Peek(1) == TokenType::kLPAREN)
+        AddChild(node, tail, NewNode(AstKind::kEMPTY, line));
+    else
+        AddChild(node, tail, ParseType());
+    node->text = ExpectIdentifier("a function name");
+    Expect(TokenType::kLPAREN, "(");
+    if (!Accept(TokenType::kRPAREN)) {
+        do {
+            AddChild(node, tail, ParseVarDecl(kMOD_CONST | kMOD_SIGNED | kMOD_UNSIGNED));
+        } while (Accept(TokenType::kCOMMA));
+        Expect(TokenType::kRPAREN, ")");
+    }
+    AddChild(node, tail, ParseBlock());
+    return node;
+}
+
+AstNode* Parser::ParseStatement() {
+    if (++depth_ > MAX_NESTING)
+        Error("Statements nested too deeply");
+    ++statements_;
+    uint32_t line = Line();
+    AstNode* node = nullptr;
+    switch (Peek()) {
+        case TokenType::kLBRACE: {
+            node = ParseBlock();
+        } break;
+        case TokenType::kIF: {
+            node = ParseIf();
+        } break;
+        case TokenType::kWHILE: {
+            node = ParseWhile();
+        } break;
+        case TokenType::kFOR: {
+            node = ParseFor();
+        } break;
+        case TokenType::kRETURN: {
+            ++pos_;
+            node = NewNode(AstKind::kRETURN, line);
+            AstNode* tail = nullptr;
+            if (Peek() != TokenType::kSCOLON)
+                AddChild(node, tail, ParseExpression());
+            Expect(TokenType::kSCOLON, ";");
+        } break;
+        case TokenType::kDELETE: {
+            ++pos_;
+            node = NewNode(AstKind::kDELETE, line);
+            AstNode* tail = nullptr;
+            AddChild(node, tail, ParseExpression());
+            Expect(TokenType::kSCOLON, ";");
+        } break;
+        case TokenType::kSTRUCT: {
+            Error("Structs can only be declared at the top level");
+        } break;
+        default: {
+            node = ParseSimpleStatement();
+            Expect(TokenType::kSCOLON, ";");
+        }
+    }
+    --depth_;
+    return node;
+}
+
+AstNode* Parser::ParseBlock() {
+    AstNode* node = NewNode(AstKind::kBLOCK, Line());
+    AstNode* tail = nullptr;
+    Expect(TokenType::kLBRACE, "{");
+    while (!Accept(TokenType::kRBRACE)) {
+        if (Peek() == TokenType::kEOF)
+            Error("Expected }");
+        AddChild(node, tail, ParseStatement());
+    }
+    return node;
+}
+
+AstNode* Parser::ParseIf() {
+    AstNode* node = NewNode(AstKind::kIF, Line());
+    AstNode* tail = nullptr;
+    Expect(TokenType::kIF, "if");
+    Expect(TokenType::kLPAREN, "(");
+    AddChild(node, tail, ParseExpression());
+    Expect(TokenType::kRPAREN, ")");
+    AddChild(node, tail, ParseStatement());
+    // "else if" is an else whose statement is another if
+    if (Accept(TokenType::kELSE))
+        AddChild(node, tail, ParseStatement());
+    return node;
+}
+
+AstNode* Parser::ParseWhile() {
+    AstNode* node = NewNode(AstKind::kWHILE, Line());
+    AstNode* tail = nullptr;
+    Expect(TokenType::kWHILE, "while");
+    Expect(TokenType::kLPAREN, "(");
+    AddChild(node, tail, ParseExpression());
+    Expect(TokenType::kRPAREN, ")");
+    AddChild(node, tail, ParseStatement());
+    return node;
+}
+
+AstNode* Parser::ParseFor() {
+    AstNode* node = NewNode(AstKind::kFOR, Line());
+    AstNode* tail = nullptr;
+    Expect(TokenType::kFOR, "for");
+    Expect(TokenType::kLPAREN, "(");
+    AddChild(node, tail, (Peek() == TokenType::kSCOLON) ? NewNode(AstKind::kEMPTY, Line()) : ParseSimpleStatement());
+    Expect(TokenType::kSCOLON, ";");
+    AddChild(node, tail, (Peek() == TokenType::kSCOLON) ? NewNode(AstKind::kEMPTY, Line()) : ParseExpression());
+    Expect(TokenType::kSCOLON, ";");
+    AddChild(node, tail, (Peek() == TokenType::kRPAREN) ? NewNode(AstKind::kEMPTY, Line()) : ParseSimpleStatement());
+    Expect(TokenType::kRPAREN, ")");
+    AddChild(node, tail, ParseStatement());
+    return node;
+}
+
+AstNode* Parser::ParseSimpleStatement() {
+    if (AtDeclaration())
+        return ParseVarDecl(kMOD_CONST | kMOD_SIGNED | kMOD_UNSIGNED);
+
+    uint32_t line = Line();
+    AstNode* expr = ParseExpression();
+    AstNode* tail = nullptr;
+    switch (Peek()) {
+        case TokenType::kASSIGN:
+        case TokenType::kADD_EQU:
+        case TokenType::kSUB_EQU:
+        case TokenType::kMULT_EQU:
+        case TokenType::kDIV_EQU:
+        case TokenType::kMOD_EQU: {
+            if (expr->kind != AstKind::kIDENTIFIER && expr->kind != AstKind::kMEMBER && expr->kind != AstKind::kINDEX)
+                Error("Invalid assignment target");
+            AstNode* node = NewNode(AstKind::kASSIGN, line);
+            node->op = Peek();
+            ++pos_;
+            AddChild(node, tail, expr);
+            AddChild(node, tail, ParseExpression());
+            return node;
+        }
+        default: {
+            AstNode* node = NewNode(AstKind::kEXPR_STMT, line);
+            AddChild(node, tail, expr);
+            return node;
+        }
+    }
+}
+
+bool Parser::AtDeclaration() const noexcept {
+    switch (Peek()) {
+        case TokenType::kCONST:
+        case TokenType::kSIGNED:
+        case TokenType::kUNSIGNED:
+        case TokenType::kNOTNULL:
+        case TokenType::kPRIMARY:
+        case TokenType::kSECONDARY:
+        case TokenType::kBYTE:
+        case TokenType::kSHORT:
+        case TokenType::kINT:
+        case TokenType::kLONG:
+        case TokenType::kFLOAT:
+        case TokenType::kDOUBLE:
+        case TokenType::kSTRING:
+        case TokenType::kBOOL:
+            return true;
+        case TokenType::kIDENTIFIER: {
+            // A struct typed declaration, "Type name", "Type[] name" or "Type* name" followed by = ; [ or (
+            TokenType next = Peek(1);
+            if (next == TokenType::kIDENTIFIER)
+                return true;
+            if (next == TokenType::kLBRACK)
+                return Peek(2) == TokenType::kRBRACK;
+            if (next != TokenType::kASTERISK)
+                return false;
+            size_t ahead = 1;
+            while (Peek(ahead) == TokenType::kASTERISK)
+                ++ahead;
+            if (Peek(ahead) == TokenType::kLBRACK && Peek(ahead + 1) == TokenType::kRBRACK)
+                return true;
+            if (Peek(ahead) != TokenType::kIDENTIFIER)
+                return false;
+            TokenType after = Peek(ahead + 1);
+            return after == TokenType::kASSIGN || after == TokenType::kSCOLON || after == TokenType::kLBRACK ||
+                   after == TokenType::kLPAREN;
+        }
+        default:
+            return false;
+    }
+}
+
+AstNode* Parser::ParseVarDecl(uint16_t allowed_modifiers) {
+    uint32_t line = Line();
+    uint16_t modifiers = 0;
+    while (true) {
+        uint16_t modifier = 0;
+        switch (Peek()) {
+            case TokenType::kCONST: modifier = kMOD_CONST; break;
+            case TokenType::kSIGNED: modifier = kMOD_SIGNED; break;
+            case TokenType::kUNSIGNED: modifier = kMOD_UNSIGNED; break;
+            case TokenType::kNOTNULL: modifier = kMOD_NOTNULL; break;
+            case TokenType::kPRIMARY: modifier = kMOD_PRIMARY; break;
+            case TokenType::kSECONDARY: modifier = kMOD_SECONDARY; break;
+            default: break;
+        }
+        if (modifier == 0)
+            break;
+        if (!(allowed_modifiers & modifier))
+            Error("Modifier only allowed on struct members");
+        if (modifiers & modifier)
+            Error("Duplicate modifier");
+        modifiers |= modifier;
+        ++pos_;
+    }
+    if ((modifiers & kMOD_SIGNED) && (modifiers & kMOD_UNSIGNED))
+        Error("A declaration cannot be both signed and unsigned");
+    if ((modifiers & kMOD_PRIMARY) && (modifiers & kMOD_SECONDARY))
+        Error("A member cannot be both a primary and a secondary key");
+
+    AstNode* node = NewNode(AstKind::kVAR_DECL, line);
+    AstNode* tail = nullptr;
+    node->flags = modifiers;
+    AstNode* type = ParseType();
+    if ((modifiers & (kMOD_SIGNED | kMOD_UNSIGNED)) && type->op != TokenType::kBYTE && type->op != TokenType::kSHORT &&
+        type->op != TokenType::kINT && type->op != TokenType::kLONG)
+        Error("signed and unsigned only apply to integer types");
+    AddChild(node, tail, type);
+    node->text = ExpectIdentifier("a variable name");
+
+    // grammar.txt puts the array part after the name, "Type name[size]"
+    if (Accept(TokenType::kLBRACK)) {
+        if (type->flags & kAST_ARRAY)
+            Error("Type is already an array");
+        type->flags |= kAST_ARRAY;
+        if (Peek() != TokenType::kRBRACK) {
+            AstNode* type_tail = nullptr;
+            AddChild(type, type_tail, ParseExpression());
+        }
+        Expect(TokenType::kRBRACK, "]");
+    }
+
+    if (Accept(TokenType::kASSIGN)) {
+        AddChild(node, tail, ParseExpression());
+    } else if (Peek() == TokenType::kLPAREN) {
+        AstNode* construct = NewNode(AstKind::kCONSTRUCT, Line());
+        AstNode* args_tail = nullptr;
+        ++pos_;
+        ParseArguments(construct, args_tail);
+        AddChild(node, tail, construct);
+    }
+    return node;
+}
+
+AstNode* Parser::ParseType() {
+    switch (Peek()) {
+        case TokenType::kBYTE:
+        case TokenType::kSHORT:
+        case TokenType::kINT:
+        case TokenType::kLONG:
+        case TokenType::kFLOAT:
+        case TokenType::kDOUBLE:
+        case TokenType::kSTRING:
+        case TokenType::kBOOL:
+        case TokenType::kIDENTIFIER:
+            break;
+        default:
+            Error("Expected a type");
+    }
+    AstNode* node = NewNode(AstKind::kTYPE, Line());
+    node->op = Peek();
+    node->text = arena_->CopyString(tokens_->Value(pos_++));
+    while (Accept(TokenType::kASTERISK)) {
+        if ((node->flags & kAST_POINTER_MASK) == kAST_POINTER_MASK)
+            Error("Too many levels of pointers");
+        ++node->flags;
+    }
+    if (Peek() == TokenType::kLBRACK && Peek(1) == TokenType::kRBRACK) {
+        pos_ += 2;
+        node->flags |= kAST_ARRAY;
+    }
+    return node;
+}
+
+/**
+ * Expressions
+ */
+AstNode* Parser::ParseExpression() {
+    AstNode* lhs = ParseAnd();
+    while (Peek() == TokenType::kBOOL_OR) {
+        uint32_t line = Line();
+        ++pos_;
+        lhs = NewBinary(TokenType::kBOOL_OR, lhs, ParseAnd(), line);
+    }
+    return lhs;
+}
+
+AstNode* Parser::ParseAnd() {
+    AstNode* lhs = ParseRelational();
+    while (Peek() == TokenType::kBOOL_AND) {
+        uint32_t line = Line();
+        ++pos_;
+        lhs = NewBinary(TokenType::kBOOL_AND, lhs, ParseRelational(), line);
+    }
+    return lhs;
+}
+
+AstNode* Parser::ParseRelational() {
+    AstNode* lhs = ParseAdditive();
+    while (true) {
+        TokenType op = Peek();
+        switch (op) {
+            case TokenType::kEQUALITY:
+            case TokenType::kDNE:
+            case TokenType::kLT:
+            case TokenType::kLTE:
+            case TokenType::kGT:
+            case TokenType::kGTE: {
+                uint32_t line = Line();
+                ++pos_;
+                lhs = NewBinary(op, lhs, ParseAdditive(), line);
+            } break;
+            default:
+                return lhs;
+        }
+    }
+}
+
+AstNode* Parser::ParseAdditive() {
+    AstNode* lhs = ParseMultiplicative();
+    while (Peek() == TokenType::kPLUS || Peek() == TokenType::kMINUS) {
+        TokenType op = Peek();
+        uint32_t line = Line();
+        ++pos_;
+        lhs = NewBinary(op, lhs, ParseMultiplicative(), line);
+    }
+    return lhs;
+}
+
+AstNode* Parser::ParseMultiplicative() {
+    AstNode* lhs = ParseUnary();
+    while (Peek() == TokenType::kASTERISK || Peek() == TokenType::kDIVIDE || Peek() == TokenType::kMODULO) {
+        TokenType op = Peek();
+        uint32_t line = Line();
+        ++pos_;
+        lhs = NewBinary(op, lhs, ParseUnary(), line);
+    }
+    return lhs;
+}
+
+AstNode* Parser::ParseUnary() {
+    if (++depth_ > MAX_NESTING)
+        Error("Expression nested too deeply");
+    AstNode* node = nullptr;
+    TokenType op = Peek();
+    if (op == TokenType::kNOT || op == TokenType::kMINUS || op == TokenType::kPLUS) {
+        node = NewNode(AstKind::kUNARY, Line());
+        AstNode* tail = nullptr;
+        node->op = op;
+        ++pos_;
+        AddChild(node, tail, ParseUnary());
+    } else {
+        node = ParsePostfix();
+    }
+    --depth_;
+    return node;
+}
+
+AstNode* Parser::ParsePostfix() {
+    AstNode* node = ParsePrimary();
+    while (true) {
+        uint32_t line = Line();
+        AstNode* tail = nullptr;
+        switch (Peek()) {
+            case TokenType::kDOT: {
+                ++pos_;
+                AstNode* member = NewNode(AstKind::kMEMBER, line);
+                member->text = ExpectIdentifier("a member name");
+                AddChild(member, tail, node);
+                node = member;
+            } break;
+            case TokenType::kLPAREN: {
+                ++pos_;
+                AstNode* call = NewNode(AstKind::kCALL, line);
+                AddChild(call, tail, node);
+                ParseArguments(call, tail);
+                node = call;
+            } break;
+            case TokenType::kLBRACK: {
+                ++pos_;
+                AstNode* index = NewNode(AstKind::kINDEX, line);
+                AddChild(index, tail, node);
+                AddChild(index, tail, ParseExpression());
+                Expect(TokenType::kRBRACK, "]");
+                node = index;
+            } break;
+            default:
+                return node;
+        }
+    }
+}
+
+AstNode* Parser::ParsePrimary() {
+    uint32_t line = Line();
+    AstNode* node = nullptr;
+    switch (Peek()) {
+        case TokenType::kIDENTIFIER: {
+            node = NewNode(AstKind::kIDENTIFIER, line);
+            node->text = arena_->CopyString(tokens_->Value(pos_++));
+        } break;
+        case TokenType::kINTEGER: {
+            node = NewNode(AstKind::kINTEGER, line);
+            node->text = arena_->CopyString(tokens_->Value(pos_++));
+        } break;
+        case TokenType::kREAL_NUMBER: {
+            node = NewNode(AstKind::kREAL, line);
+            node->text = arena_->CopyString(tokens_->Value(pos_++));
+        } break;
+        case TokenType::kSTRING_LITERAL: {
+            node = NewNode(AstKind::kSTRING, line);
+            node->text = arena_->CopyString(tokens_->Value(pos_++));
+        } break;
+        case TokenType::kTRUE:
+        case TokenType::kFALSE: {
+            node = NewNode(AstKind::kBOOL, line);
+            node->op = Peek();
+            ++pos_;
+        } break;
+        case TokenType::kPLACEHOLDER: {
+            node = NewNode(AstKind::kPARAMETER, line);
+            std::string_view name = tokens_->Value(pos_++);
+            size_t index = parameters_.size();
+            if (!name.empty()) {
+                for (size_t i = 0; i < parameters_.size(); ++i) {
+                    if (parameters_[i] == name) {
+                        index = i;
+                        break;
+                    }
+                }
+            }
+            if (index == parameters_.size()) {
+                if (index > UINT16_MAX)
+                    Error("Too many parameters");
+                parameters_.push_back(arena_->CopyString(name));
+            }
+            node->text = parameters_[index];
+            node->flags = static_cast<uint16_t>(index);
+        } break;
+        case TokenType::kLPAREN: {
+            ++pos_;
+            node = ParseExpression();
+            Expect(TokenType::kRPAREN, ")");
+        } break;
+        case TokenType::kNEW: {
+            ++pos_;
+            node = NewNode(AstKind::kNEW, line);
+            AstNode* tail = nullptr;
+            AddChild(node, tail, ParseType());
+            Expect(TokenType::kLPAREN, "(");
+            ParseArguments(node, tail);
+        } break;
+        default:
+            Error("Expected an expression");
+    }
+    return node;
+}
+
+void Parser::ParseArguments(AstNode* parent, AstNode*& tail) {
+    if (Accept(TokenType::kRPAREN))
+        return;
+    do {
+        AstNode* arg = NewNode(AstKind::kARG, Line());
+        AstNode* arg_tail = nullptr;
+        // Constructor style calls name their arguments, "Student(uid=1, name=\"x\")"
+        if (Peek() == TokenType::kIDENTIFIER && Peek(1) == TokenType::kASSIGN) {
+            arg->text = arena_->CopyString(tokens_->Value(pos_));
+            pos_ += 2;
+        }
+        AddChild(arg, arg_tail, ParseExpression());
+        AddChild(parent, tail, arg);
+    } while (Accept(TokenType::kCOMMA));
+    Expect(TokenType::kRPAREN, ")");
+}
@@ -0,0 +1,132 @@
+#ifndef DT_SRC_PARSER_PARSER_H
+#define DT_SRC_PARSER_PARSER_H
+
+// C++ Includes
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Local Includes
+#include "parser/arena.h"
+#include "parser/ast.h"
+#include "parser/tokenbuffer.h"
+
+/**
+ * @brief Recursive descent parser from a TokenBuffer to an arena allocated AST
+ * 
+ * Follows grammar.txt for struct declarations, member and variable declarations
+ * and expressions, and the README for functions and statements: assignments,
+ * calls, new, delete, if/else, while, for, return and blocks.
+ */
+class Parser {
+public:
+    /**
+     * Tors
+     */
+    Parser() noexcept;
+    ~Parser() noexcept;
+
+    /**
+     * NON-COPYABLE
+     */
+    Parser(const Parser&) = delete;
+    Parser(Parser&&) = delete;
+    Parser& operator=(const Parser&) = delete;
+
+    /**
+     * Parsing
+     */
+
+    /**
+     * @brief Parse a whole program
+     * @param tokens The tokenized program, ending in kEOF
+     * @param arena Where every node and string is allocated, the tree lives until the arena is reset
+     * @return The kPROGRAM node
+     * @throws ParseException on the first syntax error, with its line number
+     */
+    AstNode* Parse(const TokenBuffer& tokens, Arena& arena);
+
+    /**
+     * Stats
+     */
+
+    /**
+     * @brief Statements parsed by the last call to Parse(), nested ones included
+     */
+    size_t Statements() const noexcept;
+
+    /**
+     * @brief Nodes created by the last call to Parse()
+     */
+    size_t Nodes() const noexcept;
+
+    /**
+     * @brief Placeholders of the last call to Parse() by parameter index, empty names for ?
+     *
+     * Every ? is a new parameter, a $name reused later shares the index of its
+     * first appearance. The names live in the arena.
+     */
+    const std::vector<std::string_view>& Parameters() const noexcept;
+
+private:
+    /**
+     * Token Helpers
+     */
+    TokenType Peek(size_t ahead = 0) const noexcept;
+    uint32_t Line() const noexcept;
+    bool Accept(TokenType type) noexcept;
+    void Expect(TokenType type, const char* what);
+    std::string_view ExpectIdentifier(const char* what);
+    [[noreturn]] void Error(const std::string& msg) const;
+
+    /**
+     * Node Helpers
+     */
+    AstNode* NewNode(AstKind kind, uint32_t line);
+    AstNode* NewBinary(TokenType op, AstNode* lhs, AstNode* rhs, uint32_t line);
+
+    /**
+     * @brief Append child to parent, tail tracks the last child so long lists stay linear
+     */
+    static void AddChild(AstNode* parent, AstNode*& tail, AstNode* child) noexcept;
+
+    /**
+     * Statements
+     */
+    AstNode* ParseStatement();
+    AstNode* ParseStructDecl();
+    bool AtFunction() const noexcept;
+    AstNode* ParseFunction();
+    AstNode* ParseBlock();
+    AstNode* ParseIf();
+    AstNode* ParseWhile();
+    AstNode* ParseFor();
+    AstNode* ParseSimpleStatement();
+    bool AtDeclaration() const noexcept;
+    AstNode* ParseVarDecl(uint16_t allowed_modifiers);
+    AstNode* ParseType();
+
+    /**
+     * Expressions, lowest precedence first
+     */
+    AstNode* ParseExpression();
+    AstNode* ParseAnd();
+    AstNode* ParseRelational();
+    AstNode* ParseAdditive();
+    AstNode* ParseMultiplicative();
+    AstNode* ParseUnary();
+    AstNode* ParsePostfix();
+    AstNode* ParsePrimary();
+    void ParseArguments(AstNode* parent, AstNode*& tail);
+
+    const TokenBuffer* tokens_;
+    Arena* arena_;
+    size_t pos_;
+    uint32_t depth_;
+    size_t statements_;
+    size_t nodes_;
+    std::vector<std::string_view> parameters_;
+};
+
+#endif
@@ -0,0 +1,32 @@
+// C++ Includes
+#include <cstdint>
+
+// Local Includes
+#include "exception/token_exception.h"
+#include "tokenbuffer.h"
+
+TokenBuffer::TokenBuffer() noexcept
+: types_(), offsets_(), lengths_(), lines_(), text_()
+{}
+
+TokenBuffer::~TokenBuffer() noexcept {}
+
+void TokenBuffer::Clear() noexcept {
+    types_.clear();
+    offsets_.clear();
+    lengths_.clear();
+    lines_.clear();
+    text_.clear();
+}
+
+void TokenBuffer::TextLimitExceeded() {
+    throw TokenException("Token text exceeds the 4 GiB limit of a TokenBuffer");
+}
+
+void TokenBuffer::Reserve(size_t tokens, size_t text_bytes) {
+    types_.reserve(tokens);
+    offsets_.reserve(tokens);
+    lengths_.reserve(tokens);
+    lines_.reserve(tokens);
+    text_.reserve(text_bytes);
+}
@@ -0,0 +1,135 @@
+#ifndef DT_SRC_PARSER_TOKENBUFFER_H
+#define DT_SRC_PARSER_TOKENBUFFER_H
+
+// C++ Includes
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Local Includes
+#include "parser/tokenizer.h"
+
+/**
+ * @brief A whole input tokenized into flat structure-of-arrays storage
+ * 
+ * Token i is described by Type(i), Offset(i)/Length(i) into Text() and Line(i).
+ * Values are copied into one text block, so the buffer stays valid after the
+ * tokenizer moves on or is closed. The last token is always kEOF, so a parser
+ * can look ahead up to it without bounds checks.
+ */
+class TokenBuffer {
+public:
+    /**
+     * Tors
+     */
+    TokenBuffer() noexcept;
+    ~TokenBuffer() noexcept;
+
+    /**
+     * Building
+     */
+
+    /**
+     * @brief Remove every token, keeping the allocated storage
+     */
+    void Clear() noexcept;
+
+    /**
+     * @brief Reserve room for tokens tokens and text_bytes bytes of values
+     */
+    void Reserve(size_t tokens, size_t text_bytes);
+
+    /**
+     * @brief Append a token, copying its value into the text block
+     * @throws TokenException when the text block would pass 4 GiB
+     */
+    void Append(TokenType type, std::string_view value, uint32_t line);
+
+    /**
+     * Access
+     */
+    size_t Size() const noexcept;
+    bool Empty() const noexcept;
+    TokenType Type(size_t index) const noexcept;
+    uint32_t Offset(size_t index) const noexcept;
+    uint32_t Length(size_t index) const noexcept;
+    uint32_t Line(size_t index) const noexcept;
+    std::string_view Value(size_t index) const noexcept;
+
+    /**
+     * @brief The packed token types, one byte per token, for scanning many tokens at once
+     */
+    const TokenType* Types() const noexcept;
+
+    /**
+     * @brief The concatenated token values
+     */
+    const std::string& Text() const noexcept;
+
+private:
+    // Stitches per-chunk buffers together without going through Append()
+    friend class ParallelTokenizer;
+
+    /**
+     * @brief Throw the error for Append(), kept out of line so Append() stays small
+     */
+    [[noreturn]] static void TextLimitExceeded();
+
+    std::vector<TokenType> types_;
+    std::vector<uint32_t> offsets_;
+    std::vector<uint32_t> lengths_;
+    std::vector<uint32_t> lines_;
+    std::string text_;
+};
+
+/**
+ * Inline Building and Access, these sit on the tokenizer's and parser's hot paths
+ */
+inline void TokenBuffer::Append(TokenType type, std::string_view value, uint32_t line) {
+    if (value.size() > UINT32_MAX - text_.size())
+        TextLimitExceeded();
+    types_.push_back(type);
+    offsets_.push_back(static_cast<uint32_t>(text_.size()));
+    lengths_.push_back(static_cast<uint32_t>(value.size()));
+    lines_.push_back(line);
+    text_.append(value.data(), value.size());
+}
+
+inline size_t TokenBuffer::Size() const noexcept {
+    return types_.size();
+}
+
+inline bool TokenBuffer::Empty() const noexcept {
+    return types_.empty();
+}
+
+inline TokenType TokenBuffer::Type(size_t index) const noexcept {
+    return types_[index];
+}
+
+inline uint32_t TokenBuffer::Offset(size_t index) const noexcept {
+    return offsets_[index];
+}
+
+inline uint32_t TokenBuffer::Length(size_t index) const noexcept {
+    return lengths_[index];
+}
+
+inline uint32_t TokenBuffer::Line(size_t index) const noexcept {
+    return lines_[index];
+}
+
+inline std::string_view TokenBuffer::Value(size_t index) const noexcept {
+    return std::string_view(text_.data() + offsets_[index], lengths_[index]);
+}
+
+inline const TokenType* TokenBuffer::Types() const noexcept {
+    return types_.data();
+}
+
+inline const std::string& TokenBuffer::Text() const noexcept {
+    return text_;
+}
+
+#endif
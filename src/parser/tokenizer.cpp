@@ -1,10 +1,19 @@
 // C++ Includes
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string_view>
 
 // Local Includes
+#include "charscan.h"
 #include "exception/token_exception.h"
+#include "tokenbuffer.h"
 #include "tokenizer.h"
 
+// Initial size of the window used for streamed input, grown for tokens that do not fit
+#define WINDOW_SIZE (64 * 1024)
+
 // Necessary Enums
 enum class CharType : uint8_t {
     kNULL,      // \0
@@ -50,29 +59,6 @@ enum class CharType : uint8_t {
 enum class TokenState : uint16_t {
     // Book keeping states
     kS0, kS_DONE, kS_ERROR,
-    // Keyword States
-    kS_S, kS_ST, kS_STR, kS_STRU, kS_STRUC, kS_STRUCT,
-    kS_B, kS_BY, kS_BYT, kS_BYTE,
-    kS_BO, kS_BOO, kS_BOOL,
-    kS_FA, kS_FAL, kS_FALS, kS_FALSE,
-    kS_T, kS_TR, kS_TRU, kS_TRUE, 
-    kS_SH, kS_SHO, kS_SHOR, kS_SHORT,
-    kS_I, kS_IN, kS_INT,
-    kS_L, kS_LO, kS_LON, kS_LONG,
-    kS_F, kS_FL, kS_FLO, kS_FLOA, kS_FLOAT,
-    kS_FO, kS_FOR,
-    kS_W, kS_WH, kS_WHI, kS_WHIL, kS_WHILE,
-    kS_R, kS_RE, kS_RET, kS_RETU, kS_RETUR, kS_RETURN,
-    kS_D, kS_DO, kS_DOU, kS_DOUB, kS_DOUBL, kS_DOUBLE,
-    kS_STRI, kS_STRIN, kS_STRING,
-    kS_C, kS_CO, kS_CON, kS_CONS, kS_CONST,
-    kS_SI, kS_SIG, kS_SIGN, kS_SIGNE, kS_SIGNED,
-    kS_U, kS_UN, kS_UNS, kS_UNSI, kS_UNSIG, kS_UNSIGN, kS_UNSIGNE, kS_UNSIGNED,
-    kS_N, kS_NO, kS_NOT, kS_NOTN, kS_NOTNU, kS_NOTNUL, kS_NOTNULL,
-    kS_P, kS_PR, kS_PRI, kS_PRIM, kS_PRIMA, kS_PRIMAR, kS_PRIMARY,
-    kS_SE, kS_SEC, kS_SECO, kS_SECON, kS_SECOND, kS_SECONDA, kS_SECONDAR, kS_SECONDARY,
-    kS_NE, kS_NEW,
-    kS_DE, kS_DEL, kS_DELE, kS_DELET, kS_DELETE,
     // Comments
     kS_COMMENT,
     // Identifiers
@@ -111,7 +97,23 @@ static const CharType mCharType[] = {
 /* 6x */   CharType::kGRAVE,   CharType::kALPHA,   CharType::kALPHA,   CharType::kALPHA,   CharType::kALPHA,   CharType::kALPHA,   CharType::kALPHA,   CharType::kALPHA,
            CharType::kALPHA,   CharType::kALPHA,   CharType::kALPHA,   CharType::kALPHA,   CharType::kALPHA,   CharType::kALPHA,   CharType::kALPHA,   CharType::kALPHA,
 /* 7x */   CharType::kALPHA,   CharType::kALPHA,   CharType::kALPHA,   CharType::kALPHA,   CharType::kALPHA,   CharType::kALPHA,   CharType::kALPHA,   CharType::kALPHA,
-           CharType::kALPHA,   CharType::kALPHA,   CharType::kALPHA,   CharType::kLBRACE,  CharType::kPIPE,    CharType::kRBRACE,  CharType::kTILDE,   CharType::kILLEGAL
+           CharType::kALPHA,   CharType::kALPHA,   CharType::kALPHA,   CharType::kLBRACE,  CharType::kPIPE,    CharType::kRBRACE,  CharType::kTILDE,   CharType::kILLEGAL,
+/* 8x */   CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL,
+           CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL,
+/* 9x */   CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL,
+           CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL,
+/* ax */   CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL,
+           CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL,
+/* bx */   CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL,
+           CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL,
+/* cx */   CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL,
+           CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL,
+/* dx */   CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL,
+           CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL,
+/* ex */   CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL,
+           CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL,
+/* fx */   CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL,
+           CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL, CharType::kILLEGAL
 };
 
 // Map to get lowercase (only change 'A' -> 'a')
@@ -148,6 +150,8 @@ static const char* mTokenName[] = {
     "NEW",
     "DELETE",
     "COMMENT",
+    "IF",
+    "ELSE",
     "FOR",
     "WHILE",
     "RETURN",
@@ -155,6 +159,7 @@ static const char* mTokenName[] = {
     "INTEGER",
     "REAL_NUMBER",
     "STRING_LITERAL",
+    "PLACEHOLDER",
     "BOOL_AND",
     "BOOL_OR",
     "LT",
@@ -191,36 +196,169 @@ static const char* mTokenName[] = {
     "ERROR"
 };
 
+// Keywords, anything else made of identifier characters is an identifier
+struct Keyword {
+    std::string_view text;
+    TokenType type;
+};
+
+static constexpr Keyword mKeywords[] = {
+    {"struct", TokenType::kSTRUCT},
+    {"byte", TokenType::kBYTE},
+    {"short", TokenType::kSHORT},
+    {"int", TokenType::kINT},
+    {"long", TokenType::kLONG},
+    {"float", TokenType::kFLOAT},
+    {"double", TokenType::kDOUBLE},
+    {"string", TokenType::kSTRING},
+    {"bool", TokenType::kBOOL},
+    {"true", TokenType::kTRUE},
+    {"false", TokenType::kFALSE},
+    {"const", TokenType::kCONST},
+    {"signed", TokenType::kSIGNED},
+    {"unsigned", TokenType::kUNSIGNED},
+    {"notnull", TokenType::kNOTNULL},
+    {"primary", TokenType::kPRIMARY},
+    {"secondary", TokenType::kSECONDARY},
+    {"new", TokenType::kNEW},
+    {"delete", TokenType::kDELETE},
+    {"if", TokenType::kIF},
+    {"else", TokenType::kELSE},
+    {"for", TokenType::kFOR},
+    {"while", TokenType::kWHILE},
+    {"return", TokenType::kRETURN}
+};
+
+#define KEYWORD_COUNT (sizeof(mKeywords) / sizeof(mKeywords[0]))
+#define KEYWORD_SLOT_BITS 6
+#define KEYWORD_SLOTS (1u << KEYWORD_SLOT_BITS)
+
+/**
+ * @brief Hash the length, first two and last characters of a word, which tells every keyword apart
+ */
+static constexpr uint32_t KeywordHash(const char* word, size_t len, uint32_t seed) noexcept {
+    uint32_t key = (static_cast<uint32_t>(static_cast<uint8_t>(word[0])) << 24) |
+                   (static_cast<uint32_t>(static_cast<uint8_t>(word[1])) << 16) |
+                   (static_cast<uint32_t>(static_cast<uint8_t>(word[len - 1])) << 8) |
+                   static_cast<uint32_t>(len);
+    return (key * seed) >> (32 - KEYWORD_SLOT_BITS);
+}
+
+/**
+ * @brief Keyword index per hash slot, -1 when the slot is empty
+ */
+struct KeywordTable {
+    uint32_t seed;
+    int8_t slots[KEYWORD_SLOTS];
+};
+
+/**
+ * @brief Search for a multiplier that places every keyword in its own slot
+ */
+static constexpr KeywordTable BuildKeywordTable() noexcept {
+    for (uint32_t seed = 0x9E3779B1u; seed != 0; seed += 2) {
+        KeywordTable table{seed, {}};
+        for (uint32_t i = 0; i < KEYWORD_SLOTS; ++i)
+            table.slots[i] = -1;
+        bool perfect = true;
+        for (uint32_t i = 0; i < KEYWORD_COUNT && perfect; ++i) {
+            uint32_t slot = KeywordHash(mKeywords[i].text.data(), mKeywords[i].text.size(), seed);
+            if (table.slots[slot] != -1)
+                perfect = false;
+            table.slots[slot] = static_cast<int8_t>(i);
+        }
+        if (perfect)
+            return table;
+    }
+    return KeywordTable{0, {}};
+}
+
+static constexpr KeywordTable mKeywordTable = BuildKeywordTable();
+static_assert(mKeywordTable.seed != 0, "No perfect hash found for the keyword set");
+
+/**
+ * @brief Classify a scanned word as a keyword or an identifier
+ */
+static inline TokenType LookupKeyword(const uint8_t* word, size_t len) noexcept {
+    // Every keyword is 2 to 9 characters, which also keeps the hash inside the word
+    if (len < 2 || len > 9)
+        return TokenType::kIDENTIFIER;
+    const char* text = reinterpret_cast<const char*>(word);
+    int8_t index = mKeywordTable.slots[KeywordHash(text, len, mKeywordTable.seed)];
+    if (index < 0 || mKeywords[index].text.size() != len || memcmp(mKeywords[index].text.data(), text, len) != 0)
+        return TokenType::kIDENTIFIER;
+    return mKeywords[index].type;
+}
+
+static inline bool IsDigit(uint8_t c) noexcept {
+    return mCharType[c] == CharType::kDIGIT;
+}
+
+const char* TokenTypeName(TokenType type) noexcept {
+    return mTokenName[static_cast<uint8_t>(type)];
+}
+
 Tokenizer::Tokenizer() noexcept
-: str_i_(0), str_(""), curr_token_(TokenType::kEOF), curr_token_val_("")
+: Tokenizer(ReadMode::kMMAP)
+{}
+
+Tokenizer::Tokenizer(ReadMode file_mode) noexcept
+: str_(""), fr_(file_mode), streaming_(false), window_(nullptr), window_size_(0),
+  cur_(nullptr), lim_(nullptr), line_(1), curr_token_(TokenType::kEOF), curr_token_val_(""), 
+  tok_begin_(nullptr), tok_end_(nullptr), tok_decoded_(false), tok_line_(1)
 {}
 
 Tokenizer::~Tokenizer() noexcept {}
 
 void Tokenizer::OpenString(const std::string& trunk_str) {
     fr_.Close();
-    str_i_ = 0;
     str_ = trunk_str;
-    curr_token_ = TokenType::kBEGIN;
+    SetSource(reinterpret_cast<const uint8_t*>(str_.data()), str_.size());
 }
 
 void Tokenizer::OpenString(const char* trunk_str) {
     fr_.Close();
-    str_i_ = 0;
     str_ = std::string(trunk_str);
-    curr_token_ = TokenType::kBEGIN;
+    SetSource(reinterpret_cast<const uint8_t*>(str_.data()), str_.size());
+}
+
+void Tokenizer::OpenView(std::string_view text) {
+    fr_.Close();
+    str_.clear();
+    SetSource(reinterpret_cast<const uint8_t*>(text.data()), text.size());
 }
 
 void Tokenizer::OpenFile(const std::string& file_name) {
-    str_ = "";
-    fr_.Open(file_name);
-    curr_token_ = TokenType::kBEGIN;
+    OpenFile(file_name.c_str());
 }
 
 void Tokenizer::OpenFile(const char* file_name) {
     str_ = "";
     fr_.Open(file_name);
+    // A mapped file is scanned in place, anything else is streamed through the window
+    if (fr_.Mapped()) {
+        SetSource(fr_.MappedData(), fr_.MappedSize());
+    } else {
+        if (!window_) {
+            window_size_ = WINDOW_SIZE;
+            window_ = std::make_unique<uint8_t[]>(window_size_);
+        }
+        SetSource(window_.get(), 0);
+        streaming_ = true;
+    }
+}
+
+void Tokenizer::SetSource(const uint8_t* src, size_t src_len) noexcept {
+    streaming_ = false;
+    cur_ = src;
+    lim_ = src + src_len;
+    line_ = 1;
+    tok_begin_ = cur_;
+    tok_line_ = 1;
+    tok_end_ = nullptr;
     curr_token_ = TokenType::kBEGIN;
+    curr_token_val_.clear();
+    curr_token_view_ = std::string_view();
 }
 
 TokenType Tokenizer::CurrToken() const noexcept {
@@ -228,48 +366,91 @@ TokenType Tokenizer::CurrToken() const noexcept {
 }
 
 std::string Tokenizer::CurrTokenValue() const noexcept {
-    return curr_token_val_;
+    return std::string(curr_token_view_);
+}
+
+std::string_view Tokenizer::CurrTokenView() const noexcept {
+    return curr_token_view_;
+}
+
+uint32_t Tokenizer::CurrTokenLine() const noexcept {
+    return tok_line_;
+}
+
+void Tokenizer::Tokenize(TokenBuffer& buffer) {
+    buffer.Clear();
+    // Roughly one token per four bytes of input, most of which ends up as token text
+    size_t input_size = streaming_ ? static_cast<size_t>(fr_.Size()) : static_cast<size_t>(lim_ - cur_);
+    buffer.Reserve(input_size / 4 + 1, input_size);
+    while (NextToken() != TokenType::kEOF)
+        buffer.Append(curr_token_, curr_token_view_, tok_line_);
+    buffer.Append(TokenType::kEOF, std::string_view(), tok_line_);
 }
 
 std::string Tokenizer::GetDebugStr() const noexcept {
     std::string curr_str(mTokenName[static_cast<uint8_t>(curr_token_)]);
-    curr_str += ": " + curr_token_val_;
+    curr_str += ": ";
+    curr_str += curr_token_view_;
     return curr_str;
 }
 
-uint8_t Tokenizer::NextChar() {
-    uint8_t ret_val = '\0';
-    if (str_ != "" && str_i_ != static_cast<uint32_t>(str_.size())) {
-        ret_val = str_[str_i_++];
-    } else if (!fr_.End()) {
-        ret_val = fr_.ReadByte();
+bool Tokenizer::Refill() {
+    if (!streaming_)
+        return false;
+
+    // Keep the token being scanned at the front of the window, it is sliced out when it finishes
+    size_t keep = static_cast<size_t>(lim_ - tok_begin_);
+    size_t cur_off = static_cast<size_t>(cur_ - tok_begin_);
+    size_t end_off = (tok_end_ != nullptr) ? static_cast<size_t>(tok_end_ - tok_begin_) : 0;
+    if (keep == window_size_) {
+        std::unique_ptr<uint8_t[]> window = std::make_unique<uint8_t[]>(window_size_ * 2);
+        memcpy(window.get(), tok_begin_, keep);
+        window_ = std::move(window);
+        window_size_ *= 2;
+    } else if (keep != 0) {
+        memmove(window_.get(), tok_begin_, keep);
     }
-    return ret_val;
+    tok_begin_ = window_.get();
+    cur_ = tok_begin_ + cur_off;
+    if (tok_end_ != nullptr)
+        tok_end_ = tok_begin_ + end_off;
+
+    size_t bytes_read = fr_.ReadBuffer(window_.get() + keep, window_size_ - keep);
+    lim_ = window_.get() + keep + bytes_read;
+    if (bytes_read == 0)
+        streaming_ = false;
+    return cur_ < lim_;
 }
 
-uint8_t Tokenizer::PeekChar() {
-    uint8_t ret_val = '\0';
-    if (str_ != "" && str_i_ != static_cast<uint32_t>(str_.size())) {
-        ret_val = str_[str_i_];
-    } else if (!fr_.End()) {
-        ret_val = fr_.PeekByte();
-    }
-    return ret_val;
+inline uint8_t Tokenizer::NextChar() {
+    if (cur_ == lim_ && !Refill())
+        return '\0';
+    return *cur_++;
+}
+
+inline uint8_t Tokenizer::PeekChar() {
+    if (cur_ == lim_ && !Refill())
+        return '\0';
+    return *cur_;
 }
 
 TokenType Tokenizer::NextToken() {
     curr_token_ = TokenType::kEOF;
-    curr_token_val_ = "";
+    curr_token_val_.clear();
+    tok_end_ = nullptr;
+    tok_decoded_ = false;
     TokenState curr_state = TokenState::kS0;
     while (curr_state != TokenState::kS_DONE) {
         switch(curr_state) {
             case TokenState::kS0: {
+                tok_begin_ = cur_;
+                tok_line_ = line_;
                 switch(mCharType[PeekChar()]) {
-                    case CharType::kWS: {
-                        NextChar();
-                    } break;
+                    case CharType::kWS:
                     case CharType::kNEWLINE: {
-                        NextChar();
+                        const uint8_t* run = cur_;
+                        cur_ = ScanSpace(cur_, lim_);
+                        line_ += static_cast<uint32_t>(std::count(run, cur_, '\n'));
                     } break;
                     case CharType::kUNDER: {
                         curr_state = ScanIdentifier();
@@ -278,16 +459,16 @@ TokenType Tokenizer::NextToken() {
                         curr_state = ScanKeyword();
                     } break;
                     case CharType::kDIGIT: {
-                        curr_state = ScanNumber();
+                        curr_state = ScanNumber(TokenState::kS_INTEGER);
                     } break;
                     case CharType::kDQUOTE: {
                         curr_state = ScanString();
                     } break;
                     case CharType::kFSLASH: {
-                        curr_token_val_ += NextChar();
+                        NextChar();
                         switch(mCharType[PeekChar()]) {
                             case CharType::kEQ: {
-                                curr_token_val_ += NextChar();
+                                NextChar();
                                 curr_token_ = TokenType::kDIV_EQU;
                                 curr_state = TokenState::kS_DONE;
                             } break;
@@ -302,10 +483,10 @@ TokenType Tokenizer::NextToken() {
                         }
                     } break;
                     case CharType::kAND: {
-                        curr_token_val_ += NextChar();
+                        NextChar();
                         switch(mCharType[PeekChar()]) {
                             case CharType::kAND: {
-                                curr_token_val_ += NextChar();
+                                NextChar();
                                 curr_token_ = TokenType::kBOOL_AND;
                                 curr_state = TokenState::kS_DONE;
                             } break;
@@ -317,10 +498,10 @@ TokenType Tokenizer::NextToken() {
                         }
                     } break;
                     case CharType::kPIPE: {
-                        curr_token_val_ += NextChar();
+                        NextChar();
                         switch(mCharType[PeekChar()]) {
                             case CharType::kPIPE: {
-                                curr_token_val_ += NextChar();
+                                NextChar();
                                 curr_token_ = TokenType::kBOOL_OR;
                                 curr_state = TokenState::kS_DONE;
                             } break;
@@ -332,10 +513,10 @@ TokenType Tokenizer::NextToken() {
                         }
                     } break;
                     case CharType::kLT: {
-                        curr_token_val_ += NextChar();
+                        NextChar();
                         switch(mCharType[PeekChar()]) {
                             case CharType::kEQ: {
-                                curr_token_val_ += NextChar();
+                                NextChar();
                                 curr_token_ = TokenType::kLTE;
                                 curr_state = TokenState::kS_DONE;
                             } break;
@@ -346,10 +527,10 @@ TokenType Tokenizer::NextToken() {
                         }
                     } break;
                     case CharType::kGT: {
-                        curr_token_val_ += NextChar();
+                        NextChar();
                         switch(mCharType[PeekChar()]) {
                             case CharType::kEQ: {
-                                curr_token_val_ += NextChar();
+                                NextChar();
                                 curr_token_ = TokenType::kGTE;
                                 curr_state = TokenState::kS_DONE;
                             } break;
@@ -360,10 +541,10 @@ TokenType Tokenizer::NextToken() {
                         }
                     } break;
                     case CharType::kEQ: {
-                        curr_token_val_ += NextChar();
+                        NextChar();
                         switch(mCharType[PeekChar()]) {
                             case CharType::kEQ: {
-                                curr_token_val_ += NextChar();
+                                NextChar();
                                 curr_token_ = TokenType::kEQUALITY;
                                 curr_state = TokenState::kS_DONE;
                             } break;
@@ -374,10 +555,10 @@ TokenType Tokenizer::NextToken() {
                         }
                     } break;
                     case CharType::kBANG: {
-                        curr_token_val_ += NextChar();
+                        NextChar();
                         switch(mCharType[PeekChar()]) {
                             case CharType::kEQ: {
-                                curr_token_val_ += NextChar();
+                                NextChar();
                                 curr_token_ = TokenType::kDNE;
                                 curr_state = TokenState::kS_DONE;
                             } break;
@@ -388,10 +569,10 @@ TokenType Tokenizer::NextToken() {
                         }
                     } break;
                     case CharType::kPLUS: {
-                        curr_token_val_ += NextChar();
+                        NextChar();
                         switch(mCharType[PeekChar()]) {
                             case CharType::kEQ: {
-                                curr_token_val_ += NextChar();
+                                NextChar();
                                 curr_token_ = TokenType::kADD_EQU;
                                 curr_state = TokenState::kS_DONE;
                             } break;
@@ -402,10 +583,10 @@ TokenType Tokenizer::NextToken() {
                         }
                     } break;
                     case CharType::kDASH: {
-                        curr_token_val_ += NextChar();
+                        NextChar();
                         switch(mCharType[PeekChar()]) {
                             case CharType::kEQ: {
-                                curr_token_val_ += NextChar();
+                                NextChar();
                                 curr_token_ = TokenType::kSUB_EQU;
                                 curr_state = TokenState::kS_DONE;
                             } break;
@@ -416,10 +597,10 @@ TokenType Tokenizer::NextToken() {
                         }
                     } break;
                     case CharType::kAST: {
-                        curr_token_val_ += NextChar();
+                        NextChar();
                         switch(mCharType[PeekChar()]) {
                             case CharType::kEQ: {
-                                curr_token_val_ += NextChar();
+                                NextChar();
                                 curr_token_ = TokenType::kMULT_EQU;
                                 curr_state = TokenState::kS_DONE;
                             } break;
@@ -430,10 +611,10 @@ TokenType Tokenizer::NextToken() {
                         }
                     } break;
                     case CharType::kPERCENT: {
-                        curr_token_val_ += NextChar();
+                        NextChar();
                         switch(mCharType[PeekChar()]) {
                             case CharType::kEQ: {
-                                curr_token_val_ += NextChar();
+                                NextChar();
                                 curr_token_ = TokenType::kMOD_EQU;
                                 curr_state = TokenState::kS_DONE;
                             } break;
@@ -444,42 +625,42 @@ TokenType Tokenizer::NextToken() {
                         }
                     } break;
                     case CharType::kLBRACK: {
-                        curr_token_val_ += NextChar();
+                        NextChar();
                         curr_token_ = TokenType::kLBRACK;
                         curr_state = TokenState::kS_DONE;
                     } break;
                     case CharType::kRBRACK: {
-                        curr_token_val_ += NextChar();
+                        NextChar();
                         curr_token_ = TokenType::kRBRACK;
                         curr_state = TokenState::kS_DONE;
                     } break;
                     case CharType::kLP: {
-                        curr_token_val_ += NextChar();
+                        NextChar();
                         curr_token_ = TokenType::kLPAREN;
                         curr_state = TokenState::kS_DONE;
                     } break;
                     case CharType::kRP: {
-                        curr_token_val_ += NextChar();
+                        NextChar();
                         curr_token_ = TokenType::kRPAREN;
                         curr_state = TokenState::kS_DONE;
                     } break;
                     case CharType::kLBRACE: {
-                        curr_token_val_ += NextChar();
+                        NextChar();
                         curr_token_ = TokenType::kLBRACE;
                         curr_state = TokenState::kS_DONE;
                     } break;
                     case CharType::kRBRACE: {
-                        curr_token_val_ += NextChar();
+                        NextChar();
                         curr_token_ = TokenType::kRBRACE;
                         curr_state = TokenState::kS_DONE;
                     } break;
                     case CharType::kCOMMA: {
-                        curr_token_val_ += NextChar();
+                        NextChar();
                         curr_token_ = TokenType::kCOMMA;
                         curr_state = TokenState::kS_DONE;
                     } break;
                     case CharType::kDOT: {
-                        curr_token_val_ += NextChar();
+                        NextChar();
                         switch(mCharType[PeekChar()]) {
                             case CharType::kDIGIT: {
                                 curr_state = TokenState::kS_REAL_NUMBER;
@@ -490,13 +671,38 @@ TokenType Tokenizer::NextToken() {
                             }
                         }
                     } break;
+                    case CharType::kQUEST: {
+                        // Positional placeholder, the token text is empty
+                        NextChar();
+                        tok_begin_ = cur_;
+                        curr_token_ = TokenType::kPLACEHOLDER;
+                        curr_state = TokenState::kS_DONE;
+                    } break;
+                    case CharType::kDOLLAR: {
+                        // Named placeholder, the token text is the name without the $
+                        NextChar();
+                        switch(mCharType[PeekChar()]) {
+                            case CharType::kALPHA:
+                            case CharType::kUNDER: {
+                                tok_begin_ = cur_;
+                                ScanIdentifier();
+                                curr_token_ = TokenType::kPLACEHOLDER;
+                                curr_state = TokenState::kS_DONE;
+                            } break;
+                            default: {
+                                curr_token_ = TokenType::kERROR;
+                                curr_token_val_ = "Expected a parameter name after $";
+                                curr_state = TokenState::kS_ERROR;
+                            }
+                        }
+                    } break;
                     case CharType::kCOLON: {
-                        curr_token_val_ += NextChar();
+                        NextChar();
                         curr_token_ = TokenType::kCOLON;
                         curr_state = TokenState::kS_DONE;
                     } break;
                     case CharType::kSCOLON: {
-                        curr_token_val_ += NextChar();
+                        NextChar();
                         curr_token_ = TokenType::kSCOLON;
                         curr_state = TokenState::kS_DONE;
                     } break;
@@ -514,23 +720,24 @@ TokenType Tokenizer::NextToken() {
                 curr_state = ScanIdentifier();
             } break;
             case TokenState::kS_REAL_NUMBER: {
-                curr_state = ScanNumber();
+                curr_state = ScanNumber(TokenState::kS_REAL_NUMBER);
             } break;
             case TokenState::kS_COMMENT: {
-                curr_token_val_ = "";
                 curr_token_ = TokenType::kEOF;
-                while(PeekChar() != '\n' && PeekChar() != '\0') {
-                    NextChar();
-                }
+                do {
+                    cur_ = ScanCommentBody(cur_, lim_);
+                    tok_begin_ = cur_;
+                } while (cur_ == lim_ && Refill());
                 if (PeekChar() == '\0') {
                     curr_state = TokenState::kS_NULL;
                 } else {
                     NextChar();
+                    ++line_;
                     curr_state = TokenState::kS0;
                 }
             } break;
             case TokenState::kS_NULL: {
-                if (fr_.End() || str_i_ == static_cast<uint32_t>(str_.size())) {
+                if (cur_ == lim_ && !Refill()) {
                     curr_token_ = TokenType::kEOF;
                     curr_state = TokenState::kS_DONE;
                 } else {
@@ -547,42 +754,33 @@ TokenType Tokenizer::NextToken() {
             }
         }
     }
+
+    if (tok_decoded_) {
+        curr_token_view_ = curr_token_val_;
+    } else {
+        const uint8_t* tok_end = (tok_end_ != nullptr) ? tok_end_ : cur_;
+        curr_token_view_ = std::string_view(reinterpret_cast<const char*>(tok_begin_), static_cast<size_t>(tok_end - tok_begin_));
+    }
     return curr_token_;
 }
 
 TokenState Tokenizer::ScanIdentifier() {
-    TokenState curr_state = TokenState::kS_IDENTIFIER;
-    while (curr_state == TokenState::kS_IDENTIFIER) {
-        switch(mCharType[PeekChar()]) {
-            case CharType::kUNDER: {
-                curr_token_val_ += NextChar();
-            } break;
-            case CharType::kALPHA: {
-                curr_token_val_ += NextChar();
-            } break;
-            case CharType::kDIGIT: {
-                curr_token_val_ += NextChar();
-            } break;
-            default: {
-                curr_token_ = TokenType::kIDENTIFIER;
-                curr_state = TokenState::kS_DONE;
-            }
-        }
-    }
-    return curr_state;
+    do {
+        cur_ = ScanIdentifierRun(cur_, lim_);
+    } while (cur_ == lim_ && Refill());
+    curr_token_ = TokenType::kIDENTIFIER;
+    return TokenState::kS_DONE;
 }
 
-TokenState Tokenizer::ScanNumber() {
-    TokenState curr_state = TokenState::kS_INTEGER;
-    if (curr_token_val_ == ".") {
-        curr_state = TokenState::kS_REAL_NUMBER;
-    }
+TokenState Tokenizer::ScanNumber(TokenState start_state) {
+    TokenState curr_state = start_state;
     while (curr_state == TokenState::kS_INTEGER || curr_state == TokenState::kS_REAL_NUMBER || curr_state == TokenState::kS_DOT) {
         switch(curr_state) {
             case TokenState::kS_INTEGER: {
                 switch(mCharType[PeekChar()]) {
                     case CharType::kDIGIT: {
-                        curr_token_val_ += NextChar();
+                        while (cur_ < lim_ && IsDigit(*cur_))
+                            ++cur_;
                     } break;
                     case CharType::kDOT: {
                         curr_state = TokenState::kS_DOT;
@@ -596,7 +794,8 @@ TokenState Tokenizer::ScanNumber() {
             case TokenState::kS_REAL_NUMBER: {
                 switch(mCharType[PeekChar()]) {
                     case CharType::kDIGIT: {
-                        curr_token_val_ += NextChar();
+                        while (cur_ < lim_ && IsDigit(*cur_))
+                            ++cur_;
                     } break;
                     default: {
                         curr_token_ = TokenType::kREAL_NUMBER;
@@ -605,7 +804,7 @@ TokenState Tokenizer::ScanNumber() {
                 }
             } break;
             case TokenState::kS_DOT: {
-                curr_token_val_ += NextChar();
+                NextChar();
                 curr_state = TokenState::kS_REAL_NUMBER;
             } break;
             default: {
@@ -618,17 +817,24 @@ TokenState Tokenizer::ScanNumber() {
 
 TokenState Tokenizer::ScanString() {
     NextChar(); // Read in the start quote
+    tok_begin_ = cur_;
     TokenState curr_state = TokenState::kS_STRING_LITERAL;
-    while(curr_state == TokenState::kS_STRING_LITERAL || curr_state == TokenState::kS_FORWARD_SLASH) {
+    while(curr_state == TokenState::kS_STRING_LITERAL || curr_state == TokenState::kS_ESCAPE) {
         switch(curr_state) {
             case TokenState::kS_STRING_LITERAL: {
                 switch(mCharType[PeekChar()]) {
                     case CharType::kDQUOTE: {
+                        tok_end_ = cur_;
                         NextChar();
                         curr_token_ = TokenType::kSTRING_LITERAL;
                         curr_state = TokenState::kS_DONE;
                     } break;
-                    case CharType::kFSLASH: {
+                    case CharType::kBSLASH: {
+                        // Escapes need a decoded copy, start it from what was scanned so far
+                        if (!tok_decoded_) {
+                            curr_token_val_.assign(reinterpret_cast<const char*>(tok_begin_), static_cast<size_t>(cur_ - tok_begin_));
+                            tok_decoded_ = true;
+                        }
                         NextChar();
                         curr_state = TokenState::kS_ESCAPE;
                     } break; 
@@ -643,7 +849,10 @@ TokenState Tokenizer::ScanString() {
                         curr_state = TokenState::kS_ERROR;
                     } break;
                     default: {
-                        curr_token_val_ += NextChar();
+                        const uint8_t* run = cur_;
+                        cur_ = ScanStringBody(cur_, lim_);
+                        if (tok_decoded_)
+                            curr_token_val_.append(reinterpret_cast<const char*>(run), static_cast<size_t>(cur_ - run));
                     }
                 }
             } break;
@@ -705,6 +914,7 @@ TokenState Tokenizer::ScanString() {
                         curr_state = TokenState::kS_STRING_LITERAL;
                     } break;
                     default: {
+                        curr_token_ = TokenType::kERROR;
                         curr_token_val_ = "Unkown escape character";
                         curr_state = TokenState::kS_ERROR;
                     }
@@ -717,273 +927,9 @@ TokenState Tokenizer::ScanString() {
     return curr_state;
 }
 
-#define KEYWORD_CASE(CURR_STATE, CHAR, NEXT_STATE) \
-case CURR_STATE: { \
-    if (PeekChar() == CHAR) { \
-        curr_token_val_ += NextChar(); \
-        curr_state = NEXT_STATE; \
-    } else {\
-        return TokenState::kS_IDENTIFIER; \
-    } \
-} break;
-
-#define KEYWORD_CASE_2(CURR_STATE, CHAR1, NEXT1, CHAR2, NEXT2) \
-case CURR_STATE: {\
-    if (PeekChar() == CHAR1) {\
-        curr_token_val_ += NextChar();\
-        curr_state = NEXT1;\
-    } else if (PeekChar() == CHAR2) {\
-        curr_token_val_ += NextChar();\
-        curr_state = NEXT2;\
-    } else {\
-        return TokenState::kS_IDENTIFIER;\
-    } \
-}break;
-
-#define KEYWORD_CASE_3(CURR_STATE, CHAR1, NEXT1, CHAR2, NEXT2, CHAR3, NEXT3) \
-case CURR_STATE: {\
-    if (PeekChar() == CHAR1) {\
-        curr_token_val_ += NextChar();\
-        curr_state = NEXT1;\
-    } else if (PeekChar() == CHAR2) {\
-        curr_token_val_ += NextChar();\
-        curr_state = NEXT2;\
-    } else if (PeekChar() == CHAR3) {\
-        curr_token_val_ += NextChar();\
-        curr_state = NEXT3;\
-    } else {\
-        return TokenState::kS_IDENTIFIER;\
-    } \
-}break;
-
-#define FINAL_CASE(CURR_STATE, FINAL_TOKEN) \
-case CURR_STATE: { \
-    CharType next_type = mCharType[PeekChar()]; \
-    if (next_type == CharType::kALPHA || next_type == CharType::kDIGIT || next_type == CharType::kUNDER) { \
-        return TokenState::kS_IDENTIFIER; \
-    } else { \
-        curr_token_ = FINAL_TOKEN; \
-        return TokenState::kS_DONE; \
-    } \
-} break; 
-
 TokenState Tokenizer::ScanKeyword() {
-    TokenState curr_state = TokenState::kS0;
-    while(1) {
-        switch(curr_state) {
-            case TokenState::kS0: {
-                switch(PeekChar()) {
-                    case 's': {
-                        curr_token_val_ += NextChar();
-                        curr_state = TokenState::kS_S;
-                    } break;
-                    case 'b': {
-                        curr_token_val_ += NextChar();
-                        curr_state = TokenState::kS_B;
-                    } break;
-                    case 'i': {
-                        curr_token_val_ += NextChar();
-                        curr_state = TokenState::kS_I;
-                    } break;
-                    case 'l': {
-                        curr_token_val_ += NextChar();
-                        curr_state = TokenState::kS_L;
-                    } break;
-                    case 'f': {
-                        curr_token_val_ += NextChar();
-                        curr_state = TokenState::kS_F;
-                    } break;
-                    case 'd': {
-                        curr_token_val_ += NextChar();
-                        curr_state = TokenState::kS_D;
-                    } break;
-                    case 'c': {
-                        curr_token_val_ += NextChar();
-                        curr_state = TokenState::kS_C;
-                    } break;
-                    case 'u': {
-                        curr_token_val_ += NextChar();
-                        curr_state = TokenState::kS_U;
-                    } break;
-                    case 'n': {
-                        curr_token_val_ += NextChar();
-                        curr_state = TokenState::kS_N;
-                    } break;
-                    case 'p': {
-                        curr_token_val_ += NextChar();
-                        curr_state = TokenState::kS_P;
-                    } break;
-                    case 'w': {
-                        curr_token_val_ += NextChar();
-                        curr_state = TokenState::kS_W;
-                    } break;
-                    case 'r': {
-                        curr_token_val_ += NextChar();
-                        curr_state = TokenState::kS_R;
-                    } break;
-                    case 't': {
-                        curr_token_val_ += NextChar();
-                        curr_state = TokenState::kS_T;
-                    } break;
-                    default: {
-                        return TokenState::kS_IDENTIFIER;
-                    }
-                }
-            } break;
-            // BYTE
-            KEYWORD_CASE_2(TokenState::kS_B, 'y', TokenState::kS_BY, 'o', TokenState::kS_BO)
-            KEYWORD_CASE(TokenState::kS_BY, 't', TokenState::kS_BYT)
-            KEYWORD_CASE(TokenState::kS_BYT, 'e', TokenState::kS_BYTE)
-            FINAL_CASE(TokenState::kS_BYTE, TokenType::kBYTE)
-            // BOOL
-            KEYWORD_CASE(TokenState::kS_BO, 'o', TokenState::kS_BOO)
-            KEYWORD_CASE(TokenState::kS_BOO, 'l', TokenState::kS_BOOL)
-            FINAL_CASE(TokenState::kS_BOOL, TokenType::kBOOL_OR)
-            // INT
-            KEYWORD_CASE(TokenState::kS_I, 'n', TokenState::kS_IN)
-            KEYWORD_CASE(TokenState::kS_IN, 't', TokenState::kS_INT)
-            FINAL_CASE(TokenState::kS_INT, TokenType::kINT);
-            // LONG
-            KEYWORD_CASE(TokenState::kS_L, 'o', TokenState::kS_LO)
-            KEYWORD_CASE(TokenState::kS_LO, 'n', TokenState::kS_LON)
-            KEYWORD_CASE(TokenState::kS_LON, 'g', TokenState::kS_LONG)
-            FINAL_CASE(TokenState::kS_LONG, TokenType::kLONG)
-            // FLOAT
-            KEYWORD_CASE_3(TokenState::kS_F, 'l', TokenState::kS_FL, 'o', TokenState::kS_FO, 'a', TokenState::kS_FA)
-            KEYWORD_CASE(TokenState::kS_FL, 'o', TokenState::kS_FLO)
-            KEYWORD_CASE(TokenState::kS_FLO, 'a', TokenState::kS_FLOA)
-            KEYWORD_CASE(TokenState::kS_FLOA, 't', TokenState::kS_FLOAT)
-            FINAL_CASE(TokenState::kS_FLOAT, TokenType::kFLOAT)
-            // FOR
-            KEYWORD_CASE(TokenState::kS_FO, 'r', TokenState::kS_FOR)
-            FINAL_CASE(TokenState::kS_FOR, TokenType::kFOR)
-            // FALSE
-            KEYWORD_CASE(TokenState::kS_FA, 'l', TokenState::kS_FAL)
-            KEYWORD_CASE(TokenState::kS_FAL, 's', TokenState::kS_FALS)
-            KEYWORD_CASE(TokenState::kS_FALS, 'e', TokenState::kS_FALSE)
-            FINAL_CASE(TokenState::kS_FALSE, TokenType::kFALSE)
-            // True
-            KEYWORD_CASE(TokenState::kS_T, 'r', TokenState::kS_TR)
-            KEYWORD_CASE(TokenState::kS_TR, 'u', TokenState::kS_TRU)
-            KEYWORD_CASE(TokenState::kS_TRU, 'e', TokenState::kS_TRUE)
-            FINAL_CASE(TokenState::kS_TRUE, TokenType::kTRUE)
-            // CONST
-            KEYWORD_CASE(TokenState::kS_C, 'o', TokenState::kS_CO)
-            KEYWORD_CASE(TokenState::kS_CO, 'n', TokenState::kS_CON)
-            KEYWORD_CASE(TokenState::kS_CON, 's', TokenState::kS_CONS)
-            KEYWORD_CASE(TokenState::kS_CONS, 't', TokenState::kS_CONST)
-            FINAL_CASE(TokenState::kS_CONST, TokenType::kCONST)
-            // UNSIGNED
-            KEYWORD_CASE(TokenState::kS_U, 'n', TokenState::kS_UN)
-            KEYWORD_CASE(TokenState::kS_UN, 's', TokenState::kS_UNS)
-            KEYWORD_CASE(TokenState::kS_UNS, 'i', TokenState::kS_UNSI)
-            KEYWORD_CASE(TokenState::kS_UNSI, 'g', TokenState::kS_UNSIG)
-            KEYWORD_CASE(TokenState::kS_UNSIG, 'n', TokenState::kS_UNSIGN)
-            KEYWORD_CASE(TokenState::kS_UNSIGN, 'e', TokenState::kS_UNSIGNE)
-            KEYWORD_CASE(TokenState::kS_UNSIGNE, 'd', TokenState::kS_UNSIGNED)
-            FINAL_CASE(TokenState::kS_UNSIGNED, TokenType::kUNSIGNED)
-            // PRIMARY
-            KEYWORD_CASE(TokenState::kS_P, 'r', TokenState::kS_PR)
-            KEYWORD_CASE(TokenState::kS_PR, 'i', TokenState::kS_PRI)
-            KEYWORD_CASE(TokenState::kS_PRI, 'm', TokenState::kS_PRIM)
-            KEYWORD_CASE(TokenState::kS_PRIM, 'a', TokenState::kS_PRIMA)
-            KEYWORD_CASE(TokenState::kS_PRIMA, 'r', TokenState::kS_PRIMAR)
-            KEYWORD_CASE(TokenState::kS_PRIMAR, 'y', TokenState::kS_PRIMARY)
-            FINAL_CASE(TokenState::kS_PRIMARY, TokenType::kPRIMARY)
-            // DOUBLE
-            KEYWORD_CASE_2(TokenState::kS_D, 'o', TokenState::kS_DO, 'e', TokenState::kS_DE)
-            KEYWORD_CASE(TokenState::kS_DO, 'u', TokenState::kS_DOU)
-            KEYWORD_CASE(TokenState::kS_DOU, 'b', TokenState::kS_DOUB)
-            KEYWORD_CASE(TokenState::kS_DOUB, 'l', TokenState::kS_DOUBL)
-            KEYWORD_CASE(TokenState::kS_DOUBL, 'e', TokenState::kS_DOUBLE)
-            FINAL_CASE(TokenState::kS_DOUBLE, TokenType::kDOUBLE)
-            // DELETE
-            KEYWORD_CASE(TokenState::kS_DE, 'l', TokenState::kS_DEL)
-            KEYWORD_CASE(TokenState::kS_DEL, 'e', TokenState::kS_DELE)
-            KEYWORD_CASE(TokenState::kS_DELE, 't', TokenState::kS_DELET)
-            KEYWORD_CASE(TokenState::kS_DELET, 'e', TokenState::kS_DELETE)
-            FINAL_CASE(TokenState::kS_DELETE, TokenType::kDELETE)
-            // NEW
-            KEYWORD_CASE_2(TokenState::kS_N, 'e', TokenState::kS_NE, 'o', TokenState::kS_NO)
-            KEYWORD_CASE(TokenState::kS_NE, 'w', TokenState::kS_NEW)
-            FINAL_CASE(TokenState::kS_NEW, TokenType::kNEW)
-            // NOTNULL
-            KEYWORD_CASE(TokenState::kS_NO, 't', TokenState::kS_NOT)
-            KEYWORD_CASE(TokenState::kS_NOT, 'n', TokenState::kS_NOTN)
-            KEYWORD_CASE(TokenState::kS_NOTN, 'u', TokenState::kS_NOTNU)
-            KEYWORD_CASE(TokenState::kS_NOTNU, 'l', TokenState::kS_NOTNUL)
-            KEYWORD_CASE(TokenState::kS_NOTNUL, 'l', TokenState::kS_NOTNULL)
-            FINAL_CASE(TokenState::kS_NOTNULL, TokenType::kNOTNULL)
-            // INITIAL STR
-            case TokenState::kS_S: {
-                switch(PeekChar()) {
-                    case 't': {
-                        curr_token_val_ += NextChar();
-                        curr_state = TokenState::kS_ST;
-                    } break;
-                    case 'h': {
-                        curr_token_val_ += NextChar();
-                        curr_state = TokenState::kS_SH;
-                    } break;
-                    case 'i': {
-                        curr_token_val_ += NextChar();
-                        curr_state = TokenState::kS_SI;
-                    } break;
-                    case 'e': {
-                        curr_token_val_ += NextChar();
-                        curr_state = TokenState::kS_SE;
-                    } break;
-                    default: return TokenState::kS_IDENTIFIER;
-                }
-            } break;
-            KEYWORD_CASE(TokenState::kS_ST, 'r', TokenState::kS_STR)
-            KEYWORD_CASE_2(TokenState::kS_STR, 'u', TokenState::kS_STRU, 'i', TokenState::kS_STRI)
-            // STRUCT
-            KEYWORD_CASE(TokenState::kS_STRU, 'c', TokenState::kS_STRUC)
-            KEYWORD_CASE(TokenState::kS_STRUC, 't', TokenState::kS_STRUCT)
-            FINAL_CASE(TokenState::kS_STRUCT, TokenType::kSTRUCT)
-            // STRING
-            KEYWORD_CASE(TokenState::kS_STRI, 'n', TokenState::kS_STRIN)
-            KEYWORD_CASE(TokenState::kS_STRIN, 'g', TokenState::kS_STRING)
-            FINAL_CASE(TokenState::kS_STRING, TokenType::kSTRING)
-            // SHORT
-            KEYWORD_CASE(TokenState::kS_SH, 'o', TokenState::kS_SHO)
-            KEYWORD_CASE(TokenState::kS_SHO, 'r', TokenState::kS_SHOR)
-            KEYWORD_CASE(TokenState::kS_SHOR, 't', TokenState::kS_SHORT)
-            FINAL_CASE(TokenState::kS_SHORT, TokenType::kSHORT)
-            // SIGNED
-            KEYWORD_CASE(TokenState::kS_SI, 'g', TokenState::kS_SIG)
-            KEYWORD_CASE(TokenState::kS_SIG, 'n', TokenState::kS_SIGN)
-            KEYWORD_CASE(TokenState::kS_SIGN, 'e', TokenState::kS_SIGNE)
-            KEYWORD_CASE(TokenState::kS_SIGNE, 'd', TokenState::kS_SIGNED)
-            FINAL_CASE(TokenState::kS_SIGNED, TokenType::kSIGNED)
-            // SECONDARY
-            KEYWORD_CASE(TokenState::kS_SE, 'c', TokenState::kS_SEC)
-            KEYWORD_CASE(TokenState::kS_SEC, 'o', TokenState::kS_SECO)
-            KEYWORD_CASE(TokenState::kS_SECO, 'n', TokenState::kS_SECON)
-            KEYWORD_CASE(TokenState::kS_SECON, 'd', TokenState::kS_SECOND)
-            KEYWORD_CASE(TokenState::kS_SECOND, 'a', TokenState::kS_SECONDA)
-            KEYWORD_CASE(TokenState::kS_SECONDA, 'r', TokenState::kS_SECONDAR)
-            KEYWORD_CASE(TokenState::kS_SECONDAR, 'y', TokenState::kS_SECONDARY)
-            FINAL_CASE(TokenState::kS_SECONDARY, TokenType::kSECONDARY)
-            // WHILE
-            KEYWORD_CASE(TokenState::kS_W, 'h', TokenState::kS_WH)
-            KEYWORD_CASE(TokenState::kS_WH, 'i', TokenState::kS_WHI)
-            KEYWORD_CASE(TokenState::kS_WHI, 'l', TokenState::kS_WHIL)
-            KEYWORD_CASE(TokenState::kS_WHIL, 'e', TokenState::kS_WHILE)
-            FINAL_CASE(TokenState::kS_WHILE, TokenType::kWHILE)
-            // RETURN
-            KEYWORD_CASE(TokenState::kS_R, 'e', TokenState::kS_RE)
-            KEYWORD_CASE(TokenState::kS_RE, 't', TokenState::kS_RET)
-            KEYWORD_CASE(TokenState::kS_RET, 'u', TokenState::kS_RETU)
-            KEYWORD_CASE(TokenState::kS_RETU, 'r', TokenState::kS_RETUR)
-            KEYWORD_CASE(TokenState::kS_RETUR, 'n', TokenState::kS_RETURN)
-            FINAL_CASE(TokenState::kS_RETURN, TokenType::kRETURN)
-            default: {
-                curr_token_ = TokenType::kERROR;
-                throw TokenException("Invalid state within ScanIdentifier");
-            }
-        }
-    }
-    return curr_state;
-}
\ No newline at end of file
+    // Scan the whole word once, then classify it, keywords never need a rescan
+    ScanIdentifier();
+    curr_token_ = LookupKeyword(tok_begin_, static_cast<size_t>(cur_ - tok_begin_));
+    return TokenState::kS_DONE;
+}
@@ -3,12 +3,15 @@
 
 // C++ includes
 #include <cstdint>
+#include <memory>
 #include <string>
+#include <string_view>
 
 // Local Includes
 #include <file/filereader.h>
 
 enum class TokenState : uint16_t;
+class TokenBuffer;
 
 enum class TokenType : uint8_t {
     // DATA TYPES
@@ -35,6 +38,9 @@ enum class TokenType : uint8_t {
     kNEW,
     kDELETE,
     kCOMMENT,
+    // CONDITIONALS
+    kIF,
+    kELSE,
     // LOOPS,
     kFOR,
     kWHILE,
@@ -47,6 +53,8 @@ enum class TokenType : uint8_t {
     kREAL_NUMBER,
     // STRINGS
     kSTRING_LITERAL,
+    // PARAMETERS
+    kPLACEHOLDER,
     // BOOLEAN OPERATORS
     kBOOL_AND,
     kBOOL_OR,
@@ -89,6 +97,10 @@ enum class TokenType : uint8_t {
     kERROR
 };
 
+/**
+ * @brief Name of a token type for debugging, e.g. "IDENTIFIER"
+ */
+const char* TokenTypeName(TokenType type) noexcept;
 
 /**
  * @brief Responsible for scanning tokens from either a file or SQL string
@@ -99,6 +111,7 @@ public:
      * TORS
      */
     Tokenizer() noexcept;
+    explicit Tokenizer(ReadMode file_mode) noexcept;
     ~Tokenizer() noexcept;
 
     /**
@@ -109,6 +122,11 @@ public:
     void OpenFile(const std::string& file_name);
     void OpenFile(const char* file_name);
 
+    /**
+     * @brief Scan text in place without copying it, text must outlive the scan
+     */
+    void OpenView(std::string_view text);
+
     /**
      * TOKENIZATION 
      */
@@ -116,6 +134,28 @@ public:
     TokenType NextToken();
     std::string CurrTokenValue() const noexcept;
 
+    /**
+     * @brief View of the current token's value without copying it
+     * 
+     * Points into the source for strings and mapped files, into the input window
+     * for streamed files, or into an internal buffer for string literals
+     * containing escapes. Valid until the next call to NextToken() or Open*().
+     */
+    std::string_view CurrTokenView() const noexcept;
+
+    /**
+     * @brief Line the current token starts on, counting from 1
+     */
+    uint32_t CurrTokenLine() const noexcept;
+
+    /**
+     * @brief Tokenize the rest of the input into buffer, replacing its contents
+     * 
+     * The buffer always ends with a kEOF token. Throws TokenException on the first
+     * malformed token, like NextToken().
+     */
+    void Tokenize(TokenBuffer& buffer);
+
     /**
      * DEBUG 
      */
@@ -125,26 +165,42 @@ private:
     /**
      * HELPERS 
      */
+    void SetSource(const uint8_t* src, size_t src_len) noexcept;
+    bool Refill();
     uint8_t NextChar();
     uint8_t PeekChar();
 
     TokenState ScanIdentifier();
     TokenState ScanKeyword();
-    TokenState ScanNumber();
+    TokenState ScanNumber(TokenState start_state);
     TokenState ScanString();
 
     /**
      * STATE INFO 
      */
-    uint32_t str_i_;
     std::string str_;
     FileReader fr_;
+    bool streaming_;
+    std::unique_ptr<uint8_t[]> window_;
+    size_t window_size_;
+
+    /**
+     * CURSOR INFO, every input is scanned as the contiguous window [cur_, lim_)
+     */
+    const uint8_t* cur_;
+    const uint8_t* lim_;
+    uint32_t line_;
 
     /**
      * CURR TOKEN INFO 
      */
     TokenType curr_token_;
     std::string curr_token_val_;
+    std::string_view curr_token_view_;
+    const uint8_t* tok_begin_;
+    const uint8_t* tok_end_;
+    bool tok_decoded_;
+    uint32_t tok_line_;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,450 @@
+// C++ Includes
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+
+// Local Includes
+#include "catalog.h"
+#include "exception/schema_exception.h"
+#include "record.h"
+
+// Size of the type id every record starts with
+#define TYPE_TAG_SIZE 4
+
+static inline uint32_t AlignUp(uint32_t value, uint32_t alignment) noexcept {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+/**
+ * @brief Place size bytes at alignment in the first padding gap that fits, or at the end
+ * @param gaps Unused [start, end) ranges before end, updated
+ * @param end The end of the layout so far, updated
+ * @return The offset of the placed bytes
+ */
+static uint32_t Place(std::vector<std::pair<uint32_t, uint32_t>>& gaps, uint32_t& end, uint32_t size, uint32_t alignment) {
+    for (size_t i = 0; i < gaps.size(); ++i) {
+        uint32_t start = AlignUp(gaps[i].first, alignment);
+        if (start + size > gaps[i].second)
+            continue;
+        std::pair<uint32_t, uint32_t> gap = gaps[i];
+        gaps.erase(gaps.begin() + i);
+        if (start + size < gap.second)
+            gaps.emplace_back(start + size, gap.second);
+        if (gap.first < start)
+            gaps.emplace_back(gap.first, start);
+        return start;
+    }
+    uint32_t start = AlignUp(end, alignment);
+    if (start > end)
+        gaps.emplace_back(end, start);
+    end = start + size;
+    return start;
+}
+
+/**
+ * RecordLayout
+ */
+RecordLayout::RecordLayout() noexcept
+: name_(), type_id_(NO_TYPE), base_id_(NO_TYPE), depth_(0), fixed_size_(0), alignment_(1), fields_(), field_index_(),
+  primary_field_(-1), secondary_fields_(), default_record_(), default_strings_()
+{}
+
+const std::string& RecordLayout::Name() const noexcept {
+    return name_;
+}
+
+uint32_t RecordLayout::TypeId() const noexcept {
+    return type_id_;
+}
+
+uint32_t RecordLayout::BaseId() const noexcept {
+    return base_id_;
+}
+
+uint32_t RecordLayout::Depth() const noexcept {
+    return depth_;
+}
+
+uint32_t RecordLayout::FixedSize() const noexcept {
+    return fixed_size_;
+}
+
+uint32_t RecordLayout::Alignment() const noexcept {
+    return alignment_;
+}
+
+size_t RecordLayout::FieldCount() const noexcept {
+    return fields_.size();
+}
+
+const FieldLayout& RecordLayout::Field(size_t index) const noexcept {
+    return fields_[index];
+}
+
+int32_t RecordLayout::FieldIndex(std::string_view name) const noexcept {
+    auto it = field_index_.find(std::string(name));
+    return (it != field_index_.end()) ? static_cast<int32_t>(it->second) : -1;
+}
+
+int32_t RecordLayout::PrimaryField() const noexcept {
+    return primary_field_;
+}
+
+const std::vector<uint32_t>& RecordLayout::SecondaryFields() const noexcept {
+    return secondary_fields_;
+}
+
+const std::vector<uint8_t>& RecordLayout::DefaultRecord() const noexcept {
+    return default_record_;
+}
+
+const std::vector<std::pair<uint32_t, std::string>>& RecordLayout::DefaultStrings() const noexcept {
+    return default_strings_;
+}
+
+/**
+ * SchemaCatalog
+ */
+SchemaCatalog::SchemaCatalog() noexcept
+: layouts_(), by_name_()
+{}
+
+SchemaCatalog::~SchemaCatalog() noexcept {}
+
+size_t SchemaCatalog::Size() const noexcept {
+    return layouts_.size();
+}
+
+const RecordLayout* SchemaCatalog::Find(std::string_view name) const noexcept {
+    auto it = by_name_.find(std::string(name));
+    return (it != by_name_.end()) ? layouts_[it->second].get() : nullptr;
+}
+
+const RecordLayout& SchemaCatalog::Get(uint32_t type_id) const noexcept {
+    return *layouts_[type_id];
+}
+
+bool SchemaCatalog::IsA(uint32_t type_id, uint32_t base_id) const noexcept {
+    while (type_id != NO_TYPE) {
+        if (type_id == base_id)
+            return true;
+        type_id = layouts_[type_id]->base_id_;
+    }
+    return false;
+}
+
+void SchemaCatalog::AddProgram(const AstNode* program) {
+    for (const AstNode* node = program->first_child; node != nullptr; node = node->next_sibling) {
+        if (node->kind == AstKind::kSTRUCT_DECL)
+            AddStruct(node);
+    }
+}
+
+const RecordLayout& SchemaCatalog::AddStruct(const AstNode* decl) {
+    std::string name(decl->text);
+    if (by_name_.count(name) != 0)
+        throw SchemaException("Line " + std::to_string(decl->line) + ": struct " + name + " is already declared");
+
+    std::unique_ptr<RecordLayout> layout(new RecordLayout());
+    layout->name_ = name;
+    layout->type_id_ = static_cast<uint32_t>(layouts_.size());
+
+    // Start from the base's layout, or from just the type tag
+    const AstNode* member = decl->first_child;
+    uint32_t offset = TYPE_TAG_SIZE;
+    layout->alignment_ = TYPE_TAG_SIZE;
+    if (member != nullptr && member->kind == AstKind::kBASE) {
+        const RecordLayout* base = Find(member->text);
+        if (base == nullptr)
+            throw SchemaException("Line " + std::to_string(member->line) + ": unknown base struct " + std::string(member->text));
+        layout->base_id_ = base->type_id_;
+        layout->depth_ = base->depth_ + 1;
+        layout->fields_ = base->fields_;
+        layout->field_index_ = base->field_index_;
+        layout->primary_field_ = base->primary_field_;
+        layout->secondary_fields_ = base->secondary_fields_;
+        layout->default_record_ = base->default_record_;
+        layout->default_strings_ = base->default_strings_;
+        layout->alignment_ = base->alignment_;
+        offset = base->fixed_size_;
+        member = member->next_sibling;
+    }
+
+    // Compile this level's members, members redeclared from a base only change the default
+    std::vector<FieldLayout> own;
+    std::vector<const AstNode*> own_defaults;
+    std::vector<std::pair<uint32_t, const AstNode*>> overrides;
+    bool own_primary = false;
+    for (; member != nullptr; member = member->next_sibling) {
+        std::string field_name(member->text);
+        const AstNode* init = member->Child(1);
+        int32_t inherited = layout->FieldIndex(field_name);
+        if (inherited >= 0 && layout->fields_[inherited].declared_in != layout->type_id_) {
+            FieldLayout redeclared;
+            CompileField(*layout, member, redeclared);
+            const FieldLayout& original = layout->fields_[inherited];
+            if (redeclared.type != original.type || redeclared.is_array != original.is_array ||
+                redeclared.struct_type != original.struct_type || redeclared.modifiers != 0)
+                throw SchemaException("Line " + std::to_string(member->line) + ": " + field_name +
+                                      " can only override the default of the inherited member");
+            overrides.emplace_back(static_cast<uint32_t>(inherited), init);
+            continue;
+        }
+        for (const FieldLayout& field : own) {
+            if (field.name == field_name)
+                throw SchemaException("Line " + std::to_string(member->line) + ": duplicate member " + field_name);
+        }
+        own.emplace_back();
+        CompileField(*layout, member, own.back());
+        if (own.back().modifiers & kMOD_PRIMARY) {
+            if (own_primary)
+                throw SchemaException("Line " + std::to_string(member->line) + ": " + name + " already has a primary key");
+            own_primary = true;
+        }
+        own_defaults.push_back(init);
+    }
+
+    // Pack this level by descending alignment, first fit into the padding left so far, then the null bitmap
+    std::vector<uint32_t> order(own.size());
+    for (uint32_t i = 0; i < order.size(); ++i)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&own](uint32_t a, uint32_t b) {
+        return own[a].alignment > own[b].alignment;
+    });
+    std::vector<std::pair<uint32_t, uint32_t>> gaps;
+    for (uint32_t index : order) {
+        own[index].offset = Place(gaps, offset, own[index].size, own[index].alignment);
+        layout->alignment_ = std::max(layout->alignment_, own[index].alignment);
+    }
+    uint32_t bitmap = Place(gaps, offset, static_cast<uint32_t>((own.size() + 7) / 8), 1);
+    for (uint32_t i = 0; i < own.size(); ++i) {
+        own[i].null_offset = bitmap + i / 8;
+        own[i].null_mask = static_cast<uint8_t>(1u << (i % 8));
+    }
+    layout->fixed_size_ = AlignUp(offset, layout->alignment_);
+
+    // Fields start out null, then take their defaults
+    layout->default_record_.resize(layout->fixed_size_, 0);
+    memcpy(layout->default_record_.data(), &layout->type_id_, TYPE_TAG_SIZE);
+    for (uint32_t i = 0; i < own.size(); ++i) {
+        FieldLayout& field = own[i];
+        layout->default_record_[field.null_offset] |= field.null_mask;
+        if (field.type == FieldType::kSTRUCT && !field.is_array) {
+            // An embedded struct carries its own defaults, its var slots are relative to the outer record
+            const RecordLayout& nested = *layouts_[field.struct_type];
+            memcpy(layout->default_record_.data() + field.offset, nested.default_record_.data(), nested.fixed_size_);
+            for (const auto& str : nested.default_strings_)
+                layout->default_strings_.emplace_back(field.offset + str.first, str.second);
+        }
+        if (own_defaults[i] != nullptr)
+            CompileDefault(*layout, field, own_defaults[i]);
+        layout->field_index_[field.name] = static_cast<uint32_t>(layout->fields_.size() + i);
+    }
+    for (uint32_t i = 0; i < own.size(); ++i) {
+        uint32_t index = static_cast<uint32_t>(layout->fields_.size());
+        if (own[i].modifiers & kMOD_PRIMARY)
+            layout->primary_field_ = static_cast<int32_t>(index);
+        if (own[i].modifiers & kMOD_SECONDARY)
+            layout->secondary_fields_.push_back(index);
+        layout->fields_.push_back(std::move(own[i]));
+    }
+    for (const auto& override : overrides) {
+        if (override.second == nullptr)
+            continue;
+        FieldLayout& field = layout->fields_[override.first];
+        auto stale = std::remove_if(layout->default_strings_.begin(), layout->default_strings_.end(),
+                                    [&field](const std::pair<uint32_t, std::string>& str) { return str.first == field.offset; });
+        layout->default_strings_.erase(stale, layout->default_strings_.end());
+        CompileDefault(*layout, field, override.second);
+    }
+
+    by_name_[name] = layout->type_id_;
+    layouts_.push_back(std::move(layout));
+    return *layouts_.back();
+}
+
+void SchemaCatalog::CompileField(const RecordLayout& layout, const AstNode* member, FieldLayout& field) const {
+    const AstNode* type = member->Child(0);
+    std::string line = "Line " + std::to_string(member->line) + ": ";
+    field.name = std::string(member->text);
+    field.modifiers = member->flags;
+    field.is_array = (type->flags & kAST_ARRAY) != 0;
+    field.is_signed = !(member->flags & kMOD_UNSIGNED);
+    field.struct_type = NO_TYPE;
+    field.max_length = 0;
+    field.declared_in = layout.type_id_;
+    field.default_kind = DefaultKind::kNONE;
+    field.offset = 0;
+    field.null_offset = 0;
+    field.null_mask = 0;
+    // A primary key identifies the record, so it can never be null
+    if (field.modifiers & kMOD_PRIMARY)
+        field.modifiers |= kMOD_NOTNULL;
+
+    uint32_t element_size = 0;
+    uint32_t element_alignment = 1;
+    switch (type->op) {
+        case TokenType::kBYTE: field.type = FieldType::kBYTE; element_size = 1; break;
+        case TokenType::kSHORT: field.type = FieldType::kSHORT; element_size = 2; break;
+        case TokenType::kINT: field.type = FieldType::kINT; element_size = 4; break;
+        case TokenType::kLONG: field.type = FieldType::kLONG; element_size = 8; break;
+        case TokenType::kFLOAT: field.type = FieldType::kFLOAT; element_size = 4; break;
+        case TokenType::kDOUBLE: field.type = FieldType::kDOUBLE; element_size = 8; break;
+        case TokenType::kBOOL: field.type = FieldType::kBOOL; element_size = 1; break;
+        case TokenType::kSTRING: field.type = FieldType::kSTRING; element_size = sizeof(VarSlot); break;
+        default: {
+            // A struct typed member, a pointer may refer to the struct being declared
+            if (type->text == layout.name_ && (type->flags & kAST_POINTER_MASK)) {
+                field.struct_type = layout.type_id_;
+            } else {
+                const RecordLayout* target = Find(type->text);
+                if (target == nullptr)
+                    throw SchemaException(line + "unknown type " + std::string(type->text));
+                field.struct_type = target->type_id_;
+                element_size = target->fixed_size_;
+                element_alignment = target->alignment_;
+            }
+            field.type = FieldType::kSTRUCT;
+        }
+    }
+    if (field.type != FieldType::kSTRUCT)
+        element_alignment = (field.type == FieldType::kSTRING) ? alignof(VarSlot) : element_size;
+
+    if (type->flags & kAST_POINTER_MASK) {
+        field.type = FieldType::kPOINTER;
+        element_size = element_alignment = sizeof(uint64_t);
+    }
+    field.element_size = element_size;
+    if (field.is_array) {
+        field.size = sizeof(VarSlot);
+        field.alignment = alignof(VarSlot);
+        const AstNode* length = type->first_child;
+        if (length != nullptr) {
+            if (length->kind != AstKind::kINTEGER)
+                throw SchemaException(line + "array lengths must be integer constants");
+            unsigned long long max_length = strtoull(std::string(length->text).c_str(), nullptr, 10);
+            if (max_length == 0 || max_length > UINT32_MAX)
+                throw SchemaException(line + "invalid array length");
+            field.max_length = static_cast<uint32_t>(max_length);
+        }
+    } else {
+        field.size = element_size;
+        field.alignment = element_alignment;
+    }
+
+    if ((field.modifiers & (kMOD_PRIMARY | kMOD_SECONDARY)) &&
+        (field.is_array || field.type == FieldType::kSTRUCT || field.type == FieldType::kPOINTER))
+        throw SchemaException(line + "arrays, embedded structs and pointers cannot be keys");
+}
+
+/**
+ * @brief Evaluate a literal, optionally negated, into either an integer or a real
+ */
+static bool ConstantNumber(const AstNode* value, bool& is_real, int64_t& integer, double& real) {
+    bool negate = false;
+    while (value->kind == AstKind::kUNARY && (value->op == TokenType::kMINUS || value->op == TokenType::kPLUS)) {
+        if (value->op == TokenType::kMINUS)
+            negate = !negate;
+        value = value->first_child;
+    }
+    std::string text(value->text);
+    if (value->kind == AstKind::kINTEGER) {
+        errno = 0;
+        unsigned long long magnitude = strtoull(text.c_str(), nullptr, 10);
+        if (errno == ERANGE || magnitude > static_cast<unsigned long long>(INT64_MAX) + (negate ? 1 : 0))
+            return false;
+        is_real = false;
+        integer = negate ? static_cast<int64_t>(0 - magnitude) : static_cast<int64_t>(magnitude);
+        return true;
+    }
+    if (value->kind == AstKind::kREAL) {
+        is_real = true;
+        real = strtod(text.c_str(), nullptr);
+        real = negate ? -real : real;
+        return true;
+    }
+    return false;
+}
+
+void SchemaCatalog::CompileDefault(RecordLayout& layout, FieldLayout& field, const AstNode* value) const {
+    std::string line = "Line " + std::to_string(value->line) + ": ";
+    uint8_t* record = layout.default_record_.data();
+
+    // Default functions, e.g. auto_increment(100), with integer constant arguments
+    if (value->kind == AstKind::kCALL && value->first_child->kind == AstKind::kIDENTIFIER) {
+        field.default_kind = DefaultKind::kFUNCTION;
+        field.default_function = std::string(value->first_child->text);
+        field.default_args.clear();
+        for (const AstNode* arg = value->first_child->next_sibling; arg != nullptr; arg = arg->next_sibling) {
+            bool is_real = false;
+            int64_t integer = 0;
+            double real = 0;
+            if (!arg->text.empty() || !ConstantNumber(arg->first_child, is_real, integer, real) || is_real)
+                throw SchemaException(line + "default function arguments must be integer constants");
+            field.default_args.push_back(integer);
+        }
+        return;
+    }
+
+    if (field.is_array || field.type == FieldType::kSTRUCT || field.type == FieldType::kPOINTER)
+        throw SchemaException(line + "only scalar and string members can have a default value");
+
+    switch (field.type) {
+        case FieldType::kSTRING: {
+            if (value->kind != AstKind::kSTRING)
+                throw SchemaException(line + "default of " + field.name + " must be a string");
+            VarSlot slot = {0, static_cast<uint32_t>(value->text.size())};
+            memcpy(record + field.offset, &slot, sizeof(slot));
+            layout.default_strings_.emplace_back(field.offset, std::string(value->text));
+        } break;
+        case FieldType::kBOOL: {
+            if (value->kind != AstKind::kBOOL)
+                throw SchemaException(line + "default of " + field.name + " must be true or false");
+            record[field.offset] = (value->op == TokenType::kTRUE) ? 1 : 0;
+        } break;
+        default: {
+            bool is_real = false;
+            int64_t integer = 0;
+            double real = 0;
+            if (!ConstantNumber(value, is_real, integer, real))
+                throw SchemaException(line + "default of " + field.name + " must be a constant or a default function");
+            if (field.type == FieldType::kFLOAT || field.type == FieldType::kDOUBLE) {
+                WriteReal(record, field, is_real ? real : static_cast<double>(integer));
+            } else {
+                if (is_real)
+                    throw SchemaException(line + "default of " + field.name + " must be an integer");
+                if (!WriteInteger(record, field, integer))
+                    throw SchemaException(line + "default of " + field.name + " is out of range");
+            }
+        }
+    }
+    field.default_kind = DefaultKind::kCONSTANT;
+    record[field.null_offset] &= static_cast<uint8_t>(~field.null_mask);
+}
+
+FieldLayout SchemaCatalog::Resolve(uint32_t type_id, std::string_view path) const {
+    const RecordLayout* layout = layouts_[type_id].get();
+    uint32_t base_offset = 0;
+    while (true) {
+        size_t dot = path.find('.');
+        std::string_view name = path.substr(0, dot);
+        int32_t index = layout->FieldIndex(name);
+        if (index < 0)
+            throw SchemaException(layout->name_ + " has no member " + std::string(name));
+        FieldLayout field = layout->fields_[index];
+        field.offset += base_offset;
+        field.null_offset += base_offset;
+        if (dot == std::string_view::npos)
+            return field;
+        if (field.type != FieldType::kSTRUCT || field.is_array)
+            throw SchemaException(std::string(name) + " is not an embedded struct");
+        base_offset = field.offset;
+        layout = layouts_[field.struct_type].get();
+        path = path.substr(dot + 1);
+    }
+}
@@ -0,0 +1,211 @@
+#ifndef DT_SRC_SCHEMA_CATALOG_H
+#define DT_SRC_SCHEMA_CATALOG_H
+
+// C++ Includes
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Local Includes
+#include "parser/ast.h"
+
+// Type id of a record layout that does not exist, e.g. the base of a root struct
+#define NO_TYPE UINT32_MAX
+
+/**
+ * @brief Storage type of a field
+ */
+enum class FieldType : uint8_t {
+    kBYTE,
+    kSHORT,
+    kINT,
+    kLONG,
+    kFLOAT,
+    kDOUBLE,
+    kBOOL,
+    kSTRING,    // Var slot into the out-of-line area
+    kSTRUCT,    // Embedded record, its fixed part is stored inline
+    kPOINTER    // 64-bit reference to another record
+};
+
+/**
+ * @brief How a field gets its value when an insert leaves it out
+ */
+enum class DefaultKind : uint8_t {
+    kNONE,      // Null
+    kCONSTANT,  // Stored in the layout's default record
+    kFUNCTION   // A default function such as auto_increment(100), evaluated on insert
+};
+
+/**
+ * @brief Where and how one field is stored in a record
+ * 
+ * Every offset is from the start of the record, so reading a field is a single
+ * offset add. Fields of embedded structs are resolved to the same form by
+ * RecordLayout::Resolve().
+ */
+struct FieldLayout {
+    std::string name;
+    FieldType type;
+    bool is_array;              // Stored as a var slot of elements, whatever the element type
+    bool is_signed;
+    uint16_t modifiers;         // kMOD_* flags
+    uint32_t offset;
+    uint32_t size;              // Bytes taken by the field in the fixed part
+    uint32_t alignment;
+    uint32_t null_offset;       // Byte of the null bitmap holding the field's bit
+    uint8_t null_mask;          // The field's bit, set while the field is null
+    uint32_t element_size;      // Size of one array element, the fixed size of an embedded struct
+    uint32_t struct_type;       // Layout of an embedded struct or a pointer's target, NO_TYPE otherwise
+    uint32_t max_length;        // Declared array length, 0 when unbounded
+    uint32_t declared_in;       // The struct that declared the field
+    DefaultKind default_kind;
+    std::string default_function;
+    std::vector<int64_t> default_args;
+};
+
+/**
+ * @brief The compiled layout of one struct
+ * 
+ * A record is a fixed part of FixedSize() bytes followed by an out-of-line area
+ * for strings and arrays. The fixed part starts with the uint32_t type id. Each
+ * inheritance level appends its own fields, packed by alignment, followed by a
+ * null bitmap for those fields, so a subclass layout starts with its base's
+ * layout byte for byte.
+ */
+class RecordLayout {
+public:
+    /**
+     * Identity
+     */
+    const std::string& Name() const noexcept;
+    uint32_t TypeId() const noexcept;
+    uint32_t BaseId() const noexcept;
+    uint32_t Depth() const noexcept;
+
+    /**
+     * Layout
+     */
+    uint32_t FixedSize() const noexcept;
+    uint32_t Alignment() const noexcept;
+
+    /**
+     * Fields, the base's fields first in declaration order
+     */
+    size_t FieldCount() const noexcept;
+    const FieldLayout& Field(size_t index) const noexcept;
+
+    /**
+     * @brief Index of a field by name, -1 when there is none
+     */
+    int32_t FieldIndex(std::string_view name) const noexcept;
+
+    /**
+     * @brief Index of the primary key of this struct's hierarchy level or the nearest base, -1 when there is none
+     */
+    int32_t PrimaryField() const noexcept;
+
+    /**
+     * @brief Indexes of every secondary key
+     */
+    const std::vector<uint32_t>& SecondaryFields() const noexcept;
+
+    /**
+     * @brief The fixed part of a record holding only defaults
+     */
+    const std::vector<uint8_t>& DefaultRecord() const noexcept;
+
+    /**
+     * @brief Constant string defaults, as the var slot offset they go to and their value
+     */
+    const std::vector<std::pair<uint32_t, std::string>>& DefaultStrings() const noexcept;
+
+private:
+    friend class SchemaCatalog;
+    RecordLayout() noexcept;
+
+    std::string name_;
+    uint32_t type_id_;
+    uint32_t base_id_;
+    uint32_t depth_;
+    uint32_t fixed_size_;
+    uint32_t alignment_;
+    std::vector<FieldLayout> fields_;
+    std::unordered_map<std::string, uint32_t> field_index_;
+    int32_t primary_field_;
+    std::vector<uint32_t> secondary_fields_;
+    std::vector<uint8_t> default_record_;
+    std::vector<std::pair<uint32_t, std::string>> default_strings_;
+};
+
+/**
+ * @brief Compiles parsed struct declarations into record layouts
+ */
+class SchemaCatalog {
+public:
+    /**
+     * Tors
+     */
+    SchemaCatalog() noexcept;
+    ~SchemaCatalog() noexcept;
+
+    /**
+     * NON-COPYABLE
+     */
+    SchemaCatalog(const SchemaCatalog&) = delete;
+    SchemaCatalog(SchemaCatalog&&) = delete;
+    SchemaCatalog& operator=(const SchemaCatalog&) = delete;
+
+    /**
+     * Compilation
+     */
+
+    /**
+     * @brief Compile every struct declaration of a program, in order
+     * @throws SchemaException for invalid declarations, bases and embedded structs must be declared first
+     */
+    void AddProgram(const AstNode* program);
+
+    /**
+     * @brief Compile one kSTRUCT_DECL node
+     * @throws SchemaException for invalid declarations
+     */
+    const RecordLayout& AddStruct(const AstNode* decl);
+
+    /**
+     * Lookup
+     */
+    size_t Size() const noexcept;
+    const RecordLayout* Find(std::string_view name) const noexcept;
+    const RecordLayout& Get(uint32_t type_id) const noexcept;
+
+    /**
+     * @brief Whether type_id is base_id or derives from it
+     */
+    bool IsA(uint32_t type_id, uint32_t base_id) const noexcept;
+
+    /**
+     * @brief Resolve a dotted member path like "address.city" to one field with absolute offsets
+     * @throws SchemaException when a member does not exist or is not an embedded struct
+     */
+    FieldLayout Resolve(uint32_t type_id, std::string_view path) const;
+
+private:
+    /**
+     * @brief Compile one member declaration into field, its offset is assigned afterwards
+     */
+    void CompileField(const RecordLayout& layout, const AstNode* member, FieldLayout& field) const;
+
+    /**
+     * @brief Write a constant default into the layout's default record
+     */
+    void CompileDefault(RecordLayout& layout, FieldLayout& field, const AstNode* value) const;
+
+    std::vector<std::unique_ptr<RecordLayout>> layouts_;
+    std::unordered_map<std::string, uint32_t> by_name_;
+};
+
+#endif
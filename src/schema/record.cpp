@@ -0,0 +1,207 @@
+// C++ Includes
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// Local Includes
+#include "exception/schema_exception.h"
+#include "record.h"
+
+int64_t ReadInteger(const uint8_t* record, const FieldLayout& field) noexcept {
+    switch (field.type) {
+        case FieldType::kBYTE:
+            return field.is_signed ? ReadField<int8_t>(record, field) : ReadField<uint8_t>(record, field);
+        case FieldType::kSHORT:
+            return field.is_signed ? ReadField<int16_t>(record, field) : ReadField<uint16_t>(record, field);
+        case FieldType::kINT:
+            // Both arms are widened first, int32_t and uint32_t alone would meet as uint32_t
+            if (field.is_signed)
+                return ReadField<int32_t>(record, field);
+            return ReadField<uint32_t>(record, field);
+        case FieldType::kLONG:
+        case FieldType::kPOINTER:
+            return ReadField<int64_t>(record, field);
+        case FieldType::kBOOL:
+            return ReadField<uint8_t>(record, field);
+        default:
+            return 0;
+    }
+}
+
+double ReadReal(const uint8_t* record, const FieldLayout& field) noexcept {
+    if (field.type == FieldType::kFLOAT)
+        return ReadField<float>(record, field);
+    return ReadField<double>(record, field);
+}
+
+template <typename T>
+static inline bool StoreChecked(uint8_t* record, uint32_t offset, int64_t value) noexcept {
+    T narrowed = static_cast<T>(value);
+    if (static_cast<int64_t>(narrowed) != value)
+        return false;
+    memcpy(record + offset, &narrowed, sizeof(T));
+    return true;
+}
+
+bool WriteInteger(uint8_t* record, const FieldLayout& field, int64_t value) noexcept {
+    switch (field.type) {
+        case FieldType::kBYTE:
+            return field.is_signed ? StoreChecked<int8_t>(record, field.offset, value) : StoreChecked<uint8_t>(record, field.offset, value);
+        case FieldType::kSHORT:
+            return field.is_signed ? StoreChecked<int16_t>(record, field.offset, value) : StoreChecked<uint16_t>(record, field.offset, value);
+        case FieldType::kINT:
+            return field.is_signed ? StoreChecked<int32_t>(record, field.offset, value) : StoreChecked<uint32_t>(record, field.offset, value);
+        case FieldType::kLONG: {
+            // Unsigned longs keep the bit pattern, negative values are rejected
+            if (!field.is_signed && value < 0)
+                return false;
+            memcpy(record + field.offset, &value, sizeof(value));
+            return true;
+        }
+        case FieldType::kBOOL: {
+            if (value != 0 && value != 1)
+                return false;
+            record[field.offset] = static_cast<uint8_t>(value);
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+void WriteReal(uint8_t* record, const FieldLayout& field, double value) noexcept {
+    if (field.type == FieldType::kFLOAT) {
+        float narrowed = static_cast<float>(value);
+        memcpy(record + field.offset, &narrowed, sizeof(narrowed));
+    } else {
+        memcpy(record + field.offset, &value, sizeof(value));
+    }
+}
+
+/**
+ * RecordBuilder
+ */
+RecordBuilder::RecordBuilder(const RecordLayout& layout)
+: layout_(layout), fixed_(), vars_()
+{
+    Reset();
+}
+
+RecordBuilder::~RecordBuilder() noexcept {}
+
+void RecordBuilder::Reset() {
+    fixed_ = layout_.DefaultRecord();
+    vars_ = layout_.DefaultStrings();
+}
+
+void RecordBuilder::SetNull(const FieldLayout& field) {
+    if (field.modifiers & kMOD_NOTNULL)
+        throw SchemaException(field.name + " cannot be null");
+    fixed_[field.null_offset] |= field.null_mask;
+    for (auto it = vars_.begin(); it != vars_.end(); ++it) {
+        if (it->first == field.offset) {
+            vars_.erase(it);
+            break;
+        }
+    }
+}
+
+void RecordBuilder::SetInteger(const FieldLayout& field, int64_t value) {
+    if (field.is_array)
+        throw SchemaException(field.name + " is an array");
+    if (field.type == FieldType::kFLOAT || field.type == FieldType::kDOUBLE) {
+        SetReal(field, static_cast<double>(value));
+        return;
+    }
+    if (!WriteInteger(fixed_.data(), field, value))
+        throw SchemaException(field.name + " cannot hold " + std::to_string(value));
+    fixed_[field.null_offset] &= static_cast<uint8_t>(~field.null_mask);
+}
+
+void RecordBuilder::SetReal(const FieldLayout& field, double value) {
+    if (field.is_array || (field.type != FieldType::kFLOAT && field.type != FieldType::kDOUBLE))
+        throw SchemaException(field.name + " is not a float or double");
+    WriteReal(fixed_.data(), field, value);
+    fixed_[field.null_offset] &= static_cast<uint8_t>(~field.null_mask);
+}
+
+void RecordBuilder::SetBool(const FieldLayout& field, bool value) {
+    if (field.is_array || field.type != FieldType::kBOOL)
+        throw SchemaException(field.name + " is not a bool");
+    WriteInteger(fixed_.data(), field, value ? 1 : 0);
+    fixed_[field.null_offset] &= static_cast<uint8_t>(~field.null_mask);
+}
+
+void RecordBuilder::SetString(const FieldLayout& field, std::string_view value) {
+    if (field.is_array || field.type != FieldType::kSTRING)
+        throw SchemaException(field.name + " is not a string");
+    SetVar(field, value, static_cast<uint32_t>(value.size()));
+}
+
+void RecordBuilder::SetPointer(const FieldLayout& field, uint64_t reference) {
+    if (field.is_array || field.type != FieldType::kPOINTER)
+        throw SchemaException(field.name + " is not a pointer");
+    memcpy(fixed_.data() + field.offset, &reference, sizeof(reference));
+    fixed_[field.null_offset] &= static_cast<uint8_t>(~field.null_mask);
+}
+
+void RecordBuilder::SetArray(const FieldLayout& field, const void* elements, uint32_t count) {
+    if (!field.is_array)
+        throw SchemaException(field.name + " is not an array");
+    if (field.max_length != 0 && count > field.max_length)
+        throw SchemaException(field.name + " holds at most " + std::to_string(field.max_length) + " elements");
+    SetVar(field, std::string_view(static_cast<const char*>(elements), static_cast<size_t>(count) * field.element_size), count);
+}
+
+void RecordBuilder::SetVar(const FieldLayout& field, std::string_view bytes, uint32_t length) {
+    VarSlot slot = {0, length};
+    memcpy(fixed_.data() + field.offset, &slot, sizeof(slot));
+    fixed_[field.null_offset] &= static_cast<uint8_t>(~field.null_mask);
+    for (auto& var : vars_) {
+        if (var.first == field.offset) {
+            var.second.assign(bytes.data(), bytes.size());
+            return;
+        }
+    }
+    vars_.emplace_back(field.offset, std::string(bytes));
+}
+
+const uint8_t* RecordBuilder::Fixed() const noexcept {
+    return fixed_.data();
+}
+
+std::string_view RecordBuilder::Var(const FieldLayout& field) const noexcept {
+    for (const auto& var : vars_) {
+        if (var.first == field.offset)
+            return var.second;
+    }
+    return std::string_view();
+}
+
+const RecordLayout& RecordBuilder::Layout() const noexcept {
+    return layout_;
+}
+
+std::vector<uint8_t> RecordBuilder::Finish() const {
+    for (size_t i = 0; i < layout_.FieldCount(); ++i) {
+        const FieldLayout& field = layout_.Field(i);
+        if ((field.modifiers & kMOD_NOTNULL) && FieldIsNull(fixed_.data(), field))
+            throw SchemaException(field.name + " cannot be null");
+    }
+
+    size_t size = fixed_.size();
+    for (const auto& var : vars_)
+        size += var.second.size();
+    std::vector<uint8_t> record(size);
+    memcpy(record.data(), fixed_.data(), fixed_.size());
+    uint32_t offset = static_cast<uint32_t>(fixed_.size());
+    for (const auto& var : vars_) {
+        VarSlot slot;
+        memcpy(&slot, record.data() + var.first, sizeof(slot));
+        slot.offset = offset;
+        memcpy(record.data() + var.first, &slot, sizeof(slot));
+        memcpy(record.data() + offset, var.second.data(), var.second.size());
+        offset += static_cast<uint32_t>(var.second.size());
+    }
+    return record;
+}
@@ -0,0 +1,130 @@
+#ifndef DT_SRC_SCHEMA_RECORD_H
+#define DT_SRC_SCHEMA_RECORD_H
+
+// C++ Includes
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Local Includes
+#include "schema/catalog.h"
+
+/**
+ * @brief Fixed part slot of a string or array, pointing into the record's out-of-line area
+ */
+struct VarSlot {
+    uint32_t offset;    // From the start of the record
+    uint32_t length;    // Bytes of a string, elements of an array
+};
+
+/**
+ * Record Access, every read is an offset add on the record
+ */
+inline uint32_t RecordTypeId(const uint8_t* record) noexcept {
+    uint32_t type_id;
+    memcpy(&type_id, record, sizeof(type_id));
+    return type_id;
+}
+
+inline bool FieldIsNull(const uint8_t* record, const FieldLayout& field) noexcept {
+    return (record[field.null_offset] & field.null_mask) != 0;
+}
+
+template <typename T>
+inline T ReadField(const uint8_t* record, const FieldLayout& field) noexcept {
+    T value;
+    memcpy(&value, record + field.offset, sizeof(T));
+    return value;
+}
+
+/**
+ * @brief Read any integer or bool field widened to 64 bits
+ */
+int64_t ReadInteger(const uint8_t* record, const FieldLayout& field) noexcept;
+
+/**
+ * @brief Read a float or double field
+ */
+double ReadReal(const uint8_t* record, const FieldLayout& field) noexcept;
+
+/**
+ * @brief The bytes of a string or array field
+ */
+inline std::string_view ReadVar(const uint8_t* record, const FieldLayout& field) noexcept {
+    VarSlot slot = ReadField<VarSlot>(record, field);
+    uint32_t bytes = field.is_array ? slot.length * field.element_size : slot.length;
+    return std::string_view(reinterpret_cast<const char*>(record) + slot.offset, bytes);
+}
+
+/**
+ * @brief Store an integer in an integer or bool field
+ * @return false when value does not fit the field
+ */
+bool WriteInteger(uint8_t* record, const FieldLayout& field, int64_t value) noexcept;
+
+/**
+ * @brief Store a real in a float or double field
+ */
+void WriteReal(uint8_t* record, const FieldLayout& field, double value) noexcept;
+
+/**
+ * @brief Builds one record, starting from the layout's defaults
+ */
+class RecordBuilder {
+public:
+    /**
+     * Tors
+     */
+    explicit RecordBuilder(const RecordLayout& layout);
+    ~RecordBuilder() noexcept;
+
+    /**
+     * @brief Start over from the layout's defaults
+     */
+    void Reset();
+
+    /**
+     * Setters, each clears the field's null bit, all throw SchemaException on a type mismatch
+     */
+    void SetNull(const FieldLayout& field);
+    void SetInteger(const FieldLayout& field, int64_t value);
+    void SetReal(const FieldLayout& field, double value);
+    void SetBool(const FieldLayout& field, bool value);
+    void SetString(const FieldLayout& field, std::string_view value);
+    void SetPointer(const FieldLayout& field, uint64_t reference);
+
+    /**
+     * @brief Store an array of count elements of field.element_size bytes each
+     */
+    void SetArray(const FieldLayout& field, const void* elements, uint32_t count);
+
+    /**
+     * @brief The fixed part as built so far
+     */
+    const uint8_t* Fixed() const noexcept;
+
+    /**
+     * @brief The bytes of a string or array field as built so far, empty when it is null
+     */
+    std::string_view Var(const FieldLayout& field) const noexcept;
+
+    const RecordLayout& Layout() const noexcept;
+
+    /**
+     * @brief Lay out the record, fixed part then out-of-line area
+     * @throws SchemaException when a notnull member is still null
+     */
+    std::vector<uint8_t> Finish() const;
+
+private:
+    void SetVar(const FieldLayout& field, std::string_view bytes, uint32_t length);
+
+    const RecordLayout& layout_;
+    std::vector<uint8_t> fixed_;
+    std::vector<std::pair<uint32_t, std::string>> vars_;
+};
+
+#endif
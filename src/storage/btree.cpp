@@ -0,0 +1,674 @@
+// C++ Includes
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// C Includes
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define DT_HAVE_X86_SIMD 1
+#endif
+
+// Local Includes
+#include "exception/file_exception.h"
+#include "btree.h"
+
+/**
+ * @brief The node fields after the PageHeader, the header's flags hold the tree's KeyType
+ */
+struct NodeHeader {
+    uint16_t count;
+    uint16_t level;             // 0 for leaves
+    uint16_t prefix_length;     // String trees, bytes every key of the node starts with
+    uint16_t prefix_offset;
+    uint32_t heap_top;          // Lowest byte of the entries
+    uint32_t garbage;           // Entry bytes no slot points at any more
+    uint32_t upper;             // Inner nodes, the child for keys at or above the last separator
+    uint32_t reserved;
+};
+static_assert(sizeof(NodeHeader) == 24, "NodeHeader is part of the file format");
+
+#define NODE_OFFSET sizeof(PageHeader)
+#define ARRAY_OFFSET (sizeof(PageHeader) + sizeof(NodeHeader))
+
+/**
+ * @brief An entry is a 16-bit suffix length and value length, then the suffix and value bytes
+ */
+#define ENTRY_HEADER 4
+
+/**
+ * @brief Search keys left for the SIMD kernels once binary search has narrowed the array
+ */
+#define SEARCH_WINDOW 16
+
+/**
+ * Search Kernels, counting the keys below (or at) a search key in a sorted array
+ */
+static size_t CountBelow64Scalar(const int64_t* keys, size_t n, int64_t key, bool or_equal) noexcept {
+    size_t count = 0;
+    for (size_t i = 0; i < n; ++i)
+        count += or_equal ? keys[i] <= key : keys[i] < key;
+    return count;
+}
+
+#ifdef DT_HAVE_X86_SIMD
+__attribute__((target("avx2")))
+static size_t CountBelow64Avx2(const int64_t* keys, size_t n, int64_t key, bool or_equal) noexcept {
+    __m256i needle = _mm256_set1_epi64x(key);
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i vector = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i));
+        // keys <= key is the complement of keys > key
+        __m256i mask = or_equal ? _mm256_cmpgt_epi64(vector, needle) : _mm256_cmpgt_epi64(needle, vector);
+        int bits = __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(mask)));
+        count += or_equal ? 4 - bits : bits;
+    }
+    return count + CountBelow64Scalar(keys + i, n - i, key, or_equal);
+}
+
+static bool HaveAvx2() noexcept {
+    // May run from a static initializer, before the runtime has probed the CPU
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+
+static const bool mHaveAvx2 = HaveAvx2();
+#endif
+
+static inline size_t CountBelow64(const int64_t* keys, size_t n, int64_t key, bool or_equal) noexcept {
+#ifdef DT_HAVE_X86_SIMD
+    if (mHaveAvx2)
+        return CountBelow64Avx2(keys, n, key, or_equal);
+#endif
+    return CountBelow64Scalar(keys, n, key, or_equal);
+}
+
+static size_t CountBelow32(const uint32_t* heads, size_t n, uint32_t head, bool or_equal) noexcept {
+    size_t count = 0;
+    size_t i = 0;
+#ifdef DT_HAVE_X86_SIMD
+    // SSE2 compares signed lanes, flipping the sign bit of both sides orders them as unsigned
+    __m128i flip = _mm_set1_epi32(INT32_MIN);
+    __m128i needle = _mm_xor_si128(_mm_set1_epi32(static_cast<int32_t>(head)), flip);
+    for (; i + 4 <= n; i += 4) {
+        __m128i vector = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(heads + i)), flip);
+        __m128i mask = or_equal ? _mm_cmpgt_epi32(vector, needle) : _mm_cmpgt_epi32(needle, vector);
+        int bits = __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(mask)));
+        count += or_equal ? 4 - bits : bits;
+    }
+#endif
+    for (; i < n; ++i)
+        count += or_equal ? heads[i] <= head : heads[i] < head;
+    return count;
+}
+
+/**
+ * @brief Binary search down to SEARCH_WINDOW keys, then count the rest at once
+ * @return The first index with a key at or above (above if upper) the search key
+ */
+template <typename T, typename Count>
+static size_t Bound(const T* keys, size_t n, T key, bool upper, Count count) noexcept {
+    size_t base = 0;
+    while (n > SEARCH_WINDOW) {
+        size_t half = n / 2;
+        if (upper ? keys[base + half] <= key : keys[base + half] < key) {
+            base += half + 1;
+            n -= half + 1;
+        } else {
+            n = half;
+        }
+    }
+    return base + count(keys + base, n, key, upper);
+}
+
+/**
+ * Helpers
+ */
+static inline uint16_t LoadU16(const uint8_t* p) noexcept {
+    uint16_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static inline void StoreU16(uint8_t* p, size_t value) noexcept {
+    uint16_t narrow = static_cast<uint16_t>(value);
+    memcpy(p, &narrow, sizeof(narrow));
+}
+
+static inline uint32_t LoadU32(const uint8_t* p) noexcept {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static inline std::string ChildBytes(uint32_t page_no) {
+    return std::string(reinterpret_cast<const char*>(&page_no), sizeof(page_no));
+}
+
+/**
+ * @brief The first four bytes of a suffix, big endian and zero padded, so heads order like suffixes
+ */
+static inline uint32_t HeadOf(std::string_view suffix) noexcept {
+    uint32_t head = 0;
+    for (size_t i = 0; i < 4; ++i)
+        head = (head << 8) | ((i < suffix.size()) ? static_cast<uint8_t>(suffix[i]) : 0);
+    return head;
+}
+
+static inline int CompareBytes(std::string_view lhs, std::string_view rhs) noexcept {
+    // char_traits compares as unsigned char, the memcmp order of the keys
+    return lhs.compare(rhs);
+}
+
+static inline size_t CommonPrefix(std::string_view lhs, std::string_view rhs) noexcept {
+    size_t length = std::min(lhs.size(), rhs.size());
+    size_t i = 0;
+    while (i < length && lhs[i] == rhs[i])
+        ++i;
+    return i;
+}
+
+/**
+ * @brief Typed access to one node page
+ */
+class Node {
+public:
+    Node(uint8_t* page, KeyType key_type) noexcept
+    : page_(page), strings_(key_type == KeyType::kSTRING), width_(strings_ ? sizeof(uint32_t) : sizeof(int64_t))
+    {}
+
+    NodeHeader& Header() const noexcept { return *reinterpret_cast<NodeHeader*>(page_ + NODE_OFFSET); }
+    PageHeader& Page() const noexcept { return *reinterpret_cast<PageHeader*>(page_); }
+    uint32_t Count() const noexcept { return Header().count; }
+    bool IsLeaf() const noexcept { return Header().level == 0; }
+
+    int64_t* Keys() const noexcept { return reinterpret_cast<int64_t*>(page_ + ARRAY_OFFSET); }
+    uint32_t* Heads() const noexcept { return reinterpret_cast<uint32_t*>(page_ + ARRAY_OFFSET); }
+    uint16_t* Offsets() const noexcept { return reinterpret_cast<uint16_t*>(page_ + ARRAY_OFFSET + Count() * width_); }
+
+    std::string_view Prefix() const noexcept {
+        return std::string_view(reinterpret_cast<const char*>(page_ + Header().prefix_offset), Header().prefix_length);
+    }
+
+    const uint8_t* EntryAt(uint32_t slot) const noexcept { return page_ + Offsets()[slot]; }
+    size_t EntrySize(uint32_t slot) const noexcept {
+        return ENTRY_HEADER + LoadU16(EntryAt(slot)) + LoadU16(EntryAt(slot) + 2);
+    }
+
+    std::string_view Suffix(uint32_t slot) const noexcept {
+        const uint8_t* entry = EntryAt(slot);
+        return std::string_view(reinterpret_cast<const char*>(entry + ENTRY_HEADER), LoadU16(entry));
+    }
+
+    uint8_t* Value(uint32_t slot) const noexcept {
+        uint8_t* entry = page_ + Offsets()[slot];
+        return entry + ENTRY_HEADER + LoadU16(entry);
+    }
+
+    size_t ValueSize(uint32_t slot) const noexcept { return LoadU16(EntryAt(slot) + 2); }
+
+    uint32_t Child(uint32_t slot) const noexcept {
+        return (slot == Count()) ? Header().upper : LoadU32(Value(slot));
+    }
+
+    void SetChild(uint32_t slot, uint32_t page_no) noexcept {
+        if (slot == Count())
+            Header().upper = page_no;
+        else
+            memcpy(Value(slot), &page_no, sizeof(page_no));
+    }
+
+    size_t FreeSpace() const noexcept {
+        return Header().heap_top - (ARRAY_OFFSET + Count() * (width_ + sizeof(uint16_t)));
+    }
+
+    bool SharesPrefix(std::string_view key) const noexcept {
+        return key.substr(0, Header().prefix_length) == Prefix();
+    }
+
+    /**
+     * @brief The first slot with a key at or above key, or above it if upper
+     */
+    uint32_t Bound(int64_t integer, std::string_view bytes, bool upper) const noexcept {
+        uint32_t count = Count();
+        if (!strings_)
+            return static_cast<uint32_t>(::Bound(Keys(), count, integer, upper, CountBelow64));
+
+        // Keys that do not share the prefix sort before or after the whole node
+        std::string_view prefix = Prefix();
+        int cmp = bytes.substr(0, prefix.size()).compare(prefix);
+        if (cmp < 0)
+            return 0;
+        if (cmp > 0)
+            return count;
+        std::string_view suffix = bytes.substr(prefix.size());
+        uint32_t head = HeadOf(suffix);
+        uint32_t lo = static_cast<uint32_t>(::Bound(Heads(), count, head, false, CountBelow32));
+        uint32_t hi = static_cast<uint32_t>(::Bound(Heads(), count, head, true, CountBelow32));
+        // Only keys with an equal head need their bytes compared
+        while (lo < hi) {
+            uint32_t mid = lo + (hi - lo) / 2;
+            int order = CompareBytes(Suffix(mid), suffix);
+            if (order < 0 || (upper && order == 0))
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return lo;
+    }
+
+    bool Matches(uint32_t slot, int64_t integer, std::string_view bytes) const noexcept {
+        if (slot >= Count())
+            return false;
+        if (!strings_)
+            return Keys()[slot] == integer;
+        return SharesPrefix(bytes) && Suffix(slot) == bytes.substr(Header().prefix_length);
+    }
+
+    /**
+     * @brief Add an entry at slot, the caller has checked it fits and shares the prefix
+     */
+    void Insert(uint32_t slot, int64_t integer, std::string_view key, std::string_view value) noexcept {
+        NodeHeader& header = Header();
+        std::string_view suffix = strings_ ? key.substr(header.prefix_length) : std::string_view();
+        size_t size = ENTRY_HEADER + suffix.size() + value.size();
+        header.heap_top -= static_cast<uint32_t>(size);
+        uint8_t* entry = page_ + header.heap_top;
+        StoreU16(entry, suffix.size());
+        StoreU16(entry + 2, value.size());
+        if (!suffix.empty())
+            memcpy(entry + ENTRY_HEADER, suffix.data(), suffix.size());
+        if (!value.empty())
+            memcpy(entry + ENTRY_HEADER + suffix.size(), value.data(), value.size());
+
+        // Open a gap in both arrays, the offsets move up by one key first
+        uint32_t count = header.count;
+        uint8_t* base = page_ + ARRAY_OFFSET;
+        uint8_t* old_offsets = base + count * width_;
+        uint8_t* new_offsets = old_offsets + width_;
+        memmove(new_offsets + (slot + 1) * sizeof(uint16_t), old_offsets + slot * sizeof(uint16_t),
+                (count - slot) * sizeof(uint16_t));
+        memmove(new_offsets, old_offsets, slot * sizeof(uint16_t));
+        memmove(base + (slot + 1) * width_, base + slot * width_, (count - slot) * width_);
+        if (strings_) {
+            uint32_t head = HeadOf(suffix);
+            memcpy(base + slot * width_, &head, sizeof(head));
+        } else {
+            memcpy(base + slot * width_, &integer, sizeof(integer));
+        }
+        StoreU16(new_offsets + slot * sizeof(uint16_t), header.heap_top);
+        ++header.count;
+    }
+
+    /**
+     * @brief Remove the entry at slot, its bytes become garbage until the node is packed again
+     */
+    void Erase(uint32_t slot) noexcept {
+        NodeHeader& header = Header();
+        header.garbage += static_cast<uint32_t>(EntrySize(slot));
+        uint32_t count = header.count;
+        uint8_t* base = page_ + ARRAY_OFFSET;
+        uint8_t* old_offsets = base + count * width_;
+        uint8_t* new_offsets = old_offsets - width_;
+        memmove(base + slot * width_, base + (slot + 1) * width_, (count - slot - 1) * width_);
+        memmove(new_offsets, old_offsets, slot * sizeof(uint16_t));
+        memmove(new_offsets + slot * sizeof(uint16_t), old_offsets + (slot + 1) * sizeof(uint16_t),
+                (count - slot - 1) * sizeof(uint16_t));
+        --header.count;
+    }
+
+    size_t Width() const noexcept { return width_; }
+
+private:
+    uint8_t* page_;
+    bool strings_;
+    size_t width_;
+};
+
+/**
+ * BTreeCursor
+ */
+BTreeCursor::BTreeCursor() noexcept
+: pool_(nullptr), key_type_(KeyType::kINTEGER), leaf_(), slot_(0)
+{}
+
+bool BTreeCursor::Valid() const noexcept {
+    return static_cast<bool>(leaf_);
+}
+
+void BTreeCursor::Next() {
+    ++slot_;
+    Settle();
+}
+
+int64_t BTreeCursor::IntegerKey() const noexcept {
+    int64_t key = Node(leaf_.Data(), key_type_).Keys()[slot_];
+    return (key_type_ == KeyType::kUNSIGNED) ? key ^ INT64_MIN : key;
+}
+
+std::string BTreeCursor::StringKey() const {
+    Node node(leaf_.Data(), key_type_);
+    std::string key(node.Prefix());
+    key.append(node.Suffix(slot_));
+    return key;
+}
+
+const uint8_t* BTreeCursor::Value() const noexcept {
+    return Node(leaf_.Data(), key_type_).Value(slot_);
+}
+
+size_t BTreeCursor::ValueSize() const noexcept {
+    return Node(leaf_.Data(), key_type_).ValueSize(slot_);
+}
+
+void BTreeCursor::Settle() {
+    while (leaf_) {
+        Node node(leaf_.Data(), key_type_);
+        if (slot_ < node.Count())
+            return;
+        uint32_t next = node.Page().next;
+        if (next == Pager::NO_PAGE) {
+            leaf_.Release();
+            return;
+        }
+        leaf_ = pool_->Pin(next);
+        slot_ = 0;
+    }
+}
+
+/**
+ * BTree
+ */
+uint32_t BTree::Create(BufferPool& pool, KeyType key_type) {
+    PinnedPage root = pool.PinNew(PageType::kBTREE_LEAF);
+    Node node(root.Data(), key_type);
+    node.Page().flags = static_cast<uint8_t>(key_type);
+    node.Header().heap_top = pool.GetPager().PageSize();
+    return root.PageNo();
+}
+
+BTree::BTree(BufferPool& pool, uint32_t root_page, KeyType key_type)
+: pool_(pool), root_page_(root_page), key_type_(key_type), page_size_(pool.GetPager().PageSize()), splits_(0)
+{
+    PinnedPage root = pool_.Pin(root_page_);
+    const PageHeader& header = Node(root.Data(), key_type_).Page();
+    if ((header.type != PageType::kBTREE_LEAF && header.type != PageType::kBTREE_INNER) ||
+        header.flags != static_cast<uint8_t>(key_type_))
+        throw FileException("Page " + std::to_string(root_page_) + " is not the root of a B+Tree of this key type");
+}
+
+bool BTree::Insert(const BTreeKey& key, const uint8_t* value, size_t size) {
+    SearchKey search = Normalize(key);
+    if (search.bytes.size() + size > MaxEntrySize())
+        throw FileException("B+Tree entry of " + std::to_string(search.bytes.size() + size) + " bytes, at most " +
+                            std::to_string(MaxEntrySize()) + " fit");
+    std::vector<PathStep> path;
+    PinnedPage leaf = Descend(search, &path);
+    Node node(leaf.Data(), key_type_);
+    uint32_t slot = node.Bound(search.integer, search.bytes, false);
+    if (node.Matches(slot, search.integer, search.bytes))
+        return false;
+    Entry entry{search.integer, std::string(search.bytes), std::string(reinterpret_cast<const char*>(value), size)};
+    InsertAt(path, leaf, slot, entry, Pager::NO_PAGE);
+    return true;
+}
+
+bool BTree::Update(const BTreeKey& key, const uint8_t* value, size_t size) {
+    SearchKey search = Normalize(key);
+    if (search.bytes.size() + size > MaxEntrySize())
+        throw FileException("B+Tree entry of " + std::to_string(search.bytes.size() + size) + " bytes, at most " +
+                            std::to_string(MaxEntrySize()) + " fit");
+    std::vector<PathStep> path;
+    PinnedPage leaf = Descend(search, &path);
+    Node node(leaf.Data(), key_type_);
+    uint32_t slot = node.Bound(search.integer, search.bytes, false);
+    if (!node.Matches(slot, search.integer, search.bytes))
+        return false;
+    leaf.MarkDirty();
+    if (node.ValueSize(slot) == size) {
+        if (size > 0)
+            memcpy(node.Value(slot), value, size);
+        return true;
+    }
+    node.Erase(slot);
+    Entry entry{search.integer, std::string(search.bytes), std::string(reinterpret_cast<const char*>(value), size)};
+    InsertAt(path, leaf, slot, entry, Pager::NO_PAGE);
+    return true;
+}
+
+bool BTree::Erase(const BTreeKey& key) {
+    SearchKey search = Normalize(key);
+    PinnedPage leaf = Descend(search, nullptr);
+    Node node(leaf.Data(), key_type_);
+    uint32_t slot = node.Bound(search.integer, search.bytes, false);
+    if (!node.Matches(slot, search.integer, search.bytes))
+        return false;
+    node.Erase(slot);
+    leaf.MarkDirty();
+    return true;
+}
+
+bool BTree::Find(const BTreeKey& key, std::vector<uint8_t>& value) const {
+    SearchKey search = Normalize(key);
+    PinnedPage leaf = Descend(search, nullptr);
+    Node node(leaf.Data(), key_type_);
+    uint32_t slot = node.Bound(search.integer, search.bytes, false);
+    if (!node.Matches(slot, search.integer, search.bytes))
+        return false;
+    value.assign(node.Value(slot), node.Value(slot) + node.ValueSize(slot));
+    return true;
+}
+
+BTreeCursor BTree::Seek(const BTreeKey& key) const {
+    SearchKey search = Normalize(key);
+    BTreeCursor cursor;
+    cursor.pool_ = &pool_;
+    cursor.key_type_ = key_type_;
+    cursor.leaf_ = Descend(search, nullptr);
+    cursor.slot_ = Node(cursor.leaf_.Data(), key_type_).Bound(search.integer, search.bytes, false);
+    cursor.Settle();
+    return cursor;
+}
+
+BTreeCursor BTree::Begin() const {
+    BTreeCursor cursor;
+    cursor.pool_ = &pool_;
+    cursor.key_type_ = key_type_;
+    cursor.leaf_ = Descend(SearchKey{INT64_MIN, std::string_view()}, nullptr);
+    cursor.slot_ = 0;
+    cursor.Settle();
+    return cursor;
+}
+
+uint32_t BTree::RootPage() const noexcept {
+    return root_page_;
+}
+
+KeyType BTree::GetKeyType() const noexcept {
+    return key_type_;
+}
+
+uint32_t BTree::Height() const {
+    PinnedPage root = pool_.Pin(root_page_);
+    return Node(root.Data(), key_type_).Header().level + 1u;
+}
+
+uint64_t BTree::Splits() const noexcept {
+    return splits_;
+}
+
+size_t BTree::MaxEntrySize() const noexcept {
+    return (page_size_ - ARRAY_OFFSET) / 4 - ENTRY_HEADER - sizeof(int64_t) - sizeof(uint16_t);
+}
+
+BTree::SearchKey BTree::Normalize(const BTreeKey& key) const {
+    if (key.is_string != (key_type_ == KeyType::kSTRING))
+        throw FileException(key.is_string ? "B+Tree keys are integers, not strings" : "B+Tree keys are strings, not integers");
+    if (key_type_ == KeyType::kUNSIGNED)
+        return SearchKey{key.integer ^ INT64_MIN, std::string_view()};
+    return SearchKey{key.integer, key.bytes};
+}
+
+PinnedPage BTree::Descend(const SearchKey& key, std::vector<PathStep>* path) const {
+    PinnedPage page = pool_.Pin(root_page_);
+    for (;;) {
+        Node node(page.Data(), key_type_);
+        if (node.IsLeaf())
+            return page;
+        uint32_t child = node.Bound(key.integer, key.bytes, true);
+        if (path != nullptr)
+            path->push_back(PathStep{page.PageNo(), child});
+        page = pool_.Pin(node.Child(child));
+    }
+}
+
+void BTree::InsertAt(std::vector<PathStep>& path, PinnedPage& page, uint32_t slot, Entry& entry, uint32_t right) {
+    Node node(page.Data(), key_type_);
+    page.MarkDirty();
+    if (node.SharesPrefix(entry.key)) {
+        size_t suffix = entry.key.size() - node.Header().prefix_length;
+        if (ENTRY_HEADER + suffix + entry.value.size() + node.Width() + sizeof(uint16_t) <= node.FreeSpace()) {
+            node.Insert(slot, entry.integer, entry.key, entry.value);
+            if (!node.IsLeaf())
+                node.SetChild(slot + 1, right);
+            return;
+        }
+    }
+
+    // Out of room, or the key does not share the prefix: pack the node again, splitting it if needed
+    std::vector<Entry> entries;
+    Unpack(page.Data(), entries);
+    uint32_t upper = node.Header().upper;
+    entries.insert(entries.begin() + slot, std::move(entry));
+    if (!node.IsLeaf()) {
+        if (slot + 1 == entries.size())
+            upper = right;
+        else
+            entries[slot + 1].value = ChildBytes(right);
+    }
+    if (!Pack(page.Data(), node.Header().level, entries, 0, entries.size(), upper))
+        Split(path, page, entries, upper);
+}
+
+void BTree::Unpack(const uint8_t* page, std::vector<Entry>& entries) const {
+    Node node(const_cast<uint8_t*>(page), key_type_);
+    std::string_view prefix = node.Prefix();
+    uint32_t count = node.Count();
+    entries.reserve(count + 1);
+    for (uint32_t slot = 0; slot < count; ++slot) {
+        Entry entry{0, std::string(), std::string(reinterpret_cast<const char*>(node.Value(slot)), node.ValueSize(slot))};
+        if (key_type_ == KeyType::kSTRING) {
+            entry.key.reserve(prefix.size() + node.Suffix(slot).size());
+            entry.key.append(prefix).append(node.Suffix(slot));
+        } else {
+            entry.integer = node.Keys()[slot];
+        }
+        entries.push_back(std::move(entry));
+    }
+}
+
+size_t BTree::PackedSize(const std::vector<Entry>& entries, size_t first, size_t last) const noexcept {
+    size_t prefix = (last > first) ? CommonPrefix(entries[first].key, entries[last - 1].key) : 0;
+    size_t width = (key_type_ == KeyType::kSTRING) ? sizeof(uint32_t) : sizeof(int64_t);
+    size_t size = ARRAY_OFFSET + prefix;
+    for (size_t i = first; i < last; ++i)
+        size += width + sizeof(uint16_t) + ENTRY_HEADER + entries[i].key.size() - prefix + entries[i].value.size();
+    return size;
+}
+
+bool BTree::Pack(uint8_t* page, uint16_t level, const std::vector<Entry>& entries, size_t first, size_t last,
+                 uint32_t upper) const {
+    if (PackedSize(entries, first, last) > page_size_)
+        return false;
+    Node node(page, key_type_);
+    node.Page().type = (level == 0) ? PageType::kBTREE_LEAF : PageType::kBTREE_INNER;
+    node.Page().flags = static_cast<uint8_t>(key_type_);
+    NodeHeader& header = node.Header();
+    // Sorted keys share whatever the first and the last share
+    size_t prefix = (last > first) ? CommonPrefix(entries[first].key, entries[last - 1].key) : 0;
+    header.count = 0;
+    header.level = level;
+    header.heap_top = static_cast<uint32_t>(page_size_ - prefix);
+    header.prefix_length = static_cast<uint16_t>(prefix);
+    header.prefix_offset = static_cast<uint16_t>(header.heap_top);
+    header.garbage = 0;
+    header.upper = upper;
+    if (prefix > 0)
+        memcpy(page + header.heap_top, entries[first].key.data(), prefix);
+    for (size_t i = first; i < last; ++i)
+        node.Insert(static_cast<uint32_t>(i - first), entries[i].integer, entries[i].key, entries[i].value);
+    return true;
+}
+
+void BTree::Split(std::vector<PathStep>& path, PinnedPage& page, std::vector<Entry>& entries, uint32_t upper) {
+    ++splits_;
+    Node node(page.Data(), key_type_);
+    uint16_t level = node.Header().level;
+    bool leaf = level == 0;
+    size_t count = entries.size();
+
+    // Split by bytes so both halves fit whatever the entry sizes, each half's prefix is at least the whole node's
+    size_t prefix = CommonPrefix(entries[0].key, entries[count - 1].key);
+    size_t total = PackedSize(entries, 0, count);
+    size_t middle = 1;
+    for (size_t bytes = ARRAY_OFFSET + prefix; middle < count - 1; ++middle) {
+        bytes += entries[middle - 1].key.size() - prefix + entries[middle - 1].value.size() + ENTRY_HEADER +
+                 node.Width() + sizeof(uint16_t);
+        if (bytes >= total / 2)
+            break;
+    }
+
+    // A leaf keeps all its entries and pushes up the shortest key between the halves,
+    // an inner node gives its middle separator to the parent, whose child becomes the left upper
+    Entry separator;
+    size_t right_first = middle;
+    uint32_t left_upper = Pager::NO_PAGE;
+    if (leaf) {
+        separator.integer = entries[middle].integer;
+        if (key_type_ == KeyType::kSTRING)
+            separator.key = entries[middle].key.substr(0, CommonPrefix(entries[middle - 1].key, entries[middle].key) + 1);
+    } else {
+        separator.integer = entries[middle].integer;
+        separator.key = entries[middle].key;
+        left_upper = LoadU32(reinterpret_cast<const uint8_t*>(entries[middle].value.data()));
+        right_first = middle + 1;
+    }
+
+    if (page.PageNo() == root_page_) {
+        // The root stays where it is, both halves move to new pages below it
+        PinnedPage left = pool_.PinNew(leaf ? PageType::kBTREE_LEAF : PageType::kBTREE_INNER);
+        PinnedPage right = pool_.PinNew(leaf ? PageType::kBTREE_LEAF : PageType::kBTREE_INNER);
+        if (!Pack(left.Data(), level, entries, 0, middle, left_upper) ||
+            !Pack(right.Data(), level, entries, right_first, count, upper))
+            throw FileException("B+Tree split of page " + std::to_string(page.PageNo()) + " does not fit");
+        if (leaf)
+            Node(left.Data(), key_type_).Page().next = right.PageNo();
+        separator.value = ChildBytes(left.PageNo());
+        std::vector<Entry> root{std::move(separator)};
+        Pack(page.Data(), level + 1, root, 0, 1, right.PageNo());
+        node.Page().next = Pager::NO_PAGE;
+        return;
+    }
+
+    PinnedPage right = pool_.PinNew(leaf ? PageType::kBTREE_LEAF : PageType::kBTREE_INNER);
+    if (!Pack(right.Data(), level, entries, right_first, count, upper) ||
+        !Pack(page.Data(), level, entries, 0, middle, left_upper))
+        throw FileException("B+Tree split of page " + std::to_string(page.PageNo()) + " does not fit");
+    if (leaf) {
+        Node(right.Data(), key_type_).Page().next = node.Page().next;
+        node.Page().next = right.PageNo();
+    }
+    uint32_t right_page = right.PageNo();
+    separator.value = ChildBytes(page.PageNo());
+    right.Release();
+    page.Release();
+
+    PathStep step = path.back();
+    path.pop_back();
+    PinnedPage parent = pool_.Pin(step.page_no);
+    InsertAt(path, parent, step.child, separator, right_page);
+}
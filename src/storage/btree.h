@@ -0,0 +1,254 @@
+#ifndef DT_SRC_STORAGE_BTREE_H
+#define DT_SRC_STORAGE_BTREE_H
+
+// C++ Includes
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Local Includes
+#include "file/bufferpool.h"
+
+/**
+ * @brief How the keys of a B+Tree are ordered
+ */
+enum class KeyType : uint8_t {
+    kINTEGER,   // Signed 64-bit, byte to long
+    kUNSIGNED,  // Unsigned 64-bit, stored with the sign bit flipped so it orders like kINTEGER
+    kSTRING     // Bytes in memcmp order, strings and guids
+};
+
+/**
+ * @brief A key to look up, an integer or a view of bytes that must outlive the call
+ */
+struct BTreeKey {
+    BTreeKey(int64_t value) noexcept : integer(value), bytes(), is_string(false) {}
+    BTreeKey(std::string_view value) noexcept : integer(0), bytes(value), is_string(true) {}
+    BTreeKey(const std::string& value) noexcept : integer(0), bytes(value), is_string(true) {}
+
+    int64_t integer;
+    std::string_view bytes;
+    bool is_string;
+};
+
+class BTree;
+
+/**
+ * @brief A position in the leaves of a B+Tree, moving forward through the sibling links
+ *
+ * The current leaf stays pinned; the tree must not be changed while a cursor is valid.
+ */
+class BTreeCursor {
+public:
+    /**
+     * Tors
+     */
+    BTreeCursor() noexcept;
+    BTreeCursor(BTreeCursor&&) noexcept = default;
+    BTreeCursor& operator=(BTreeCursor&&) noexcept = default;
+
+    /**
+     * @brief Whether the cursor is on an entry, false past the last one
+     */
+    bool Valid() const noexcept;
+
+    /**
+     * @brief Move to the next entry in key order
+     */
+    void Next();
+
+    /**
+     * @brief The key of an integer tree
+     */
+    int64_t IntegerKey() const noexcept;
+
+    /**
+     * @brief The key of a string tree, the node's prefix and the entry's suffix
+     */
+    std::string StringKey() const;
+
+    /**
+     * @brief The value, valid until the cursor moves
+     */
+    const uint8_t* Value() const noexcept;
+    size_t ValueSize() const noexcept;
+
+private:
+    friend class BTree;
+
+    /**
+     * @brief Step over empty leaves until the cursor is on an entry or past the end
+     */
+    void Settle();
+
+    BufferPool* pool_;
+    KeyType key_type_;
+    PinnedPage leaf_;
+    uint32_t slot_;
+};
+
+/**
+ * @brief A B+Tree of unique keys over pages of a BufferPool, the primary index of a trunk
+ *
+ * Each node is one page: after the headers comes a sorted array of fixed width
+ * search keys, then a parallel array of entry offsets, then free space, then
+ * the entries themselves, growing down from the end of the page. Integer trees
+ * keep whole keys in the array. String trees strip the prefix every key of the
+ * node shares and keep the first four bytes of each suffix, big endian, so the
+ * array orders like the keys and only equal heads need a full comparison.
+ * Searches halve the array down to a short window that SIMD compares at once.
+ *
+ * Leaf splits push up the shortest separator between the two halves, leaves
+ * are chained left to right for range scans and the root never moves, so the
+ * trunk directory keeps pointing at it. Erased entries leave their leaf in
+ * place; nodes are not merged.
+ */
+class BTree {
+public:
+    /**
+     * @brief Make a new, empty tree
+     * @return The root page, fixed for the tree's lifetime
+     */
+    static uint32_t Create(BufferPool& pool, KeyType key_type);
+
+    /**
+     * Tors
+     */
+
+    /**
+     * @brief Open the tree rooted at root_page
+     * @param pool Must outlive the tree
+     * @throws FileException if root_page is not the root of a tree of key_type
+     */
+    BTree(BufferPool& pool, uint32_t root_page, KeyType key_type);
+
+    /**
+     * NON-COPYABLE
+     */
+    BTree(const BTree&) = delete;
+    BTree(BTree&&) = delete;
+    BTree& operator=(const BTree&) = delete;
+
+    /**
+     * Entries
+     */
+
+    /**
+     * @brief Add a key that is not in the tree yet
+     * @return False if the key is already present, the tree is unchanged
+     * @throws FileException if the key and value are larger than MaxEntrySize()
+     */
+    bool Insert(const BTreeKey& key, const uint8_t* value, size_t size);
+
+    /**
+     * @brief Replace the value of a key in the tree
+     * @return False if the key is not present
+     */
+    bool Update(const BTreeKey& key, const uint8_t* value, size_t size);
+
+    /**
+     * @brief Remove a key
+     * @return False if the key is not present
+     */
+    bool Erase(const BTreeKey& key);
+
+    /**
+     * @brief Copy the value of a key into value
+     * @return False if the key is not present
+     */
+    bool Find(const BTreeKey& key, std::vector<uint8_t>& value) const;
+
+    /**
+     * @brief A cursor on the first entry with a key of at least key
+     */
+    BTreeCursor Seek(const BTreeKey& key) const;
+
+    /**
+     * @brief A cursor on the first entry
+     */
+    BTreeCursor Begin() const;
+
+    /**
+     * Stats
+     */
+    uint32_t RootPage() const noexcept;
+    KeyType GetKeyType() const noexcept;
+    uint32_t Height() const;
+    uint64_t Splits() const noexcept;
+
+    /**
+     * @brief The largest key length plus value size an entry may have, a quarter of a node
+     */
+    size_t MaxEntrySize() const noexcept;
+
+private:
+    /**
+     * @brief A page on the way down and the child index followed from it
+     */
+    struct PathStep {
+        uint32_t page_no;
+        uint32_t child;
+    };
+
+    /**
+     * @brief A key in the tree's own order, unsigned keys have their sign bit flipped
+     */
+    struct SearchKey {
+        int64_t integer;
+        std::string_view bytes;
+    };
+
+    /**
+     * @brief A node's entry taken out of its page to rebuild or split the node
+     */
+    struct Entry {
+        int64_t integer;
+        std::string key;
+        std::string value;
+    };
+
+    SearchKey Normalize(const BTreeKey& key) const;
+
+    /**
+     * @brief Walk from the root to the leaf that holds key
+     * @param path Filled with every inner node passed, root first, if not null
+     */
+    PinnedPage Descend(const SearchKey& key, std::vector<PathStep>* path) const;
+
+    /**
+     * @brief Insert entry at slot of a leaf or inner node, splitting it and its ancestors as needed
+     * @param right For an inner node, the child that takes over the pointer after the new slot
+     */
+    void InsertAt(std::vector<PathStep>& path, PinnedPage& page, uint32_t slot, Entry& entry, uint32_t right);
+
+    /**
+     * @brief Take every entry of a node out of its page, in order
+     */
+    void Unpack(const uint8_t* page, std::vector<Entry>& entries) const;
+
+    /**
+     * @brief Write entries [first, last) into page as a node of the given level
+     * @return False if they do not fit, the page is then unchanged
+     */
+    bool Pack(uint8_t* page, uint16_t level, const std::vector<Entry>& entries, size_t first, size_t last,
+              uint32_t upper) const;
+
+    /**
+     * @brief Bytes a node of entries [first, last) needs
+     */
+    size_t PackedSize(const std::vector<Entry>& entries, size_t first, size_t last) const noexcept;
+
+    /**
+     * @brief Split an overfull node and insert the separator into its parent
+     */
+    void Split(std::vector<PathStep>& path, PinnedPage& node, std::vector<Entry>& entries, uint32_t upper);
+
+    BufferPool& pool_;
+    const uint32_t root_page_;
+    const KeyType key_type_;
+    const size_t page_size_;
+    uint64_t splits_;
+};
+
+#endif
@@ -0,0 +1,162 @@
+// C++ Includes
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+// Local Includes
+#include "exception/schema_exception.h"
+#include "schema/record.h"
+#include "indexkey.h"
+
+#define SIGN_BIT (1ULL << 63)
+
+/**
+ * @brief Null sorts before every value of a member
+ */
+#define KEY_NULL '\x00'
+#define KEY_VALUE '\x01'
+
+/**
+ * @brief A 0 byte in a string is escaped as 0 0xFF, the string ends in 0 0
+ */
+#define KEY_ESCAPE '\xFF'
+#define KEY_END '\x00'
+
+static inline bool IsReal(const FieldLayout& field) noexcept {
+    return field.type == FieldType::kFLOAT || field.type == FieldType::kDOUBLE;
+}
+
+static inline bool IsUnsignedLong(const FieldLayout& field) noexcept {
+    return field.type == FieldType::kLONG && !field.is_signed;
+}
+
+/**
+ * @brief IEEE 754 bits rearranged to compare as unsigned integers, -0.0 equal to 0.0
+ */
+static void AppendOrderedReal(std::string& key, double value) {
+    if (value == 0.0)
+        value = 0.0;
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    bits = (bits & SIGN_BIT) ? ~bits : bits | SIGN_BIT;
+    AppendOrderedInteger(key, static_cast<int64_t>(bits), true);
+}
+
+static void AppendOrderedString(std::string& key, std::string_view value) {
+    for (char c : value) {
+        key.push_back(c);
+        if (c == KEY_END)
+            key.push_back(KEY_ESCAPE);
+    }
+    key.push_back(KEY_END);
+    key.push_back(KEY_END);
+}
+
+void AppendOrderedInteger(std::string& key, int64_t value, bool is_unsigned) {
+    uint64_t bits = static_cast<uint64_t>(value) ^ (is_unsigned ? 0 : SIGN_BIT);
+    for (int shift = 56; shift >= 0; shift -= 8)
+        key.push_back(static_cast<char>(bits >> shift));
+}
+
+int64_t ReadOrderedInteger(const char* bytes, bool is_unsigned) noexcept {
+    uint64_t bits = 0;
+    for (int i = 0; i < 8; ++i)
+        bits = (bits << 8) | static_cast<uint8_t>(bytes[i]);
+    return static_cast<int64_t>(bits ^ (is_unsigned ? 0 : SIGN_BIT));
+}
+
+void AppendIndexKey(std::string& key, const FieldLayout& field, const uint8_t* record) {
+    if (FieldIsNull(record, field)) {
+        key.push_back(KEY_NULL);
+        return;
+    }
+    key.push_back(KEY_VALUE);
+    if (IsReal(field))
+        AppendOrderedReal(key, ReadReal(record, field));
+    else if (field.type == FieldType::kSTRING)
+        AppendOrderedString(key, ReadVar(record, field));
+    else
+        AppendOrderedInteger(key, ReadInteger(record, field), IsUnsignedLong(field));
+}
+
+void AppendIndexKey(std::string& key, const FieldLayout& field, const IndexValue& value) {
+    if (value.kind == IndexValue::Kind::kNULL) {
+        key.push_back(KEY_NULL);
+        return;
+    }
+    // Integers widen to reals like the VM's comparisons, nothing else converts
+    bool matches = (field.type == FieldType::kSTRING) ? value.kind == IndexValue::Kind::kSTRING
+                   : IsReal(field) ? value.kind != IndexValue::Kind::kSTRING
+                                   : value.kind == IndexValue::Kind::kINTEGER;
+    if (!matches)
+        throw SchemaException("The index on " + field.name + " cannot be searched with a value of another type");
+    key.push_back(KEY_VALUE);
+    if (IsReal(field)) {
+        double real = (value.kind == IndexValue::Kind::kINTEGER) ? static_cast<double>(value.integer) : value.real;
+        // A float member holds the value rounded to float, so must the key
+        AppendOrderedReal(key, (field.type == FieldType::kFLOAT) ? static_cast<float>(real) : real);
+    } else if (field.type == FieldType::kSTRING) {
+        AppendOrderedString(key, value.bytes);
+    } else {
+        AppendOrderedInteger(key, value.integer, IsUnsignedLong(field));
+    }
+}
+
+size_t IndexKeySize(std::string_view key, const FieldLayout& field) noexcept {
+    if (key.empty() || key[0] == KEY_NULL)
+        return 1;
+    if (field.type != FieldType::kSTRING)
+        return 1 + sizeof(uint64_t);
+    size_t i = 1;
+    while (i + 1 < key.size() && !(key[i] == KEY_END && key[i + 1] == KEY_END))
+        i += (key[i] == KEY_END) ? 2 : 1;
+    return i + 2;
+}
+
+KeyType PrimaryKeyType(const RecordLayout& layout) noexcept {
+    if (layout.PrimaryField() < 0)
+        return KeyType::kINTEGER;
+    const FieldLayout& field = layout.Field(layout.PrimaryField());
+    if (field.type == FieldType::kSTRING || IsReal(field))
+        return KeyType::kSTRING;
+    return IsUnsignedLong(field) ? KeyType::kUNSIGNED : KeyType::kINTEGER;
+}
+
+PrimaryKey ReadPrimaryKey(const FieldLayout& field, const uint8_t* record) {
+    PrimaryKey primary;
+    if (field.type == FieldType::kSTRING) {
+        primary.is_string = true;
+        primary.bytes = ReadVar(record, field);
+    } else if (IsReal(field)) {
+        primary.is_string = true;
+        AppendOrderedReal(primary.bytes, ReadReal(record, field));
+    } else {
+        primary.integer = ReadInteger(record, field);
+    }
+    return primary;
+}
+
+PrimaryKey MakePrimaryKey(const FieldLayout* field, const IndexValue& value) {
+    PrimaryKey primary;
+    if (field == nullptr) {
+        if (value.kind != IndexValue::Kind::kINTEGER)
+            throw SchemaException("Records without a primary key are found by their integer row id");
+        primary.integer = value.integer;
+        return primary;
+    }
+    if (value.kind == IndexValue::Kind::kNULL)
+        throw SchemaException("The primary key " + field->name + " is never null");
+    std::string key;
+    AppendIndexKey(key, *field, value);
+    if (field->type == FieldType::kSTRING) {
+        primary.is_string = true;
+        primary.bytes = value.bytes;
+    } else if (IsReal(*field)) {
+        primary.is_string = true;
+        primary.bytes = key.substr(1);
+    } else {
+        primary.integer = value.integer;
+    }
+    return primary;
+}
@@ -0,0 +1,105 @@
+#ifndef DT_SRC_STORAGE_INDEXKEY_H
+#define DT_SRC_STORAGE_INDEXKEY_H
+
+// C++ Includes
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Local Includes
+#include "schema/catalog.h"
+#include "storage/btree.h"
+
+/**
+ * @brief A value to look a member up by, converted to the member's type when encoded
+ */
+struct IndexValue {
+    enum class Kind : uint8_t {
+        kNULL,
+        kINTEGER,   // Integers, bools and pointers, unsigned longs as their bit pattern
+        kREAL,
+        kSTRING
+    };
+
+    IndexValue() noexcept : kind(Kind::kNULL), integer(0), real(0.0), bytes() {}
+    IndexValue(int64_t value) noexcept : kind(Kind::kINTEGER), integer(value), real(0.0), bytes() {}
+    IndexValue(double value) noexcept : kind(Kind::kREAL), integer(0), real(value), bytes() {}
+    IndexValue(std::string_view value) noexcept : kind(Kind::kSTRING), integer(0), real(0.0), bytes(value) {}
+    IndexValue(const std::string& value) noexcept : kind(Kind::kSTRING), integer(0), real(0.0), bytes(value) {}
+
+    Kind kind;
+    int64_t integer;
+    double real;
+    std::string_view bytes;     // Must outlive the lookup
+};
+
+/**
+ * @brief The primary key of a record as its trunk's primary B+Tree orders it
+ *
+ * Integer keys are kept whole, strings as their bytes and reals as the eight
+ * bytes of their order-preserving encoding.
+ */
+struct PrimaryKey {
+    int64_t integer = 0;
+    std::string bytes;
+    bool is_string = false;
+
+    BTreeKey Key() const noexcept { return is_string ? BTreeKey(bytes) : BTreeKey(integer); }
+};
+
+/**
+ * Index Keys
+ *
+ * A member is encoded so that memcmp order is the member's order: a null byte
+ * of 0 for null, which sorts first, or 1 followed by the value. Integers and
+ * reals take eight big endian bytes with the sign arranged to compare
+ * unsigned, strings escape 0 as 0 0xFF and end in 0 0. Every encoding knows
+ * its own length, so keys of several members can be concatenated.
+ */
+
+/**
+ * @brief Append the encoding of a record's member
+ * @param field A scalar member, not an array or embedded struct
+ */
+void AppendIndexKey(std::string& key, const FieldLayout& field, const uint8_t* record);
+
+/**
+ * @brief Append the encoding of a value as field would hold it
+ * @throws SchemaException if the value cannot be compared with the member, e.g. a string for an int
+ */
+void AppendIndexKey(std::string& key, const FieldLayout& field, const IndexValue& value);
+
+/**
+ * @brief The length of the member encoding key starts with
+ */
+size_t IndexKeySize(std::string_view key, const FieldLayout& field) noexcept;
+
+/**
+ * @brief Eight bytes that order like value, big endian with the sign bit flipped unless it is unsigned
+ */
+void AppendOrderedInteger(std::string& key, int64_t value, bool is_unsigned);
+int64_t ReadOrderedInteger(const char* bytes, bool is_unsigned) noexcept;
+
+/**
+ * Primary Keys
+ */
+
+/**
+ * @brief How a primary member orders in the primary tree, kINTEGER for a layout without one
+ */
+KeyType PrimaryKeyType(const RecordLayout& layout) noexcept;
+
+/**
+ * @brief The primary key of a record
+ * @param field The layout's primary member
+ */
+PrimaryKey ReadPrimaryKey(const FieldLayout& field, const uint8_t* record);
+
+/**
+ * @brief A primary key given as a value
+ * @param field The layout's primary member, nullptr for a layout keyed by row id
+ * @throws SchemaException if the value cannot be compared with the member
+ */
+PrimaryKey MakePrimaryKey(const FieldLayout* field, const IndexValue& value);
+
+#endif
@@ -0,0 +1,454 @@
+// C++ Includes
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+// C Includes
+#include <string.h>
+
+// Local Includes
+#include "exception/file_exception.h"
+#include "file/checksum.h"
+#include "pager.h"
+
+#define PAGER_MAGIC "DTRUNK\0\0"
+#define PAGER_VERSION 1
+
+/**
+ * @brief The superblock's fields, right after its PageHeader
+ */
+struct SuperblockLayout {
+    char magic[8];
+    uint32_t version;
+    uint32_t page_size;
+    uint32_t page_count;
+    uint32_t free_head;
+    uint32_t free_count;
+    uint32_t trunk_count;
+};
+static_assert(sizeof(SuperblockLayout) == 32, "SuperblockLayout is part of the file format");
+
+/**
+ * @brief One trunk directory slot, the slots follow SuperblockLayout
+ */
+struct TrunkSlot {
+    char name[Pager::MAX_NAME_LENGTH + 1];
+    char base_type[Pager::MAX_NAME_LENGTH + 1];
+    uint32_t root_page;
+    uint32_t reserved;
+};
+static_assert(sizeof(TrunkSlot) == 64, "TrunkSlot is part of the file format");
+
+#define SUPERBLOCK_OFFSET sizeof(PageHeader)
+#define TRUNK_OFFSET (sizeof(PageHeader) + sizeof(SuperblockLayout))
+#define FREE_LIST_OFFSET sizeof(PageHeader)
+
+/**
+ * Helpers
+ */
+static inline PageHeader* HeaderOf(uint8_t* page) noexcept {
+    return reinterpret_cast<PageHeader*>(page);
+}
+
+static inline const PageHeader* HeaderOf(const uint8_t* page) noexcept {
+    return reinterpret_cast<const PageHeader*>(page);
+}
+
+static inline SuperblockLayout* SuperblockOf(uint8_t* page) noexcept {
+    return reinterpret_cast<SuperblockLayout*>(page + SUPERBLOCK_OFFSET);
+}
+
+/**
+ * @brief A kFREELIST page's body is a count, then that many page numbers filling the rest of the page
+ */
+static inline uint32_t& FreeCountOf(uint8_t* page) noexcept {
+    return *reinterpret_cast<uint32_t*>(page + FREE_LIST_OFFSET);
+}
+
+static inline uint32_t* FreeEntriesOf(uint8_t* page) noexcept {
+    return reinterpret_cast<uint32_t*>(page + FREE_LIST_OFFSET + sizeof(uint32_t));
+}
+
+static inline uint32_t PageChecksum(const uint8_t* page, size_t page_size) noexcept {
+    return Crc32c(page + sizeof(uint32_t), page_size - sizeof(uint32_t));
+}
+
+static bool IsZero(const uint8_t* page, size_t page_size) noexcept {
+    return page[0] == 0 && memcmp(page, page + 1, page_size - 1) == 0;
+}
+
+static void CheckName(const std::string& name, const char* what) {
+    if (name.empty() || name.size() > Pager::MAX_NAME_LENGTH)
+        throw FileException(std::string(what) + " names must be 1 to " + std::to_string(Pager::MAX_NAME_LENGTH) +
+                            " characters: \"" + name + "\"");
+}
+
+/**
+ * Pager
+ */
+Pager::Pager() noexcept
+: page_size_(0), page_count_(0), direct_(false), unsynced_(false), meta_changed_(false), superblock_dirty_(false),
+  free_head_(NO_PAGE), free_count_(0), free_dirty_(false)
+{}
+
+Pager::~Pager() {
+    try {
+        Close();
+    } catch (const FileException&) {
+    }
+}
+
+void Pager::Create(const std::string& file_path, const PagerOptions& options) {
+    if (options.page_size < MIN_PAGE_SIZE || options.page_size > MAX_PAGE_SIZE ||
+        (options.page_size & (options.page_size - 1)) != 0)
+        throw FileException("Page size must be a power of two from 512 bytes to 64 KiB");
+    Close();
+    page_size_ = options.page_size;
+    direct_ = options.direct && page_size_ >= 4096;
+    file_ = std::make_unique<FileWriter>(file_path, FileWriterOptions{true, true, direct_});
+    page_count_ = 1;
+    superblock_ = AllocatePageBuffer();
+    free_page_ = AllocatePageBuffer();
+    superblock_dirty_ = true;
+    Flush();
+}
+
+void Pager::Open(const std::string& file_path, bool direct) {
+    Close();
+    // The page size is in the superblock, read the smallest possible page first to learn it
+    {
+        FileWriter probe(file_path, FileWriterOptions{false, false, false});
+        uint8_t head[MIN_PAGE_SIZE];
+        if (probe.ReadAt(0, head, sizeof(head)) < sizeof(PageHeader) + sizeof(SuperblockLayout))
+            throw FileException("Not a database file: " + file_path);
+        const SuperblockLayout* layout = SuperblockOf(head);
+        if (memcmp(layout->magic, PAGER_MAGIC, sizeof(layout->magic)) != 0)
+            throw FileException("Not a database file: " + file_path);
+        if (layout->version != PAGER_VERSION)
+            throw FileException("Unsupported database version " + std::to_string(layout->version) + ": " + file_path);
+        if (layout->page_size < MIN_PAGE_SIZE || layout->page_size > MAX_PAGE_SIZE ||
+            (layout->page_size & (layout->page_size - 1)) != 0)
+            throw FileException("Damaged superblock: " + file_path);
+        page_size_ = layout->page_size;
+    }
+    direct_ = direct && page_size_ >= 4096;
+    file_ = std::make_unique<FileWriter>(file_path, FileWriterOptions{false, false, direct_});
+    superblock_ = AllocatePageBuffer();
+    free_page_ = AllocatePageBuffer();
+    // The superblock is checked before page_count_ is known
+    page_count_ = 1;
+    try {
+        ReadPage(0, superblock_.get());
+        LoadSuperblock();
+        if (free_head_ != NO_PAGE)
+            ReadPage(free_head_, free_page_.get());
+    } catch (const FileException&) {
+        Reset();
+        throw;
+    }
+}
+
+void Pager::Close() {
+    if (!file_)
+        return;
+    Flush();
+    file_->Close();
+    Reset();
+}
+
+bool Pager::IsOpen() const noexcept {
+    return file_ != nullptr;
+}
+
+void Pager::Flush() {
+    std::vector<uint32_t> page_nos;
+    std::vector<uint8_t*> pages;
+    if (superblock_dirty_) {
+        StoreSuperblock();
+        page_nos.push_back(0);
+        pages.push_back(superblock_.get());
+    }
+    if (free_dirty_) {
+        page_nos.push_back(free_head_);
+        pages.push_back(free_page_.get());
+    }
+    for (auto& spilled : spilled_) {
+        page_nos.push_back(spilled.first);
+        pages.push_back(spilled.second.get());
+    }
+    if (!pages.empty())
+        WritePages(page_nos.data(), pages.data(), pages.size());
+    if (unsynced_)
+        file_->Sync();
+    unsynced_ = free_dirty_ = superblock_dirty_ = false;
+    spilled_.clear();
+}
+
+uint32_t Pager::Allocate() {
+    superblock_dirty_ = meta_changed_ = true;
+    if (free_head_ == NO_PAGE)
+        return page_count_++;
+
+    --free_count_;
+    uint32_t& listed = FreeCountOf(free_page_.get());
+    if (listed > 0) {
+        free_dirty_ = true;
+        return FreeEntriesOf(free_page_.get())[--listed];
+    }
+    // The head list page is empty, hand it out and move on to the next one
+    uint32_t page_no = free_head_;
+    free_head_ = HeaderOf(free_page_.get())->next;
+    free_dirty_ = false;
+    if (free_head_ != NO_PAGE)
+        LoadFreePage(free_head_);
+    return page_no;
+}
+
+void Pager::Free(uint32_t page_no) {
+    if (page_no == NO_PAGE || page_no >= page_count_)
+        throw FileException("Cannot free page " + std::to_string(page_no) + " of " + std::to_string(page_count_));
+    superblock_dirty_ = meta_changed_ = true;
+    ++free_count_;
+    uint32_t& listed = FreeCountOf(free_page_.get());
+    if (free_head_ != NO_PAGE && listed < FreeListCapacity()) {
+        FreeEntriesOf(free_page_.get())[listed++] = page_no;
+        free_dirty_ = true;
+        return;
+    }
+    // The head list page is full, or there is none, the freed page becomes the new head. The full page is
+    // not written yet: until Flush() the file must keep the free list a logged superblock describes
+    if (free_dirty_) {
+        spilled_.emplace_back(free_head_, AllocatePageBuffer());
+        memcpy(spilled_.back().second.get(), free_page_.get(), page_size_);
+    }
+    InitPage(free_page_.get(), PageType::kFREELIST);
+    HeaderOf(free_page_.get())->next = free_head_;
+    free_head_ = page_no;
+    free_dirty_ = true;
+}
+
+void Pager::ReadPage(uint32_t page_no, uint8_t* page) const {
+    CheckPage(page_no);
+    // Allocated pages that were never written lie past the end of the file and read as zero
+    if (file_->ReadAt(static_cast<uint64_t>(page_no) * page_size_, page, page_size_) < page_size_)
+        memset(page, 0, page_size_);
+    VerifyPage(page_no, page);
+}
+
+void Pager::WritePage(uint32_t page_no, uint8_t* page) {
+    CheckPage(page_no);
+    StampPage(page_no, page, page_size_);
+    file_->WriteAt(static_cast<uint64_t>(page_no) * page_size_, page, page_size_);
+    unsynced_ = true;
+}
+
+void Pager::ReadPages(const uint32_t* page_nos, uint8_t* const* pages, size_t count) const {
+    std::vector<FileIo> batch(count);
+    for (size_t i = 0; i < count; ++i) {
+        CheckPage(page_nos[i]);
+        batch[i] = FileIo{static_cast<uint64_t>(page_nos[i]) * page_size_, pages[i], page_size_};
+    }
+    file_->ReadBatch(batch);
+    for (size_t i = 0; i < count; ++i)
+        VerifyPage(page_nos[i], pages[i]);
+}
+
+void Pager::WritePages(const uint32_t* page_nos, uint8_t* const* pages, size_t count) {
+    std::vector<FileIo> batch(count);
+    for (size_t i = 0; i < count; ++i) {
+        CheckPage(page_nos[i]);
+        StampPage(page_nos[i], pages[i], page_size_);
+        batch[i] = FileIo{static_cast<uint64_t>(page_nos[i]) * page_size_, pages[i], page_size_};
+    }
+    file_->WriteBatch(batch);
+    unsynced_ = true;
+}
+
+void Pager::InitPage(uint8_t* page, PageType type) const noexcept {
+    memset(page, 0, page_size_);
+    HeaderOf(page)->type = type;
+    HeaderOf(page)->next = NO_PAGE;
+}
+
+std::unique_ptr<uint8_t[], AlignedDeleter> Pager::AllocatePageBuffer(size_t pages) const {
+    uint8_t* buffer = static_cast<uint8_t*>(aligned_alloc(page_size_, pages * page_size_));
+    if (buffer == nullptr)
+        throw FileException(std::string("Failed to allocate page buffer: ") + strerror(errno));
+    return std::unique_ptr<uint8_t[], AlignedDeleter>(buffer);
+}
+
+void Pager::StampPage(uint32_t page_no, uint8_t* page, size_t page_size) noexcept {
+    HeaderOf(page)->page_no = page_no;
+    HeaderOf(page)->checksum = PageChecksum(page, page_size);
+}
+
+void Pager::ChangedMeta(std::vector<uint32_t>& page_nos, std::vector<uint8_t*>& pages) {
+    if (!meta_changed_)
+        return;
+    StoreSuperblock();
+    page_nos.push_back(0);
+    pages.push_back(superblock_.get());
+    if (free_head_ != NO_PAGE) {
+        page_nos.push_back(free_head_);
+        pages.push_back(free_page_.get());
+    }
+    for (auto& spilled : spilled_) {
+        page_nos.push_back(spilled.first);
+        pages.push_back(spilled.second.get());
+    }
+    meta_changed_ = false;
+}
+
+uint32_t Pager::CreateTrunk(const std::string& name, const std::string& base_type) {
+    CheckName(name, "Trunk");
+    CheckName(base_type, "Type");
+    if (FindTrunk(name) != nullptr)
+        throw FileException("Trunk already exists: " + name);
+    if (trunks_.size() >= MaxTrunks())
+        throw FileException("No room for trunk " + name + ", the superblock holds " + std::to_string(MaxTrunks()));
+    uint32_t root_page = Allocate();
+    std::unique_ptr<uint8_t[], AlignedDeleter> root = AllocatePageBuffer();
+    InitPage(root.get(), PageType::kDATA);
+    WritePage(root_page, root.get());
+    trunks_.push_back(TrunkInfo{name, base_type, root_page});
+    superblock_dirty_ = meta_changed_ = true;
+    return root_page;
+}
+
+const TrunkInfo* Pager::FindTrunk(const std::string& name) const noexcept {
+    for (const TrunkInfo& trunk : trunks_)
+        if (trunk.name == name)
+            return &trunk;
+    return nullptr;
+}
+
+void Pager::SetTrunkRoot(const std::string& name, uint32_t root_page) {
+    CheckPage(root_page);
+    TrunkInfo* trunk = const_cast<TrunkInfo*>(FindTrunk(name));
+    if (trunk == nullptr)
+        throw FileException("No trunk named " + name);
+    trunk->root_page = root_page;
+    superblock_dirty_ = meta_changed_ = true;
+}
+
+uint32_t Pager::DropTrunk(const std::string& name) {
+    const TrunkInfo* trunk = FindTrunk(name);
+    if (trunk == nullptr)
+        throw FileException("No trunk named " + name);
+    uint32_t root_page = trunk->root_page;
+    trunks_.erase(trunks_.begin() + (trunk - trunks_.data()));
+    superblock_dirty_ = meta_changed_ = true;
+    return root_page;
+}
+
+const std::vector<TrunkInfo>& Pager::Trunks() const noexcept {
+    return trunks_;
+}
+
+size_t Pager::MaxTrunks() const noexcept {
+    return (page_size_ - TRUNK_OFFSET) / sizeof(TrunkSlot);
+}
+
+uint32_t Pager::PageSize() const noexcept {
+    return page_size_;
+}
+
+uint32_t Pager::PageCount() const noexcept {
+    return page_count_;
+}
+
+uint32_t Pager::FreeCount() const noexcept {
+    return free_count_;
+}
+
+const FileWriter& Pager::File() const noexcept {
+    return *file_;
+}
+
+void Pager::Reset() noexcept {
+    file_.reset();
+    superblock_.reset();
+    free_page_.reset();
+    trunks_.clear();
+    page_size_ = page_count_ = 0;
+    free_head_ = NO_PAGE;
+    free_count_ = 0;
+    unsynced_ = meta_changed_ = superblock_dirty_ = free_dirty_ = false;
+    spilled_.clear();
+}
+
+void Pager::CheckPage(uint32_t page_no) const {
+    if (!file_)
+        throw FileException("No database file is open");
+    if (page_no >= page_count_)
+        throw FileException("Page " + std::to_string(page_no) + " is past the end of the file, " +
+                            std::to_string(page_count_) + " pages");
+}
+
+void Pager::VerifyPage(uint32_t page_no, const uint8_t* page) const {
+    const PageHeader* header = HeaderOf(page);
+    if (header->checksum == PageChecksum(page, page_size_) && header->page_no == page_no)
+        return;
+    // Checked last, a zero page is rare and only costs a scan when the checksum already failed
+    if (IsZero(page, page_size_))
+        return;
+    if (header->page_no != page_no)
+        throw FileException("Page " + std::to_string(page_no) + " holds page " + std::to_string(header->page_no));
+    throw FileException("Page " + std::to_string(page_no) + " failed its checksum");
+}
+
+void Pager::LoadSuperblock() {
+    const SuperblockLayout* layout = SuperblockOf(superblock_.get());
+    if (layout->page_size != page_size_ || layout->page_count == 0 || layout->free_count >= layout->page_count ||
+        layout->free_head >= layout->page_count || layout->trunk_count > MaxTrunks())
+        throw FileException("Damaged superblock");
+    page_count_ = layout->page_count;
+    free_head_ = layout->free_head;
+    free_count_ = layout->free_count;
+    const TrunkSlot* slots = reinterpret_cast<const TrunkSlot*>(superblock_.get() + TRUNK_OFFSET);
+    for (uint32_t i = 0; i < layout->trunk_count; ++i) {
+        TrunkInfo trunk{std::string(slots[i].name, strnlen(slots[i].name, sizeof(slots[i].name))),
+                        std::string(slots[i].base_type, strnlen(slots[i].base_type, sizeof(slots[i].base_type))),
+                        slots[i].root_page};
+        if (trunk.root_page == NO_PAGE || trunk.root_page >= page_count_)
+            throw FileException("Damaged superblock, trunk " + trunk.name + " has root page " +
+                                std::to_string(trunk.root_page));
+        trunks_.push_back(std::move(trunk));
+    }
+}
+
+void Pager::StoreSuperblock() noexcept {
+    InitPage(superblock_.get(), PageType::kSUPERBLOCK);
+    SuperblockLayout* layout = SuperblockOf(superblock_.get());
+    memcpy(layout->magic, PAGER_MAGIC, sizeof(layout->magic));
+    layout->version = PAGER_VERSION;
+    layout->page_size = page_size_;
+    layout->page_count = page_count_;
+    layout->free_head = free_head_;
+    layout->free_count = free_count_;
+    layout->trunk_count = static_cast<uint32_t>(trunks_.size());
+    TrunkSlot* slots = reinterpret_cast<TrunkSlot*>(superblock_.get() + TRUNK_OFFSET);
+    for (size_t i = 0; i < trunks_.size(); ++i) {
+        memcpy(slots[i].name, trunks_[i].name.data(), trunks_[i].name.size());
+        memcpy(slots[i].base_type, trunks_[i].base_type.data(), trunks_[i].base_type.size());
+        slots[i].root_page = trunks_[i].root_page;
+    }
+}
+
+uint32_t Pager::FreeListCapacity() const noexcept {
+    return static_cast<uint32_t>((page_size_ - FREE_LIST_OFFSET - sizeof(uint32_t)) / sizeof(uint32_t));
+}
+
+void Pager::LoadFreePage(uint32_t page_no) {
+    for (auto it = spilled_.begin(); it != spilled_.end(); ++it) {
+        if (it->first != page_no)
+            continue;
+        memcpy(free_page_.get(), it->second.get(), page_size_);
+        spilled_.erase(it);
+        free_dirty_ = true;
+        return;
+    }
+    ReadPage(page_no, free_page_.get());
+}
@@ -0,0 +1,274 @@
+#ifndef DT_SRC_STORAGE_PAGER_H
+#define DT_SRC_STORAGE_PAGER_H
+
+// C++ Includes
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Local Includes
+#include "file/filereader.h"
+#include "file/filewriter.h"
+
+/**
+ * @brief What a page holds, stored in its header
+ */
+enum class PageType : uint8_t {
+    kFREE,          // Never written, or zeroed
+    kSUPERBLOCK,    // Page 0, the file header and the trunk directory
+    kFREELIST,      // Numbers of free pages, chained through the header's next
+    kDATA,          // Owned by a trunk
+    kBTREE_INNER,   // B+Tree separators and children
+    kBTREE_LEAF     // B+Tree keys and values, chained to the right sibling through next
+};
+
+/**
+ * @brief The first bytes of every page, host byte order
+ */
+struct PageHeader {
+    uint32_t checksum;      // CRC-32C of the page after this field
+    uint32_t page_no;       // Where the page belongs, catches misdirected writes
+    PageType type;
+    uint8_t flags;
+    uint16_t reserved;
+    uint32_t next;          // Sibling or chain link, Pager::NO_PAGE if none
+    uint64_t lsn;           // Last log record applied to the page
+};
+static_assert(sizeof(PageHeader) == 24, "PageHeader is part of the file format");
+
+/**
+ * @brief Construction time settings for a new database file
+ */
+struct PagerOptions {
+    uint32_t page_size = 4096;  // a power of two from 512 bytes to 64 KiB, fixed for the file's lifetime
+    bool direct = false;        // O_DIRECT, only for page sizes of at least 4 KiB
+};
+
+/**
+ * @brief A trunk of the database, the objects of one base struct
+ */
+struct TrunkInfo {
+    std::string name;
+    std::string base_type;
+    uint32_t root_page;
+};
+
+/**
+ * @brief Owns the single database file as an array of fixed size pages
+ *
+ * Page 0 is the superblock: the file's magic, page size and page count, the
+ * head of the free list and the trunk directory. Free pages are tracked in
+ * kFREELIST pages that each list page numbers, so allocating or freeing a
+ * page touches only the head list page, which stays in memory.
+ *
+ * Every page starts with a PageHeader the pager stamps on write and checks on
+ * read. Superblock and free list changes reach the disk on Flush(), so a
+ * WriteAheadLog can log them with the pages of a commit first.
+ */
+class Pager {
+public:
+    /**
+     * @brief Page 0 is the superblock, so it can name "no page" everywhere else
+     */
+    static constexpr uint32_t NO_PAGE = 0;
+    static constexpr uint32_t MIN_PAGE_SIZE = 512;
+    static constexpr uint32_t MAX_PAGE_SIZE = 64 * 1024;
+    static constexpr size_t MAX_NAME_LENGTH = 27;
+
+    /**
+     * Tors
+     */
+    Pager() noexcept;
+
+    /**
+     * @brief Flush and close the file, errors are lost, call Close() to see them
+     */
+    ~Pager();
+
+    /**
+     * NON-COPYABLE
+     */
+    Pager(const Pager&) = delete;
+    Pager(Pager&&) = delete;
+    Pager& operator=(const Pager&) = delete;
+
+    /**
+     * File Functions
+     */
+
+    /**
+     * @brief Create a new, empty database file, replacing any file at file_path
+     * @throws FileException for an invalid page size or I/O errors
+     */
+    void Create(const std::string& file_path, const PagerOptions& options = PagerOptions());
+
+    /**
+     * @brief Open an existing database file, the page size is read from it
+     * @throws FileException if the file is not a database or is damaged
+     */
+    void Open(const std::string& file_path, bool direct = false);
+
+    /**
+     * @brief Flush and close the file if open
+     */
+    void Close();
+
+    bool IsOpen() const noexcept;
+
+    /**
+     * @brief Write the superblock and free list and sync the file if anything was written since the last sync
+     */
+    void Flush();
+
+    /**
+     * Pages
+     */
+
+    /**
+     * @brief Take a free page, or grow the file by one
+     * @return The page number, its contents are undefined until written
+     */
+    uint32_t Allocate();
+
+    /**
+     * @brief Return a page to the free list
+     * @param page_no An allocated page other than the superblock
+     */
+    void Free(uint32_t page_no);
+
+    /**
+     * @brief Read and check one page
+     * @param page Destination of PageSize() bytes, aligned for O_DIRECT if it is in use
+     * @throws FileException if the page fails its checksum or belongs elsewhere
+     */
+    void ReadPage(uint32_t page_no, uint8_t* page) const;
+
+    /**
+     * @brief Stamp the header of one page and write it
+     * @param page PageSize() bytes, the header's page_no and checksum are filled in
+     */
+    void WritePage(uint32_t page_no, uint8_t* page);
+
+    /**
+     * @brief Read many pages, adjacent page numbers share one system call
+     */
+    void ReadPages(const uint32_t* page_nos, uint8_t* const* pages, size_t count) const;
+
+    /**
+     * @brief Stamp and write many pages, adjacent page numbers share one system call
+     */
+    void WritePages(const uint32_t* page_nos, uint8_t* const* pages, size_t count);
+
+    /**
+     * @brief Zero a page buffer and set up its header
+     */
+    void InitPage(uint8_t* page, PageType type) const noexcept;
+
+    /**
+     * @brief A page buffer aligned for direct I/O
+     */
+    std::unique_ptr<uint8_t[], AlignedDeleter> AllocatePageBuffer(size_t pages = 1) const;
+
+    /**
+     * @brief Fill in the header's page_no and checksum, as WritePage() does
+     */
+    static void StampPage(uint32_t page_no, uint8_t* page, size_t page_size) noexcept;
+
+    /**
+     * @brief The superblock and free list pages as Flush() would write them, if they changed since the last call
+     *
+     * Pages stay owned by the pager and valid until its next change. A
+     * WriteAheadLog commit logs them with the data pages they describe.
+     */
+    void ChangedMeta(std::vector<uint32_t>& page_nos, std::vector<uint8_t*>& pages);
+
+    /**
+     * Trunks
+     */
+
+    /**
+     * @brief Add a trunk with an empty kDATA root page
+     * @return The trunk's root page
+     * @throws FileException for a duplicate or overlong name or a full directory
+     */
+    uint32_t CreateTrunk(const std::string& name, const std::string& base_type);
+
+    /**
+     * @brief Find a trunk by name
+     * @return The trunk, nullptr if there is none
+     */
+    const TrunkInfo* FindTrunk(const std::string& name) const noexcept;
+
+    /**
+     * @brief Move a trunk's root, e.g. after its tree grew a level
+     */
+    void SetTrunkRoot(const std::string& name, uint32_t root_page);
+
+    /**
+     * @brief Remove a trunk from the directory, freeing its pages is up to the caller
+     * @return The trunk's root page
+     */
+    uint32_t DropTrunk(const std::string& name);
+
+    const std::vector<TrunkInfo>& Trunks() const noexcept;
+
+    /**
+     * @brief The number of trunks the superblock has room for
+     */
+    size_t MaxTrunks() const noexcept;
+
+    /**
+     * Stats
+     */
+    uint32_t PageSize() const noexcept;
+    uint32_t PageCount() const noexcept;
+    uint32_t FreeCount() const noexcept;
+    const FileWriter& File() const noexcept;
+
+private:
+    /**
+     * Internal Functions
+     */
+    void Reset() noexcept;
+    void CheckPage(uint32_t page_no) const;
+    void VerifyPage(uint32_t page_no, const uint8_t* page) const;
+    void LoadSuperblock();
+    void StoreSuperblock() noexcept;
+    uint32_t FreeListCapacity() const noexcept;
+
+    /**
+     * @brief Make a free list page the head, from spilled_ if it was never written
+     */
+    void LoadFreePage(uint32_t page_no);
+
+    std::unique_ptr<FileWriter> file_;
+    uint32_t page_size_;
+    uint32_t page_count_;
+    bool direct_;
+    bool unsynced_;         // Pages were written since the last sync
+    bool meta_changed_;     // The superblock or free list changed since the last ChangedMeta()
+
+    /**
+     * Superblock Items
+     */
+    std::unique_ptr<uint8_t[], AlignedDeleter> superblock_;
+    std::vector<TrunkInfo> trunks_;
+    bool superblock_dirty_;
+
+    /**
+     * Free List Items, the head list page is kept in free_page_
+     */
+    std::unique_ptr<uint8_t[], AlignedDeleter> free_page_;
+    uint32_t free_head_;
+    uint32_t free_count_;
+    bool free_dirty_;
+
+    /**
+     * @brief Full list pages pushed off the head, held back until Flush() like the head itself
+     */
+    std::vector<std::pair<uint32_t, std::unique_ptr<uint8_t[], AlignedDeleter>>> spilled_;
+};
+
+#endif
@@ -0,0 +1,269 @@
+// C++ Includes
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Local Includes
+#include "exception/file_exception.h"
+#include "exception/schema_exception.h"
+#include "schema/record.h"
+#include "secondaryindex.h"
+
+/**
+ * @brief Present byte of an included member
+ */
+#define INCLUDE_NULL 0
+#define INCLUDE_VALUE 1
+
+static inline bool IsReal(const FieldLayout& field) noexcept {
+    return field.type == FieldType::kFLOAT || field.type == FieldType::kDOUBLE;
+}
+
+static const FieldLayout& ScalarField(const RecordLayout& layout, const std::string& member) {
+    int32_t index = layout.FieldIndex(member);
+    if (index < 0)
+        throw SchemaException(layout.Name() + " has no member " + member + " to index");
+    const FieldLayout& field = layout.Field(index);
+    if (field.is_array || field.type == FieldType::kSTRUCT)
+        throw SchemaException("Arrays and embedded structs like " + member + " cannot be indexed");
+    return field;
+}
+
+/**
+ * Index Cursor
+ */
+IndexCursor::IndexCursor() noexcept
+: index_(nullptr), cursor_(), last_(), valid_(false), primary_(), included_()
+{}
+
+bool IndexCursor::Valid() const noexcept {
+    return valid_;
+}
+
+void IndexCursor::Next() {
+    cursor_.Next();
+    Settle();
+}
+
+const PrimaryKey& IndexCursor::Primary() const noexcept {
+    return primary_;
+}
+
+bool IndexCursor::IsNull(size_t include) const noexcept {
+    return *Included(include) == INCLUDE_NULL;
+}
+
+int64_t IndexCursor::Integer(size_t include) const noexcept {
+    int64_t value = 0;
+    if (!IsNull(include))
+        memcpy(&value, Included(include) + 1, sizeof(value));
+    return value;
+}
+
+double IndexCursor::Real(size_t include) const noexcept {
+    double value = 0.0;
+    if (!IsNull(include))
+        memcpy(&value, Included(include) + 1, sizeof(value));
+    return value;
+}
+
+std::string_view IndexCursor::String(size_t include) const noexcept {
+    if (IsNull(include))
+        return std::string_view();
+    uint32_t length;
+    memcpy(&length, Included(include) + 1, sizeof(length));
+    return std::string_view(reinterpret_cast<const char*>(Included(include)) + 1 + sizeof(length), length);
+}
+
+void IndexCursor::Settle() {
+    valid_ = false;
+    if (!cursor_.Valid())
+        return;
+    std::string key = cursor_.StringKey();
+    if (key.compare(0, last_.size(), last_) > 0)
+        return;
+    valid_ = true;
+
+    // The primary key follows the member's encoding
+    size_t member = IndexKeySize(key, index_->key_field_);
+    primary_.is_string = index_->primary_type_ == KeyType::kSTRING;
+    if (primary_.is_string)
+        primary_.bytes.assign(key, member, std::string::npos);
+    else
+        primary_.integer = ReadOrderedInteger(key.data() + member, index_->primary_type_ == KeyType::kUNSIGNED);
+
+    const uint8_t* value = cursor_.Value();
+    uint32_t offset = 0;
+    for (size_t i = 0; i < index_->include_.size(); ++i) {
+        included_[i] = offset;
+        if (value[offset++] == INCLUDE_NULL)
+            continue;
+        if (index_->include_[i].type == FieldType::kSTRING) {
+            uint32_t length;
+            memcpy(&length, value + offset, sizeof(length));
+            offset += sizeof(length) + length;
+        } else {
+            offset += sizeof(uint64_t);
+        }
+    }
+}
+
+const uint8_t* IndexCursor::Included(size_t include) const noexcept {
+    return cursor_.Value() + included_[include];
+}
+
+/**
+ * Secondary Index
+ */
+SecondaryIndex::SecondaryIndex(BufferPool& pool, uint32_t root_page, const RecordLayout& layout,
+                               const IndexSpec& spec, KeyType primary_type)
+: tree_(pool, root_page, KeyType::kSTRING), spec_(spec), key_field_(ScalarField(layout, spec.member)), include_(),
+  primary_type_(primary_type)
+{
+    for (const std::string& member : spec.include)
+        include_.push_back(ScalarField(layout, member));
+}
+
+SecondaryIndex::SecondaryIndex(BufferPool& pool, uint32_t root_page, const FieldLayout& key_field, KeyType primary_type)
+: tree_(pool, root_page, KeyType::kSTRING), spec_(IndexSpec{key_field.name, {}, {}}), key_field_(key_field), include_(),
+  primary_type_(primary_type)
+{}
+
+void SecondaryIndex::CheckSpec(const RecordLayout& layout, const IndexSpec& spec) {
+    ScalarField(layout, spec.member);
+    for (const std::string& member : spec.include)
+        ScalarField(layout, member);
+}
+
+void SecondaryIndex::Insert(const uint8_t* record, const PrimaryKey& primary) {
+    std::string key, value;
+    EntryKey(key, record, primary);
+    EntryValue(value, record);
+    if (!tree_.Insert(key, reinterpret_cast<const uint8_t*>(value.data()), value.size()))
+        throw FileException("The index on " + spec_.member + " already has an entry for the record");
+}
+
+void SecondaryIndex::Erase(const uint8_t* record, const PrimaryKey& primary) {
+    std::string key;
+    EntryKey(key, record, primary);
+    tree_.Erase(key);
+}
+
+void SecondaryIndex::CheckEntry(const uint8_t* record, const PrimaryKey& primary) const {
+    std::string key, value;
+    EntryKey(key, record, primary);
+    EntryValue(value, record);
+    if (key.size() + value.size() > tree_.MaxEntrySize())
+        throw FileException("The index on " + spec_.member + " cannot hold an entry of " +
+                            std::to_string(key.size() + value.size()) + " bytes, at most " +
+                            std::to_string(tree_.MaxEntrySize()) + " fit");
+}
+
+void SecondaryIndex::Update(const uint8_t* old_record, const uint8_t* new_record, const PrimaryKey& primary) {
+    std::string old_key, new_key, old_value, new_value;
+    EntryKey(old_key, old_record, primary);
+    EntryKey(new_key, new_record, primary);
+    EntryValue(old_value, old_record);
+    EntryValue(new_value, new_record);
+    if (old_key == new_key) {
+        if (old_value != new_value)
+            tree_.Update(new_key, reinterpret_cast<const uint8_t*>(new_value.data()), new_value.size());
+        return;
+    }
+    tree_.Erase(old_key);
+    if (!tree_.Insert(new_key, reinterpret_cast<const uint8_t*>(new_value.data()), new_value.size()))
+        throw FileException("The index on " + spec_.member + " already has an entry for the record");
+}
+
+IndexCursor SecondaryIndex::Find(const IndexValue& value) const {
+    std::string key;
+    AppendIndexKey(key, key_field_, value);
+    return Scan(key, key);
+}
+
+IndexCursor SecondaryIndex::Range(const IndexValue& lower, const IndexValue& upper) const {
+    std::string first, last;
+    AppendIndexKey(first, key_field_, lower);
+    AppendIndexKey(last, key_field_, upper);
+    return Scan(first, std::move(last));
+}
+
+IndexCursor SecondaryIndex::FindLike(const uint8_t* record) const {
+    std::string key;
+    AppendIndexKey(key, key_field_, record);
+    return Scan(key, key);
+}
+
+bool SecondaryIndex::Covers(const std::vector<std::string>& members) const noexcept {
+    for (const std::string& member : members) {
+        if (member != spec_.member && IncludeIndex(member) < 0)
+            return false;
+    }
+    return true;
+}
+
+int32_t SecondaryIndex::IncludeIndex(std::string_view member) const noexcept {
+    for (size_t i = 0; i < spec_.include.size(); ++i) {
+        if (spec_.include[i] == member)
+            return static_cast<int32_t>(i);
+    }
+    return -1;
+}
+
+const IndexSpec& SecondaryIndex::Spec() const noexcept {
+    return spec_;
+}
+
+const FieldLayout& SecondaryIndex::KeyField() const noexcept {
+    return key_field_;
+}
+
+uint32_t SecondaryIndex::RootPage() const noexcept {
+    return tree_.RootPage();
+}
+
+const BTree& SecondaryIndex::Tree() const noexcept {
+    return tree_;
+}
+
+void SecondaryIndex::EntryKey(std::string& key, const uint8_t* record, const PrimaryKey& primary) const {
+    AppendIndexKey(key, key_field_, record);
+    if (primary.is_string)
+        key += primary.bytes;
+    else
+        AppendOrderedInteger(key, primary.integer, primary_type_ == KeyType::kUNSIGNED);
+}
+
+void SecondaryIndex::EntryValue(std::string& value, const uint8_t* record) const {
+    for (const FieldLayout& field : include_) {
+        if (FieldIsNull(record, field)) {
+            value.push_back(INCLUDE_NULL);
+            continue;
+        }
+        value.push_back(INCLUDE_VALUE);
+        if (field.type == FieldType::kSTRING) {
+            std::string_view bytes = ReadVar(record, field);
+            uint32_t length = static_cast<uint32_t>(bytes.size());
+            value.append(reinterpret_cast<const char*>(&length), sizeof(length));
+            value.append(bytes);
+        } else if (IsReal(field)) {
+            double real = ReadReal(record, field);
+            value.append(reinterpret_cast<const char*>(&real), sizeof(real));
+        } else {
+            int64_t integer = ReadInteger(record, field);
+            value.append(reinterpret_cast<const char*>(&integer), sizeof(integer));
+        }
+    }
+}
+
+IndexCursor SecondaryIndex::Scan(const std::string& first, std::string last) const {
+    IndexCursor cursor;
+    cursor.index_ = this;
+    cursor.cursor_ = tree_.Seek(first);
+    cursor.last_ = std::move(last);
+    cursor.included_.resize(include_.size());
+    cursor.Settle();
+    return cursor;
+}
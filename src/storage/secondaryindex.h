@@ -0,0 +1,192 @@
+#ifndef DT_SRC_STORAGE_SECONDARYINDEX_H
+#define DT_SRC_STORAGE_SECONDARYINDEX_H
+
+// C++ Includes
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Local Includes
+#include "file/bufferpool.h"
+#include "schema/catalog.h"
+#include "storage/btree.h"
+#include "storage/indexkey.h"
+
+/**
+ * @brief A secondary index of a trunk and the members it carries
+ */
+struct IndexSpec {
+    std::string member;                 // A secondary key of the trunk's layout
+    std::vector<std::string> include;   // Scalar members copied into the index, so lookups need not fetch records
+    std::string type;                   // The derived struct declaring member, empty for the trunk's base struct
+};
+
+class SecondaryIndex;
+
+/**
+ * @brief The entries of a secondary index with one key or a range of keys, in key then primary key order
+ *
+ * Like BTreeCursor, the index must not be changed while a cursor is valid.
+ */
+class IndexCursor {
+public:
+    /**
+     * Tors
+     */
+    IndexCursor() noexcept;
+    IndexCursor(IndexCursor&&) noexcept = default;
+    IndexCursor& operator=(IndexCursor&&) noexcept = default;
+
+    bool Valid() const noexcept;
+    void Next();
+
+    /**
+     * @brief The primary key of the record the entry belongs to
+     */
+    const PrimaryKey& Primary() const noexcept;
+
+    /**
+     * Included Members, by position in IndexSpec::include, valid until the cursor moves
+     */
+    bool IsNull(size_t include) const noexcept;
+    int64_t Integer(size_t include) const noexcept;
+    double Real(size_t include) const noexcept;
+    std::string_view String(size_t include) const noexcept;
+
+private:
+    friend class SecondaryIndex;
+
+    /**
+     * @brief Stop past the last key of the range, or decode the entry the cursor is on
+     */
+    void Settle();
+    const uint8_t* Included(size_t include) const noexcept;
+
+    const SecondaryIndex* index_;
+    BTreeCursor cursor_;
+    std::string last_;          // Encoded last key of the range, every entry it prefixes is in range
+    bool valid_;
+    PrimaryKey primary_;
+    std::vector<uint32_t> included_;
+};
+
+/**
+ * @brief A non-unique index of one member, entries are (key, primary key) pairs in a string B+Tree
+ *
+ * Each entry's tree key is the member's IndexKey encoding followed by the
+ * primary key, so equal members stay unique and sort by primary key. The
+ * entry's value holds the included members: a present byte and then eight
+ * bytes of an integer or real or a 32-bit length and the bytes of a string.
+ * Entries follow the records through Insert(), Update() and Erase(), which
+ * the owning Trunk calls.
+ */
+class SecondaryIndex {
+public:
+    /**
+     * Tors
+     */
+
+    /**
+     * @param root_page A tree from BTree::Create(pool, KeyType::kSTRING)
+     * @param primary_type How the trunk's primary keys are ordered, see PrimaryKeyType()
+     * @throws SchemaException if a member of spec is not a scalar member of layout
+     */
+    SecondaryIndex(BufferPool& pool, uint32_t root_page, const RecordLayout& layout, const IndexSpec& spec,
+                   KeyType primary_type);
+
+    /**
+     * @brief An index of a member no layout declares, like a record's type tag, with nothing included
+     */
+    SecondaryIndex(BufferPool& pool, uint32_t root_page, const FieldLayout& key_field, KeyType primary_type);
+
+    /**
+     * @brief Check that spec names scalar members of layout
+     * @throws SchemaException for unknown members, arrays and embedded structs
+     */
+    static void CheckSpec(const RecordLayout& layout, const IndexSpec& spec);
+
+    /**
+     * NON-COPYABLE
+     */
+    SecondaryIndex(const SecondaryIndex&) = delete;
+    SecondaryIndex(SecondaryIndex&&) = delete;
+    SecondaryIndex& operator=(const SecondaryIndex&) = delete;
+
+    /**
+     * Entries
+     */
+
+    /**
+     * @throws FileException if the entry is larger than the tree's MaxEntrySize()
+     */
+    void Insert(const uint8_t* record, const PrimaryKey& primary);
+    void Erase(const uint8_t* record, const PrimaryKey& primary);
+
+    /**
+     * @brief Check that the entry of a record fits, so a trunk can refuse it before writing anything
+     * @throws FileException if the entry is larger than the tree's MaxEntrySize()
+     */
+    void CheckEntry(const uint8_t* record, const PrimaryKey& primary) const;
+
+    /**
+     * @brief Follow a record's change, nothing is written unless the key or an included member changed
+     */
+    void Update(const uint8_t* old_record, const uint8_t* new_record, const PrimaryKey& primary);
+
+    /**
+     * Lookup
+     */
+
+    /**
+     * @brief Every entry whose member equals value, a null value finds the null members
+     */
+    IndexCursor Find(const IndexValue& value) const;
+
+    /**
+     * @brief Every entry whose member is in [lower, upper]
+     */
+    IndexCursor Range(const IndexValue& lower, const IndexValue& upper) const;
+
+    /**
+     * @brief Every entry whose member equals the member of record
+     */
+    IndexCursor FindLike(const uint8_t* record) const;
+
+    /**
+     * @brief Whether every member in members is the key or included, so an index-only fetch can answer
+     */
+    bool Covers(const std::vector<std::string>& members) const noexcept;
+
+    /**
+     * @brief Position of an included member, -1 when it is not included
+     */
+    int32_t IncludeIndex(std::string_view member) const noexcept;
+
+    /**
+     * Stats
+     */
+    const IndexSpec& Spec() const noexcept;
+    const FieldLayout& KeyField() const noexcept;
+    uint32_t RootPage() const noexcept;
+    const BTree& Tree() const noexcept;
+
+private:
+    friend class IndexCursor;
+
+    void EntryKey(std::string& key, const uint8_t* record, const PrimaryKey& primary) const;
+    void EntryValue(std::string& value, const uint8_t* record) const;
+
+    /**
+     * @brief A cursor from the first entry at or above first through the entries last prefixes
+     */
+    IndexCursor Scan(const std::string& first, std::string last) const;
+
+    BTree tree_;
+    IndexSpec spec_;
+    FieldLayout key_field_;
+    std::vector<FieldLayout> include_;
+    KeyType primary_type_;
+};
+
+#endif
@@ -0,0 +1,419 @@
+// C++ Includes
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Local Includes
+#include "exception/file_exception.h"
+#include "exception/schema_exception.h"
+#include "schema/record.h"
+#include "storage/pager.h"
+#include "trunk.h"
+
+/**
+ * @brief The directory fields after the root page's PageHeader, index descriptors follow
+ *
+ * A descriptor is the index's root page, the type id of the struct declaring
+ * its member, the member name's length and the number of included members,
+ * the member name, then each included member as a length byte and the name.
+ */
+struct TrunkHeader {
+    uint32_t primary_root;      // Pager::NO_PAGE until the trunk is formatted
+    uint32_t type_root;
+    uint32_t index_count;
+    uint32_t reserved;
+    int64_t last_row_id;
+};
+static_assert(sizeof(TrunkHeader) == 24, "TrunkHeader is part of the file format");
+
+#define DIRECTORY_OFFSET sizeof(PageHeader)
+#define DESCRIPTOR_OFFSET (sizeof(PageHeader) + sizeof(TrunkHeader))
+
+static inline TrunkHeader* Directory(uint8_t* page) noexcept {
+    return reinterpret_cast<TrunkHeader*>(page + DIRECTORY_OFFSET);
+}
+
+static size_t DescriptorSize(const IndexSpec& spec) noexcept {
+    size_t size = 2 * sizeof(uint32_t) + 2 + spec.member.size();
+    for (const std::string& member : spec.include)
+        size += 1 + member.size();
+    return size;
+}
+
+static void StoreDescriptor(uint8_t*& out, uint32_t root, uint32_t type_id, const IndexSpec& spec) noexcept {
+    memcpy(out, &root, sizeof(root));
+    out += sizeof(root);
+    memcpy(out, &type_id, sizeof(type_id));
+    out += sizeof(type_id);
+    *out++ = static_cast<uint8_t>(spec.member.size());
+    *out++ = static_cast<uint8_t>(spec.include.size());
+    memcpy(out, spec.member.data(), spec.member.size());
+    out += spec.member.size();
+    for (const std::string& member : spec.include) {
+        *out++ = static_cast<uint8_t>(member.size());
+        memcpy(out, member.data(), member.size());
+        out += member.size();
+    }
+}
+
+static uint32_t LoadDescriptor(const uint8_t*& in, uint32_t& type_id, IndexSpec& spec) {
+    uint32_t root;
+    memcpy(&root, in, sizeof(root));
+    in += sizeof(root);
+    memcpy(&type_id, in, sizeof(type_id));
+    in += sizeof(type_id);
+    size_t length = *in++;
+    size_t includes = *in++;
+    spec.member.assign(reinterpret_cast<const char*>(in), length);
+    in += length;
+    spec.include.clear();
+    for (size_t i = 0; i < includes; ++i) {
+        length = *in++;
+        spec.include.emplace_back(reinterpret_cast<const char*>(in), length);
+        in += length;
+    }
+    return root;
+}
+
+/**
+ * @brief The type id every record starts with, as a member the type tag index can key on
+ */
+static FieldLayout TypeTagField() {
+    FieldLayout field{};
+    field.name = "type id";
+    field.type = FieldType::kINT;
+    field.size = field.alignment = field.element_size = sizeof(uint32_t);
+    field.struct_type = NO_TYPE;
+    field.declared_in = NO_TYPE;
+    // A null mask of 0 is never set, the tag is never null
+    return field;
+}
+
+static inline bool SameKey(const PrimaryKey& lhs, const PrimaryKey& rhs) noexcept {
+    return lhs.is_string ? lhs.bytes == rhs.bytes : lhs.integer == rhs.integer;
+}
+
+/**
+ * Type Cursor
+ */
+TypeCursor::TypeCursor() noexcept
+: index_(nullptr), types_(), type_(0), cursor_()
+{}
+
+bool TypeCursor::Valid() const noexcept {
+    return type_ < types_.size() && cursor_.Valid();
+}
+
+void TypeCursor::Next() {
+    cursor_.Next();
+    Settle();
+}
+
+uint32_t TypeCursor::TypeId() const noexcept {
+    return types_[type_];
+}
+
+const PrimaryKey& TypeCursor::Primary() const noexcept {
+    return cursor_.Primary();
+}
+
+void TypeCursor::Settle() {
+    while (!cursor_.Valid() && ++type_ < types_.size())
+        cursor_ = index_->Find(static_cast<int64_t>(types_[type_]));
+}
+
+/**
+ * Trunk
+ */
+void Trunk::Format(BufferPool& pool, uint32_t root_page, const SchemaCatalog& catalog, uint32_t base_type,
+                   const std::vector<IndexSpec>& indexes) {
+    // Secondary members of the base index every record, keys a derived struct declares index its branch
+    std::vector<IndexSpec> specs;
+    std::vector<uint32_t> types;
+    for (uint32_t type_id = 0; type_id < catalog.Size(); ++type_id) {
+        if (!catalog.IsA(type_id, base_type))
+            continue;
+        const RecordLayout& layout = catalog.Get(type_id);
+        for (size_t i = 0; i < layout.FieldCount(); ++i) {
+            const FieldLayout& field = layout.Field(i);
+            bool indexed = (type_id == base_type)
+                               ? (field.modifiers & kMOD_SECONDARY) != 0
+                               : field.declared_in == type_id && (field.modifiers & (kMOD_PRIMARY | kMOD_SECONDARY));
+            if (!indexed)
+                continue;
+            specs.push_back(IndexSpec{field.name, {}, (type_id == base_type) ? "" : layout.Name()});
+            types.push_back(type_id);
+        }
+    }
+    for (const IndexSpec& spec : indexes) {
+        auto it = std::find_if(specs.begin(), specs.end(), [&spec](const IndexSpec& key) {
+            return key.member == spec.member && key.type == spec.type;
+        });
+        if (it == specs.end())
+            throw SchemaException(spec.member + " is not a key of " +
+                                  (spec.type.empty() ? catalog.Get(base_type).Name() : spec.type));
+        SecondaryIndex::CheckSpec(catalog.Get(types[it - specs.begin()]), spec);
+        if (spec.include.size() > UINT8_MAX)
+            throw SchemaException("The index on " + spec.member + " includes too many members");
+        it->include = spec.include;
+    }
+    size_t size = DESCRIPTOR_OFFSET;
+    for (const IndexSpec& spec : specs) {
+        size_t longest = spec.member.size();
+        for (const std::string& member : spec.include)
+            longest = std::max(longest, member.size());
+        if (longest > UINT8_MAX)
+            throw SchemaException("The index on " + spec.member + " names a member too long to store");
+        size += DescriptorSize(spec);
+    }
+    if (size > pool.GetPager().PageSize())
+        throw FileException("The indexes of " + catalog.Get(base_type).Name() + " do not fit the trunk's root page");
+
+    PinnedPage root = pool.Pin(root_page);
+    const PageHeader* header = reinterpret_cast<const PageHeader*>(root.Data());
+    if (header->type != PageType::kDATA || Directory(root.Data())->primary_root != Pager::NO_PAGE)
+        throw FileException("Page " + std::to_string(root_page) + " is not the root of a new trunk");
+    TrunkHeader* directory = Directory(root.Data());
+    directory->primary_root = BTree::Create(pool, PrimaryKeyType(catalog.Get(base_type)));
+    directory->type_root = BTree::Create(pool, KeyType::kSTRING);
+    directory->index_count = static_cast<uint32_t>(specs.size());
+    directory->last_row_id = 0;
+    uint8_t* out = root.Data() + DESCRIPTOR_OFFSET;
+    for (size_t i = 0; i < specs.size(); ++i)
+        StoreDescriptor(out, BTree::Create(pool, KeyType::kSTRING), types[i], specs[i]);
+    root.MarkDirty();
+}
+
+Trunk::Trunk(BufferPool& pool, uint32_t root_page, const SchemaCatalog& catalog, uint32_t base_type)
+: pool_(pool), root_page_(root_page), catalog_(catalog), base_type_(base_type), primary_field_(nullptr), primary_(),
+  types_(), indexes_(), index_types_(), last_row_id_(0)
+{
+    const RecordLayout& layout = catalog_.Get(base_type_);
+    if (layout.PrimaryField() >= 0)
+        primary_field_ = &layout.Field(layout.PrimaryField());
+
+    PinnedPage root = pool_.Pin(root_page_);
+    const PageHeader* header = reinterpret_cast<const PageHeader*>(root.Data());
+    const TrunkHeader* directory = Directory(root.Data());
+    if (header->type != PageType::kDATA || directory->primary_root == Pager::NO_PAGE)
+        throw FileException("Page " + std::to_string(root_page_) + " is not the root of a trunk");
+    KeyType primary_type = PrimaryKeyType(layout);
+    primary_ = std::make_unique<BTree>(pool_, directory->primary_root, primary_type);
+    types_ = std::make_unique<SecondaryIndex>(pool_, directory->type_root, TypeTagField(), primary_type);
+    last_row_id_ = directory->last_row_id;
+
+    const uint8_t* in = root.Data() + DESCRIPTOR_OFFSET;
+    IndexSpec spec;
+    for (uint32_t i = 0; i < directory->index_count; ++i) {
+        uint32_t type_id;
+        uint32_t index_root = LoadDescriptor(in, type_id, spec);
+        if (type_id >= catalog_.Size() || !catalog_.IsA(type_id, base_type_))
+            throw FileException("An index of trunk page " + std::to_string(root_page_) + " belongs to an unknown struct");
+        spec.type = (type_id == base_type_) ? "" : catalog_.Get(type_id).Name();
+        indexes_.push_back(std::make_unique<SecondaryIndex>(pool_, index_root, catalog_.Get(type_id), spec,
+                                                            primary_type));
+        index_types_.push_back(type_id);
+    }
+}
+
+bool Trunk::Insert(const std::vector<uint8_t>& record) {
+    CheckRecord(record);
+    PrimaryKey primary;
+    if (primary_field_ != nullptr)
+        primary = ReadPrimaryKey(*primary_field_, record.data());
+    else
+        primary.integer = last_row_id_ + 1;
+    if (Repeats(record.data(), nullptr))
+        return false;
+    CheckEntries(record.data(), primary);
+    if (!primary_->Insert(primary.Key(), record.data(), record.size()))
+        return false;
+    if (primary_field_ == nullptr) {
+        last_row_id_ = primary.integer;
+        StoreRowId();
+    }
+    types_->Insert(record.data(), primary);
+    for (size_t i = 0; i < indexes_.size(); ++i) {
+        if (Applies(i, record.data()))
+            indexes_[i]->Insert(record.data(), primary);
+    }
+    return true;
+}
+
+bool Trunk::Update(const IndexValue& primary, const std::vector<uint8_t>& record) {
+    CheckRecord(record);
+    PrimaryKey key = KeyOf(primary);
+    if (primary_field_ != nullptr && !SameKey(ReadPrimaryKey(*primary_field_, record.data()), key))
+        throw SchemaException("The primary key " + primary_field_->name + " of a record cannot be updated");
+    std::vector<uint8_t> old_record;
+    if (!primary_->Find(key.Key(), old_record))
+        return false;
+    if (Repeats(record.data(), &key))
+        throw SchemaException("The record repeats the primary key of another " +
+                              catalog_.Get(RecordTypeId(record.data())).Name());
+    CheckEntries(record.data(), key);
+    primary_->Update(key.Key(), record.data(), record.size());
+    types_->Update(old_record.data(), record.data(), key);
+    // A record changing its type leaves the indexes of its old branch and joins those of the new one
+    for (size_t i = 0; i < indexes_.size(); ++i) {
+        bool before = Applies(i, old_record.data());
+        bool after = Applies(i, record.data());
+        if (before && after)
+            indexes_[i]->Update(old_record.data(), record.data(), key);
+        else if (before)
+            indexes_[i]->Erase(old_record.data(), key);
+        else if (after)
+            indexes_[i]->Insert(record.data(), key);
+    }
+    return true;
+}
+
+bool Trunk::Erase(const IndexValue& primary) {
+    return EraseKey(KeyOf(primary));
+}
+
+bool Trunk::Fetch(const IndexValue& primary, std::vector<uint8_t>& record) const {
+    return Fetch(KeyOf(primary), record);
+}
+
+bool Trunk::Fetch(const PrimaryKey& primary, std::vector<uint8_t>& record) const {
+    return primary_->Find(primary.Key(), record);
+}
+
+BTreeCursor Trunk::Scan() const {
+    return primary_->Begin();
+}
+
+TypeCursor Trunk::ScanType(uint32_t type_id) const {
+    if (type_id >= catalog_.Size() || !catalog_.IsA(type_id, base_type_))
+        throw SchemaException("The trunk of " + catalog_.Get(base_type_).Name() + " holds no records of type " +
+                              std::to_string(type_id));
+    TypeCursor cursor;
+    cursor.index_ = types_.get();
+    for (uint32_t derived = type_id; derived < catalog_.Size(); ++derived) {
+        // A derived struct is declared after its base, so its id is higher
+        if (catalog_.IsA(derived, type_id))
+            cursor.types_.push_back(derived);
+    }
+    cursor.cursor_ = types_->Find(static_cast<int64_t>(type_id));
+    cursor.Settle();
+    return cursor;
+}
+
+size_t Trunk::CountType(uint32_t type_id) const {
+    size_t count = 0;
+    for (TypeCursor cursor = ScanType(type_id); cursor.Valid(); cursor.Next())
+        ++count;
+    return count;
+}
+
+size_t Trunk::EraseType(uint32_t type_id) {
+    std::vector<PrimaryKey> keys;
+    for (TypeCursor cursor = ScanType(type_id); cursor.Valid(); cursor.Next())
+        keys.push_back(cursor.Primary());
+    for (const PrimaryKey& key : keys)
+        EraseKey(key);
+    return keys.size();
+}
+
+size_t Trunk::IndexCount() const noexcept {
+    return indexes_.size();
+}
+
+const SecondaryIndex& Trunk::Index(size_t index) const noexcept {
+    return *indexes_[index];
+}
+
+uint32_t Trunk::IndexType(size_t index) const noexcept {
+    return index_types_[index];
+}
+
+const SecondaryIndex* Trunk::FindIndex(std::string_view member, uint32_t type_id) const noexcept {
+    if (type_id == NO_TYPE)
+        type_id = base_type_;
+    for (size_t i = 0; i < indexes_.size(); ++i) {
+        if (index_types_[i] == type_id && indexes_[i]->Spec().member == member)
+            return indexes_[i].get();
+    }
+    return nullptr;
+}
+
+uint32_t Trunk::RootPage() const noexcept {
+    return root_page_;
+}
+
+uint32_t Trunk::BaseType() const noexcept {
+    return base_type_;
+}
+
+const BTree& Trunk::Primary() const noexcept {
+    return *primary_;
+}
+
+const SecondaryIndex& Trunk::TypeIndex() const noexcept {
+    return *types_;
+}
+
+int64_t Trunk::LastRowId() const noexcept {
+    return last_row_id_;
+}
+
+bool Trunk::EraseKey(const PrimaryKey& key) {
+    std::vector<uint8_t> old_record;
+    if (!primary_->Find(key.Key(), old_record))
+        return false;
+    primary_->Erase(key.Key());
+    types_->Erase(old_record.data(), key);
+    for (size_t i = 0; i < indexes_.size(); ++i) {
+        if (Applies(i, old_record.data()))
+            indexes_[i]->Erase(old_record.data(), key);
+    }
+    return true;
+}
+
+void Trunk::CheckRecord(const std::vector<uint8_t>& record) const {
+    uint32_t type_id = (record.size() >= sizeof(uint32_t)) ? RecordTypeId(record.data()) : NO_TYPE;
+    if (type_id >= catalog_.Size() || !catalog_.IsA(type_id, base_type_) ||
+        record.size() < catalog_.Get(type_id).FixedSize()) {
+        const std::string& base = catalog_.Get(base_type_).Name();
+        throw SchemaException("The trunk of " + base + " only holds records of " + base + " and derived structs");
+    }
+}
+
+PrimaryKey Trunk::KeyOf(const IndexValue& primary) const {
+    return MakePrimaryKey(primary_field_, primary);
+}
+
+bool Trunk::Applies(size_t index, const uint8_t* record) const noexcept {
+    return catalog_.IsA(RecordTypeId(record), index_types_[index]);
+}
+
+bool Trunk::Repeats(const uint8_t* record, const PrimaryKey* primary) const {
+    for (size_t i = 0; i < indexes_.size(); ++i) {
+        if (!(indexes_[i]->KeyField().modifiers & kMOD_PRIMARY) || !Applies(i, record))
+            continue;
+        for (IndexCursor cursor = indexes_[i]->FindLike(record); cursor.Valid(); cursor.Next()) {
+            if (primary == nullptr || !SameKey(cursor.Primary(), *primary))
+                return true;
+        }
+    }
+    return false;
+}
+
+void Trunk::CheckEntries(const uint8_t* record, const PrimaryKey& primary) const {
+    types_->CheckEntry(record, primary);
+    for (size_t i = 0; i < indexes_.size(); ++i) {
+        if (Applies(i, record))
+            indexes_[i]->CheckEntry(record, primary);
+    }
+}
+
+void Trunk::StoreRowId() {
+    PinnedPage root = pool_.Pin(root_page_);
+    Directory(root.Data())->last_row_id = last_row_id_;
+    root.MarkDirty();
+}
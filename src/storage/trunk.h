@@ -0,0 +1,222 @@
+#ifndef DT_SRC_STORAGE_TRUNK_H
+#define DT_SRC_STORAGE_TRUNK_H
+
+// C++ Includes
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// Local Includes
+#include "file/bufferpool.h"
+#include "schema/catalog.h"
+#include "storage/btree.h"
+#include "storage/indexkey.h"
+#include "storage/secondaryindex.h"
+
+/**
+ * @brief The records of one struct and the structs derived from it, through the trunk's type tag index
+ *
+ * Moves type by type in ascending type id, each in primary key order. Like
+ * IndexCursor, the trunk must not be changed while a cursor is valid.
+ */
+class TypeCursor {
+public:
+    /**
+     * Tors
+     */
+    TypeCursor() noexcept;
+    TypeCursor(TypeCursor&&) noexcept = default;
+    TypeCursor& operator=(TypeCursor&&) noexcept = default;
+
+    bool Valid() const noexcept;
+    void Next();
+
+    /**
+     * @brief The type id of the record the cursor is on
+     */
+    uint32_t TypeId() const noexcept;
+    const PrimaryKey& Primary() const noexcept;
+
+private:
+    friend class Trunk;
+
+    /**
+     * @brief Move on to the next type while the current one has no records left
+     */
+    void Settle();
+
+    const SecondaryIndex* index_;
+    std::vector<uint32_t> types_;
+    size_t type_;
+    IndexCursor cursor_;
+};
+
+/**
+ * @brief The records of one trunk, a primary B+Tree and the indexes kept in step with it
+ *
+ * The trunk's root page, the one Pager::CreateTrunk() handed out, is its
+ * directory: the primary tree's root, the type tag index's root, the next row
+ * id and one descriptor per secondary index naming its root, the struct that
+ * declares its member, the member and the included members.
+ *
+ * Records of the base struct and of every struct derived from it are stored
+ * whole as the primary tree's values, keyed by the base's primary member, or
+ * by a row id counting up from 1 when the base has none. The type tag index
+ * holds (type id, primary key) pairs, so the records of one branch of the
+ * hierarchy are found without reading the others. Every secondary member of
+ * the base gets an index over all records; every secondary or primary member
+ * a derived struct declares gets an index over the records of that struct and
+ * the structs below it. Primary members of derived structs stay unique.
+ */
+class Trunk {
+public:
+    /**
+     * @brief Set up the directory, primary tree and indexes of a new trunk
+     * @param root_page The trunk's empty kDATA root page
+     * @param base_type The trunk's base struct, every struct of catalog derived from it gets its indexes
+     * @param indexes Members to include in the index of a secondary member
+     * @throws SchemaException if a spec names a member that is not a key, or includes non-scalar members
+     * @throws FileException if the page is not an empty kDATA page or the descriptors do not fit it
+     */
+    static void Format(BufferPool& pool, uint32_t root_page, const SchemaCatalog& catalog, uint32_t base_type,
+                       const std::vector<IndexSpec>& indexes = {});
+
+    /**
+     * Tors
+     */
+
+    /**
+     * @brief Open a formatted trunk
+     * @param catalog Must outlive the trunk
+     * @throws FileException if root_page is not a trunk directory
+     */
+    Trunk(BufferPool& pool, uint32_t root_page, const SchemaCatalog& catalog, uint32_t base_type);
+
+    /**
+     * NON-COPYABLE
+     */
+    Trunk(const Trunk&) = delete;
+    Trunk(Trunk&&) = delete;
+    Trunk& operator=(const Trunk&) = delete;
+
+    /**
+     * Records
+     */
+
+    /**
+     * @brief Add a record and its index entries
+     * @param record A record of the base struct or a derived one, from RecordBuilder::Finish()
+     * @return False if a record with the same primary key exists, or the same primary member of a
+     *         derived struct, nothing is changed
+     * @throws SchemaException for a record of a struct outside the trunk's hierarchy
+     * @throws FileException if the record or one of its index entries is too large, nothing is changed
+     */
+    bool Insert(const std::vector<uint8_t>& record);
+
+    /**
+     * @brief Replace the record with a primary key, possibly by one of another derived struct
+     * @return False if there is no such record
+     * @throws SchemaException if record has another primary key or repeats a derived struct's primary member
+     * @throws FileException if the record or one of its index entries is too large, nothing is changed
+     */
+    bool Update(const IndexValue& primary, const std::vector<uint8_t>& record);
+
+    /**
+     * @brief Remove a record and its index entries
+     * @return False if there is no such record
+     */
+    bool Erase(const IndexValue& primary);
+
+    /**
+     * @brief Copy the record with a primary key, given as a value or taken from a cursor
+     * @return False if there is no such record
+     */
+    bool Fetch(const IndexValue& primary, std::vector<uint8_t>& record) const;
+    bool Fetch(const PrimaryKey& primary, std::vector<uint8_t>& record) const;
+
+    /**
+     * @brief Every record in primary key order, the cursor's values are the records
+     */
+    BTreeCursor Scan() const;
+
+    /**
+     * Types
+     */
+
+    /**
+     * @brief The records of type_id and every struct derived from it
+     * @throws SchemaException if type_id is not in the trunk's hierarchy
+     */
+    TypeCursor ScanType(uint32_t type_id) const;
+    size_t CountType(uint32_t type_id) const;
+
+    /**
+     * @brief Remove the records of type_id and every struct derived from it
+     * @return Records removed
+     */
+    size_t EraseType(uint32_t type_id);
+
+    /**
+     * Indexes
+     */
+    size_t IndexCount() const noexcept;
+    const SecondaryIndex& Index(size_t index) const noexcept;
+
+    /**
+     * @brief The struct whose records an index holds, with the records of structs derived from it
+     */
+    uint32_t IndexType(size_t index) const noexcept;
+
+    /**
+     * @brief The index of a member, nullptr if the member is not indexed
+     * @param type_id The struct declaring the member, NO_TYPE for the base struct
+     */
+    const SecondaryIndex* FindIndex(std::string_view member, uint32_t type_id = NO_TYPE) const noexcept;
+
+    /**
+     * Stats
+     */
+    uint32_t RootPage() const noexcept;
+    uint32_t BaseType() const noexcept;
+    const BTree& Primary() const noexcept;
+    const SecondaryIndex& TypeIndex() const noexcept;
+
+    /**
+     * @brief The row id given to the last record inserted into a trunk without a primary key
+     */
+    int64_t LastRowId() const noexcept;
+
+private:
+    /**
+     * Internal Functions
+     */
+    bool EraseKey(const PrimaryKey& key);
+    void CheckRecord(const std::vector<uint8_t>& record) const;
+    PrimaryKey KeyOf(const IndexValue& primary) const;
+    bool Applies(size_t index, const uint8_t* record) const noexcept;
+
+    /**
+     * @brief Whether record repeats the member of a unique index held by a record other than primary
+     */
+    bool Repeats(const uint8_t* record, const PrimaryKey* primary) const;
+
+    /**
+     * @brief Check every index entry of a record fits before the record is written, see SecondaryIndex::CheckEntry()
+     */
+    void CheckEntries(const uint8_t* record, const PrimaryKey& primary) const;
+    void StoreRowId();
+
+    BufferPool& pool_;
+    const uint32_t root_page_;
+    const SchemaCatalog& catalog_;
+    const uint32_t base_type_;
+    const FieldLayout* primary_field_;
+    std::unique_ptr<BTree> primary_;
+    std::unique_ptr<SecondaryIndex> types_;
+    std::vector<std::unique_ptr<SecondaryIndex>> indexes_;
+    std::vector<uint32_t> index_types_;
+    int64_t last_row_id_;
+};
+
+#endif
@@ -0,0 +1,449 @@
+// C++ Includes
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// C Includes
+#include <string.h>
+#include <unistd.h>
+
+// Local Includes
+#include "exception/file_exception.h"
+#include "file/checksum.h"
+#include "file/filereader.h"
+#include "file/parallel.h"
+#include "pager.h"
+#include "wal.h"
+
+#define WAL_MAGIC "DTLOG\0\0\0"
+#define WAL_VERSION 1
+
+/**
+ * @brief Record types
+ */
+#define RECORD_PAGE 1
+#define RECORD_COMMIT 2
+
+/**
+ * @brief Pages a recovery thread stamps and writes with one batch
+ */
+#define REPLAY_BATCH 256
+
+/**
+ * @brief The start of the log file, records follow it
+ */
+struct LogHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t page_size;
+    uint64_t base_lsn;      // LSN of the first record
+    uint32_t checksum;      // CRC-32C of the fields above
+    uint32_t reserved;
+};
+static_assert(sizeof(LogHeader) == 32, "LogHeader is part of the log format");
+
+/**
+ * @brief The start of every record, a page image or nothing follows it
+ */
+struct RecordHeader {
+    uint32_t checksum;      // CRC-32C of the record after this field, payload included
+    uint8_t type;
+    uint8_t reserved[3];
+    uint32_t page_no;
+    uint32_t size;          // Payload bytes
+    uint64_t lsn;
+};
+static_assert(sizeof(RecordHeader) == 24, "RecordHeader is part of the log format");
+
+/**
+ * Helpers
+ */
+static uint32_t HeaderChecksum(const LogHeader& header) noexcept {
+    return Crc32c(reinterpret_cast<const uint8_t*>(&header), offsetof(LogHeader, checksum));
+}
+
+/**
+ * @brief Read the log's header
+ * @return False if the log is too short or its header is damaged, a log whose creation was cut short
+ */
+static bool ReadHeader(const FileWriter& file, LogHeader& header) {
+    if (file.ReadAt(0, reinterpret_cast<uint8_t*>(&header), sizeof(header)) < sizeof(header))
+        return false;
+    return memcmp(header.magic, WAL_MAGIC, sizeof(header.magic)) == 0 && header.checksum == HeaderChecksum(header);
+}
+
+/**
+ * @brief Replace the log by a header alone
+ */
+static void ResetLog(FileWriter& file, uint32_t page_size, uint64_t base_lsn) {
+    LogHeader header{};
+    memcpy(header.magic, WAL_MAGIC, sizeof(header.magic));
+    header.version = WAL_VERSION;
+    header.page_size = page_size;
+    header.base_lsn = base_lsn;
+    header.checksum = HeaderChecksum(header);
+    file.Truncate(0);
+    file.WriteAt(0, reinterpret_cast<const uint8_t*>(&header), sizeof(header));
+}
+
+/**
+ * @brief The size of the record at data going by its header alone, 0 at a torn or stale tail
+ * @param available Bytes from data to the end of the log
+ * @param lsn The LSN the record must carry
+ */
+static size_t RecordSize(const uint8_t* data, size_t available, uint64_t lsn, uint32_t page_size) noexcept {
+    if (available < sizeof(RecordHeader))
+        return 0;
+    RecordHeader header;
+    memcpy(&header, data, sizeof(header));
+    bool sized = (header.type == RECORD_PAGE && header.size == page_size) ||
+                 (header.type == RECORD_COMMIT && header.size == 0);
+    if (!sized || header.lsn != lsn || available - sizeof(header) < header.size)
+        return 0;
+    return sizeof(header) + header.size;
+}
+
+/**
+ * @brief Whether a record RecordSize() accepted passes its checksum
+ */
+static bool RecordIntact(const uint8_t* data) noexcept {
+    RecordHeader header;
+    memcpy(&header, data, sizeof(header));
+    size_t size = sizeof(header) + header.size;
+    return Crc32c(data + sizeof(header.checksum), size - sizeof(header.checksum)) == header.checksum;
+}
+
+/**
+ * @brief Write the last image of each page in one partition of the committed records
+ * @param images (page number, image) pairs in log order
+ * @return Pages written
+ */
+static size_t ReplayPartition(const std::string& database_path, uint32_t page_size,
+                              const std::vector<std::pair<uint32_t, const uint8_t*>>& images) {
+    if (images.empty())
+        return 0;
+    // Later images replace earlier ones, walk backwards and keep the first seen
+    std::unordered_set<uint32_t> seen;
+    std::vector<std::pair<uint32_t, const uint8_t*>> last;
+    for (auto image = images.rbegin(); image != images.rend(); ++image) {
+        if (seen.insert(image->first).second)
+            last.push_back(*image);
+    }
+    std::sort(last.begin(), last.end());
+
+    // The log may be mapped read only, pages are stamped in a buffer of their own
+    FileWriter database(database_path, FileWriterOptions{false, false, false});
+    std::unique_ptr<uint8_t[], AlignedDeleter> buffer(
+        static_cast<uint8_t*>(aligned_alloc(page_size, static_cast<size_t>(REPLAY_BATCH) * page_size)));
+    if (buffer == nullptr)
+        throw FileException(std::string("Failed to allocate replay buffer: ") + strerror(errno));
+    std::vector<FileIo> batch;
+    for (size_t first = 0; first < last.size(); first += REPLAY_BATCH) {
+        batch.clear();
+        for (size_t i = first; i < last.size() && i - first < REPLAY_BATCH; ++i) {
+            uint8_t* page = buffer.get() + (i - first) * page_size;
+            memcpy(page, last[i].second, page_size);
+            Pager::StampPage(last[i].first, page, page_size);
+            batch.push_back(FileIo{static_cast<uint64_t>(last[i].first) * page_size, page, page_size});
+        }
+        database.WriteBatch(batch);
+    }
+    return last.size();
+}
+
+/**
+ * WriteAheadLog
+ */
+std::string WriteAheadLog::PathFor(const std::string& database_path) {
+    return database_path + "-wal";
+}
+
+RecoveryStats WriteAheadLog::Recover(const std::string& database_path, uint32_t page_size, uint32_t threads) {
+    RecoveryStats stats;
+    std::string path = PathFor(database_path);
+    if (access(path.c_str(), F_OK) != 0)
+        return stats;
+    FileWriter log(path, FileWriterOptions{false, false, false});
+    LogHeader header;
+    if (!ReadHeader(log, header)) {
+        ResetLog(log, page_size, 1);
+        return stats;
+    }
+    if (header.page_size != page_size)
+        throw FileException("The log " + path + " holds pages of " + std::to_string(header.page_size) +
+                            " bytes, the database " + std::to_string(page_size));
+    if (threads == 0)
+        threads = (std::thread::hardware_concurrency() != 0) ? std::thread::hardware_concurrency() : 1;
+    stats.threads = threads;
+
+    // Map the log, or read it whole with one large read where it cannot be mapped
+    FileReader reader(path, FileReaderOptions{ReadMode::kMMAP});
+    std::vector<uint8_t> buffered;
+    const uint8_t* data = reader.MappedData();
+    size_t size = reader.MappedSize();
+    if (!reader.Mapped()) {
+        buffered.resize(reader.Size());
+        buffered.resize(reader.ReadAt(0, buffered.data(), buffered.size()));
+        data = buffered.data();
+        size = buffered.size();
+    }
+
+    // Record boundaries follow the LSN chain, cheap enough to walk alone
+    std::vector<size_t> offsets;
+    size_t offset = sizeof(LogHeader);
+    for (uint64_t lsn = header.base_lsn; offset <= size; ++lsn) {
+        size_t length = RecordSize(data + offset, size - offset, lsn, page_size);
+        if (length == 0)
+            break;
+        offsets.push_back(offset);
+        offset += length;
+    }
+
+    // Checksums are verified in parallel, the first damaged record ends the log
+    std::vector<size_t> damaged(threads, offsets.size());
+    RunParallel(threads, threads, [&](size_t chunk) {
+        size_t last = offsets.size() * (chunk + 1) / threads;
+        for (size_t i = offsets.size() * chunk / threads; i < last; ++i) {
+            if (!RecordIntact(data + offsets[i])) {
+                damaged[chunk] = i;
+                return;
+            }
+        }
+    });
+    size_t intact = *std::min_element(damaged.begin(), damaged.end());
+
+    // Images after the last commit are dropped, the others are partitioned by page
+    size_t committed = 0;
+    std::vector<std::vector<std::pair<uint32_t, const uint8_t*>>> partitions(threads);
+    for (size_t i = 0; i < intact; ++i) {
+        if (reinterpret_cast<const RecordHeader*>(data + offsets[i])->type == RECORD_COMMIT) {
+            committed = i + 1;
+            ++stats.commits;
+        }
+    }
+    for (size_t i = 0; i < committed; ++i) {
+        const RecordHeader* record = reinterpret_cast<const RecordHeader*>(data + offsets[i]);
+        if (record->type == RECORD_PAGE)
+            partitions[record->page_no % threads].emplace_back(record->page_no, data + offsets[i] + sizeof(*record));
+    }
+    stats.records = intact;
+    stats.log_bytes = (intact < offsets.size()) ? offsets[intact] - sizeof(LogHeader) : offset - sizeof(LogHeader);
+
+    // Each partition's pages are written by one thread, the database is synced once for all of them
+    std::vector<size_t> pages(threads, 0);
+    RunParallel(threads, threads, [&](size_t partition) {
+        pages[partition] = ReplayPartition(database_path, page_size, partitions[partition]);
+    });
+    for (size_t count : pages)
+        stats.pages += count;
+    if (stats.pages > 0) {
+        FileWriter database(database_path, FileWriterOptions{false, false, false});
+        database.Sync();
+    }
+    ResetLog(log, page_size, header.base_lsn + intact);
+    log.Sync();
+    return stats;
+}
+
+WriteAheadLog::WriteAheadLog(const std::string& database_path, uint32_t page_size, const WalOptions& options)
+: path_(PathFor(database_path)), page_size_(page_size), options_(options),
+  file_(path_, FileWriterOptions{true, false, false}), file_size_(sizeof(LogHeader)), next_lsn_(1), written_lsn_(0),
+  durable_lsn_(0), busy_(false), failed_(false), closed_(false), commits_(0), syncs_(0)
+{
+    LogHeader header;
+    if (ReadHeader(file_, header)) {
+        std::vector<uint8_t> first(sizeof(RecordHeader) + page_size_);
+        size_t available = file_.ReadAt(sizeof(header), first.data(), first.size());
+        if (header.page_size == page_size_ && RecordSize(first.data(), available, header.base_lsn, page_size_) > 0 &&
+            RecordIntact(first.data()))
+            throw FileException("The log " + path_ + " holds records, recover the database first");
+        next_lsn_ = header.base_lsn;
+    }
+    written_lsn_ = durable_lsn_ = next_lsn_ - 1;
+    ResetLog(file_, page_size_, next_lsn_);
+    file_.Sync();
+    buffer_.reserve(options_.buffer_size);
+    if (options_.durability == Durability::kPERIODIC)
+        syncer_ = std::thread(&WriteAheadLog::SyncPeriodically, this);
+}
+
+WriteAheadLog::~WriteAheadLog() {
+    try {
+        Close();
+    } catch (const FileException&) {
+    }
+}
+
+uint64_t WriteAheadLog::Commit(const uint32_t* page_nos, uint8_t* const* pages, size_t count) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    CheckOpen();
+    for (size_t i = 0; i < count; ++i) {
+        reinterpret_cast<PageHeader*>(pages[i])->lsn = next_lsn_;
+        Append(RECORD_PAGE, page_nos[i], pages[i], page_size_);
+    }
+    uint64_t lsn = next_lsn_;
+    Append(RECORD_COMMIT, Pager::NO_PAGE, nullptr, 0);
+    ++commits_;
+
+    if (options_.durability == Durability::kSYNC)
+        Await(lock, lsn, true);
+    else if (buffer_.size() >= options_.buffer_size && !busy_)
+        Drain(lock, false);
+    return lsn;
+}
+
+void WriteAheadLog::Flush(uint64_t lsn) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    CheckOpen();
+    Await(lock, std::min(lsn, next_lsn_ - 1), options_.durability != Durability::kNONE);
+}
+
+void WriteAheadLog::Truncate() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    CheckOpen();
+    done_.wait(lock, [this] { return !busy_; });
+    buffer_.clear();
+    ResetLog(file_, page_size_, next_lsn_);
+    file_size_ = sizeof(LogHeader);
+    written_lsn_ = durable_lsn_ = next_lsn_ - 1;
+}
+
+void WriteAheadLog::Close() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (closed_)
+        return;
+    closed_ = true;
+    stop_.notify_all();
+    lock.unlock();
+    if (syncer_.joinable())
+        syncer_.join();
+    lock.lock();
+    if (!failed_)
+        Await(lock, next_lsn_ - 1, true);
+    lock.unlock();
+    file_.Close();
+}
+
+const WalOptions& WriteAheadLog::Options() const noexcept {
+    return options_;
+}
+
+uint64_t WriteAheadLog::NextLsn() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return next_lsn_;
+}
+
+uint64_t WriteAheadLog::DurableLsn() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return durable_lsn_;
+}
+
+uint64_t WriteAheadLog::Size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return file_size_ + buffer_.size();
+}
+
+uint64_t WriteAheadLog::Commits() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return commits_;
+}
+
+uint64_t WriteAheadLog::Syncs() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return syncs_;
+}
+
+void WriteAheadLog::Append(uint8_t type, uint32_t page_no, const uint8_t* payload, uint32_t size) {
+    RecordHeader header{};
+    header.type = type;
+    header.page_no = page_no;
+    header.size = size;
+    header.lsn = next_lsn_++;
+    uint32_t checksum = Crc32c(reinterpret_cast<const uint8_t*>(&header) + sizeof(header.checksum),
+                               sizeof(header) - sizeof(header.checksum));
+    header.checksum = (size > 0) ? Crc32c(payload, size, checksum) : checksum;
+    buffer_.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (size > 0)
+        buffer_.append(reinterpret_cast<const char*>(payload), size);
+}
+
+void WriteAheadLog::CheckOpen() const {
+    if (closed_)
+        throw FileException("The log " + path_ + " is closed");
+    if (failed_)
+        throw FileException("The log " + path_ + " failed a write or sync, recover the database");
+}
+
+void WriteAheadLog::Await(std::unique_lock<std::mutex>& lock, uint64_t lsn, bool sync) {
+    while ((sync ? durable_lsn_ : written_lsn_) < lsn) {
+        if (failed_)
+            throw FileException("The log " + path_ + " failed a write or sync, recover the database");
+        if (busy_)
+            done_.wait(lock);
+        else
+            Drain(lock, sync);
+    }
+}
+
+void WriteAheadLog::Drain(std::unique_lock<std::mutex>& lock, bool sync) {
+    busy_ = true;
+    if (sync && options_.group_delay_us > 0) {
+        // Let the commits arriving meanwhile join this sync
+        lock.unlock();
+        std::this_thread::sleep_for(std::chrono::microseconds(options_.group_delay_us));
+        lock.lock();
+    }
+    std::string batch;
+    batch.swap(buffer_);
+    uint64_t last = next_lsn_ - 1;
+    uint64_t offset = file_size_;
+    file_size_ += batch.size();
+    lock.unlock();
+    try {
+        if (!batch.empty())
+            file_.WriteAt(offset, reinterpret_cast<const uint8_t*>(batch.data()), batch.size());
+        if (sync)
+            file_.Sync();
+    } catch (...) {
+        lock.lock();
+        busy_ = false;
+        failed_ = true;
+        done_.notify_all();
+        throw;
+    }
+    lock.lock();
+    // Hand the written buffer's capacity back
+    if (buffer_.empty()) {
+        batch.clear();
+        buffer_.swap(batch);
+    }
+    written_lsn_ = last;
+    if (sync) {
+        durable_lsn_ = last;
+        ++syncs_;
+    }
+    busy_ = false;
+    done_.notify_all();
+}
+
+void WriteAheadLog::SyncPeriodically() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    std::chrono::milliseconds interval(options_.sync_interval_ms);
+    auto deadline = std::chrono::steady_clock::now() + interval;
+    while (!stop_.wait_until(lock, deadline, [this] { return closed_; })) {
+        deadline = std::chrono::steady_clock::now() + interval;
+        if (busy_ || failed_ || durable_lsn_ == next_lsn_ - 1)
+            continue;
+        try {
+            Drain(lock, true);
+        } catch (const FileException&) {
+            // failed_ is set, the next commit reports it
+        }
+    }
+}
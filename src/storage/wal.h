@@ -0,0 +1,193 @@
+#ifndef DT_SRC_STORAGE_WAL_H
+#define DT_SRC_STORAGE_WAL_H
+
+// C++ Includes
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Local Includes
+#include "file/filewriter.h"
+
+/**
+ * @brief When a commit reaches the disk
+ */
+enum class Durability : uint8_t {
+    kSYNC,          // Before Commit() returns, commits waiting together share one fdatasync
+    kPERIODIC,      // Within WalOptions::sync_interval_ms, a crash loses at most that much
+    kNONE           // When the OS writes it back, only checkpoints are synced
+};
+
+/**
+ * @brief Construction time settings for a WriteAheadLog
+ */
+struct WalOptions {
+    Durability durability = Durability::kSYNC;
+    uint32_t sync_interval_ms = 100;        // kPERIODIC: longest time between a commit and its sync
+    uint32_t group_delay_us = 0;            // kSYNC: how long a sync waits for more commits to join it
+    size_t buffer_size = 1 << 20;           // Records buffered before they are written without a sync
+    uint64_t checkpoint_size = 64 << 20;    // Log bytes after which BufferPool::Commit() checkpoints
+};
+
+/**
+ * @brief What a recovery found in the log and wrote to the database
+ */
+struct RecoveryStats {
+    uint64_t log_bytes = 0;     // Bytes of intact records read
+    uint64_t records = 0;
+    uint64_t commits = 0;
+    uint64_t pages = 0;         // Distinct pages written to the database
+    uint32_t threads = 0;       // Threads that verified and replayed the records
+};
+
+/**
+ * @brief The redo log of one database file, kept next to it as <database>-wal
+ *
+ * A commit appends an image of every page it changed and a commit record,
+ * each record carrying a CRC-32C of itself and the next log sequence number
+ * (LSN), then makes them durable as its Durability asks. Records are
+ * buffered, and one write and one fdatasync serve every commit waiting
+ * when a sync starts: group commit.
+ *
+ * Recovery replays the last committed image of each page and stops at the
+ * first record that fails its CRC or is out of sequence, a torn tail. It
+ * maps the log, checks CRCs and writes pages on every core: records are
+ * partitioned by page number, so each page is written by one thread once.
+ * Images after the last commit record are ignored, which is why a
+ * BufferPool with a log never writes back a page before it is committed.
+ * A checkpoint writes and syncs every page, then Truncate() empties the log.
+ *
+ * Thread safe, concurrent commits are what group commit batches.
+ */
+class WriteAheadLog {
+public:
+    /**
+     * @brief The log's file name for a database file
+     */
+    static std::string PathFor(const std::string& database_path);
+
+    /**
+     * @brief Replay the committed pages of a log into its database file, then empty the log
+     *
+     * Run before Pager::Open() after an unclean shutdown, a missing or empty log is
+     * a clean one. The database is synced before the log is truncated.
+     * @param threads Threads to verify and replay records with, 0 for one per core
+     * @throws FileException for I/O errors or a log of another page size
+     */
+    static RecoveryStats Recover(const std::string& database_path, uint32_t page_size, uint32_t threads = 0);
+
+    /**
+     * Tors
+     */
+
+    /**
+     * @brief Open or create the log of a database file
+     * @param page_size The database's page size, every page record holds one page
+     * @throws FileException if the log still holds records, Recover() them first
+     */
+    WriteAheadLog(const std::string& database_path, uint32_t page_size, const WalOptions& options = WalOptions());
+
+    /**
+     * @brief Write and sync buffered records, errors are lost, call Close() to see them
+     */
+    ~WriteAheadLog();
+
+    /**
+     * NON-COPYABLE
+     */
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog(WriteAheadLog&&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+    /**
+     * Log Functions
+     */
+
+    /**
+     * @brief Log page images and a commit record as one atomic change
+     *
+     * Each page's header lsn is set to its record's LSN before it is copied.
+     * @param pages count pages of the database's page size
+     * @return The commit record's LSN
+     * @throws FileException if a write or sync failed, the log then refuses every later commit
+     */
+    uint64_t Commit(const uint32_t* page_nos, uint8_t* const* pages, size_t count);
+
+    /**
+     * @brief Make the records through lsn durable, whatever the durability level
+     *
+     * Pages logged up to lsn may then be written to the database, the log's
+     * records reach the disk first. Durability::kNONE writes without a sync.
+     */
+    void Flush(uint64_t lsn);
+
+    /**
+     * @brief Empty the log once every committed page is synced to the database, LSNs keep counting up
+     */
+    void Truncate();
+
+    /**
+     * @brief Write and sync buffered records and stop the periodic sync
+     */
+    void Close();
+
+    /**
+     * Stats
+     */
+    const WalOptions& Options() const noexcept;
+    uint64_t NextLsn() const;
+    uint64_t DurableLsn() const;
+
+    /**
+     * @brief Bytes of the log, buffered records included
+     */
+    uint64_t Size() const;
+    uint64_t Commits() const;
+    uint64_t Syncs() const;
+
+private:
+    /**
+     * Internal Functions
+     */
+    void Append(uint8_t type, uint32_t page_no, const uint8_t* payload, uint32_t size);
+    void CheckOpen() const;
+
+    /**
+     * @brief Wait until the records through lsn are written, and synced if sync, leading the I/O when nobody is
+     */
+    void Await(std::unique_lock<std::mutex>& lock, uint64_t lsn, bool sync);
+
+    /**
+     * @brief Write the buffer and optionally sync, the mutex is released for the I/O
+     */
+    void Drain(std::unique_lock<std::mutex>& lock, bool sync);
+
+    /**
+     * @brief The body of the Durability::kPERIODIC sync thread
+     */
+    void SyncPeriodically();
+
+    const std::string path_;
+    const uint32_t page_size_;
+    const WalOptions options_;
+    FileWriter file_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable done_;      // I/O finished
+    std::condition_variable stop_;      // The periodic sync thread should stop
+    std::string buffer_;                // Records not yet written
+    uint64_t file_size_;                // Bytes written or being written
+    uint64_t next_lsn_;
+    uint64_t written_lsn_;              // Last LSN written to the file
+    uint64_t durable_lsn_;              // Last LSN synced
+    bool busy_;                         // A thread is writing or syncing
+    bool failed_;
+    bool closed_;
+    uint64_t commits_;
+    uint64_t syncs_;
+    std::thread syncer_;
+};
+
+#endif
@@ -0,0 +1,137 @@
+// C++ Includes
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// C Includes
+#include <unistd.h>
+
+// Local Includes
+#include "exception/file_exception.h"
+#include "file/blockcache.h"
+#include "file/filereader.h"
+
+#define BLOCK 4096
+#define FILE_SIZE (10 * BLOCK + 100)
+
+static bool mPassed = true;
+
+static void Check(bool condition, const std::string& what) {
+    std::cout << (condition ? "ok      " : "FAILED  ") << what << std::endl;
+    mPassed = mPassed && condition;
+}
+
+static uint8_t Pattern(uint64_t offset, uint8_t generation) {
+    return static_cast<uint8_t>(offset * 7 + offset / BLOCK + generation);
+}
+
+static void WriteFile(const std::string& path, uint8_t generation) {
+    std::vector<uint8_t> data(FILE_SIZE);
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = Pattern(i, generation);
+    FILE* file = fopen(path.c_str(), "wb");
+    fwrite(data.data(), 1, data.size(), file);
+    fclose(file);
+}
+
+/**
+ * @brief ReadAt() through the reader, true when it returned the expected count and bytes
+ */
+static bool ReadsBack(const FileReader& reader, uint64_t offset, size_t size, size_t expected, uint8_t generation = 0) {
+    std::vector<uint8_t> buffer(size + 1, 0xEE);
+    if (reader.ReadAt(offset, buffer.data() + 1, size) != expected)
+        return false;
+    for (size_t i = 0; i < expected; ++i)
+        if (buffer[i + 1] != Pattern(offset + i, generation))
+            return false;
+    return true;
+}
+
+static void CheckCache(const std::string& path, bool direct) {
+    std::string mode = direct ? " (direct)" : "";
+    FileReaderOptions options;
+    options.direct = direct;
+    options.cache_blocks = 4;
+    FileReader reader(path, options);
+    const BlockCache* cache = reader.Cache();
+    Check(cache != nullptr && cache->Capacity() == 4 && cache->BlockSize() == BLOCK, "reader owns a cache" + mode);
+
+    // Misses load blocks, repeated reads hit
+    Check(ReadsBack(reader, 0, BLOCK, BLOCK), "first block read" + mode);
+    Check(cache->Misses() == 1 && cache->Hits() == 0, "first read misses" + mode);
+    Check(ReadsBack(reader, 10, 100, 100), "read inside a cached block" + mode);
+    Check(cache->Misses() == 1 && cache->Hits() == 1, "second read hits" + mode);
+    Check(ReadsBack(reader, 100, 9000, 9000), "read spanning three blocks" + mode);
+    Check(cache->Misses() == 3 && cache->Hits() == 2, "only the new blocks miss" + mode);
+
+    // CLOCK: a full sweep clears every reference bit, then a referenced block survives the next one
+    Check(ReadsBack(reader, 3 * BLOCK, BLOCK, BLOCK), "fourth block fills the cache" + mode);
+    Check(ReadsBack(reader, 4 * BLOCK, BLOCK, BLOCK), "fifth block evicts the first" + mode);
+    Check(ReadsBack(reader, 1 * BLOCK, BLOCK, BLOCK), "second block read again" + mode);
+    uint64_t misses = cache->Misses();
+    Check(cache->Hits() == 3 && misses == 5, "second block was still cached" + mode);
+    Check(ReadsBack(reader, 0, BLOCK, BLOCK), "first block read again" + mode);
+    Check(cache->Misses() == misses + 1, "first block was evicted" + mode);
+    Check(ReadsBack(reader, 1 * BLOCK, 1, 1) && cache->Misses() == misses + 1, "referenced block kept over the third" + mode);
+    Check(ReadsBack(reader, 2 * BLOCK, 1, 1) && cache->Misses() == misses + 2, "third block was evicted" + mode);
+
+    // The short last block ends every read
+    Check(ReadsBack(reader, 10 * BLOCK + 50, 200, 50), "read past the end is short" + mode);
+    Check(ReadsBack(reader, 9 * BLOCK + 4000, 500, 196), "read into the short block" + mode);
+    Check(ReadsBack(reader, 10 * BLOCK + 100, 10, 0), "read at the end is empty" + mode);
+    Check(ReadsBack(reader, 11 * BLOCK, 10, 0), "read after the end is empty" + mode);
+    misses = cache->Misses();
+    Check(ReadsBack(reader, 10 * BLOCK, 100, 100) && cache->Misses() == misses, "short block is cached" + mode);
+
+    // Reopening drops the cached blocks of the old file
+    reader.Close();
+    WriteFile(path, 1);
+    reader.Open(path);
+    Check(ReadsBack(reader, 0, 100, 100, 1), "reopened file is read again" + mode);
+    WriteFile(path, 0);
+}
+
+int main(int argc, char* argv[]) {
+    // Read a scratch file at the given path through a FileReader's block cache
+    if (argc != 2)
+        return -1;
+    std::string path = argv[1];
+
+    try {
+        WriteFile(path, 0);
+        CheckCache(path, false);
+        CheckCache(path, true);
+
+        // Without cache_blocks every ReadAt() goes to the file
+        FileReader reader(path);
+        Check(reader.Cache() == nullptr, "no cache by default");
+        Check(ReadsBack(reader, 9 * BLOCK + 4000, 500, 196), "uncached read into the short block");
+
+        // A cache of its own over a reader
+        BlockCache cache(reader, 2, 512);
+        std::vector<uint8_t> buffer(1000);
+        Check(cache.ReadAt(1000, buffer.data(), buffer.size()) == 1000 && buffer[0] == Pattern(1000, 0) &&
+              buffer[999] == Pattern(1999, 0), "512 byte blocks");
+        Check(cache.Misses() == 3 && cache.Hits() == 0, "three blocks loaded");
+    } catch (const FileException& e) {
+        std::cout << "FileException: " << e.what() << std::endl;
+        unlink(path.c_str());
+        return -1;
+    }
+
+    bool throws = false;
+    try {
+        FileReader reader(path);
+        BlockCache cache(reader, 4, 1000);
+    } catch (const FileException& e) {
+        std::cout << "        FileException: " << e.what() << std::endl;
+        throws = true;
+    }
+    Check(throws, "block size must be a power of two");
+
+    unlink(path.c_str());
+    return mPassed ? 1 : 0;
+}
@@ -0,0 +1,220 @@
+// C++ Includes
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+// Local Includes
+#include "exception/file_exception.h"
+#include "file/bufferpool.h"
+#include "storage/btree.h"
+#include "storage/pager.h"
+
+#define KEYS 50000
+
+static bool mPassed = true;
+
+static void Check(bool condition, const std::string& what) {
+    std::cout << (condition ? "ok      " : "FAILED  ") << what << std::endl;
+    mPassed = mPassed && condition;
+}
+
+static uint32_t Next(uint64_t& state) {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return static_cast<uint32_t>(state >> 33);
+}
+
+/**
+ * @brief A value of a length that varies with the key, so nodes split at uneven points
+ */
+static std::string ValueOf(const std::string& key, uint32_t generation) {
+    return key.substr(0, 4) + std::string(key.size() % 13 + generation % 3, static_cast<char>('a' + generation % 26));
+}
+
+static bool SameAsReference(const BTree& tree, const std::map<std::string, std::string>& reference) {
+    std::vector<uint8_t> value;
+    for (const auto& item : reference) {
+        if (!tree.Find(item.first, value) || std::string(value.begin(), value.end()) != item.second)
+            return false;
+    }
+    size_t count = 0;
+    auto it = reference.begin();
+    for (BTreeCursor cursor = tree.Begin(); cursor.Valid(); cursor.Next(), ++it, ++count) {
+        if (it == reference.end() || cursor.StringKey() != it->first ||
+            std::string(reinterpret_cast<const char*>(cursor.Value()), cursor.ValueSize()) != it->second)
+            return false;
+    }
+    return count == reference.size();
+}
+
+static bool SameAsReference(const BTree& tree, const std::map<int64_t, int64_t>& reference) {
+    std::vector<uint8_t> value;
+    for (const auto& item : reference) {
+        if (!tree.Find(item.first, value) || value.size() != sizeof(int64_t) ||
+            *reinterpret_cast<const int64_t*>(value.data()) != item.second)
+            return false;
+    }
+    size_t count = 0;
+    auto it = reference.begin();
+    for (BTreeCursor cursor = tree.Begin(); cursor.Valid(); cursor.Next(), ++it, ++count) {
+        if (it == reference.end() || cursor.IntegerKey() != it->first)
+            return false;
+    }
+    return count == reference.size();
+}
+
+int main(int argc, char* argv[]) {
+    // Build trees in a scratch database file at the given path and check them against std::map
+    if (argc != 2)
+        return -1;
+    std::string path = argv[1];
+
+    try {
+        Pager pager;
+        // Small pages make deep trees with many splits
+        pager.Create(path, PagerOptions{512});
+        uint32_t integer_root;
+        uint32_t string_root;
+        std::map<int64_t, int64_t> integers;
+        std::map<std::string, std::string> strings;
+        {
+            BufferPool pool(pager, 64);
+            integer_root = BTree::Create(pool, KeyType::kINTEGER);
+            BTree tree(pool, integer_root, KeyType::kINTEGER);
+            uint64_t state = 1;
+            bool inserted = true;
+            for (int i = 0; i < KEYS; ++i) {
+                int64_t key = static_cast<int64_t>(Next(state)) - INT32_MAX + ((i % 7 == 0) ? INT64_MIN / 2 : 0);
+                int64_t value = ~key;
+                bool fresh = integers.emplace(key, value).second;
+                inserted = inserted && tree.Insert(key, reinterpret_cast<const uint8_t*>(&value), sizeof(value)) == fresh;
+            }
+            Check(inserted, "integer inserts report duplicates");
+            Check(tree.Height() > 2 && tree.Splits() > 0, "integer tree is " + std::to_string(tree.Height()) + " levels");
+            Check(SameAsReference(tree, integers), "integer lookups and scan");
+
+            int64_t value = 0;
+            Check(!tree.Insert(integers.begin()->first, reinterpret_cast<const uint8_t*>(&value), sizeof(value)),
+                  "duplicate insert rejected");
+            // Erase every third key and update every fifth, some to another size
+            uint32_t index = 0;
+            bool changed = true;
+            for (auto it = integers.begin(); it != integers.end(); ++index) {
+                if (index % 3 == 0) {
+                    changed = changed && tree.Erase(it->first);
+                    it = integers.erase(it);
+                    continue;
+                }
+                if (index % 5 == 0) {
+                    it->second = -it->second;
+                    changed = changed && tree.Update(it->first, reinterpret_cast<const uint8_t*>(&it->second),
+                                                     sizeof(it->second));
+                }
+                ++it;
+            }
+            Check(changed && !tree.Erase(INT64_MAX) && !tree.Update(INT64_MAX, nullptr, 0), "erase and update");
+            Check(SameAsReference(tree, integers), "integer tree after erase and update");
+
+            // Range scan from the middle
+            auto middle = integers.begin();
+            std::advance(middle, integers.size() / 2);
+            BTreeCursor cursor = tree.Seek(middle->first - 1);
+            Check(cursor.Valid() && cursor.IntegerKey() == middle->first, "seek lands on the next key");
+            cursor = tree.Seek(INT64_MAX);
+            Check(!cursor.Valid(), "seek past the last key");
+
+            // Strings sharing long prefixes, guid-like binary keys and keys that shrink a node's prefix
+            string_root = BTree::Create(pool, KeyType::kSTRING);
+            BTree names(pool, string_root, KeyType::kSTRING);
+            state = 2;
+            inserted = true;
+            for (int i = 0; i < KEYS; ++i) {
+                uint32_t pick = Next(state);
+                std::string key;
+                if (pick % 4 == 0) {
+                    key.resize(16);
+                    for (char& c : key)
+                        c = static_cast<char>(Next(state));
+                } else {
+                    char buffer[48];
+                    snprintf(buffer, sizeof(buffer), "customer/region-%02u/%08u", pick % 3, pick % 100000);
+                    key = buffer;
+                    if (pick % 4 == 1)
+                        key.resize(key.size() - pick % 9);
+                }
+                std::string value = ValueOf(key, 0);
+                bool fresh = strings.emplace(key, value).second;
+                inserted = inserted && names.Insert(key, reinterpret_cast<const uint8_t*>(value.data()), value.size()) == fresh;
+            }
+            Check(inserted, "string inserts report duplicates");
+            Check(SameAsReference(names, strings), "string lookups and scan, " + std::to_string(names.Height()) + " levels");
+            index = 0;
+            for (auto it = strings.begin(); it != strings.end(); ++index) {
+                if (index % 2 == 0) {
+                    names.Erase(it->first);
+                    it = strings.erase(it);
+                    continue;
+                }
+                it->second = ValueOf(it->first, index);
+                names.Update(it->first, reinterpret_cast<const uint8_t*>(it->second.data()), it->second.size());
+                ++it;
+            }
+            Check(SameAsReference(names, strings), "string tree after erase and update");
+            std::vector<uint8_t> scratch;
+            Check(!names.Find(std::string("customer/"), scratch) &&
+                  names.Seek(std::string("customer/")).StringKey().compare(0, 9, "customer/") == 0,
+                  "seek to a prefix of many keys");
+
+            try {
+                std::string huge(names.MaxEntrySize() + 1, 'x');
+                names.Insert(huge, nullptr, 0);
+                Check(false, "oversized entry");
+            } catch (const FileException& e) {
+                std::cout << "        FileException: " << e.what() << std::endl;
+                Check(true, "oversized entry");
+            }
+            try {
+                names.Insert(int64_t{5}, nullptr, 0);
+                Check(false, "integer key in a string tree");
+            } catch (const FileException& e) {
+                std::cout << "        FileException: " << e.what() << std::endl;
+                Check(true, "integer key in a string tree");
+            }
+        }
+        pager.CreateTrunk("ints", "Sample");
+        pager.SetTrunkRoot("ints", integer_root);
+        pager.Close();
+
+        // Everything is still there after reopening
+        pager.Open(path);
+        BufferPool pool(pager, 64);
+        BTree tree(pool, pager.FindTrunk("ints")->root_page, KeyType::kINTEGER);
+        Check(SameAsReference(tree, integers), "integer tree survives reopening");
+        BTree names(pool, string_root, KeyType::kSTRING);
+        Check(SameAsReference(names, strings), "string tree survives reopening");
+        try {
+            BTree wrong(pool, string_root, KeyType::kINTEGER);
+            Check(false, "open with the wrong key type");
+        } catch (const FileException& e) {
+            std::cout << "        FileException: " << e.what() << std::endl;
+            Check(true, "open with the wrong key type");
+        }
+
+        // Unsigned keys order above the signed range
+        uint32_t unsigned_root = BTree::Create(pool, KeyType::kUNSIGNED);
+        BTree large(pool, unsigned_root, KeyType::kUNSIGNED);
+        std::vector<uint64_t> values{UINT64_MAX, 0, 1ULL << 63, 5, (1ULL << 63) - 1};
+        for (uint64_t value : values)
+            large.Insert(static_cast<int64_t>(value), nullptr, 0);
+        std::vector<uint64_t> order;
+        for (BTreeCursor cursor = large.Begin(); cursor.Valid(); cursor.Next())
+            order.push_back(static_cast<uint64_t>(cursor.IntegerKey()));
+        Check(order == std::vector<uint64_t>{0, 5, (1ULL << 63) - 1, 1ULL << 63, UINT64_MAX}, "unsigned key order");
+    } catch (const FileException& e) {
+        std::cout << "FileException: " << e.what() << std::endl;
+        return -1;
+    }
+    return mPassed ? 1 : 0;
+}
@@ -0,0 +1,114 @@
+// C++ Includes
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Local Includes
+#include "exception/file_exception.h"
+#include "file/bufferpool.h"
+#include "storage/pager.h"
+
+#define PAGES 256
+#define FRAMES 16
+
+static bool mPassed = true;
+
+static void Check(bool condition, const std::string& what) {
+    std::cout << (condition ? "ok      " : "FAILED  ") << what << std::endl;
+    mPassed = mPassed && condition;
+}
+
+static uint32_t& Counter(const PinnedPage& page) {
+    return *reinterpret_cast<uint32_t*>(page.Data() + sizeof(PageHeader));
+}
+
+int main(int argc, char* argv[]) {
+    // Run a small pool over a scratch database file at the given path
+    if (argc != 2)
+        return -1;
+    std::string path = argv[1];
+
+    Pager pager;
+    try {
+        pager.Create(path, PagerOptions{512});
+        std::vector<uint32_t> pages;
+        {
+            BufferPool pool(pager, FRAMES);
+            for (uint32_t i = 0; i < PAGES; ++i) {
+                PinnedPage page = pool.PinNew(PageType::kDATA);
+                Counter(page) = page.PageNo();
+                pages.push_back(page.PageNo());
+            }
+            Check(pool.PinnedCount() == 0, "pins released at the end of scope");
+            Check(pool.Evictions() == PAGES - FRAMES, "one eviction per page past the capacity");
+            Check(pool.PagesWritten() == PAGES - FRAMES, "evicted pages written back");
+            Check(pool.WriteBatches() < (PAGES - FRAMES) / 4, "write back is batched");
+            Check(pool.DirtyCount() == FRAMES, "resident pages still dirty");
+
+            // Hits and misses
+            uint64_t misses = pool.Misses();
+            bool resident = true;
+            for (int pass = 0; pass < 3; ++pass)
+                for (uint32_t i = PAGES - FRAMES; i < PAGES; ++i)
+                    resident = resident && Counter(pool.Pin(pages[i])) == pages[i];
+            Check(resident && pool.Misses() == misses && pool.Hits() == 3 * FRAMES, "a working set that fits only hits");
+            {
+                PinnedPage first = pool.Pin(pages[0]);
+                Check(pool.Misses() == misses + 1 && Counter(first) == pages[0], "evicted page read back");
+                Counter(first) += 1000;
+                first.MarkDirty();
+            }
+
+            // Pinned frames survive a scan of the whole file
+            std::vector<PinnedPage> held;
+            for (uint32_t i = 0; i < FRAMES - 1; ++i)
+                held.push_back(pool.Pin(pages[i]));
+            for (uint32_t i = 0; i < PAGES; ++i)
+                pool.Pin(pages[i]);
+            bool stayed = true;
+            for (uint32_t i = 0; i < FRAMES - 1; ++i)
+                stayed = stayed && held[i].Data() == pool.Pin(pages[i]).Data();
+            Check(stayed, "pinned pages are never evicted");
+            PinnedPage last = pool.Pin(pages[PAGES - 1]);
+            try {
+                pool.Pin(pages[PAGES - 2]);
+                Check(false, "pin with every frame pinned");
+            } catch (const FileException& e) {
+                std::cout << "        FileException: " << e.what() << std::endl;
+                Check(true, "pin with every frame pinned");
+            }
+            try {
+                pool.Free(pages[0]);
+                Check(false, "free a pinned page");
+            } catch (const FileException& e) {
+                std::cout << "        FileException: " << e.what() << std::endl;
+                Check(true, "free a pinned page");
+            }
+            last.Release();
+            held.clear();
+
+            // Freed pages go back to the pager
+            pool.Free(pages[PAGES - 1]);
+            Check(pager.FreeCount() == 1, "freed page reaches the free list");
+            PinnedPage reused = pool.PinNew(PageType::kDATA);
+            Check(reused.PageNo() == pages[PAGES - 1], "freed page is allocated again");
+            Counter(reused) = reused.PageNo();
+            reused.MarkDirty();
+        }
+        pager.Close();
+
+        // Everything reached the file
+        pager.Open(path);
+        BufferPool pool(pager, FRAMES);
+        bool intact = true;
+        for (uint32_t i = 0; i < PAGES; ++i)
+            intact = intact && Counter(pool.Pin(pages[i])) == pages[i] + (i == 0 ? 1000 : 0);
+        Check(intact, "every page survives reopening");
+        Check(pool.DirtyCount() == 0 && pool.PagesWritten() == 0, "reads leave pages clean");
+    } catch (const FileException& e) {
+        std::cout << "FileException: " << e.what() << std::endl;
+        return -1;
+    }
+    return mPassed ? 1 : 0;
+}
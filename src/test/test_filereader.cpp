@@ -0,0 +1,215 @@
+// C++ Includes
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// C Includes
+#include <unistd.h>
+
+// Local Includes
+#include "exception/file_exception.h"
+#include "file/filereader.h"
+
+#define BLOCK 4096
+
+static bool mPassed = true;
+
+static const char* mModeName[] = {"kBUFFERED", "kMMAP", "kREAD_AHEAD"};
+
+static void Check(bool condition, const std::string& what) {
+    std::cout << (condition ? "ok      " : "FAILED  ") << what << std::endl;
+    mPassed = mPassed && condition;
+}
+
+/**
+ * @brief Lines of varying length, so line reads end inside and across blocks
+ */
+static std::vector<uint8_t> Contents(size_t size) {
+    std::vector<uint8_t> data(size);
+    size_t line = 0;
+    for (size_t i = 0; i < size; ++i) {
+        bool end = line == (i / 97) % 151 + 3;
+        data[i] = end ? '\n' : static_cast<uint8_t>('a' + i % 26);
+        line = end ? 0 : line + 1;
+    }
+    return data;
+}
+
+static void WriteFile(const std::string& path, const std::vector<uint8_t>& data, const char* how = "wb") {
+    FILE* file = fopen(path.c_str(), how);
+    if (!data.empty())
+        fwrite(data.data(), 1, data.size(), file);
+    fclose(file);
+}
+
+static bool Same(const uint8_t* bytes, const std::vector<uint8_t>& data, uint64_t offset, size_t size) {
+    return size == 0 || memcmp(bytes, data.data() + offset, size) == 0;
+}
+
+/**
+ * @brief The whole file through ReadBuffer() in requests of changing size, some larger than the buffer
+ */
+static bool ReadsBuffers(FileReader& reader, const std::vector<uint8_t>& data) {
+    const size_t sizes[] = {1, 7, 5000, 4096, 13000, 100};
+    std::vector<uint8_t> buffer(13000);
+    std::vector<uint8_t> all;
+    for (size_t i = 0;; ++i) {
+        size_t size = sizes[i % 6];
+        size_t bytes_read = reader.ReadBuffer(buffer.data(), size);
+        all.insert(all.end(), buffer.begin(), buffer.begin() + bytes_read);
+        if (bytes_read < size)
+            break;
+    }
+    return all == data && reader.ReadBuffer(buffer.data(), 1) == 0 && reader.End();
+}
+
+/**
+ * @brief The whole file through ReadLine(), every line ends at a newline, a full buffer or the end
+ */
+static bool ReadsLines(FileReader& reader, const std::vector<uint8_t>& data) {
+    uint8_t buffer[120];
+    std::vector<uint8_t> all;
+    size_t bytes_read;
+    while ((bytes_read = reader.ReadLine(buffer, sizeof(buffer), '\n')) != 0) {
+        all.insert(all.end(), buffer, buffer + bytes_read);
+        if (buffer[bytes_read - 1] != '\n' && bytes_read != sizeof(buffer) && all.size() != data.size())
+            return false;
+    }
+    return all == data;
+}
+
+/**
+ * @brief Seek() from every origin, inside and outside the buffered window, then read on
+ */
+static bool ReadsAfterSeeks(FileReader& reader, const std::vector<uint8_t>& data) {
+    uint64_t size = data.size();
+    uint8_t buffer[300];
+    for (uint64_t offset : {size / 2, uint64_t{0}, size / 3 + 1, size, size + 10, (size > 5000) ? size - 5000 : 0}) {
+        if (reader.Seek(static_cast<int64_t>(offset), SeekStart::kSEEK_SET) != offset || reader.Tell() != offset)
+            return false;
+        size_t expected = (offset < size) ? std::min<uint64_t>(sizeof(buffer), size - offset) : 0;
+        if (reader.ReadBuffer(buffer, sizeof(buffer)) != expected || !Same(buffer, data, offset, expected))
+            return false;
+    }
+
+    // Back a little from where the last read stopped, usually inside the buffered window
+    reader.Seek(0, SeekStart::kSEEK_SET);
+    size_t first = reader.ReadBuffer(buffer, 200);
+    if (first != std::min<uint64_t>(200, size))
+        return false;
+    uint64_t back = std::min<uint64_t>(first, 50);
+    if (reader.Seek(-static_cast<int64_t>(back), SeekStart::kSEEK_CUR) != first - back)
+        return false;
+    size_t expected = std::min<uint64_t>(100, size - (first - back));
+    if (reader.ReadBuffer(buffer, 100) != expected || !Same(buffer, data, first - back, expected))
+        return false;
+
+    uint64_t tail = std::min<uint64_t>(size, 10);
+    if (reader.Seek(-static_cast<int64_t>(tail), SeekStart::kSEEK_END) != size - tail)
+        return false;
+    if (reader.ReadBuffer(buffer, sizeof(buffer)) != tail || !Same(buffer, data, size - tail, tail))
+        return false;
+
+    // Bytes one at a time from the start
+    reader.Seek(0, SeekStart::kSEEK_SET);
+    for (uint64_t i = 0; i < std::min<uint64_t>(size, 10); ++i) {
+        if (reader.PeekByte() != data[i] || reader.ReadByte() != data[i])
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief ReadAt() at offsets around block boundaries and the end, the file pointer stays put
+ */
+static bool ReadsAt(FileReader& reader, const std::vector<uint8_t>& data) {
+    uint64_t size = data.size();
+    uint64_t position = reader.Tell();
+    std::vector<uint8_t> buffer(3 * BLOCK + 1);
+    for (uint64_t offset : {uint64_t{0}, uint64_t{1}, uint64_t{BLOCK - 1}, uint64_t{BLOCK}, size / 2, size - size % BLOCK,
+                            (size > 0) ? size - 1 : 0, size, size + BLOCK}) {
+        for (size_t length : {size_t{1}, size_t{BLOCK}, size_t{BLOCK + 1}, buffer.size()}) {
+            size_t expected = (offset < size) ? std::min<uint64_t>(length, size - offset) : 0;
+            if (reader.ReadAt(offset, buffer.data(), length) != expected || !Same(buffer.data(), data, offset, expected))
+                return false;
+        }
+    }
+    return reader.Tell() == position;
+}
+
+static void CheckMode(const std::string& path, ReadMode mode, bool direct, const std::vector<size_t>& sizes) {
+    std::string name = std::string(mModeName[static_cast<int>(mode)]) + (direct ? " direct" : "");
+    FileReaderOptions options;
+    options.mode = mode;
+    options.direct = direct;
+    bool buffers = true;
+    bool lines = true;
+    bool seeks = true;
+    bool positional = true;
+    for (size_t size : sizes) {
+        std::vector<uint8_t> data = Contents(size);
+        WriteFile(path, data);
+        FileReader reader(path, options);
+        bool ok_buffers = ReadsBuffers(reader, data);
+        reader.Seek(0, SeekStart::kSEEK_SET);
+        bool ok_lines = ReadsLines(reader, data);
+        bool ok_seeks = ReadsAfterSeeks(reader, data);
+        bool ok_positional = ReadsAt(reader, data);
+        if (!ok_buffers || !ok_lines || !ok_seeks || !ok_positional)
+            std::cout << "        " << name << " failed on " << size << " bytes" << std::endl;
+        buffers = buffers && ok_buffers;
+        lines = lines && ok_lines;
+        seeks = seeks && ok_seeks;
+        positional = positional && ok_positional;
+    }
+    Check(buffers, name + " ReadBuffer");
+    Check(lines, name + " ReadLine");
+    Check(seeks, name + " Seek");
+    Check(positional, name + " ReadAt");
+}
+
+int main(int argc, char* argv[]) {
+    // Read scratch files at the given path in every mode, with and without direct reads
+    if (argc != 2)
+        return -1;
+    std::string path = argv[1];
+
+    // Empty, shorter than a block, around block boundaries and several blocks with a short last one
+    const std::vector<size_t> sizes = {0, 1, 100, BLOCK - 1, BLOCK, BLOCK + 1, 5 * BLOCK + 1234, 20 * BLOCK};
+    try {
+        for (ReadMode mode : {ReadMode::kBUFFERED, ReadMode::kMMAP, ReadMode::kREAD_AHEAD}) {
+            CheckMode(path, mode, false, sizes);
+            CheckMode(path, mode, true, sizes);
+        }
+
+        // A short block restarts the read-ahead where it stopped, so bytes appended since are read
+        for (bool direct : {false, true}) {
+            std::string name = direct ? " direct" : "";
+            std::vector<uint8_t> data = Contents(3 * BLOCK + 500);
+            std::vector<uint8_t> head(data.begin(), data.begin() + BLOCK + 904);
+            std::vector<uint8_t> rest(data.begin() + head.size(), data.end());
+            WriteFile(path, head);
+            FileReaderOptions options;
+            options.mode = ReadMode::kREAD_AHEAD;
+            options.direct = direct;
+            FileReader reader(path, options);
+            std::vector<uint8_t> buffer(data.size());
+            Check(reader.ReadBuffer(buffer.data(), head.size()) == head.size() && Same(buffer.data(), data, 0, head.size()),
+                  "read-ahead up to a short block" + name);
+            WriteFile(path, rest, "ab");
+            Check(reader.ReadBuffer(buffer.data(), rest.size()) == rest.size() &&
+                  Same(buffer.data(), data, head.size(), rest.size()), "read-ahead restarts after the short block" + name);
+            Check(reader.ReadBuffer(buffer.data(), 1) == 0 && reader.End(), "read-ahead ends at the new end" + name);
+        }
+    } catch (const FileException& e) {
+        std::cout << "FileException: " << e.what() << std::endl;
+        unlink(path.c_str());
+        return -1;
+    }
+
+    unlink(path.c_str());
+    return mPassed ? 1 : 0;
+}
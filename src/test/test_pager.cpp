@@ -0,0 +1,199 @@
+// C++ Includes
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Local Includes
+#include "exception/file_exception.h"
+#include "file/checksum.h"
+#include "file/filewriter.h"
+#include "storage/pager.h"
+
+#define PAGES 2000
+
+static bool mPassed = true;
+
+static void Check(bool condition, const std::string& what) {
+    std::cout << (condition ? "ok      " : "FAILED  ") << what << std::endl;
+    mPassed = mPassed && condition;
+}
+
+/**
+ * @brief Fill a page's body with a pattern derived from its number and a generation
+ */
+static void FillPage(Pager& pager, uint8_t* page, uint32_t page_no, uint32_t generation) {
+    pager.InitPage(page, PageType::kDATA);
+    for (size_t i = sizeof(PageHeader); i < pager.PageSize(); ++i)
+        page[i] = static_cast<uint8_t>(page_no * 31 + generation * 7 + i);
+}
+
+static bool HasPattern(const Pager& pager, const uint8_t* page, uint32_t page_no, uint32_t generation) {
+    for (size_t i = sizeof(PageHeader); i < pager.PageSize(); ++i)
+        if (page[i] != static_cast<uint8_t>(page_no * 31 + generation * 7 + i))
+            return false;
+    return true;
+}
+
+template <typename F>
+static bool Throws(F function) {
+    try {
+        function();
+    } catch (const FileException& e) {
+        std::cout << "        FileException: " << e.what() << std::endl;
+        return true;
+    }
+    return false;
+}
+
+int main(int argc, char* argv[]) {
+    // Create, fill, free, reuse and reopen a database file at the given scratch path
+    if (argc != 2)
+        return -1;
+    std::string path = argv[1];
+
+    // CRC-32C check value
+    const char* digits = "123456789";
+    Check(Crc32c(reinterpret_cast<const uint8_t*>(digits), 9) == 0xE3069283, "crc32c check value");
+    Check(Crc32c(reinterpret_cast<const uint8_t*>(digits) + 4, 5, Crc32c(reinterpret_cast<const uint8_t*>(digits), 4)) ==
+          0xE3069283, "crc32c continued");
+
+    // Batched positional I/O, adjacent transfers coalesce
+    try {
+        FileWriter writer(path, FileWriterOptions{true, true, false});
+        std::vector<uint8_t> blocks(8 * 512);
+        for (size_t i = 0; i < blocks.size(); ++i)
+            blocks[i] = static_cast<uint8_t>(i / 512 + 1);
+        std::vector<FileIo> batch;
+        for (uint64_t block : {3, 1, 0, 2, 6, 7})
+            batch.push_back(FileIo{block * 512, blocks.data() + block * 512, 512});
+        writer.WriteBatch(batch);
+        Check(writer.WriteCalls() == 2, "two runs written with two calls");
+        Check(writer.Size() == 8 * 512, "file grew to the last block");
+        std::vector<uint8_t> back(9 * 512, 0xFF);
+        std::vector<FileIo> reads;
+        for (uint64_t block = 0; block < 9; ++block)
+            reads.push_back(FileIo{block * 512, back.data() + block * 512, 512});
+        size_t bytes = writer.ReadBatch(reads);
+        Check(bytes == 8 * 512, "batch read stops at the end of the file");
+        bool same = true;
+        for (size_t i = 0; i < 8 * 512; ++i) {
+            uint8_t expected = (i / 512 == 4 || i / 512 == 5) ? 0 : static_cast<uint8_t>(i / 512 + 1);
+            same = same && back[i] == expected;
+        }
+        Check(same, "batch read returns the written blocks and zero filled holes");
+        Check(back[8 * 512] == 0, "batch read zero fills past the end of the file");
+    } catch (const FileException& e) {
+        std::cout << "FileException: " << e.what() << std::endl;
+        return -1;
+    }
+
+    // A fresh file with small pages so the free list spans several list pages
+    Pager pager;
+    std::vector<uint32_t> pages;
+    try {
+        Check(Throws([&]() { pager.Create(path, PagerOptions{1000}); }), "page size must be a power of two");
+        pager.Create(path, PagerOptions{512});
+        Check(pager.PageCount() == 1 && pager.FreeCount() == 0, "empty file holds only the superblock");
+        uint32_t root = pager.CreateTrunk("people", "Person");
+        Check(root == 1, "trunk root is the first page");
+        Check(Throws([&]() { pager.CreateTrunk("people", "Person"); }), "duplicate trunk");
+        Check(Throws([&]() { pager.CreateTrunk("a_trunk_name_that_is_far_too_long", "Person"); }), "long trunk name");
+        pager.CreateTrunk("orders", "Order");
+        pager.CreateTrunk("scratch", "Order");
+        Check(pager.DropTrunk("scratch") == 3, "drop returns the root page");
+        pager.Free(3);
+
+        // Allocate and write in one batch
+        auto buffers = pager.AllocatePageBuffer(PAGES);
+        std::vector<uint8_t*> pointers;
+        for (uint32_t i = 0; i < PAGES; ++i) {
+            pages.push_back(pager.Allocate());
+            pointers.push_back(buffers.get() + i * pager.PageSize());
+            FillPage(pager, pointers.back(), pages.back(), 0);
+        }
+        Check(pages[0] == 3, "freed page is reused first");
+        uint64_t calls = pager.File().WriteCalls();
+        pager.WritePages(pages.data(), pointers.data(), PAGES);
+        Check(pager.File().WriteCalls() - calls <= PAGES / 256 + 1, "contiguous pages coalesce into runs");
+        pager.Flush();
+
+        // Free every other page, then allocate them back, the file does not grow
+        uint32_t count = pager.PageCount();
+        for (uint32_t i = 0; i < PAGES; i += 2)
+            pager.Free(pages[i]);
+        Check(pager.FreeCount() == PAGES / 2, "free count after freeing half");
+        std::vector<uint32_t> reused;
+        for (uint32_t i = 0; i < PAGES / 4; ++i)
+            reused.push_back(pager.Allocate());
+        Check(pager.PageCount() == count, "allocations are served from the free list");
+        for (uint32_t page_no : reused) {
+            FillPage(pager, buffers.get(), page_no, 1);
+            pager.WritePage(page_no, buffers.get());
+        }
+        Check(Throws([&]() { pager.ReadPage(count, buffers.get()); }), "read past the last page");
+        Check(Throws([&]() { pager.Free(0); }), "superblock cannot be freed");
+        pager.SetTrunkRoot("orders", reused[0]);
+        pager.Close();
+
+        // Reopen and read everything back
+        pager.Open(path);
+        Check(pager.PageSize() == 512 && pager.PageCount() == count, "page size and count survive reopening");
+        Check(pager.FreeCount() == PAGES / 2 - PAGES / 4, "free count survives reopening");
+        Check(pager.Trunks().size() == 2 && pager.FindTrunk("people") != nullptr &&
+              pager.FindTrunk("people")->base_type == "Person" && pager.FindTrunk("people")->root_page == root,
+              "trunk directory survives reopening");
+        Check(pager.FindTrunk("orders")->root_page == reused[0], "moved root survives reopening");
+        bool intact = true;
+        std::vector<bool> rewritten(count, false);
+        for (uint32_t page_no : reused)
+            rewritten[page_no] = true;
+        std::vector<uint32_t> live;
+        std::vector<uint8_t*> live_pointers;
+        for (uint32_t i = 0; i < PAGES; ++i) {
+            if (i % 2 == 0 && !rewritten[pages[i]])
+                continue;
+            live.push_back(pages[i]);
+            live_pointers.push_back(buffers.get() + live_pointers.size() * pager.PageSize());
+        }
+        pager.ReadPages(live.data(), live_pointers.data(), live.size());
+        for (size_t i = 0; i < live.size(); ++i)
+            intact = intact && HasPattern(pager, live_pointers[i], live[i], rewritten[live[i]] ? 1 : 0);
+        Check(intact, "live pages read back intact");
+
+        // The rest of the free list is handed out before the file grows
+        for (uint32_t i = 0; i < PAGES / 2 - PAGES / 4; ++i)
+            pager.Allocate();
+        Check(pager.FreeCount() == 0 && pager.PageCount() == count, "free list drained without growing");
+        Check(pager.Allocate() == count, "then the file grows");
+        pager.Close();
+    } catch (const FileException& e) {
+        std::cout << "FileException: " << e.what() << std::endl;
+        return -1;
+    }
+
+    // Damage one byte of a page and one of the superblock
+    try {
+        FileWriter writer(path, FileWriterOptions{false, false, false});
+        uint8_t byte = 0x5A;
+        writer.WriteAt(static_cast<uint64_t>(pages[1]) * 512 + 100, &byte, 1);
+        writer.Close();
+        pager.Open(path);
+        Check(Throws([&]() { pager.ReadPage(pages[1], pager.AllocatePageBuffer().get()); }), "damaged page fails its checksum");
+        pager.Close();
+        writer.Open(path);
+        writer.WriteAt(40, &byte, 1);
+        writer.Close();
+        Check(Throws([&]() { pager.Open(path); }), "damaged superblock");
+        Check(!pager.IsOpen(), "failed open leaves the pager closed");
+        writer.Open(path);
+        writer.WriteAt(24, &byte, 1);
+        writer.Close();
+        Check(Throws([&]() { pager.Open(path); }), "bad magic");
+    } catch (const FileException& e) {
+        std::cout << "FileException: " << e.what() << std::endl;
+        return -1;
+    }
+    return mPassed ? 1 : 0;
+}
@@ -0,0 +1,76 @@
+// C++ Includes
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+// Local Includes
+#include "exception/parse_exception.h"
+#include "parser/arena.h"
+#include "parser/optimizer.h"
+#include "parser/parser.h"
+#include "parser/tokenbuffer.h"
+#include "parser/tokenizer.h"
+
+
+int main(int argc, char* argv[]) {
+    // Parse the file, print the tree, then time repeated parses of the same tokens, -O prints the optimized tree
+    if (argc < 2 || argc > 3)
+        return -1;
+    bool optimize = (argc == 3) && strcmp(argv[2], "-O") == 0;
+    int32_t rounds = optimize ? 0 : (argc == 3) ? atoi(argv[2]) : 100;
+
+    Tokenizer tokenizer;
+    TokenBuffer tokens;
+    tokenizer.OpenFile(argv[1]);
+    tokenizer.Tokenize(tokens);
+
+    Parser parser;
+    Arena arena;
+    Optimizer optimizer;
+    try {
+        AstNode* root = parser.Parse(tokens, arena);
+        if (optimize)
+            root = optimizer.Optimize(root, arena);
+        std::cout << AstToString(root);
+    } catch (const ParseException& e) {
+        std::cout << "ParseException: " << e.what() << std::endl;
+        return -1;
+    }
+    if (parser.Statements() == 0)
+        return 1;
+
+    // Allocation counts of the first parse, the arena starts out empty
+    size_t statements = parser.Statements();
+    size_t arena_allocations = arena.Allocations();
+    size_t heap_allocations = arena.HeapAllocations();
+    size_t bytes = arena.BytesUsed();
+
+    double best = 1e300;
+    for (int32_t round = 0; round < rounds; ++round) {
+        arena.Reset();
+        auto start = std::chrono::steady_clock::now();
+        parser.Parse(tokens, arena);
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        if (elapsed.count() < best)
+            best = elapsed.count();
+    }
+
+    // Stats go to stderr so the tree on stdout stays comparable between runs
+    std::cerr << "statements:                  " << statements << std::endl;
+    std::cerr << "nodes per statement:         " << static_cast<double>(parser.Nodes()) / statements << std::endl;
+    std::cerr << "arena allocations/statement: " << static_cast<double>(arena_allocations) / statements << std::endl;
+    std::cerr << "heap allocations/statement:  " << static_cast<double>(heap_allocations) / statements << std::endl;
+    std::cerr << "arena bytes/statement:       " << static_cast<double>(bytes) / statements << std::endl;
+    if (optimize) {
+        std::cerr << "folded:                      " << optimizer.Folded() << std::endl;
+        std::cerr << "normalized:                  " << optimizer.Normalized() << std::endl;
+        std::cerr << "flattened:                   " << optimizer.Flattened() << std::endl;
+        std::cerr << "ranges:                      " << optimizer.Ranges() << std::endl;
+    }
+    if (rounds > 0)
+        std::cerr << "parse ns/statement:          " << best / statements << std::endl;
+
+    return 1;
+}
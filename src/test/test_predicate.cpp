@@ -0,0 +1,170 @@
+// C++ Includes
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Local Includes
+#include "exception/parse_exception.h"
+#include "exception/schema_exception.h"
+#include "exception/vm_exception.h"
+#include "parser/arena.h"
+#include "parser/optimizer.h"
+#include "parser/parser.h"
+#include "parser/tokenbuffer.h"
+#include "parser/tokenizer.h"
+#include "schema/catalog.h"
+#include "schema/record.h"
+#include "vm/predicate.h"
+
+// Records scanned by every predicate
+#define RECORDS 4096
+
+static const char* mModeName[] = {"interpret", "closure", "native"};
+static const char* mNames[] = {"", "ant", "bee", "cat", "dog", "eel"};
+
+/**
+ * @brief A small deterministic generator so every run scans the same records
+ */
+static uint32_t Next(uint64_t& state) {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return static_cast<uint32_t>(state >> 33);
+}
+
+/**
+ * @brief Give every scalar field of a layout a value, null one in eight of the nullable ones, arrays stay empty
+ */
+static void Fill(RecordBuilder& builder, const SchemaCatalog& catalog, uint32_t type_id, const std::string& prefix,
+                 uint32_t root_id, uint64_t& state) {
+    const RecordLayout& layout = catalog.Get(type_id);
+    for (size_t i = 0; i < layout.FieldCount(); ++i) {
+        std::string path = prefix + layout.Field(i).name;
+        FieldLayout field = catalog.Resolve(root_id, path);
+        if (field.type == FieldType::kSTRUCT) {
+            Fill(builder, catalog, field.struct_type, path + ".", root_id, state);
+            continue;
+        }
+        if (field.is_array)
+            continue;
+        if (!(field.modifiers & kMOD_NOTNULL) && Next(state) % 8 == 0)
+            continue;
+        uint32_t pick = Next(state);
+        switch (field.type) {
+            case FieldType::kBOOL:
+                builder.SetBool(field, pick % 2 == 0);
+                break;
+            case FieldType::kFLOAT:
+            case FieldType::kDOUBLE:
+                builder.SetReal(field, (pick % 50 == 0) ? NAN : static_cast<double>(pick % 101) / 4.0 - 12.5);
+                break;
+            case FieldType::kSTRING:
+                builder.SetString(field, mNames[pick % 6]);
+                break;
+            case FieldType::kPOINTER:
+                builder.SetPointer(field, pick % 5000);
+                break;
+            default: {
+                int64_t value = static_cast<int64_t>(pick % 61) - 30;
+                if (!field.is_signed)
+                    value = pick % 256;
+                if (field.type == FieldType::kLONG && pick % 4 == 0)
+                    value = (pick % 8 == 0 || !field.is_signed) ? 1099511627776LL + (pick % 3) : -1099511627777LL;
+                if (field.type == FieldType::kINT && !field.is_signed && pick % 4 == 0)
+                    value = 4000000000LL + (pick % 3) * 100000000LL;
+                if (field.modifiers & kMOD_PRIMARY)
+                    value = static_cast<int64_t>(state % 5000);
+                builder.SetInteger(field, value);
+                break;
+            }
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    // Scan generated records of the file's last struct with each of its expression statements,
+    // unoptimized and interpreted as the reference, then optimized in every mode
+    if (argc != 2)
+        return -1;
+
+    Tokenizer tokenizer;
+    TokenBuffer tokens;
+    tokenizer.OpenFile(argv[1]);
+    tokenizer.Tokenize(tokens);
+
+    Parser parser;
+    Arena arena;
+    Arena plain_arena;
+    Optimizer optimizer;
+    SchemaCatalog catalog;
+    const AstNode* root;
+    const AstNode* plain;
+    try {
+        plain = parser.Parse(tokens, plain_arena);
+        root = optimizer.Optimize(parser.Parse(tokens, arena), arena);
+        catalog.AddProgram(root);
+    } catch (const ParseException& e) {
+        std::cout << "ParseException: " << e.what() << std::endl;
+        return -1;
+    } catch (const SchemaException& e) {
+        std::cout << "SchemaException: " << e.what() << std::endl;
+        return -1;
+    }
+    if (catalog.Size() == 0)
+        return -1;
+
+    uint32_t type_id = static_cast<uint32_t>(catalog.Size() - 1);
+    const RecordLayout& layout = catalog.Get(type_id);
+    std::vector<std::vector<uint8_t>> records;
+    std::vector<const uint8_t*> pointers;
+    uint64_t state = 42;
+    RecordBuilder builder(layout);
+    try {
+        for (uint32_t i = 0; i < RECORDS; ++i) {
+            builder.Reset();
+            Fill(builder, catalog, type_id, "", type_id, state);
+            records.push_back(builder.Finish());
+        }
+    } catch (const SchemaException& e) {
+        std::cout << "SchemaException: " << e.what() << std::endl;
+        return -1;
+    }
+    for (const auto& record : records)
+        pointers.push_back(record.data());
+    std::cout << "struct " << layout.Name() << ", " << RECORDS << " records" << std::endl;
+
+    // $ parameters are bound to 7
+    std::vector<Argument> arguments(4, Argument{ValueType::kINT, 7, 0.0, ""});
+    bool agree = true;
+    Predicate reference;
+    Predicate predicate;
+    const AstNode* plain_node = plain->first_child;
+    for (const AstNode* node = root->first_child; node != nullptr; node = node->next_sibling, plain_node = plain_node->next_sibling) {
+        if (node->kind != AstKind::kEXPR_STMT)
+            continue;
+        std::cout << "line " << node->line << ":";
+        try {
+            std::vector<uint32_t> expected;
+            reference.Compile(plain_node->first_child, catalog, type_id, PredicateMode::kINTERPRET, arguments);
+            reference.Select(pointers.data(), pointers.size(), expected);
+            std::cout << " matches=" << expected.size();
+            for (int mode = 0; mode < 3; ++mode) {
+                std::vector<uint32_t> selected;
+                predicate.Compile(node->first_child, catalog, type_id, static_cast<PredicateMode>(mode), arguments);
+                predicate.Select(pointers.data(), pointers.size(), selected);
+                size_t counted = predicate.Count(pointers.data(), pointers.size());
+                if (mode == 2)
+                    std::cout << " " << mModeName[static_cast<int>(predicate.Mode())];
+                if (selected != expected || counted != expected.size()) {
+                    std::cout << " MISMATCH in " << mModeName[static_cast<int>(predicate.Mode())] << " ("
+                              << selected.size() << ")";
+                    agree = false;
+                }
+            }
+        } catch (const VmException& e) {
+            std::cout << " VmException: " << e.what();
+        }
+        std::cout << std::endl;
+    }
+    return agree ? 1 : 0;
+}
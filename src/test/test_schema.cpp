@@ -0,0 +1,84 @@
+// C++ Includes
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+// Local Includes
+#include "exception/parse_exception.h"
+#include "exception/schema_exception.h"
+#include "parser/arena.h"
+#include "parser/parser.h"
+#include "parser/tokenbuffer.h"
+#include "parser/tokenizer.h"
+#include "schema/catalog.h"
+#include "schema/record.h"
+
+static const char* mFieldTypeName[] = {
+    "byte", "short", "int", "long", "float", "double", "bool", "string", "struct", "pointer"
+};
+
+static std::string DefaultString(const RecordLayout& layout, uint32_t offset) {
+    for (const auto& str : layout.DefaultStrings())
+        if (str.first == offset)
+            return str.second;
+    return "";
+}
+
+int main(int argc, char* argv[]) {
+    // Compile the structs of a file and print every layout
+    if (argc != 2)
+        return -1;
+
+    Tokenizer tokenizer;
+    TokenBuffer tokens;
+    tokenizer.OpenFile(argv[1]);
+    tokenizer.Tokenize(tokens);
+
+    Parser parser;
+    Arena arena;
+    SchemaCatalog catalog;
+    try {
+        catalog.AddProgram(parser.Parse(tokens, arena));
+    } catch (const ParseException& e) {
+        std::cout << "ParseException: " << e.what() << std::endl;
+        return -1;
+    } catch (const SchemaException& e) {
+        std::cout << "SchemaException: " << e.what() << std::endl;
+        return -1;
+    }
+
+    for (uint32_t type_id = 0; type_id < catalog.Size(); ++type_id) {
+        const RecordLayout& layout = catalog.Get(type_id);
+        std::cout << "struct " << layout.Name() << " id=" << layout.TypeId();
+        if (layout.BaseId() != NO_TYPE)
+            std::cout << " base=" << catalog.Get(layout.BaseId()).Name();
+        std::cout << " size=" << layout.FixedSize() << " align=" << layout.Alignment();
+        if (layout.PrimaryField() >= 0)
+            std::cout << " primary=" << layout.Field(layout.PrimaryField()).name;
+        std::cout << std::endl;
+
+        // Every field reads back its default, or null
+        RecordBuilder builder(layout);
+        for (size_t i = 0; i < layout.FieldCount(); ++i) {
+            const FieldLayout& field = layout.Field(i);
+            std::cout << "    " << field.name << ": " << mFieldTypeName[static_cast<uint8_t>(field.type)]
+                      << (field.is_array ? "[]" : "") << " offset=" << field.offset << " size=" << field.size
+                      << " null=" << field.null_offset << "/" << static_cast<uint32_t>(field.null_mask);
+            const uint8_t* fixed = builder.Fixed();
+            if (field.default_kind == DefaultKind::kFUNCTION) {
+                std::cout << " default=" << field.default_function << "()";
+            } else if (!FieldIsNull(fixed, field)) {
+                std::cout << " default=";
+                if (field.type == FieldType::kFLOAT || field.type == FieldType::kDOUBLE)
+                    std::cout << ReadReal(fixed, field);
+                else if (field.type == FieldType::kSTRING)
+                    std::cout << '"' << DefaultString(layout, field.offset) << '"';
+                else if (field.type != FieldType::kSTRUCT)
+                    std::cout << ReadInteger(fixed, field);
+            }
+            std::cout << std::endl;
+        }
+    }
+
+    return 1;
+}
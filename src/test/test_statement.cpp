@@ -0,0 +1,189 @@
+// C++ Includes
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+// Local Includes
+#include "exception/parse_exception.h"
+#include "exception/schema_exception.h"
+#include "exception/token_exception.h"
+#include "exception/vm_exception.h"
+#include "parser/arena.h"
+#include "parser/parser.h"
+#include "parser/tokenbuffer.h"
+#include "parser/tokenizer.h"
+#include "schema/catalog.h"
+#include "vm/statement.h"
+#include "vm/statementcache.h"
+#include "vm/vm.h"
+
+static void PrintStats(const StatementCache& cache) {
+    std::cout << "hits=" << cache.Hits() << " misses=" << cache.Misses() << " evictions=" << cache.Evictions()
+              << " size=" << cache.Size() << "/" << cache.Capacity() << std::endl;
+}
+
+/**
+ * @brief Run a statement and print its error instead of stopping
+ */
+static void Execute(PreparedStatement& statement, Vm& vm) {
+    try {
+        statement.Execute(vm);
+    } catch (const VmException& e) {
+        std::cout << "VmException: " << e.what() << std::endl;
+    }
+}
+
+static void Prepare(StatementCache& cache, const std::string& text) {
+    try {
+        cache.Prepare(text);
+        std::cout << "prepared: " << text << std::endl;
+    } catch (const TokenException& e) {
+        std::cout << "TokenException: " << e.what() << std::endl;
+    } catch (const ParseException& e) {
+        std::cout << "ParseException: " << e.what() << std::endl;
+    } catch (const VmException& e) {
+        std::cout << "VmException: " << e.what() << std::endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    // Take the structs of a file as the schema and run prepared statements against it
+    if (argc != 2)
+        return -1;
+
+    Tokenizer tokenizer;
+    TokenBuffer tokens;
+    tokenizer.OpenFile(argv[1]);
+    tokenizer.Tokenize(tokens);
+
+    Parser parser;
+    Arena arena;
+    SchemaCatalog catalog;
+    try {
+        catalog.AddProgram(parser.Parse(tokens, arena));
+    } catch (const ParseException& e) {
+        std::cout << "ParseException: " << e.what() << std::endl;
+        return -1;
+    } catch (const SchemaException& e) {
+        std::cout << "SchemaException: " << e.what() << std::endl;
+        return -1;
+    }
+
+    Vm vm;
+    StatementCache cache(catalog);
+    try {
+        // One plan, a program per combination of bound types
+        PreparedStatement scale = cache.Prepare("double x = ? * 2; print(x, $tag);");
+        std::cout << "normalized: " << scale.Plan().text << std::endl;
+        std::cout << "parameters: " << scale.ParameterCount() << ", $tag is " << scale.ParameterIndex("tag")
+                  << std::endl;
+        scale.BindInteger(0, 21);
+        scale.BindString(scale.ParameterIndex("$tag"), "int");
+        scale.Execute(vm);
+        scale.BindReal(0, 1.25);
+        scale.BindString(1, "real");
+        scale.Execute(vm);
+        scale.BindInteger(0, -4);
+        scale.Execute(vm);
+        std::cout << "programs: " << scale.Plan().programs.size() << std::endl;
+
+        // Whitespace and comments do not matter
+        PreparedStatement same = cache.Prepare("double   x = ?*2;  // scaled\nprint( x , $tag ) ;");
+        std::cout << "shared plan: " << (&same.Plan() == &scale.Plan()) << std::endl;
+        same.BindInteger(0, 5);
+        same.BindString(1, "copy");
+        same.Execute(vm);
+        PrintStats(cache);
+
+        // A named parameter used twice is one parameter
+        PreparedStatement twice = cache.Prepare("print($a + $a, $a < $b, !?);");
+        std::cout << "parameters: " << twice.ParameterCount() << std::endl;
+        twice.BindInteger(twice.ParameterIndex("a"), 7);
+        twice.BindInteger(twice.ParameterIndex("b"), 9);
+        twice.BindBool(2, false);
+        twice.Execute(vm);
+
+        // Parameters in records, loops and conditions
+        PreparedStatement record = cache.Prepare("Employee e = Employee(id=?, name=$name, level=?);\n"
+                                                 "e.balance += $amount;\n"
+                                                 "print(e.id, e.name, e.level, e.balance, e.home.city);");
+        record.BindInteger(0, 42);
+        record.BindString(1, "Ada");
+        record.BindInteger(2, 3);
+        record.BindReal(3, 0.25);
+        record.Execute(vm);
+        record.BindInteger(3, 100);
+        record.Execute(vm);
+
+        PreparedStatement loop = cache.Prepare("long sum = 0;\n"
+                                               "for (long i = 0; i < ?; i += 1)\n"
+                                               "    if (i % $step == 0)\n"
+                                               "        sum += i;\n"
+                                               "print(sum);");
+        loop.BindInteger(0, 100);
+        loop.BindInteger(1, 7);
+        loop.Execute(vm);
+        loop.BindInteger(0, 1000000);
+        loop.Execute(vm);
+
+        // Bindings belong to the statement, not the plan
+        PreparedStatement other = cache.Prepare("long sum = 0;\n"
+                                                "for (long i = 0; i < ?; i += 1)\n"
+                                                "    if (i % $step == 0)\n"
+                                                "        sum += i;\n"
+                                                "print(sum);");
+        Execute(other, vm);
+        other.BindInteger(0, 10);
+        other.BindInteger(1, 2);
+        other.Execute(vm);
+        loop.ClearBindings();
+        Execute(loop, vm);
+
+        // Errors
+        PreparedStatement typed = cache.Prepare("int n = ?; print(n);");
+        typed.BindString(0, "text");
+        Execute(typed, vm);
+        typed.BindReal(0, 2.5);
+        Execute(typed, vm);
+        try {
+            typed.BindInteger(1, 0);
+        } catch (const VmException& e) {
+            std::cout << "VmException: " << e.what() << std::endl;
+        }
+        try {
+            typed.ParameterIndex("missing");
+        } catch (const VmException& e) {
+            std::cout << "VmException: " << e.what() << std::endl;
+        }
+        PreparedStatement nested = cache.Prepare("int twice(int x) {\n    return x * ?;\n}\nprint(twice(2));");
+        nested.BindInteger(0, 2);
+        Execute(nested, vm);
+        Prepare(cache, "struct Extra {\n    int x;\n};");
+        Prepare(cache, "print($);");
+        Prepare(cache, "print(? ?);");
+        PrintStats(cache);
+
+        // The least recently used plan goes first, statements holding it keep working
+        StatementCache small(catalog, 2);
+        PreparedStatement first = small.Prepare("print(1, ?);");
+        small.Prepare("print(2);");
+        small.Prepare("print(1, ?);");
+        small.Prepare("print(3);");
+        small.Prepare("print(2);");
+        PrintStats(small);
+        first.BindString(0, "still runs");
+        first.Execute(vm);
+        small.Clear();
+        PrintStats(small);
+    } catch (const TokenException& e) {
+        std::cout << "TokenException: " << e.what() << std::endl;
+        return -1;
+    } catch (const ParseException& e) {
+        std::cout << "ParseException: " << e.what() << std::endl;
+        return -1;
+    } catch (const VmException& e) {
+        std::cout << "VmException: " << e.what() << std::endl;
+        return -1;
+    }
+    return 1;
+}
@@ -0,0 +1,452 @@
+// C++ Includes
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// Local Includes
+#include "exception/file_exception.h"
+#include "exception/parse_exception.h"
+#include "exception/schema_exception.h"
+#include "file/bufferpool.h"
+#include "parser/arena.h"
+#include "parser/parser.h"
+#include "parser/tokenbuffer.h"
+#include "parser/tokenizer.h"
+#include "schema/catalog.h"
+#include "schema/record.h"
+#include "storage/pager.h"
+#include "storage/trunk.h"
+
+#define RECORDS 5000
+
+static const char* mSchema =
+    "struct Customer {\n"
+    "    primary long id;\n"
+    "    secondary string name;\n"
+    "    secondary int age;\n"
+    "    secondary double balance;\n"
+    "    string city;\n"
+    "    int visits;\n"
+    "};\n"
+    "struct Note {\n"
+    "    secondary string tag;\n"
+    "    string text;\n"
+    "};\n"
+    "struct Account {\n"
+    "    primary string code;\n"
+    "    secondary unsigned long flags;\n"
+    "};\n"
+    "struct Vehicle {\n"
+    "    primary long id;\n"
+    "    secondary string maker;\n"
+    "};\n"
+    "struct Truck : Vehicle {\n"
+    "    primary string plate;\n"
+    "    double load;\n"
+    "};\n"
+    "struct Car : Vehicle {\n"
+    "    secondary int seats;\n"
+    "};\n"
+    "struct Tanker : Truck {\n"
+    "    secondary string liquid;\n"
+    "};\n";
+
+static const char* mNames[] = {"ada", "bob", "cy", "dee", "ed\0x", "flo", "gus"};
+static const char* mCities[] = {"Oslo", "Lima", "Kyiv", "Pune"};
+
+static bool mPassed = true;
+
+static void Check(bool condition, const std::string& what) {
+    std::cout << (condition ? "ok      " : "FAILED  ") << what << std::endl;
+    mPassed = mPassed && condition;
+}
+
+static uint32_t Next(uint64_t& state) {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return static_cast<uint32_t>(state >> 33);
+}
+
+/**
+ * @brief What a Customer record holds, kept alongside the trunk
+ */
+struct Customer {
+    std::string name;
+    bool age_null;
+    int32_t age;
+    double balance;
+    std::string city;
+};
+
+static std::vector<uint8_t> Build(const RecordLayout& layout, int64_t id, const Customer& customer) {
+    RecordBuilder builder(layout);
+    builder.SetInteger(layout.Field(layout.FieldIndex("id")), id);
+    builder.SetString(layout.Field(layout.FieldIndex("name")), customer.name);
+    if (!customer.age_null)
+        builder.SetInteger(layout.Field(layout.FieldIndex("age")), customer.age);
+    builder.SetReal(layout.Field(layout.FieldIndex("balance")), customer.balance);
+    builder.SetString(layout.Field(layout.FieldIndex("city")), customer.city);
+    builder.SetInteger(layout.Field(layout.FieldIndex("visits")), id % 17);
+    return builder.Finish();
+}
+
+static Customer Generate(uint64_t& state) {
+    Customer customer;
+    uint32_t pick = Next(state);
+    // One name has a 0 byte, escaped in the index key
+    customer.name = (pick % 7 == 4) ? std::string("ed\0x", 4) : mNames[pick % 7];
+    customer.age_null = pick % 11 == 0;
+    customer.age = static_cast<int32_t>(Next(state) % 90) - 5;
+    customer.balance = static_cast<double>(static_cast<int32_t>(Next(state) % 2001) - 1000) / 8.0;
+    customer.city = mCities[Next(state) % 4];
+    return customer;
+}
+
+/**
+ * @brief Every index of the trunk holds exactly the entries of the reference, in key then id order
+ */
+static bool IndexesMatch(const Trunk& trunk, const std::map<int64_t, Customer>& reference) {
+    std::vector<std::pair<std::string, int64_t>> names;
+    std::vector<std::pair<int32_t, int64_t>> ages;
+    std::vector<std::pair<double, int64_t>> balances;
+    size_t null_ages = 0;
+    for (const auto& item : reference) {
+        names.emplace_back(item.second.name, item.first);
+        if (item.second.age_null)
+            ++null_ages;
+        else
+            ages.emplace_back(item.second.age, item.first);
+        balances.emplace_back(item.second.balance, item.first);
+    }
+    std::sort(names.begin(), names.end());
+    std::sort(ages.begin(), ages.end());
+    std::sort(balances.begin(), balances.end());
+
+    // Names one at a time, with the included city and age
+    const SecondaryIndex& by_name = *trunk.FindIndex("name");
+    int32_t city = by_name.IncludeIndex("city");
+    int32_t age = by_name.IncludeIndex("age");
+    size_t position = 0;
+    for (const char* name : mNames) {
+        std::string key = (name[0] == 'e') ? std::string("ed\0x", 4) : name;
+        for (IndexCursor cursor = by_name.Find(key); cursor.Valid(); cursor.Next(), ++position) {
+            if (position >= names.size() || names[position].first != key ||
+                cursor.Primary().integer != names[position].second)
+                return false;
+            const Customer& customer = reference.at(cursor.Primary().integer);
+            if (cursor.String(city) != customer.city || cursor.IsNull(age) != customer.age_null ||
+                (!customer.age_null && cursor.Integer(age) != customer.age))
+                return false;
+        }
+    }
+    if (position != names.size())
+        return false;
+
+    // Every age as one range, then the nulls
+    const SecondaryIndex& by_age = *trunk.FindIndex("age");
+    position = 0;
+    for (IndexCursor cursor = by_age.Range(int64_t{INT32_MIN}, int64_t{INT32_MAX}); cursor.Valid();
+         cursor.Next(), ++position) {
+        if (position >= ages.size() || cursor.Primary().integer != ages[position].second)
+            return false;
+    }
+    size_t nulls = 0;
+    for (IndexCursor cursor = by_age.Find(IndexValue()); cursor.Valid(); cursor.Next())
+        nulls += reference.at(cursor.Primary().integer).age_null;
+    if (position != ages.size() || nulls != null_ages)
+        return false;
+
+    const SecondaryIndex& by_balance = *trunk.FindIndex("balance");
+    position = 0;
+    for (IndexCursor cursor = by_balance.Range(-1e300, 1e300); cursor.Valid(); cursor.Next(), ++position) {
+        if (position >= balances.size() || cursor.Primary().integer != balances[position].second)
+            return false;
+    }
+    return position == balances.size();
+}
+
+/**
+ * @brief Records of a hierarchy in one trunk, found by branch and by keys of derived structs
+ */
+static void CheckHierarchy(BufferPool& pool, Pager& pager, const SchemaCatalog& catalog) {
+    const RecordLayout& vehicle = *catalog.Find("Vehicle");
+    const RecordLayout& truck = *catalog.Find("Truck");
+    const RecordLayout& car = *catalog.Find("Car");
+    const RecordLayout& tanker = *catalog.Find("Tanker");
+    uint32_t root = pager.CreateTrunk("vehicles", "Vehicle");
+    Trunk::Format(pool, root, catalog, vehicle.TypeId(), {IndexSpec{"liquid", {"load"}, "Tanker"}});
+    Trunk trunk(pool, root, catalog, vehicle.TypeId());
+    Check(trunk.IndexCount() == 4 && trunk.FindIndex("maker") && trunk.FindIndex("plate", truck.TypeId()) &&
+          trunk.FindIndex("seats", car.TypeId()) && trunk.FindIndex("liquid", tanker.TypeId()) &&
+          !trunk.FindIndex("plate"), "derived structs index the keys they declare");
+
+    // Records of every kind in turn, Car is declared between Truck and Tanker so a branch's type ids are not contiguous
+    std::map<uint32_t, size_t> counts;
+    bool inserted = true;
+    for (int64_t id = 0; id < 2000; ++id) {
+        const RecordLayout& layout = (id % 4 == 0) ? vehicle : (id % 4 == 1) ? truck : (id % 4 == 2) ? car : tanker;
+        RecordBuilder builder(layout);
+        builder.SetInteger(layout.Field(layout.FieldIndex("id")), id);
+        builder.SetString(layout.Field(layout.FieldIndex("maker")), (id % 3) ? "acme" : "zenith");
+        if (layout.FieldIndex("plate") >= 0) {
+            builder.SetString(layout.Field(layout.FieldIndex("plate")), "PL-" + std::to_string(id));
+            builder.SetReal(layout.Field(layout.FieldIndex("load")), static_cast<double>(id) / 2);
+        }
+        if (layout.FieldIndex("seats") >= 0)
+            builder.SetInteger(layout.Field(layout.FieldIndex("seats")), 2 + id % 5);
+        if (layout.FieldIndex("liquid") >= 0)
+            builder.SetString(layout.Field(layout.FieldIndex("liquid")), (id % 8 == 3) ? "oil" : "milk");
+        inserted = inserted && trunk.Insert(builder.Finish());
+        ++counts[layout.TypeId()];
+    }
+    Check(inserted, "records of every struct of the hierarchy");
+
+    // A branch visits its own types only, each in primary key order
+    bool branch = true;
+    size_t visited = 0;
+    int64_t previous = -1;
+    uint32_t previous_type = 0;
+    for (TypeCursor cursor = trunk.ScanType(truck.TypeId()); cursor.Valid(); cursor.Next(), ++visited) {
+        std::vector<uint8_t> record;
+        branch = branch && catalog.IsA(cursor.TypeId(), truck.TypeId()) && trunk.Fetch(cursor.Primary(), record) &&
+                 RecordTypeId(record.data()) == cursor.TypeId() &&
+                 (cursor.TypeId() > previous_type || cursor.Primary().integer > previous);
+        previous = cursor.Primary().integer;
+        previous_type = cursor.TypeId();
+    }
+    Check(branch && visited == counts[truck.TypeId()] + counts[tanker.TypeId()] &&
+          trunk.CountType(vehicle.TypeId()) == 2000 && trunk.CountType(car.TypeId()) == counts[car.TypeId()],
+          "type scans visit one branch");
+
+    // The primary key a derived struct declares acts as a unique secondary key of its branch
+    const SecondaryIndex& plates = *trunk.FindIndex("plate", truck.TypeId());
+    IndexCursor plate = plates.Find(std::string("PL-7"));
+    std::vector<uint8_t> record;
+    Check(plate.Valid() && plate.Primary().integer == 7 && trunk.Fetch(plate.Primary(), record) &&
+          RecordTypeId(record.data()) == tanker.TypeId(), "probe a derived primary key");
+    RecordBuilder duplicate(truck);
+    duplicate.SetInteger(truck.Field(truck.FieldIndex("id")), 5000);
+    duplicate.SetString(truck.Field(truck.FieldIndex("plate")), "PL-7");
+    Check(!trunk.Insert(duplicate.Finish()) && !trunk.Fetch(int64_t{5000}, record), "derived primary keys stay unique");
+    size_t oil = 0;
+    for (IndexCursor cursor = trunk.FindIndex("liquid", tanker.TypeId())->Find(std::string("oil")); cursor.Valid();
+         cursor.Next())
+        oil += cursor.Real(0) == static_cast<double>(cursor.Primary().integer) / 2;
+    Check(oil == counts[tanker.TypeId()] / 2, "covered member of a derived struct");
+
+    // A car becomes a truck, leaving the car's index and joining the truck's
+    RecordBuilder converted(truck);
+    converted.SetInteger(truck.Field(truck.FieldIndex("id")), 2);
+    converted.SetString(truck.Field(truck.FieldIndex("maker")), "acme");
+    converted.SetString(truck.Field(truck.FieldIndex("plate")), "PL-2");
+    trunk.Update(int64_t{2}, converted.Finish());
+    size_t seats = 0;
+    for (BTreeCursor cursor = trunk.FindIndex("seats", car.TypeId())->Tree().Begin(); cursor.Valid(); cursor.Next())
+        ++seats;
+    Check(seats == counts[car.TypeId()] - 1 && plates.Find(std::string("PL-2")).Valid() &&
+          trunk.CountType(truck.TypeId()) == counts[truck.TypeId()] + counts[tanker.TypeId()] + 1,
+          "update into another derived struct");
+
+    // Erasing a branch leaves every index without its records
+    size_t erased = trunk.EraseType(truck.TypeId());
+    size_t makers = 0;
+    for (IndexCursor cursor = trunk.FindIndex("maker")->Range(std::string(""), std::string("zz")); cursor.Valid();
+         cursor.Next())
+        ++makers;
+    Check(erased == counts[truck.TypeId()] + counts[tanker.TypeId()] + 1 && trunk.CountType(truck.TypeId()) == 0 &&
+          !plates.Tree().Begin().Valid() && makers == 2000 - erased &&
+          trunk.CountType(vehicle.TypeId()) == 2000 - erased, "erase a branch");
+
+    try {
+        RecordBuilder note(*catalog.Find("Note"));
+        trunk.Insert(note.Finish());
+        Check(false, "record of another hierarchy rejected");
+    } catch (const SchemaException& e) {
+        std::cout << "        SchemaException: " << e.what() << std::endl;
+        Check(true, "record of another hierarchy rejected");
+    }
+}
+
+int main(int argc, char* argv[]) {
+    // Keep trunks with secondary indexes in a scratch database file at the given path
+    if (argc != 2)
+        return -1;
+    std::string path = argv[1];
+
+    Tokenizer tokenizer;
+    TokenBuffer tokens;
+    tokenizer.OpenString(mSchema);
+    tokenizer.Tokenize(tokens);
+    Parser parser;
+    Arena arena;
+    SchemaCatalog catalog;
+    try {
+        catalog.AddProgram(parser.Parse(tokens, arena));
+    } catch (const ParseException& e) {
+        std::cout << "ParseException: " << e.what() << std::endl;
+        return -1;
+    }
+    const RecordLayout& customers = *catalog.Find("Customer");
+    const RecordLayout& notes = *catalog.Find("Note");
+    const RecordLayout& accounts = *catalog.Find("Account");
+
+    try {
+        Pager pager;
+        pager.Create(path, PagerOptions{1024});
+        std::map<int64_t, Customer> reference;
+        {
+            BufferPool pool(pager, 128);
+            try {
+                Trunk::Format(pool, pager.CreateTrunk("wrong", "Customer"), catalog, customers.TypeId(),
+                              {IndexSpec{"city", {}, {}}});
+                Check(false, "index on a member that is not secondary");
+            } catch (const SchemaException& e) {
+                std::cout << "        SchemaException: " << e.what() << std::endl;
+                Check(true, "index on a member that is not secondary");
+            }
+            uint32_t root = pager.CreateTrunk("customers", "Customer");
+            Trunk::Format(pool, root, catalog, customers.TypeId(), {IndexSpec{"name", {"city", "age"}, {}}});
+            Trunk trunk(pool, root, catalog, customers.TypeId());
+            Check(trunk.IndexCount() == 3 && trunk.FindIndex("city") == nullptr, "every secondary member is indexed");
+            Check(trunk.FindIndex("name")->Covers({"name", "city", "age"}) &&
+                  !trunk.FindIndex("name")->Covers({"name", "visits"}) &&
+                  trunk.FindIndex("age")->Covers({"age"}), "covered members");
+
+            uint64_t state = 5;
+            bool inserted = true;
+            for (int64_t id = 0; id < RECORDS; ++id) {
+                int64_t key = (id * 7919) % RECORDS - RECORDS / 2;
+                Customer customer = Generate(state);
+                inserted = inserted && trunk.Insert(Build(customers, key, customer));
+                reference[key] = customer;
+            }
+            Check(inserted && !trunk.Insert(Build(customers, 0, Generate(state))), "inserts, duplicate primary key");
+            Check(IndexesMatch(trunk, reference), "indexes after inserts");
+
+            std::vector<uint8_t> record;
+            Check(trunk.Fetch(int64_t{17}, record) &&
+                  ReadVar(record.data(), customers.Field(customers.FieldIndex("city"))) == reference[17].city,
+                  "fetch by primary key");
+
+            // Change some keys and some included members only, erase others
+            bool changed = true;
+            for (auto it = reference.begin(); it != reference.end();) {
+                uint32_t pick = Next(state) % 6;
+                if (pick == 0) {
+                    changed = changed && trunk.Erase(it->first);
+                    it = reference.erase(it);
+                    continue;
+                }
+                if (pick == 1) {
+                    it->second = Generate(state);
+                    changed = changed && trunk.Update(it->first, Build(customers, it->first, it->second));
+                } else if (pick == 2) {
+                    it->second.city = mCities[Next(state) % 4];
+                    changed = changed && trunk.Update(it->first, Build(customers, it->first, it->second));
+                }
+                ++it;
+            }
+            Check(changed && !trunk.Erase(int64_t{RECORDS}) &&
+                  !trunk.Update(int64_t{RECORDS}, Build(customers, RECORDS, Generate(state))), "updates and erases");
+            Check(IndexesMatch(trunk, reference), "indexes after updates and erases");
+
+            try {
+                trunk.Update(int64_t{1}, Build(customers, 2, reference[2]));
+                Check(false, "primary key update rejected");
+            } catch (const SchemaException& e) {
+                std::cout << "        SchemaException: " << e.what() << std::endl;
+                Check(true, "primary key update rejected");
+            }
+            try {
+                trunk.FindIndex("age")->Find(std::string("old"));
+                Check(false, "string probe of an int index rejected");
+            } catch (const SchemaException& e) {
+                std::cout << "        SchemaException: " << e.what() << std::endl;
+                Check(true, "string probe of an int index rejected");
+            }
+
+            // A trunk without a primary key numbers its records
+            uint32_t note_root = pager.CreateTrunk("notes", "Note");
+            Trunk::Format(pool, note_root, catalog, notes.TypeId());
+            Trunk note_trunk(pool, note_root, catalog, notes.TypeId());
+            RecordBuilder builder(notes);
+            for (int i = 0; i < 10; ++i) {
+                builder.SetString(notes.Field(notes.FieldIndex("tag")), (i % 2) ? "odd" : "even");
+                note_trunk.Insert(builder.Finish());
+            }
+            size_t odd = 0;
+            for (IndexCursor cursor = note_trunk.FindIndex("tag")->Find(std::string("odd")); cursor.Valid();
+                 cursor.Next())
+                odd += cursor.Primary().integer % 2 == 0;
+            Check(note_trunk.LastRowId() == 10 && odd == 5, "row ids for a trunk without a primary key");
+
+            // Escaped 0 bytes make the index entry too large while the record still fits, neither is written
+            builder.SetString(notes.Field(notes.FieldIndex("tag")), std::string(130, '\0'));
+            std::vector<uint8_t> oversized = builder.Finish();
+            try {
+                note_trunk.Insert(oversized);
+                Check(false, "oversized index entry rejected");
+            } catch (const FileException& e) {
+                std::cout << "        FileException: " << e.what() << std::endl;
+                size_t rows = 0;
+                for (BTreeCursor cursor = note_trunk.Scan(); cursor.Valid(); cursor.Next())
+                    ++rows;
+                Check(rows == 10 && note_trunk.LastRowId() == 10, "oversized index entry rejected");
+            }
+            try {
+                note_trunk.Update(int64_t{1}, oversized);
+                Check(false, "oversized index entry update rejected");
+            } catch (const FileException& e) {
+                std::cout << "        FileException: " << e.what() << std::endl;
+                size_t even = 0;
+                for (IndexCursor cursor = note_trunk.FindIndex("tag")->Find(std::string("even")); cursor.Valid();
+                     cursor.Next())
+                    ++even;
+                Check(note_trunk.Fetch(int64_t{1}, record) &&
+                      ReadVar(record.data(), notes.Field(notes.FieldIndex("tag"))) == "even" && even == 5,
+                      "oversized index entry update rejected");
+            }
+
+            // String primary keys follow the secondary key in the entries
+            uint32_t account_root = pager.CreateTrunk("accounts", "Account");
+            Trunk::Format(pool, account_root, catalog, accounts.TypeId());
+            Trunk account_trunk(pool, account_root, catalog, accounts.TypeId());
+            RecordBuilder account(accounts);
+            for (uint64_t flags : std::vector<uint64_t>{INT64_MAX, 0, 1ULL << 62, 7}) {
+                account.SetString(accounts.Field(accounts.FieldIndex("code")), "acct-" + std::to_string(flags % 1000));
+                account.SetInteger(accounts.Field(accounts.FieldIndex("flags")), static_cast<int64_t>(flags));
+                account_trunk.Insert(account.Finish());
+            }
+            std::vector<std::string> codes;
+            for (IndexCursor cursor = account_trunk.FindIndex("flags")->Range(int64_t{0}, int64_t{-1});
+                 cursor.Valid(); cursor.Next())
+                codes.push_back(cursor.Primary().bytes);
+            Check(codes == std::vector<std::string>{"acct-0", "acct-7", "acct-904", "acct-807"},
+                  "unsigned secondary keys with string primary keys");
+            CheckHierarchy(pool, pager, catalog);
+            pool.FlushAll();
+        }
+        pager.Close();
+
+        // Everything is still there after reopening
+        pager.Open(path);
+        BufferPool pool(pager, 128);
+        Trunk trunk(pool, pager.FindTrunk("customers")->root_page, catalog, customers.TypeId());
+        Check(IndexesMatch(trunk, reference), "indexes survive reopening");
+        Trunk note_trunk(pool, pager.FindTrunk("notes")->root_page, catalog, notes.TypeId());
+        RecordBuilder builder(notes);
+        builder.SetString(notes.Field(notes.FieldIndex("tag")), "late");
+        note_trunk.Insert(builder.Finish());
+        Check(note_trunk.LastRowId() == 11, "row ids survive reopening");
+    } catch (const FileException& e) {
+        std::cout << "FileException: " << e.what() << std::endl;
+        return -1;
+    } catch (const SchemaException& e) {
+        std::cout << "SchemaException: " << e.what() << std::endl;
+        return -1;
+    }
+    return mPassed ? 1 : 0;
+}
@@ -0,0 +1,72 @@
+// C++ Includes
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+// Local Includes
+#include "exception/parse_exception.h"
+#include "exception/schema_exception.h"
+#include "exception/vm_exception.h"
+#include "parser/arena.h"
+#include "parser/optimizer.h"
+#include "parser/parser.h"
+#include "parser/tokenbuffer.h"
+#include "parser/tokenizer.h"
+#include "schema/catalog.h"
+#include "vm/bytecode.h"
+#include "vm/compiler.h"
+#include "vm/vm.h"
+
+
+int main(int argc, char* argv[]) {
+    // Compile and run the file, -d prints the bytecode first, -N only folds the struct defaults the catalog needs
+    if (argc < 2 || argc > 3)
+        return -1;
+    bool disassemble = (argc == 3) && strcmp(argv[2], "-d") == 0;
+    bool optimize = (argc < 3) || strcmp(argv[2], "-N") != 0;
+
+    Tokenizer tokenizer;
+    TokenBuffer tokens;
+    tokenizer.OpenFile(argv[1]);
+    tokenizer.Tokenize(tokens);
+
+    Parser parser;
+    Arena arena;
+    Optimizer optimizer;
+    SchemaCatalog catalog;
+    Compiler compiler;
+    Program program;
+    try {
+        AstNode* root = parser.Parse(tokens, arena);
+        if (optimize) {
+            root = optimizer.Optimize(root, arena);
+        } else {
+            for (AstNode* node = root->first_child; node != nullptr; node = node->next_sibling) {
+                if (node->kind == AstKind::kSTRUCT_DECL)
+                    optimizer.Optimize(node, arena);
+            }
+        }
+        catalog.AddProgram(root);
+        program = compiler.Compile(root, catalog);
+    } catch (const ParseException& e) {
+        std::cout << "ParseException: " << e.what() << std::endl;
+        return -1;
+    } catch (const SchemaException& e) {
+        std::cout << "SchemaException: " << e.what() << std::endl;
+        return -1;
+    } catch (const VmException& e) {
+        std::cout << "VmException: " << e.what() << std::endl;
+        return -1;
+    }
+    if (disassemble)
+        std::cout << Disassemble(program);
+
+    Vm vm;
+    try {
+        vm.Run(program);
+    } catch (const VmException& e) {
+        std::cout << "VmException: " << e.what() << std::endl;
+        return -1;
+    }
+    return 1;
+}
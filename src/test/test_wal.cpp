@@ -0,0 +1,308 @@
+// C++ Includes
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Local Includes
+#include "exception/file_exception.h"
+#include "exception/parse_exception.h"
+#include "file/bufferpool.h"
+#include "file/filewriter.h"
+#include "parser/arena.h"
+#include "parser/parser.h"
+#include "parser/tokenbuffer.h"
+#include "parser/tokenizer.h"
+#include "schema/catalog.h"
+#include "schema/record.h"
+#include "storage/pager.h"
+#include "storage/trunk.h"
+#include "storage/wal.h"
+
+#define ORDERS 300
+#define THREADS 8
+#define THREAD_COMMITS 25
+
+static const char* mSchema =
+    "struct Order {\n"
+    "    primary long id;\n"
+    "    secondary string item;\n"
+    "    int quantity;\n"
+    "};\n";
+
+static bool mPassed = true;
+
+static void Check(bool condition, const std::string& what) {
+    std::cout << (condition ? "ok      " : "FAILED  ") << what << std::endl;
+    mPassed = mPassed && condition;
+}
+
+static std::vector<uint8_t> MakeOrder(const RecordLayout& layout, int64_t id, int64_t quantity) {
+    RecordBuilder builder(layout);
+    builder.SetInteger(layout.Field(layout.FieldIndex("id")), id);
+    builder.SetString(layout.Field(layout.FieldIndex("item")), "item-" + std::to_string(id % 10));
+    builder.SetInteger(layout.Field(layout.FieldIndex("quantity")), quantity);
+    return builder.Finish();
+}
+
+static void CopyFile(const std::string& from, const std::string& to) {
+    std::ifstream in(from, std::ios::binary);
+    std::ofstream out(to, std::ios::binary | std::ios::trunc);
+    out << in.rdbuf();
+}
+
+static std::string Contents(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+/**
+ * @brief What the disk holds if the process died now: the database file and its log
+ */
+static void Snapshot(const std::string& path, const std::string& crash) {
+    CopyFile(path, crash);
+    CopyFile(WriteAheadLog::PathFor(path), WriteAheadLog::PathFor(crash));
+}
+
+/**
+ * @brief Recover a crashed copy and read its orders back
+ * @return Orders found, -1 if a record or its index entry is wrong
+ */
+static int64_t Recovered(const std::string& crash, const SchemaCatalog& catalog, int64_t& quantity_5, bool& has_7) {
+    WriteAheadLog::Recover(crash, 1024);
+    Pager pager;
+    pager.Open(crash);
+    BufferPool pool(pager, 32);
+    const RecordLayout& orders = *catalog.Find("Order");
+    Trunk trunk(pool, pager.FindTrunk("orders")->root_page, catalog, orders.TypeId());
+    int64_t count = 0;
+    for (BTreeCursor cursor = trunk.Scan(); cursor.Valid(); cursor.Next(), ++count) {
+        int64_t id = cursor.IntegerKey();
+        std::string item = "item-" + std::to_string(id % 10);
+        bool indexed = false;
+        for (IndexCursor entry = trunk.FindIndex("item")->Find(item); entry.Valid(); entry.Next())
+            indexed = indexed || entry.Primary().integer == id;
+        if (!indexed)
+            return -1;
+    }
+    std::vector<uint8_t> record;
+    const FieldLayout& quantity = orders.Field(orders.FieldIndex("quantity"));
+    quantity_5 = trunk.Fetch(int64_t{5}, record) ? ReadInteger(record.data(), quantity) : -1;
+    has_7 = trunk.Fetch(int64_t{7}, record);
+    return count;
+}
+
+int main(int argc, char* argv[]) {
+    // Log a scratch database file at the given path, crashed copies sit next to it
+    if (argc != 2)
+        return -1;
+    std::string path = argv[1];
+
+    Tokenizer tokenizer;
+    TokenBuffer tokens;
+    tokenizer.OpenString(mSchema);
+    tokenizer.Tokenize(tokens);
+    Parser parser;
+    Arena arena;
+    SchemaCatalog catalog;
+    try {
+        catalog.AddProgram(parser.Parse(tokens, arena));
+    } catch (const ParseException& e) {
+        std::cout << "ParseException: " << e.what() << std::endl;
+        return -1;
+    }
+    const RecordLayout& orders = *catalog.Find("Order");
+
+    try {
+        // Inserts, an update and an erase, each committed, with crashes taken along the way
+        Pager pager;
+        pager.Create(path, PagerOptions{1024});
+        {
+            WriteAheadLog log(path, pager.PageSize());
+            BufferPool pool(pager, 32, &log);
+            uint32_t root = pager.CreateTrunk("orders", "Order");
+            Trunk::Format(pool, root, catalog, orders.TypeId());
+            Trunk trunk(pool, root, catalog, orders.TypeId());
+            pool.Commit();
+            for (int64_t id = 1; id <= ORDERS; ++id) {
+                trunk.Insert(MakeOrder(orders, id, id));
+                pool.Commit();
+            }
+            Check(log.Commits() == ORDERS + 1 && pool.UncommittedCount() == 0 && pool.Evictions() > 0 &&
+                  log.DurableLsn() == log.NextLsn() - 1, "every insert committed and synced");
+            Snapshot(path, path + ".inserted");
+
+            trunk.Update(int64_t{5}, MakeOrder(orders, 5, 500));
+            trunk.Erase(int64_t{7});
+            pool.Commit();
+            Snapshot(path, path + ".updated");
+            Snapshot(path, path + ".torn0");
+            Snapshot(path, path + ".torn1");
+            for (int64_t id = ORDERS + 1; id <= ORDERS + 10; ++id)
+                trunk.Insert(MakeOrder(orders, id, id));
+            Check(pool.UncommittedCount() > 0 && pool.Commit() > 0 && pool.UncommittedCount() == 0,
+                  "pages changed since the last commit");
+            for (int64_t id = ORDERS + 11; id <= ORDERS + 20; ++id)
+                trunk.Insert(MakeOrder(orders, id, id));
+            Snapshot(path, path + ".uncommitted");
+            Snapshot(path, path + ".serial");
+            Snapshot(path, path + ".parallel");
+
+            try {
+                WriteAheadLog again(path + ".updated", pager.PageSize());
+                Check(false, "log with records refused before recovery");
+            } catch (const FileException& e) {
+                std::cout << "        FileException: " << e.what() << std::endl;
+                Check(true, "log with records refused before recovery");
+            }
+
+            pool.FlushAll();
+            Check(log.Size() == 32 && pool.DirtyCount() == 0, "checkpoint truncates the log");
+        }
+        pager.Close();
+
+        // Recovery replays committed changes only
+        int64_t quantity_5;
+        bool has_7;
+        Check(Recovered(path + ".inserted", catalog, quantity_5, has_7) == ORDERS && quantity_5 == 5 && has_7,
+              "recover committed inserts");
+        Check(Recovered(path + ".updated", catalog, quantity_5, has_7) == ORDERS - 1 && quantity_5 == 500 && !has_7,
+              "recover a committed update and erase");
+        Check(Recovered(path + ".uncommitted", catalog, quantity_5, has_7) == ORDERS + 9,
+              "uncommitted inserts are lost");
+        Check(WriteAheadLog::Recover(path + ".updated", 1024).records == 0, "recovery empties the log");
+        RecoveryStats serial = WriteAheadLog::Recover(path + ".serial", 1024, 1);
+        RecoveryStats parallel = WriteAheadLog::Recover(path + ".parallel", 1024, 4);
+        Check(serial.pages > 0 && parallel.threads == 4 && serial.pages == parallel.pages &&
+              serial.records == parallel.records && Contents(path + ".serial") == Contents(path + ".parallel"),
+              "parallel replay writes what a serial one does");
+
+        // A torn or damaged tail ends recovery at the last intact commit
+        for (int damage = 0; damage < 2; ++damage) {
+            std::string crash = path + ".torn" + std::to_string(damage);
+            FileWriter log(WriteAheadLog::PathFor(crash), FileWriterOptions{false, false, false});
+            uint64_t size = log.Size();
+            if (damage == 0) {
+                log.Truncate(size - 10);
+            } else {
+                uint8_t byte;
+                log.ReadAt(size - 40, &byte, 1);
+                byte ^= 0x5A;
+                log.WriteAt(size - 40, &byte, 1);
+            }
+        }
+        Check(Recovered(path + ".torn0", catalog, quantity_5, has_7) == ORDERS && quantity_5 == 5 && has_7,
+              "torn commit record dropped");
+        Check(Recovered(path + ".torn1", catalog, quantity_5, has_7) == ORDERS && quantity_5 == 5 && has_7,
+              "damaged page record dropped with its commit");
+
+        // A recovered database takes new commits, the log stays below its checkpoint size
+        {
+            std::string recovered = path + ".inserted";
+            pager.Open(recovered);
+            WalOptions options;
+            options.checkpoint_size = 16 * 1024;
+            WriteAheadLog log(recovered, pager.PageSize(), options);
+            BufferPool pool(pager, 32, &log);
+            Trunk trunk(pool, pager.FindTrunk("orders")->root_page, catalog, orders.TypeId());
+            uint64_t largest = 0;
+            for (int64_t id = ORDERS + 1; id <= 2 * ORDERS; ++id) {
+                trunk.Insert(MakeOrder(orders, id, id));
+                pool.Commit();
+                largest = std::max(largest, log.Size());
+            }
+            Check(largest < options.checkpoint_size + 16 * 1024 && log.Commits() == ORDERS,
+                  "checkpoints bound the log");
+        }
+        pager.Close();
+        Check(Recovered(path + ".inserted", catalog, quantity_5, has_7) == 2 * ORDERS, "clean close needs no replay");
+
+        // Uncommitted pages cannot be evicted
+        {
+            pager.Create(path + ".small", PagerOptions{512});
+            WriteAheadLog log(path + ".small", pager.PageSize());
+            BufferPool pool(pager, 4, &log);
+            for (int i = 0; i < 4; ++i)
+                pool.PinNew(PageType::kDATA);
+            try {
+                pool.PinNew(PageType::kDATA);
+                Check(false, "pool full of uncommitted pages");
+            } catch (const FileException& e) {
+                std::cout << "        FileException: " << e.what() << std::endl;
+                Check(true, "pool full of uncommitted pages");
+            }
+            pool.Commit();
+            pool.PinNew(PageType::kDATA);
+            Check(pool.Evictions() == 1 && log.DurableLsn() == log.NextLsn() - 1, "committed pages are evicted");
+        }
+        pager.Close();
+
+        // Concurrent commits share syncs
+        std::string group = path + ".small";
+        {
+            WalOptions options;
+            options.group_delay_us = 2000;
+            WriteAheadLog log(group, 512, options);
+            std::vector<std::thread> threads;
+            for (uint32_t t = 0; t < THREADS; ++t) {
+                threads.emplace_back([&log, t] {
+                    std::vector<uint8_t> page(512);
+                    uint32_t page_no = 1 + t;
+                    uint8_t* pages[] = {page.data()};
+                    for (uint32_t i = 0; i < THREAD_COMMITS; ++i) {
+                        page[sizeof(PageHeader)] = static_cast<uint8_t>(i);
+                        log.Commit(&page_no, pages, 1);
+                    }
+                });
+            }
+            for (std::thread& thread : threads)
+                thread.join();
+            std::cout << "        " << log.Commits() << " commits, " << log.Syncs() << " syncs" << std::endl;
+            Check(log.Commits() == THREADS * THREAD_COMMITS && log.Syncs() < log.Commits() / 2 &&
+                  log.DurableLsn() == log.NextLsn() - 1, "group commit");
+        }
+        RecoveryStats stats = WriteAheadLog::Recover(group, 512);
+        Check(stats.commits == THREADS * THREAD_COMMITS && stats.records == 2 * stats.commits && stats.pages == THREADS,
+              "recover concurrent commits");
+
+        // Durability levels
+        std::vector<uint8_t> page(512);
+        uint32_t page_no = 1;
+        uint8_t* pages[] = {page.data()};
+        {
+            WalOptions options;
+            options.durability = Durability::kNONE;
+            WriteAheadLog log(group, 512, options);
+            uint64_t lsn = 0;
+            for (int i = 0; i < 50; ++i)
+                lsn = log.Commit(&page_no, pages, 1);
+            bool unsynced = log.Syncs() == 0 && log.DurableLsn() < lsn;
+            log.Flush(lsn);
+            Check(unsynced && log.Syncs() == 0, "no durability never syncs a commit");
+        }
+        Check(WriteAheadLog::Recover(group, 512).commits == 50, "closing syncs the log");
+        {
+            WalOptions options;
+            options.durability = Durability::kPERIODIC;
+            options.sync_interval_ms = 10;
+            WriteAheadLog log(group, 512, options);
+            uint64_t lsn = 0;
+            for (int i = 0; i < 50; ++i)
+                lsn = log.Commit(&page_no, pages, 1);
+            bool deferred = log.Syncs() <= 1;
+            for (int wait = 0; wait < 100 && log.DurableLsn() < lsn; ++wait)
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            Check(deferred && log.DurableLsn() == lsn, "periodic durability syncs in the background");
+        }
+        Check(WriteAheadLog::Recover(group, 512).commits == 50, "recover periodic commits");
+    } catch (const FileException& e) {
+        std::cout << "FileException: " << e.what() << std::endl;
+        return -1;
+    }
+    return mPassed ? 1 : 0;
+}
@@ -0,0 +1,86 @@
+// C++ Includes
+#include <cstdint>
+#include <string>
+
+// Local Includes
+#include "bytecode.h"
+
+#define DT_OPCODE_NAME(name) #name,
+
+static const char* mOpcodeName[] = {
+    DT_OPCODES(DT_OPCODE_NAME)
+};
+
+#undef DT_OPCODE_NAME
+
+static_assert(sizeof(mOpcodeName) / sizeof(mOpcodeName[0]) == static_cast<size_t>(Opcode::kCOUNT),
+              "Every opcode needs a name");
+static_assert(sizeof(Instruction) == 8, "Instructions are 8 bytes");
+
+const char* OpcodeName(Opcode op) noexcept {
+    // Skip the k prefix
+    return mOpcodeName[static_cast<uint8_t>(op)] + 1;
+}
+
+std::string Disassemble(const Program& program) {
+    std::string out;
+    for (const Function& function : program.functions) {
+        out += function.name + ": params=" + std::to_string(function.params) + " registers=" +
+               std::to_string(function.registers) + "\n";
+        for (size_t pc = 0; pc < function.code.size(); ++pc) {
+            const Instruction& instr = function.code[pc];
+            std::string line = "  " + std::to_string(pc);
+            line.resize(8, ' ');
+            line += OpcodeName(instr.op);
+            line.resize(22, ' ');
+            line += std::to_string(instr.a) + " " + std::to_string(instr.b) + " " + std::to_string(instr.c);
+            // Constants and fields inline, so listings read without the pools
+            switch (instr.op) {
+                case Opcode::kLOAD_INT: {
+                    line += "  ; " + std::to_string(program.integers[instr.b]);
+                } break;
+                case Opcode::kLOAD_SMALL: {
+                    line += "  ; " + std::to_string(static_cast<int16_t>(instr.b));
+                } break;
+                case Opcode::kLOAD_REAL: {
+                    line += "  ; " + std::to_string(program.reals[instr.b]);
+                } break;
+                case Opcode::kLOAD_STR: {
+                    line += "  ; \"" + program.strings[instr.b] + "\"";
+                } break;
+                case Opcode::kJUMP_EQ_K:
+                case Opcode::kJUMP_NE_K:
+                case Opcode::kJUMP_LT_K:
+                case Opcode::kJUMP_LE_K:
+                case Opcode::kJUMP_GT_K:
+                case Opcode::kJUMP_GE_K: {
+                    line += "  ; " + std::to_string(static_cast<int16_t>(instr.b));
+                } break;
+                case Opcode::kADDK_I: {
+                    line += "  ; " + std::to_string(static_cast<int16_t>(instr.c));
+                } break;
+                case Opcode::kCALL: {
+                    line += "  ; " + program.functions[instr.b].name + "()";
+                } break;
+                case Opcode::kNEW_REC: {
+                    line += "  ; " + program.catalog->Get(instr.b).Name();
+                } break;
+                case Opcode::kGET_I:
+                case Opcode::kGET_R:
+                case Opcode::kGET_S: {
+                    line += "  ; ." + program.fields[instr.c].name;
+                } break;
+                case Opcode::kSET_I:
+                case Opcode::kSET_B:
+                case Opcode::kSET_R:
+                case Opcode::kSET_S: {
+                    line += "  ; ." + program.fields[instr.b].name;
+                } break;
+                default:
+                    break;
+            }
+            out += line + "\n";
+        }
+    }
+    return out;
+}
@@ -0,0 +1,159 @@
+#ifndef DT_SRC_VM_BYTECODE_H
+#define DT_SRC_VM_BYTECODE_H
+
+// C++ Includes
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Local Includes
+#include "schema/catalog.h"
+
+/**
+ * @brief Every opcode with its operands, in the order of the Opcode enum
+ *
+ * Registers are relative to the frame, jump targets are instruction indexes of
+ * the same function and always go in c. The list is expanded into the enum,
+ * the name table and the VM's dispatch table so they cannot drift apart.
+ */
+#define DT_OPCODES(X) \
+    X(kMOVE)            /* a = b */ \
+    X(kMOVE_STR)        /* a = b, strings */ \
+    X(kMOVE_REC)        /* a = copy of b, records */ \
+    X(kLOAD_INT)        /* a = integers[b] */ \
+    X(kLOAD_SMALL)      /* a = (int16_t)b */ \
+    X(kLOAD_REAL)       /* a = reals[b] */ \
+    X(kLOAD_STR)        /* a = strings[b] */ \
+    X(kADD_I)           /* a = b + c */ \
+    X(kSUB_I)           /* a = b - c */ \
+    X(kMUL_I)           /* a = b * c */ \
+    X(kDIV_I)           /* a = b / c */ \
+    X(kMOD_I)           /* a = b % c */ \
+    X(kADDK_I)          /* a = b + (int16_t)c */ \
+    X(kNEG_I)           /* a = -b */ \
+    X(kADD_R)           /* a = b + c */ \
+    X(kSUB_R)           /* a = b - c */ \
+    X(kMUL_R)           /* a = b * c */ \
+    X(kDIV_R)           /* a = b / c */ \
+    X(kNEG_R)           /* a = -b */ \
+    X(kNOT)             /* a = !b */ \
+    X(kI2R)             /* a = (double)b */ \
+    X(kR2I)             /* a = (int64_t)b */ \
+    X(kEQ_I)            /* a = b == c */ \
+    X(kNE_I)            /* a = b != c */ \
+    X(kLT_I)            /* a = b < c */ \
+    X(kLE_I)            /* a = b <= c */ \
+    X(kEQ_R)            /* a = b == c */ \
+    X(kNE_R)            /* a = b != c */ \
+    X(kLT_R)            /* a = b < c */ \
+    X(kLE_R)            /* a = b <= c */ \
+    X(kEQ_S)            /* a = b == c */ \
+    X(kNE_S)            /* a = b != c */ \
+    X(kLT_S)            /* a = b < c */ \
+    X(kLE_S)            /* a = b <= c */ \
+    X(kCONCAT)          /* a = b + c, strings */ \
+    X(kJUMP)            /* goto c */ \
+    X(kJUMP_FALSE)      /* if (!a) goto c */ \
+    X(kJUMP_TRUE)       /* if (a) goto c */ \
+    X(kJUMP_EQ_I)       /* if (a == b) goto c */ \
+    X(kJUMP_NE_I)       /* if (a != b) goto c */ \
+    X(kJUMP_LT_I)       /* if (a < b) goto c */ \
+    X(kJUMP_LE_I)       /* if (a <= b) goto c */ \
+    X(kJUMP_EQ_K)       /* if (a == (int16_t)b) goto c */ \
+    X(kJUMP_NE_K)       /* if (a != (int16_t)b) goto c */ \
+    X(kJUMP_LT_K)       /* if (a < (int16_t)b) goto c */ \
+    X(kJUMP_LE_K)       /* if (a <= (int16_t)b) goto c */ \
+    X(kJUMP_GT_K)       /* if (a > (int16_t)b) goto c */ \
+    X(kJUMP_GE_K)       /* if (a >= (int16_t)b) goto c */ \
+    X(kCALL)            /* call functions[b] with its arguments from a on, the result goes to a */ \
+    X(kRETURN)          /* return register 0 */ \
+    X(kNO_RETURN)       /* fail, the end of a function with a result was reached */ \
+    X(kPRINT_I)         /* print a */ \
+    X(kPRINT_R)         /* print a */ \
+    X(kPRINT_B)         /* print a */ \
+    X(kPRINT_S)         /* print a */ \
+    X(kPRINT_SPACE)     /* print ' ' */ \
+    X(kPRINT_LINE)      /* print '\n' */ \
+    X(kNEW_REC)         /* a = a record of type b holding its defaults */ \
+    X(kGET_I)           /* a = b.fields[c], integer or bool */ \
+    X(kGET_R)           /* a = b.fields[c], float or double */ \
+    X(kGET_S)           /* a = b.fields[c], string */ \
+    X(kSET_I)           /* a.fields[b] = c, integer */ \
+    X(kSET_B)           /* a.fields[b] = c, bool */ \
+    X(kSET_R)           /* a.fields[b] = c, float or double */ \
+    X(kSET_S)           /* a.fields[b] = c, string */
+
+#define DT_OPCODE_ENUM(name) name,
+
+/**
+ * @brief One VM operation, see DT_OPCODES for the operands
+ */
+enum class Opcode : uint8_t {
+    DT_OPCODES(DT_OPCODE_ENUM)
+    kCOUNT
+};
+
+#undef DT_OPCODE_ENUM
+
+/**
+ * @brief Static type of a register, the compiler picks typed opcodes from it
+ *
+ * Every integer width lives in a register as 64 bits, it is narrowed and
+ * range checked when stored into a record field.
+ */
+enum class ValueType : uint8_t {
+    kVOID,
+    kINT,
+    kREAL,
+    kBOOL,
+    kSTRING,
+    kRECORD
+};
+
+/**
+ * @brief A fixed 8 byte instruction with up to three 16 bit operands
+ */
+struct Instruction {
+    Opcode op;
+    uint16_t a;
+    uint16_t b;
+    uint16_t c;
+};
+
+/**
+ * @brief The bytecode of one function
+ */
+struct Function {
+    std::string name;
+    ValueType result;
+    uint16_t params;                    // Arguments arrive in registers 0 to params - 1
+    uint16_t registers;                 // Registers of one frame, always at least one for the result
+    std::vector<Instruction> code;
+    std::vector<uint32_t> lines;        // Source line of each instruction
+};
+
+/**
+ * @brief A compiled program, function 0 runs the top level statements
+ */
+struct Program {
+    std::vector<Function> functions;
+    int32_t main;                       // Index of main(), -1 when there is none
+    std::vector<ValueType> parameters;  // Statement parameters, in registers 0 to n - 1 of function 0
+    const SchemaCatalog* catalog;       // Record layouts referenced by kNEW_REC
+    std::vector<int64_t> integers;
+    std::vector<double> reals;
+    std::vector<std::string> strings;
+    std::vector<FieldLayout> fields;    // Resolved fields of kGET_* and kSET_*
+};
+
+/**
+ * @brief Name of an opcode for debugging
+ */
+const char* OpcodeName(Opcode op) noexcept;
+
+/**
+ * @brief Render every function as a listing, one instruction per line
+ */
+std::string Disassemble(const Program& program);
+
+#endif
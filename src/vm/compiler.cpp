@@ -0,0 +1,1058 @@
+// C++ Includes
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+// Local Includes
+#include "exception/schema_exception.h"
+#include "exception/vm_exception.h"
+#include "compiler.h"
+
+// Registers, constants and instructions are addressed by 16 bit operands
+#define MAX_OPERAND UINT16_MAX
+
+static bool IsNumeric(ValueType type) noexcept {
+    return type == ValueType::kINT || type == ValueType::kREAL;
+}
+
+static bool IsComparison(TokenType op) noexcept {
+    switch (op) {
+        case TokenType::kEQUALITY:
+        case TokenType::kDNE:
+        case TokenType::kLT:
+        case TokenType::kLTE:
+        case TokenType::kGT:
+        case TokenType::kGTE:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief The comparison that is true exactly when op is false
+ */
+static TokenType NegateComparison(TokenType op) noexcept {
+    switch (op) {
+        case TokenType::kEQUALITY: return TokenType::kDNE;
+        case TokenType::kDNE: return TokenType::kEQUALITY;
+        case TokenType::kLT: return TokenType::kGTE;
+        case TokenType::kLTE: return TokenType::kGT;
+        case TokenType::kGT: return TokenType::kLTE;
+        default: return TokenType::kLT;
+    }
+}
+
+/**
+ * @brief The operator of a compound assignment, x += 1 is x = x + 1
+ */
+static TokenType CompoundOperator(TokenType op) noexcept {
+    switch (op) {
+        case TokenType::kADD_EQU: return TokenType::kPLUS;
+        case TokenType::kSUB_EQU: return TokenType::kMINUS;
+        case TokenType::kMULT_EQU: return TokenType::kASTERISK;
+        case TokenType::kDIV_EQU: return TokenType::kDIVIDE;
+        default: return TokenType::kMODULO;
+    }
+}
+
+/**
+ * @brief Whether node is an integer literal, or a negated one, that fits an int16_t operand once negated when asked
+ */
+static bool SmallIntLiteral(const AstNode* node, bool negate, int16_t& value) noexcept {
+    if (node->kind == AstKind::kUNARY && node->op == TokenType::kMINUS) {
+        node = node->first_child;
+        negate = !negate;
+    }
+    if (node->kind != AstKind::kINTEGER || node->text.size() > 5)
+        return false;
+    int32_t parsed = 0;
+    for (char c : node->text)
+        parsed = parsed * 10 + (c - '0');
+    if (negate)
+        parsed = -parsed;
+    if (parsed < INT16_MIN || parsed > INT16_MAX)
+        return false;
+    value = static_cast<int16_t>(parsed);
+    return true;
+}
+
+Compiler::Compiler() noexcept
+: catalog_(nullptr), program_(nullptr), function_(nullptr), signature_(nullptr), parameters_(nullptr), signatures_(),
+  locals_(),
+  next_reg_(0), integer_index_(), real_index_(), string_index_(), field_index_()
+{}
+
+Compiler::~Compiler() noexcept {}
+
+Program Compiler::Compile(const AstNode* node, const SchemaCatalog& catalog) {
+    return Compile(node, catalog, {});
+}
+
+Program Compiler::Compile(const AstNode* node, const SchemaCatalog& catalog, const std::vector<ValueType>& parameters) {
+    if (parameters.size() >= MAX_OPERAND)
+        Error(node->line, "Too many parameters");
+    for (ValueType type : parameters) {
+        if (type == ValueType::kVOID || type == ValueType::kRECORD)
+            Error(node->line, "Parameters must be integers, reals, bools or strings");
+    }
+    Program program;
+    program.main = -1;
+    program.parameters = parameters;
+    parameters_ = &parameters;
+    program.catalog = &catalog;
+    catalog_ = &catalog;
+    program_ = &program;
+    signatures_.clear();
+    integer_index_.clear();
+    real_index_.clear();
+    string_index_.clear();
+    field_index_.clear();
+
+    // Every signature first, so calls may come before their callee
+    std::vector<const AstNode*> functions;
+    for (const AstNode* child = node->first_child; child != nullptr; child = child->next_sibling) {
+        if (child->kind != AstKind::kFUNCTION)
+            continue;
+        if (signatures_.count(child->text) != 0 || catalog.Find(child->text) != nullptr || child->text == "print")
+            Error(child->line, std::string(child->text) + " is already declared");
+        Signature signature;
+        signature.index = static_cast<uint32_t>(functions.size() + 1);
+        ResolveType(child->first_child, true, signature.result, signature.result_type_id);
+        for (const AstNode* param = child->first_child->next_sibling; param->kind == AstKind::kVAR_DECL;
+             param = param->next_sibling) {
+            if (param->child_count > 1)
+                Error(param->line, "Parameters cannot have default values");
+            ValueType type;
+            uint32_t type_id;
+            ResolveType(param->first_child, false, type, type_id);
+            signature.params.push_back(type);
+            signature.param_type_ids.push_back(type_id);
+        }
+        if (child->text == "main") {
+            if (!signature.params.empty())
+                Error(child->line, "main() takes no parameters");
+            program.main = static_cast<int32_t>(signature.index);
+        }
+        signatures_.emplace(child->text, std::move(signature));
+        functions.push_back(child);
+    }
+    if (functions.size() >= MAX_OPERAND)
+        Error(node->line, "Too many functions");
+    program.functions.resize(functions.size() + 1);
+
+    // Function 0 runs the top level statements, structs are already in the catalog
+    Signature script = {0, ValueType::kVOID, NO_TYPE, {}, {}};
+    signature_ = &script;
+    BeginFunction(0);
+    function_->name = "<script>";
+    // Bound values arrive like arguments, unnamed so only kPARAMETER nodes reach them
+    function_->params = static_cast<uint16_t>(parameters.size());
+    for (ValueType type : parameters)
+        locals_.push_back({std::string_view(), {NewRegister(node->line), type, NO_TYPE}, true});
+    for (const AstNode* child = node->first_child; child != nullptr; child = child->next_sibling) {
+        if (child->kind != AstKind::kSTRUCT_DECL && child->kind != AstKind::kFUNCTION)
+            CompileStatement(child);
+    }
+    EndFunction();
+
+    for (const AstNode* function : functions)
+        CompileFunction(function, signatures_.at(function->text));
+
+    signature_ = nullptr;
+    parameters_ = nullptr;
+    function_ = nullptr;
+    program_ = nullptr;
+    return program;
+}
+
+/**
+ * Functions
+ */
+void Compiler::CompileFunction(const AstNode* node, const Signature& signature) {
+    signature_ = &signature;
+    BeginFunction(signature.index);
+    function_->name = std::string(node->text);
+    function_->result = signature.result;
+    function_->params = static_cast<uint16_t>(signature.params.size());
+
+    const AstNode* child = node->first_child->next_sibling;
+    for (size_t i = 0; i < signature.params.size(); ++i, child = child->next_sibling) {
+        Operand param = {NewRegister(child->line), signature.params[i], signature.param_type_ids[i]};
+        DeclareLocal(child->text, param, (child->flags & kMOD_CONST) != 0, child->line);
+    }
+    CompileStatement(child);
+    if (signature.result != ValueType::kVOID)
+        Emit(Opcode::kNO_RETURN, 0, 0, 0, node->line);
+    EndFunction();
+}
+
+void Compiler::BeginFunction(uint32_t index) {
+    function_ = &program_->functions[index];
+    function_->result = ValueType::kVOID;
+    function_->params = 0;
+    function_->registers = 1;
+    locals_.clear();
+    next_reg_ = 0;
+}
+
+void Compiler::EndFunction() {
+    uint32_t line = function_->lines.empty() ? 1 : function_->lines.back();
+    Emit(Opcode::kRETURN, 0, 0, 0, line);
+}
+
+/**
+ * Statements
+ */
+void Compiler::CompileStatement(const AstNode* node) {
+    switch (node->kind) {
+        case AstKind::kBLOCK: {
+            size_t scope = locals_.size();
+            for (const AstNode* child = node->first_child; child != nullptr; child = child->next_sibling)
+                CompileStatement(child);
+            PopScope(scope);
+        } break;
+        case AstKind::kVAR_DECL: {
+            CompileVarDecl(node);
+        } break;
+        case AstKind::kASSIGN: {
+            CompileAssign(node);
+        } break;
+        case AstKind::kEXPR_STMT: {
+            CompileExpr(node->first_child);
+        } break;
+        case AstKind::kIF: {
+            CompileIf(node);
+        } break;
+        case AstKind::kWHILE: {
+            CompileWhile(node);
+        } break;
+        case AstKind::kFOR: {
+            CompileFor(node);
+        } break;
+        case AstKind::kRETURN: {
+            CompileReturn(node);
+        } break;
+        case AstKind::kEMPTY: {
+        } break;
+        default:
+            Error(node->line, std::string(AstKindName(node->kind)) + " statements are not supported by the VM");
+    }
+    // Temporaries die with their statement
+    next_reg_ = LocalTop();
+}
+
+void Compiler::CompileVarDecl(const AstNode* node) {
+    ValueType type;
+    uint32_t type_id;
+    ResolveType(node->first_child, false, type, type_id);
+    uint16_t reg = NewRegister(node->line);
+    Operand value = {reg, type, type_id};
+
+    // The local is declared after its initializer, which cannot see it
+    const AstNode* init = node->first_child->next_sibling;
+    if (init == nullptr) {
+        switch (type) {
+            case ValueType::kSTRING: {
+                Emit(Opcode::kLOAD_STR, reg, StringConstant("", node->line), 0, node->line);
+            } break;
+            case ValueType::kRECORD: {
+                Emit(Opcode::kNEW_REC, reg, static_cast<uint16_t>(type_id), 0, node->line);
+            } break;
+            default: {
+                // All zero bits are 0, 0.0 and false alike
+                Emit(Opcode::kLOAD_SMALL, reg, 0, 0, node->line);
+            }
+        }
+    } else if (init->kind == AstKind::kCONSTRUCT) {
+        if (type != ValueType::kRECORD)
+            Error(node->line, "Only structs have constructors");
+        CompileConstruct(type_id, init->first_child, reg, init->line);
+    } else {
+        Operand init_value = CompileInto(init, reg);
+        ConvertInPlace(init_value, type, type_id, node->line);
+    }
+    DeclareLocal(node->text, value, (node->flags & kMOD_CONST) != 0, node->line);
+}
+
+void Compiler::CompileAssign(const AstNode* node) {
+    const AstNode* target = node->first_child;
+    const AstNode* value = target->next_sibling;
+    bool compound = node->op != TokenType::kASSIGN;
+    TokenType op = CompoundOperator(node->op);
+    int16_t constant = 0;
+
+    if (target->kind == AstKind::kIDENTIFIER) {
+        const Local* local = FindLocal(target->text);
+        if (local == nullptr)
+            Error(node->line, "Unknown variable " + std::string(target->text));
+        if (local->is_const)
+            Error(node->line, std::string(target->text) + " is const");
+        Operand dst = local->value;
+        Operand result;
+        if (!compound) {
+            result = CompileInto(value, dst.reg);
+        } else if (dst.type == ValueType::kINT && (op == TokenType::kPLUS || op == TokenType::kMINUS) &&
+                   SmallIntLiteral(value, op == TokenType::kMINUS, constant)) {
+            Emit(Opcode::kADDK_I, dst.reg, dst.reg, static_cast<uint16_t>(constant), node->line);
+            result = dst;
+        } else {
+            result = EmitArithmetic(op, dst, CompileExpr(value), dst.reg, node->line);
+        }
+        ConvertInPlace(result, dst.type, dst.type_id, node->line);
+        return;
+    }
+
+    if (target->kind != AstKind::kMEMBER)
+        Error(node->line, "Only variables and members can be assigned by the VM");
+    Operand record;
+    uint16_t field = ResolveMember(target, record);
+    const FieldLayout& layout = program_->fields[field];
+    if (layout.modifiers & kMOD_CONST)
+        Error(node->line, layout.name + " is const");
+    Operand result;
+    if (!compound) {
+        result = CompileExpr(value);
+    } else {
+        Operand current = EmitGet(record.reg, field, NewRegister(node->line), node->line);
+        if (current.type == ValueType::kINT && (op == TokenType::kPLUS || op == TokenType::kMINUS) &&
+            SmallIntLiteral(value, op == TokenType::kMINUS, constant)) {
+            Emit(Opcode::kADDK_I, current.reg, current.reg, static_cast<uint16_t>(constant), node->line);
+            result = current;
+        } else {
+            result = EmitArithmetic(op, current, CompileExpr(value), current.reg, node->line);
+        }
+    }
+    EmitSet(record.reg, field, result, node->line);
+}
+
+void Compiler::CompileIf(const AstNode* node) {
+    const AstNode* condition = node->first_child;
+    std::vector<size_t> jumps;
+    CompileCondition(condition, false, jumps);
+    CompileStatement(condition->next_sibling);
+    const AstNode* otherwise = condition->next_sibling->next_sibling;
+    if (otherwise == nullptr) {
+        PatchHere(jumps);
+        return;
+    }
+    size_t skip = EmitJump(Opcode::kJUMP, 0, 0, node->line);
+    PatchHere(jumps);
+    CompileStatement(otherwise);
+    Patch(skip, function_->code.size());
+}
+
+void Compiler::CompileWhile(const AstNode* node) {
+    // The condition goes after the body so each iteration takes one branch
+    const AstNode* condition = node->first_child;
+    size_t entry = EmitJump(Opcode::kJUMP, 0, 0, node->line);
+    size_t body = function_->code.size();
+    CompileStatement(condition->next_sibling);
+    Patch(entry, function_->code.size());
+    std::vector<size_t> jumps;
+    CompileCondition(condition, true, jumps);
+    for (size_t jump : jumps)
+        Patch(jump, body);
+}
+
+void Compiler::CompileFor(const AstNode* node) {
+    const AstNode* init = node->first_child;
+    const AstNode* condition = init->next_sibling;
+    const AstNode* step = condition->next_sibling;
+    size_t scope = locals_.size();
+    CompileStatement(init);
+    size_t entry = EmitJump(Opcode::kJUMP, 0, 0, node->line);
+    size_t body = function_->code.size();
+    CompileStatement(step->next_sibling);
+    CompileStatement(step);
+    Patch(entry, function_->code.size());
+    std::vector<size_t> jumps;
+    if (condition->kind == AstKind::kEMPTY)
+        jumps.push_back(EmitJump(Opcode::kJUMP, 0, 0, node->line));
+    else
+        CompileCondition(condition, true, jumps);
+    for (size_t jump : jumps)
+        Patch(jump, body);
+    PopScope(scope);
+}
+
+void Compiler::CompileReturn(const AstNode* node) {
+    const AstNode* value = node->first_child;
+    if (value == nullptr) {
+        if (signature_->result != ValueType::kVOID)
+            Error(node->line, function_->name + "() must return a value");
+    } else {
+        if (signature_->result == ValueType::kVOID)
+            Error(node->line, function_->name + "() returns no value");
+        // The result goes to register 0, which is the caller's register the call was made with
+        Operand result = CompileInto(value, 0);
+        ConvertInPlace(result, signature_->result, signature_->result_type_id, node->line);
+    }
+    Emit(Opcode::kRETURN, 0, 0, 0, node->line);
+}
+
+void Compiler::CompileCondition(const AstNode* node, bool jump_when, std::vector<size_t>& jumps) {
+    if (node->kind == AstKind::kBINARY && (node->op == TokenType::kBOOL_AND || node->op == TokenType::kBOOL_OR)) {
+        // a && b jumps when false as soon as either is false, a || b jumps when true as soon as either is true,
+        // chains flattened by the Optimizer have more than two operands
+        bool short_circuit = node->op == TokenType::kBOOL_OR;
+        if (jump_when == short_circuit) {
+            for (const AstNode* operand = node->first_child; operand != nullptr; operand = operand->next_sibling)
+                CompileCondition(operand, jump_when, jumps);
+        } else {
+            std::vector<size_t> skip;
+            const AstNode* operand = node->first_child;
+            for (; operand->next_sibling != nullptr; operand = operand->next_sibling)
+                CompileCondition(operand, short_circuit, skip);
+            CompileCondition(operand, jump_when, jumps);
+            PatchHere(skip);
+        }
+        return;
+    }
+    if (node->kind == AstKind::kUNARY && node->op == TokenType::kNOT) {
+        CompileCondition(node->first_child, !jump_when, jumps);
+        return;
+    }
+    if (node->kind == AstKind::kBOOL) {
+        // Folded conditions branch unconditionally or not at all
+        if ((node->op == TokenType::kTRUE) == jump_when)
+            jumps.push_back(EmitJump(Opcode::kJUMP, 0, 0, node->line));
+        return;
+    }
+    if (node->kind == AstKind::kRANGE) {
+        // The target is evaluated once for both bounds
+        const AstNode* lower = node->Child(1);
+        const AstNode* upper = node->Child(2);
+        Operand target = CompileExpr(node->first_child);
+        TokenType lower_op = (node->flags & kAST_LOWER_INCLUSIVE) ? TokenType::kGTE : TokenType::kGT;
+        TokenType upper_op = (node->flags & kAST_UPPER_INCLUSIVE) ? TokenType::kLTE : TokenType::kLT;
+        if (jump_when) {
+            std::vector<size_t> skip;
+            if (lower->kind != AstKind::kEMPTY && upper->kind != AstKind::kEMPTY) {
+                CompileCompareJump(lower_op, target, lower, false, skip, node->line);
+                CompileCompareJump(upper_op, target, upper, true, jumps, node->line);
+            } else if (lower->kind != AstKind::kEMPTY) {
+                CompileCompareJump(lower_op, target, lower, true, jumps, node->line);
+            } else {
+                CompileCompareJump(upper_op, target, upper, true, jumps, node->line);
+            }
+            PatchHere(skip);
+        } else {
+            if (lower->kind != AstKind::kEMPTY)
+                CompileCompareJump(lower_op, target, lower, false, jumps, node->line);
+            if (upper->kind != AstKind::kEMPTY)
+                CompileCompareJump(upper_op, target, upper, false, jumps, node->line);
+        }
+        return;
+    }
+
+    Operand value;
+    if (node->kind == AstKind::kBINARY && IsComparison(node->op)) {
+        CompileCompareJump(node->op, CompileExpr(node->first_child), node->first_child->next_sibling, jump_when, jumps,
+                           node->line);
+        return;
+    }
+    value = CompileExpr(node);
+    if (value.type != ValueType::kBOOL && value.type != ValueType::kINT)
+        Error(node->line, "Conditions must be bool or integer, found " + TypeName(value.type, value.type_id));
+    jumps.push_back(EmitJump(jump_when ? Opcode::kJUMP_TRUE : Opcode::kJUMP_FALSE, value.reg, 0, node->line));
+}
+
+void Compiler::CompileCompareJump(TokenType op, Operand lhs, const AstNode* rhs_node, bool jump_when,
+                                  std::vector<size_t>& jumps, uint32_t line) {
+    TokenType jump_op = jump_when ? op : NegateComparison(op);
+    int16_t constant = 0;
+    // Loop bounds like i < 100 compare against an immediate instead of reloading it every iteration
+    if (lhs.type == ValueType::kINT && SmallIntLiteral(rhs_node, false, constant)) {
+        Opcode code;
+        switch (jump_op) {
+            case TokenType::kEQUALITY: code = Opcode::kJUMP_EQ_K; break;
+            case TokenType::kDNE: code = Opcode::kJUMP_NE_K; break;
+            case TokenType::kLT: code = Opcode::kJUMP_LT_K; break;
+            case TokenType::kLTE: code = Opcode::kJUMP_LE_K; break;
+            case TokenType::kGT: code = Opcode::kJUMP_GT_K; break;
+            default: code = Opcode::kJUMP_GE_K; break;
+        }
+        jumps.push_back(EmitJump(code, lhs.reg, static_cast<uint16_t>(constant), line));
+        return;
+    }
+    Operand rhs = CompileExpr(rhs_node);
+    // Integers and bools compare and branch in one instruction
+    bool equality = op == TokenType::kEQUALITY || op == TokenType::kDNE;
+    if ((lhs.type == ValueType::kINT && rhs.type == ValueType::kINT) ||
+        (lhs.type == ValueType::kBOOL && rhs.type == ValueType::kBOOL && equality)) {
+        switch (jump_op) {
+            case TokenType::kEQUALITY: jumps.push_back(EmitJump(Opcode::kJUMP_EQ_I, lhs.reg, rhs.reg, line)); break;
+            case TokenType::kDNE: jumps.push_back(EmitJump(Opcode::kJUMP_NE_I, lhs.reg, rhs.reg, line)); break;
+            case TokenType::kLT: jumps.push_back(EmitJump(Opcode::kJUMP_LT_I, lhs.reg, rhs.reg, line)); break;
+            case TokenType::kLTE: jumps.push_back(EmitJump(Opcode::kJUMP_LE_I, lhs.reg, rhs.reg, line)); break;
+            case TokenType::kGT: jumps.push_back(EmitJump(Opcode::kJUMP_LT_I, rhs.reg, lhs.reg, line)); break;
+            default: jumps.push_back(EmitJump(Opcode::kJUMP_LE_I, rhs.reg, lhs.reg, line)); break;
+        }
+        return;
+    }
+    // Reals are not negated, !(a < b) differs from a >= b for NaN
+    Operand value = EmitCompare(op, lhs, rhs, NewRegister(line), line);
+    jumps.push_back(EmitJump(jump_when ? Opcode::kJUMP_TRUE : Opcode::kJUMP_FALSE, value.reg, 0, line));
+}
+
+/**
+ * Expressions
+ */
+Compiler::Operand Compiler::CompileExpr(const AstNode* node) {
+    if (node->kind == AstKind::kIDENTIFIER) {
+        const Local* local = FindLocal(node->text);
+        if (local != nullptr)
+            return local->value;
+    } else if (node->kind == AstKind::kPARAMETER) {
+        return Parameter(node);
+    }
+    return CompileInto(node, NewRegister(node->line));
+}
+
+Compiler::Operand Compiler::CompileInto(const AstNode* node, uint16_t dst) {
+    switch (node->kind) {
+        case AstKind::kIDENTIFIER: {
+            const Local* local = FindLocal(node->text);
+            if (local == nullptr)
+                Error(node->line, "Unknown variable " + std::string(node->text));
+            Move(local->value, dst, node->line);
+            return {dst, local->value.type, local->value.type_id};
+        }
+        case AstKind::kINTEGER:
+        case AstKind::kREAL:
+        case AstKind::kSTRING:
+        case AstKind::kBOOL:
+            return CompileLiteral(node, false, dst);
+        case AstKind::kPARAMETER: {
+            Operand param = Parameter(node);
+            Move(param, dst, node->line);
+            return {dst, param.type, param.type_id};
+        }
+        case AstKind::kBINARY:
+            return CompileBinary(node, dst);
+        case AstKind::kRANGE:
+            return CompileBoolean(node, dst);
+        case AstKind::kUNARY:
+            return CompileUnary(node, dst);
+        case AstKind::kCALL:
+            return CompileCall(node, dst);
+        case AstKind::kMEMBER: {
+            Operand record;
+            uint16_t field = ResolveMember(node, record);
+            return EmitGet(record.reg, field, dst, node->line);
+        }
+        default:
+            Error(node->line, std::string(AstKindName(node->kind)) + " expressions are not supported by the VM");
+    }
+}
+
+Compiler::Operand Compiler::CompileBinary(const AstNode* node, uint16_t dst) {
+    const AstNode* lhs = node->first_child;
+    const AstNode* rhs = lhs->next_sibling;
+    if (node->op == TokenType::kBOOL_AND || node->op == TokenType::kBOOL_OR)
+        return CompileBoolean(node, dst);
+    if (IsComparison(node->op)) {
+        Operand lhs_value = CompileExpr(lhs);
+        return EmitCompare(node->op, lhs_value, CompileExpr(rhs), dst, node->line);
+    }
+
+    Operand lhs_value = CompileExpr(lhs);
+    int16_t constant = 0;
+    if (lhs_value.type == ValueType::kINT && (node->op == TokenType::kPLUS || node->op == TokenType::kMINUS) &&
+        SmallIntLiteral(rhs, node->op == TokenType::kMINUS, constant)) {
+        Emit(Opcode::kADDK_I, dst, lhs_value.reg, static_cast<uint16_t>(constant), node->line);
+        return {dst, ValueType::kINT, NO_TYPE};
+    }
+    return EmitArithmetic(node->op, lhs_value, CompileExpr(rhs), dst, node->line);
+}
+
+Compiler::Operand Compiler::CompileBoolean(const AstNode* node, uint16_t dst) {
+    // Branches decide the value, dst is written on either path only after every operand
+    std::vector<size_t> jumps;
+    CompileCondition(node, false, jumps);
+    Emit(Opcode::kLOAD_SMALL, dst, 1, 0, node->line);
+    size_t skip = EmitJump(Opcode::kJUMP, 0, 0, node->line);
+    PatchHere(jumps);
+    Emit(Opcode::kLOAD_SMALL, dst, 0, 0, node->line);
+    Patch(skip, function_->code.size());
+    return {dst, ValueType::kBOOL, NO_TYPE};
+}
+
+Compiler::Operand Compiler::EmitArithmetic(TokenType op, Operand lhs, Operand rhs, uint16_t dst, uint32_t line) {
+    if (op == TokenType::kPLUS && lhs.type == ValueType::kSTRING && rhs.type == ValueType::kSTRING) {
+        Emit(Opcode::kCONCAT, dst, lhs.reg, rhs.reg, line);
+        return {dst, ValueType::kSTRING, NO_TYPE};
+    }
+    if (!IsNumeric(lhs.type) || !IsNumeric(rhs.type))
+        Error(line, std::string("Cannot apply ") + TokenTypeName(op) + " to " + TypeName(lhs.type, lhs.type_id) + " and " +
+                    TypeName(rhs.type, rhs.type_id));
+
+    if (lhs.type == ValueType::kINT && rhs.type == ValueType::kINT) {
+        Opcode code;
+        switch (op) {
+            case TokenType::kPLUS: code = Opcode::kADD_I; break;
+            case TokenType::kMINUS: code = Opcode::kSUB_I; break;
+            case TokenType::kASTERISK: code = Opcode::kMUL_I; break;
+            case TokenType::kDIVIDE: code = Opcode::kDIV_I; break;
+            default: code = Opcode::kMOD_I; break;
+        }
+        Emit(code, dst, lhs.reg, rhs.reg, line);
+        return {dst, ValueType::kINT, NO_TYPE};
+    }
+
+    if (op == TokenType::kMODULO)
+        Error(line, "% only applies to integers");
+    lhs = Coerce(lhs, ValueType::kREAL, NO_TYPE, line);
+    rhs = Coerce(rhs, ValueType::kREAL, NO_TYPE, line);
+    Opcode code;
+    switch (op) {
+        case TokenType::kPLUS: code = Opcode::kADD_R; break;
+        case TokenType::kMINUS: code = Opcode::kSUB_R; break;
+        case TokenType::kASTERISK: code = Opcode::kMUL_R; break;
+        default: code = Opcode::kDIV_R; break;
+    }
+    Emit(code, dst, lhs.reg, rhs.reg, line);
+    return {dst, ValueType::kREAL, NO_TYPE};
+}
+
+Compiler::Operand Compiler::EmitCompare(TokenType op, Operand lhs, Operand rhs, uint16_t dst, uint32_t line) {
+    // Integer and bool opcodes are shared, bools hold 0 or 1
+    Opcode eq = Opcode::kEQ_I;
+    if (IsNumeric(lhs.type) && IsNumeric(rhs.type)) {
+        if (lhs.type == ValueType::kREAL || rhs.type == ValueType::kREAL) {
+            lhs = Coerce(lhs, ValueType::kREAL, NO_TYPE, line);
+            rhs = Coerce(rhs, ValueType::kREAL, NO_TYPE, line);
+            eq = Opcode::kEQ_R;
+        }
+    } else if (lhs.type == ValueType::kSTRING && rhs.type == ValueType::kSTRING) {
+        eq = Opcode::kEQ_S;
+    } else if (!(lhs.type == ValueType::kBOOL && rhs.type == ValueType::kBOOL &&
+                 (op == TokenType::kEQUALITY || op == TokenType::kDNE))) {
+        Error(line, std::string("Cannot apply ") + TokenTypeName(op) + " to " + TypeName(lhs.type, lhs.type_id) + " and " +
+                    TypeName(rhs.type, rhs.type_id));
+    }
+
+    // Each family is EQ, NE, LT, LE in order, > and >= swap the operands
+    uint8_t base = static_cast<uint8_t>(eq);
+    switch (op) {
+        case TokenType::kEQUALITY: Emit(static_cast<Opcode>(base), dst, lhs.reg, rhs.reg, line); break;
+        case TokenType::kDNE: Emit(static_cast<Opcode>(base + 1), dst, lhs.reg, rhs.reg, line); break;
+        case TokenType::kLT: Emit(static_cast<Opcode>(base + 2), dst, lhs.reg, rhs.reg, line); break;
+        case TokenType::kLTE: Emit(static_cast<Opcode>(base + 3), dst, lhs.reg, rhs.reg, line); break;
+        case TokenType::kGT: Emit(static_cast<Opcode>(base + 2), dst, rhs.reg, lhs.reg, line); break;
+        default: Emit(static_cast<Opcode>(base + 3), dst, rhs.reg, lhs.reg, line); break;
+    }
+    return {dst, ValueType::kBOOL, NO_TYPE};
+}
+
+Compiler::Operand Compiler::CompileUnary(const AstNode* node, uint16_t dst) {
+    // Negative literals load as one constant
+    AstKind operand = node->first_child->kind;
+    if (node->op == TokenType::kMINUS && (operand == AstKind::kINTEGER || operand == AstKind::kREAL))
+        return CompileLiteral(node->first_child, true, dst);
+    Operand value = CompileExpr(node->first_child);
+    switch (node->op) {
+        case TokenType::kNOT: {
+            if (value.type != ValueType::kBOOL && value.type != ValueType::kINT)
+                Error(node->line, "Cannot apply ! to " + TypeName(value.type, value.type_id));
+            Emit(Opcode::kNOT, dst, value.reg, 0, node->line);
+            return {dst, ValueType::kBOOL, NO_TYPE};
+        }
+        case TokenType::kMINUS: {
+            if (!IsNumeric(value.type))
+                Error(node->line, "Cannot negate " + TypeName(value.type, value.type_id));
+            Emit((value.type == ValueType::kINT) ? Opcode::kNEG_I : Opcode::kNEG_R, dst, value.reg, 0, node->line);
+            return {dst, value.type, NO_TYPE};
+        }
+        default: {
+            if (!IsNumeric(value.type))
+                Error(node->line, "Cannot apply + to " + TypeName(value.type, value.type_id));
+            Move(value, dst, node->line);
+            return {dst, value.type, NO_TYPE};
+        }
+    }
+}
+
+Compiler::Operand Compiler::CompileCall(const AstNode* node, uint16_t dst) {
+    const AstNode* callee = node->first_child;
+    if (callee->kind != AstKind::kIDENTIFIER)
+        Error(node->line, "Method calls are not supported by the VM");
+    if (callee->text == "print") {
+        CompilePrint(node);
+        return {dst, ValueType::kVOID, NO_TYPE};
+    }
+    const RecordLayout* layout = catalog_->Find(callee->text);
+    if (layout != nullptr)
+        return CompileConstruct(layout->TypeId(), callee->next_sibling, dst, node->line);
+
+    auto it = signatures_.find(callee->text);
+    if (it == signatures_.end())
+        Error(node->line, "Unknown function " + std::string(callee->text));
+    const Signature& signature = it->second;
+    if (node->child_count - 1 != signature.params.size())
+        Error(node->line, std::string(callee->text) + "() takes " + std::to_string(signature.params.size()) + " arguments");
+
+    // Arguments go to consecutive registers that become the callee's first registers, starting at dst
+    // when it is the newest temporary so the result needs no move
+    uint16_t base = (dst + 1 == next_reg_ && dst >= LocalTop()) ? dst : next_reg_;
+    while (next_reg_ < base + std::max<size_t>(signature.params.size(), 1))
+        NewRegister(node->line);
+    uint16_t reg = base;
+    for (const AstNode* arg = callee->next_sibling; arg != nullptr; arg = arg->next_sibling, ++reg) {
+        if (!arg->text.empty())
+            Error(arg->line, "Only constructors take named arguments");
+        Operand value = CompileInto(arg->first_child, reg);
+        ConvertInPlace(value, signature.params[reg - base], signature.param_type_ids[reg - base], arg->line);
+    }
+    Emit(Opcode::kCALL, base, static_cast<uint16_t>(signature.index), 0, node->line);
+    if (signature.result == ValueType::kVOID)
+        return {dst, ValueType::kVOID, NO_TYPE};
+    Operand result = {base, signature.result, signature.result_type_id};
+    Move(result, dst, node->line);
+    return {dst, signature.result, signature.result_type_id};
+}
+
+void Compiler::CompilePrint(const AstNode* node) {
+    for (const AstNode* arg = node->first_child->next_sibling; arg != nullptr; arg = arg->next_sibling) {
+        if (!arg->text.empty())
+            Error(arg->line, "Only constructors take named arguments");
+        if (arg != node->first_child->next_sibling)
+            Emit(Opcode::kPRINT_SPACE, 0, 0, 0, arg->line);
+        Operand value = CompileExpr(arg->first_child);
+        switch (value.type) {
+            case ValueType::kINT: Emit(Opcode::kPRINT_I, value.reg, 0, 0, arg->line); break;
+            case ValueType::kREAL: Emit(Opcode::kPRINT_R, value.reg, 0, 0, arg->line); break;
+            case ValueType::kBOOL: Emit(Opcode::kPRINT_B, value.reg, 0, 0, arg->line); break;
+            case ValueType::kSTRING: Emit(Opcode::kPRINT_S, value.reg, 0, 0, arg->line); break;
+            default: Error(arg->line, "Cannot print " + TypeName(value.type, value.type_id));
+        }
+    }
+    Emit(Opcode::kPRINT_LINE, 0, 0, 0, node->line);
+}
+
+Compiler::Operand Compiler::CompileConstruct(uint32_t type_id, const AstNode* first_arg, uint16_t dst, uint32_t line) {
+    // Build aside when dst is a local, so the arguments still read its old value
+    if (type_id > MAX_OPERAND)
+        Error(line, "Too many structs");
+    uint16_t target = (dst >= LocalTop()) ? dst : NewRegister(line);
+    const RecordLayout& layout = catalog_->Get(type_id);
+    Emit(Opcode::kNEW_REC, target, static_cast<uint16_t>(type_id), 0, line);
+    for (const AstNode* arg = first_arg; arg != nullptr; arg = arg->next_sibling) {
+        if (arg->text.empty())
+            Error(arg->line, "Constructor arguments are named, like " + layout.Name() + "(member=value)");
+        if (layout.FieldIndex(arg->text) < 0)
+            Error(arg->line, layout.Name() + " has no member " + std::string(arg->text));
+        uint16_t field = FieldConstant(type_id, std::string(arg->text), arg->line);
+        EmitSet(target, field, CompileExpr(arg->first_child), arg->line);
+    }
+    Operand record = {target, ValueType::kRECORD, type_id};
+    Move(record, dst, line);
+    return {dst, ValueType::kRECORD, type_id};
+}
+
+Compiler::Operand Compiler::CompileLiteral(const AstNode* node, bool negate, uint16_t dst) {
+    switch (node->kind) {
+        case AstKind::kINTEGER: {
+            int16_t small;
+            if (SmallIntLiteral(node, negate, small)) {
+                Emit(Opcode::kLOAD_SMALL, dst, static_cast<uint16_t>(small), 0, node->line);
+            } else {
+                std::string digits(node->text);
+                errno = 0;
+                unsigned long long magnitude = strtoull(digits.c_str(), nullptr, 10);
+                // -9223372036854775808 is only reachable negated
+                if (errno == ERANGE || magnitude > static_cast<unsigned long long>(INT64_MAX) + (negate ? 1 : 0))
+                    Error(node->line, "Integer " + digits + " does not fit in 64 bits");
+                int64_t value = static_cast<int64_t>(negate ? 0 - magnitude : magnitude);
+                Emit(Opcode::kLOAD_INT, dst, IntegerConstant(value, node->line), 0, node->line);
+            }
+            return {dst, ValueType::kINT, NO_TYPE};
+        }
+        case AstKind::kREAL: {
+            std::string digits(node->text);
+            double value = strtod(digits.c_str(), nullptr);
+            Emit(Opcode::kLOAD_REAL, dst, RealConstant(negate ? -value : value, node->line), 0, node->line);
+            return {dst, ValueType::kREAL, NO_TYPE};
+        }
+        case AstKind::kSTRING: {
+            Emit(Opcode::kLOAD_STR, dst, StringConstant(node->text, node->line), 0, node->line);
+            return {dst, ValueType::kSTRING, NO_TYPE};
+        }
+        default: {
+            Emit(Opcode::kLOAD_SMALL, dst, (node->op == TokenType::kTRUE) ? 1 : 0, 0, node->line);
+            return {dst, ValueType::kBOOL, NO_TYPE};
+        }
+    }
+}
+
+Compiler::Operand Compiler::Parameter(const AstNode* node) const {
+    if (signature_->index != 0)
+        Error(node->line, "Parameters can only be used by top level statements");
+    if (node->flags >= parameters_->size())
+        Error(node->line, "Parameter " + std::to_string(node->flags + 1) + " has no type");
+    return locals_[node->flags].value;
+}
+
+uint16_t Compiler::ResolveMember(const AstNode* node, Operand& record) {
+    uint32_t line = node->line;
+    std::string path;
+    while (node->kind == AstKind::kMEMBER) {
+        path = path.empty() ? std::string(node->text) : std::string(node->text) + "." + path;
+        node = node->first_child;
+    }
+    const Local* local = (node->kind == AstKind::kIDENTIFIER) ? FindLocal(node->text) : nullptr;
+    if (local == nullptr || local->value.type != ValueType::kRECORD)
+        Error(line, "Members are only supported on struct variables");
+    record = local->value;
+    return FieldConstant(record.type_id, path, line);
+}
+
+uint16_t Compiler::FieldConstant(uint32_t type_id, const std::string& path, uint32_t line) {
+    std::string key = std::to_string(type_id) + ":" + path;
+    auto it = field_index_.find(key);
+    if (it != field_index_.end())
+        return it->second;
+    if (program_->fields.size() >= MAX_OPERAND)
+        Error(line, "Too many fields");
+    try {
+        program_->fields.push_back(catalog_->Resolve(type_id, path));
+    } catch (const SchemaException& e) {
+        Error(line, e.what());
+    }
+    uint16_t index = static_cast<uint16_t>(program_->fields.size() - 1);
+    field_index_.emplace(std::move(key), index);
+    return index;
+}
+
+Compiler::Operand Compiler::EmitGet(uint16_t record, uint16_t field, uint16_t dst, uint32_t line) {
+    const FieldLayout& layout = program_->fields[field];
+    ValueType type = FieldValueType(layout);
+    switch (type) {
+        case ValueType::kINT:
+        case ValueType::kBOOL: Emit(Opcode::kGET_I, dst, record, field, line); break;
+        case ValueType::kREAL: Emit(Opcode::kGET_R, dst, record, field, line); break;
+        case ValueType::kSTRING: Emit(Opcode::kGET_S, dst, record, field, line); break;
+        default: Error(line, layout.name + " cannot be read by the VM");
+    }
+    return {dst, type, NO_TYPE};
+}
+
+void Compiler::EmitSet(uint16_t record, uint16_t field, Operand value, uint32_t line) {
+    const FieldLayout& layout = program_->fields[field];
+    ValueType type = FieldValueType(layout);
+    if (type == ValueType::kVOID)
+        Error(line, layout.name + " cannot be written by the VM");
+    value = Coerce(value, type, NO_TYPE, line);
+    switch (type) {
+        case ValueType::kINT: Emit(Opcode::kSET_I, record, field, value.reg, line); break;
+        case ValueType::kBOOL: Emit(Opcode::kSET_B, record, field, value.reg, line); break;
+        case ValueType::kREAL: Emit(Opcode::kSET_R, record, field, value.reg, line); break;
+        default: Emit(Opcode::kSET_S, record, field, value.reg, line); break;
+    }
+}
+
+/**
+ * Types
+ */
+void Compiler::ResolveType(const AstNode* type, bool allow_void, ValueType& value_type, uint32_t& type_id) const {
+    type_id = NO_TYPE;
+    if (type->kind == AstKind::kEMPTY) {
+        value_type = ValueType::kVOID;
+        return;
+    }
+    if (type->flags & (kAST_POINTER_MASK | kAST_ARRAY))
+        Error(type->line, "Arrays and pointers are not supported by the VM");
+    switch (type->op) {
+        case TokenType::kBYTE:
+        case TokenType::kSHORT:
+        case TokenType::kINT:
+        case TokenType::kLONG: value_type = ValueType::kINT; return;
+        case TokenType::kFLOAT:
+        case TokenType::kDOUBLE: value_type = ValueType::kREAL; return;
+        case TokenType::kBOOL: value_type = ValueType::kBOOL; return;
+        case TokenType::kSTRING: value_type = ValueType::kSTRING; return;
+        default: break;
+    }
+    if (allow_void && type->text == "void") {
+        value_type = ValueType::kVOID;
+        return;
+    }
+    const RecordLayout* layout = catalog_->Find(type->text);
+    if (layout == nullptr)
+        Error(type->line, "Unknown type " + std::string(type->text));
+    value_type = ValueType::kRECORD;
+    type_id = layout->TypeId();
+}
+
+ValueType Compiler::FieldValueType(const FieldLayout& field) noexcept {
+    if (field.is_array)
+        return ValueType::kVOID;
+    switch (field.type) {
+        case FieldType::kBYTE:
+        case FieldType::kSHORT:
+        case FieldType::kINT:
+        case FieldType::kLONG: return ValueType::kINT;
+        case FieldType::kFLOAT:
+        case FieldType::kDOUBLE: return ValueType::kREAL;
+        case FieldType::kBOOL: return ValueType::kBOOL;
+        case FieldType::kSTRING: return ValueType::kSTRING;
+        default: return ValueType::kVOID;
+    }
+}
+
+std::string Compiler::TypeName(ValueType type, uint32_t type_id) const {
+    switch (type) {
+        case ValueType::kVOID: return "void";
+        case ValueType::kINT: return "integer";
+        case ValueType::kREAL: return "real";
+        case ValueType::kBOOL: return "bool";
+        case ValueType::kSTRING: return "string";
+        default: return catalog_->Get(type_id).Name();
+    }
+}
+
+void Compiler::ConvertInPlace(Operand& value, ValueType type, uint32_t type_id, uint32_t line) {
+    if (value.type == type) {
+        // Layouts are prefix compatible, so a subclass record reads fine through its base
+        if (type != ValueType::kRECORD || catalog_->IsA(value.type_id, type_id)) {
+            value.type_id = type_id;
+            return;
+        }
+    } else if (value.type == ValueType::kINT && type == ValueType::kREAL) {
+        Emit(Opcode::kI2R, value.reg, value.reg, 0, line);
+        value.type = type;
+        return;
+    } else if (value.type == ValueType::kREAL && type == ValueType::kINT) {
+        Emit(Opcode::kR2I, value.reg, value.reg, 0, line);
+        value.type = type;
+        return;
+    } else if (value.type == ValueType::kBOOL && type == ValueType::kINT) {
+        value.type = type;
+        return;
+    }
+    Error(line, "Cannot convert " + TypeName(value.type, value.type_id) + " to " + TypeName(type, type_id));
+}
+
+Compiler::Operand Compiler::Coerce(Operand value, ValueType type, uint32_t type_id, uint32_t line) {
+    if ((value.type == ValueType::kINT && type == ValueType::kREAL) ||
+        (value.type == ValueType::kREAL && type == ValueType::kINT)) {
+        uint16_t reg = NewRegister(line);
+        Emit((type == ValueType::kREAL) ? Opcode::kI2R : Opcode::kR2I, reg, value.reg, 0, line);
+        return {reg, type, NO_TYPE};
+    }
+    ConvertInPlace(value, type, type_id, line);
+    return value;
+}
+
+void Compiler::Move(Operand value, uint16_t dst, uint32_t line) {
+    if (value.type == ValueType::kVOID)
+        Error(line, "The expression has no value");
+    if (value.reg == dst)
+        return;
+    switch (value.type) {
+        case ValueType::kSTRING: Emit(Opcode::kMOVE_STR, dst, value.reg, 0, line); break;
+        case ValueType::kRECORD: Emit(Opcode::kMOVE_REC, dst, value.reg, 0, line); break;
+        default: Emit(Opcode::kMOVE, dst, value.reg, 0, line); break;
+    }
+}
+
+/**
+ * Registers and Scopes
+ */
+uint16_t Compiler::NewRegister(uint32_t line) {
+    if (next_reg_ == MAX_OPERAND)
+        Error(line, "Too many registers in " + function_->name);
+    uint16_t reg = next_reg_++;
+    if (next_reg_ > function_->registers)
+        function_->registers = next_reg_;
+    return reg;
+}
+
+uint16_t Compiler::LocalTop() const noexcept {
+    return locals_.empty() ? 0 : static_cast<uint16_t>(locals_.back().value.reg + 1);
+}
+
+const Compiler::Local* Compiler::FindLocal(std::string_view name) const noexcept {
+    for (auto it = locals_.rbegin(); it != locals_.rend(); ++it) {
+        if (it->name == name)
+            return &*it;
+    }
+    return nullptr;
+}
+
+void Compiler::DeclareLocal(std::string_view name, Operand value, bool is_const, uint32_t line) {
+    if (FindLocal(name) != nullptr)
+        Error(line, std::string(name) + " is already declared");
+    locals_.push_back({name, value, is_const});
+}
+
+void Compiler::PopScope(size_t locals) {
+    locals_.resize(locals);
+    next_reg_ = LocalTop();
+}
+
+/**
+ * Emission
+ */
+size_t Compiler::Emit(Opcode op, uint16_t a, uint16_t b, uint16_t c, uint32_t line) {
+    // Jump targets are 16 bit instruction indexes
+    if (function_->code.size() >= MAX_OPERAND)
+        Error(line, function_->name + " is too large");
+    function_->code.push_back({op, a, b, c});
+    function_->lines.push_back(line);
+    return function_->code.size() - 1;
+}
+
+size_t Compiler::EmitJump(Opcode op, uint16_t a, uint16_t b, uint32_t line) {
+    return Emit(op, a, b, 0, line);
+}
+
+void Compiler::PatchHere(const std::vector<size_t>& jumps) {
+    for (size_t jump : jumps)
+        Patch(jump, function_->code.size());
+}
+
+void Compiler::Patch(size_t jump, size_t target) {
+    function_->code[jump].c = static_cast<uint16_t>(target);
+}
+
+uint16_t Compiler::IntegerConstant(int64_t value, uint32_t line) {
+    auto it = integer_index_.find(value);
+    if (it != integer_index_.end())
+        return it->second;
+    if (program_->integers.size() >= MAX_OPERAND)
+        Error(line, "Too many integer constants");
+    program_->integers.push_back(value);
+    return integer_index_[value] = static_cast<uint16_t>(program_->integers.size() - 1);
+}
+
+uint16_t Compiler::RealConstant(double value, uint32_t line) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    auto it = real_index_.find(bits);
+    if (it != real_index_.end())
+        return it->second;
+    if (program_->reals.size() >= MAX_OPERAND)
+        Error(line, "Too many real constants");
+    program_->reals.push_back(value);
+    return real_index_[bits] = static_cast<uint16_t>(program_->reals.size() - 1);
+}
+
+uint16_t Compiler::StringConstant(std::string_view value, uint32_t line) {
+    std::string key(value);
+    auto it = string_index_.find(key);
+    if (it != string_index_.end())
+        return it->second;
+    if (program_->strings.size() >= MAX_OPERAND)
+        Error(line, "Too many string constants");
+    program_->strings.push_back(key);
+    return string_index_[key] = static_cast<uint16_t>(program_->strings.size() - 1);
+}
+
+void Compiler::Error(uint32_t line, const std::string& msg) {
+    throw VmException("Line " + std::to_string(line) + ": " + msg);
+}
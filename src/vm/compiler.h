@@ -0,0 +1,205 @@
+#ifndef DT_SRC_VM_COMPILER_H
+#define DT_SRC_VM_COMPILER_H
+
+// C++ Includes
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Local Includes
+#include "parser/ast.h"
+#include "schema/catalog.h"
+#include "vm/bytecode.h"
+
+/**
+ * @brief Compiles a parsed program into register bytecode for the Vm
+ *
+ * Types are static: every local and temporary gets a register of a known
+ * type when it is declared, so the compiler emits typed opcodes and the VM
+ * never checks a tag. Locals live in fixed registers for their scope and
+ * expression temporaries are stacked above them and released after each
+ * statement. Functions see their parameters and locals, the top level
+ * statements run as function 0 before main().
+ *
+ * Records are struct typed locals built from the catalog's layouts, member
+ * access compiles to a pre-resolved field so it costs an offset add.
+ * Arrays, pointers, new, delete and trunk methods are left to the engine
+ * and rejected here.
+ */
+class Compiler {
+public:
+    /**
+     * Tors
+     */
+    Compiler() noexcept;
+    ~Compiler() noexcept;
+
+    /**
+     * NON-COPYABLE
+     */
+    Compiler(const Compiler&) = delete;
+    Compiler(Compiler&&) = delete;
+    Compiler& operator=(const Compiler&) = delete;
+
+    /**
+     * @brief Compile a kPROGRAM node
+     * @param catalog Layouts of the program's structs, already compiled by SchemaCatalog::AddProgram()
+     * @throws VmException on the first error, with its line number
+     */
+    Program Compile(const AstNode* program, const SchemaCatalog& catalog);
+
+    /**
+     * @brief Compile a prepared statement whose kPARAMETER nodes have the given types
+     * @param parameters Type of each parameter index, kINT, kREAL, kBOOL or kSTRING
+     * @throws VmException on the first error, with its line number
+     */
+    Program Compile(const AstNode* program, const SchemaCatalog& catalog, const std::vector<ValueType>& parameters);
+
+private:
+    /**
+     * @brief A register and the static type of what it holds
+     */
+    struct Operand {
+        uint16_t reg;
+        ValueType type;
+        uint32_t type_id;   // Layout of a kRECORD
+    };
+
+    struct Local {
+        std::string_view name;
+        Operand value;
+        bool is_const;
+    };
+
+    struct Signature {
+        uint32_t index;
+        ValueType result;
+        uint32_t result_type_id;
+        std::vector<ValueType> params;
+        std::vector<uint32_t> param_type_ids;
+    };
+
+    /**
+     * Functions
+     */
+    void CompileFunction(const AstNode* node, const Signature& signature);
+    void BeginFunction(uint32_t index);
+    void EndFunction();
+
+    /**
+     * Statements
+     */
+    void CompileStatement(const AstNode* node);
+    void CompileVarDecl(const AstNode* node);
+    void CompileAssign(const AstNode* node);
+    void CompileIf(const AstNode* node);
+    void CompileWhile(const AstNode* node);
+    void CompileFor(const AstNode* node);
+    void CompileReturn(const AstNode* node);
+
+    /**
+     * @brief Emit jumps taken when the condition equals jump_when, short circuiting && || and !
+     * @param jumps Collects the jumps to patch to the target
+     */
+    void CompileCondition(const AstNode* node, bool jump_when, std::vector<size_t>& jumps);
+
+    /**
+     * @brief Emit a jump taken when (lhs op rhs) equals jump_when
+     */
+    void CompileCompareJump(TokenType op, Operand lhs, const AstNode* rhs, bool jump_when, std::vector<size_t>& jumps,
+                            uint32_t line);
+
+    /**
+     * Expressions
+     */
+
+    /**
+     * @brief Evaluate node into some register, a local's own register when node names one
+     */
+    Operand CompileExpr(const AstNode* node);
+
+    /**
+     * @brief Evaluate node into dst, dst is only written once its operands are read
+     */
+    Operand CompileInto(const AstNode* node, uint16_t dst);
+    Operand CompileBinary(const AstNode* node, uint16_t dst);
+
+    /**
+     * @brief The value of a condition, && || chains and kRANGE
+     */
+    Operand CompileBoolean(const AstNode* node, uint16_t dst);
+    Operand EmitArithmetic(TokenType op, Operand lhs, Operand rhs, uint16_t dst, uint32_t line);
+    Operand CompileUnary(const AstNode* node, uint16_t dst);
+    Operand CompileCall(const AstNode* node, uint16_t dst);
+    void CompilePrint(const AstNode* node);
+    Operand CompileConstruct(uint32_t type_id, const AstNode* first_arg, uint16_t dst, uint32_t line);
+    Operand CompileLiteral(const AstNode* node, bool negate, uint16_t dst);
+    Operand Parameter(const AstNode* node) const;
+
+    /**
+     * @brief Resolve a member chain like s.address.city to its record local and field
+     * @return Index of the field in the program's field pool
+     */
+    uint16_t ResolveMember(const AstNode* node, Operand& record);
+    uint16_t FieldConstant(uint32_t type_id, const std::string& path, uint32_t line);
+    Operand EmitCompare(TokenType op, Operand lhs, Operand rhs, uint16_t dst, uint32_t line);
+    Operand EmitGet(uint16_t record, uint16_t field, uint16_t dst, uint32_t line);
+    void EmitSet(uint16_t record, uint16_t field, Operand value, uint32_t line);
+
+    /**
+     * Types
+     */
+    void ResolveType(const AstNode* type, bool allow_void, ValueType& value_type, uint32_t& type_id) const;
+    static ValueType FieldValueType(const FieldLayout& field) noexcept;
+    std::string TypeName(ValueType type, uint32_t type_id) const;
+
+    /**
+     * @brief Convert the value in reg to type, in place
+     */
+    void ConvertInPlace(Operand& value, ValueType type, uint32_t type_id, uint32_t line);
+
+    /**
+     * @brief The value as type, in a new temporary when it has to be converted
+     */
+    Operand Coerce(Operand value, ValueType type, uint32_t type_id, uint32_t line);
+    void Move(Operand value, uint16_t dst, uint32_t line);
+
+    /**
+     * Registers and Scopes
+     */
+    uint16_t NewRegister(uint32_t line);
+    uint16_t LocalTop() const noexcept;
+    const Local* FindLocal(std::string_view name) const noexcept;
+    void DeclareLocal(std::string_view name, Operand value, bool is_const, uint32_t line);
+    void PopScope(size_t locals);
+
+    /**
+     * Emission
+     */
+    size_t Emit(Opcode op, uint16_t a, uint16_t b, uint16_t c, uint32_t line);
+    size_t EmitJump(Opcode op, uint16_t a, uint16_t b, uint32_t line);
+    void PatchHere(const std::vector<size_t>& jumps);
+    void Patch(size_t jump, size_t target);
+    uint16_t IntegerConstant(int64_t value, uint32_t line);
+    uint16_t RealConstant(double value, uint32_t line);
+    uint16_t StringConstant(std::string_view value, uint32_t line);
+
+    [[noreturn]] static void Error(uint32_t line, const std::string& msg);
+
+    const SchemaCatalog* catalog_;
+    Program* program_;
+    Function* function_;
+    const Signature* signature_;
+    const std::vector<ValueType>* parameters_;
+    std::unordered_map<std::string_view, Signature> signatures_;
+    std::vector<Local> locals_;
+    uint16_t next_reg_;
+    std::unordered_map<int64_t, uint16_t> integer_index_;
+    std::unordered_map<uint64_t, uint16_t> real_index_;
+    std::unordered_map<std::string, uint16_t> string_index_;
+    std::unordered_map<std::string, uint16_t> field_index_;
+};
+
+#endif
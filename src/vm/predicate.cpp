@@ -0,0 +1,1518 @@
+// C++ Includes
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Local Includes
+#include "exception/schema_exception.h"
+#include "exception/vm_exception.h"
+#include "schema/record.h"
+#include "predicate.h"
+
+// Native predicates are System V x86-64 functions
+#if defined(__x86_64__) && !defined(DT_PREDICATE_NO_NATIVE)
+#define DT_PREDICATE_NATIVE
+#endif
+
+/**
+ * Integer arithmetic wraps like the VM's
+ */
+static inline int64_t WrapAdd(int64_t x, int64_t y) noexcept {
+    return static_cast<int64_t>(static_cast<uint64_t>(x) + static_cast<uint64_t>(y));
+}
+
+static inline int64_t WrapSub(int64_t x, int64_t y) noexcept {
+    return static_cast<int64_t>(static_cast<uint64_t>(x) - static_cast<uint64_t>(y));
+}
+
+static inline int64_t WrapMul(int64_t x, int64_t y) noexcept {
+    return static_cast<int64_t>(static_cast<uint64_t>(x) * static_cast<uint64_t>(y));
+}
+
+static bool IsNumeric(ValueType type) noexcept {
+    return type == ValueType::kINT || type == ValueType::kREAL;
+}
+
+static bool IsComparison(TokenType op) noexcept {
+    switch (op) {
+        case TokenType::kEQUALITY:
+        case TokenType::kDNE:
+        case TokenType::kLT:
+        case TokenType::kLTE:
+        case TokenType::kGT:
+        case TokenType::kGTE:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static TokenType NegateComparison(TokenType op) noexcept {
+    switch (op) {
+        case TokenType::kEQUALITY: return TokenType::kDNE;
+        case TokenType::kDNE: return TokenType::kEQUALITY;
+        case TokenType::kLT: return TokenType::kGTE;
+        case TokenType::kLTE: return TokenType::kGT;
+        case TokenType::kGT: return TokenType::kLTE;
+        default: return TokenType::kLT;
+    }
+}
+
+static const char* TypeName(ValueType type) noexcept {
+    switch (type) {
+        case ValueType::kINT: return "integer";
+        case ValueType::kREAL: return "real";
+        case ValueType::kBOOL: return "bool";
+        case ValueType::kSTRING: return "string";
+        default: return "void";
+    }
+}
+
+/**
+ * @brief The register type of a field, kVOID for what a predicate cannot read
+ */
+static ValueType FieldValueType(const FieldLayout& field) noexcept {
+    if (field.is_array)
+        return ValueType::kVOID;
+    switch (field.type) {
+        case FieldType::kBYTE:
+        case FieldType::kSHORT:
+        case FieldType::kINT:
+        case FieldType::kLONG: return ValueType::kINT;
+        case FieldType::kFLOAT:
+        case FieldType::kDOUBLE: return ValueType::kREAL;
+        case FieldType::kBOOL: return ValueType::kBOOL;
+        case FieldType::kSTRING: return ValueType::kSTRING;
+        default: return ValueType::kVOID;
+    }
+}
+
+/**
+ * @brief The null bit of a field, 0 when it can never be set in a finished record
+ */
+static uint8_t NullMask(const FieldLayout& field) noexcept {
+    return (field.modifiers & kMOD_NOTNULL) ? 0 : field.null_mask;
+}
+
+template <typename V>
+static bool Compare(TokenType op, const V& lhs, const V& rhs) noexcept {
+    switch (op) {
+        case TokenType::kEQUALITY: return lhs == rhs;
+        case TokenType::kDNE: return lhs != rhs;
+        case TokenType::kLT: return lhs < rhs;
+        case TokenType::kLTE: return lhs <= rhs;
+        case TokenType::kGT: return lhs > rhs;
+        default: return lhs >= rhs;
+    }
+}
+
+/**
+ * Closures
+ *
+ * Every node is a virtual call that already knows its field's offset and
+ * C++ type and its operator, so evaluating one does no dispatch of its own.
+ * The common leaves, a field against a constant and a field in a range, are
+ * single nodes.
+ */
+class PredicateClosure {
+public:
+    virtual ~PredicateClosure() noexcept {}
+    virtual bool Test(const uint8_t* record) const noexcept = 0;
+};
+
+/**
+ * @brief Reads a value of type V, int64_t, double or std::string_view, false when a field read is null
+ */
+template <typename V>
+class PredicateValue {
+public:
+    virtual ~PredicateValue() noexcept {}
+    virtual bool Read(const uint8_t* record, V& value) const noexcept = 0;
+};
+
+template <typename T>
+struct TypeTag {
+    using type = T;
+};
+
+/**
+ * @brief The member of a constant that holds its value as V
+ */
+template <typename V>
+static V ConstantOf(int64_t integer, double real) noexcept {
+    if constexpr (std::is_same<V, double>::value)
+        return real;
+    else
+        return integer;
+}
+
+/**
+ * @brief Call f with the TypeTag of the C++ type a numeric or bool field is stored as
+ */
+template <typename F>
+static auto WithFieldType(const FieldLayout& field, F&& f) {
+    switch (field.type) {
+        case FieldType::kBYTE: return field.is_signed ? f(TypeTag<int8_t>()) : f(TypeTag<uint8_t>());
+        case FieldType::kSHORT: return field.is_signed ? f(TypeTag<int16_t>()) : f(TypeTag<uint16_t>());
+        case FieldType::kINT: return field.is_signed ? f(TypeTag<int32_t>()) : f(TypeTag<uint32_t>());
+        case FieldType::kFLOAT: return f(TypeTag<float>());
+        case FieldType::kDOUBLE: return f(TypeTag<double>());
+        case FieldType::kBOOL: return f(TypeTag<uint8_t>());
+        default: return f(TypeTag<int64_t>());  // Unsigned longs keep their bit pattern, as in the VM
+    }
+}
+
+struct Equal { template <typename V> static bool Apply(const V& x, const V& y) noexcept { return x == y; } };
+struct NotEqual { template <typename V> static bool Apply(const V& x, const V& y) noexcept { return x != y; } };
+struct Less { template <typename V> static bool Apply(const V& x, const V& y) noexcept { return x < y; } };
+struct LessEqual { template <typename V> static bool Apply(const V& x, const V& y) noexcept { return x <= y; } };
+struct Greater { template <typename V> static bool Apply(const V& x, const V& y) noexcept { return x > y; } };
+struct GreaterEqual { template <typename V> static bool Apply(const V& x, const V& y) noexcept { return x >= y; } };
+
+/**
+ * @brief Call f with the functor of a comparison operator
+ */
+template <typename F>
+static auto WithComparison(TokenType op, F&& f) {
+    switch (op) {
+        case TokenType::kEQUALITY: return f(Equal());
+        case TokenType::kDNE: return f(NotEqual());
+        case TokenType::kLT: return f(Less());
+        case TokenType::kLTE: return f(LessEqual());
+        case TokenType::kGT: return f(Greater());
+        default: return f(GreaterEqual());
+    }
+}
+
+struct Plus {
+    static int64_t Apply(int64_t x, int64_t y) noexcept { return WrapAdd(x, y); }
+    static double Apply(double x, double y) noexcept { return x + y; }
+};
+
+struct Minus {
+    static int64_t Apply(int64_t x, int64_t y) noexcept { return WrapSub(x, y); }
+    static double Apply(double x, double y) noexcept { return x - y; }
+};
+
+struct Times {
+    static int64_t Apply(int64_t x, int64_t y) noexcept { return WrapMul(x, y); }
+    static double Apply(double x, double y) noexcept { return x * y; }
+};
+
+template <typename T, typename V>
+class FieldValue : public PredicateValue<V> {
+public:
+    explicit FieldValue(const FieldLayout& field) noexcept
+    : offset_(field.offset), null_offset_(field.null_offset), null_mask_(NullMask(field)) {}
+
+    bool Read(const uint8_t* record, V& value) const noexcept override {
+        if (record[null_offset_] & null_mask_)
+            return false;
+        T raw;
+        memcpy(&raw, record + offset_, sizeof(T));
+        value = static_cast<V>(raw);
+        return true;
+    }
+
+private:
+    uint32_t offset_;
+    uint32_t null_offset_;
+    uint8_t null_mask_;
+};
+
+class StringFieldValue : public PredicateValue<std::string_view> {
+public:
+    explicit StringFieldValue(const FieldLayout& field) noexcept
+    : offset_(field.offset), null_offset_(field.null_offset), null_mask_(NullMask(field)) {}
+
+    bool Read(const uint8_t* record, std::string_view& value) const noexcept override {
+        if (record[null_offset_] & null_mask_)
+            return false;
+        VarSlot slot;
+        memcpy(&slot, record + offset_, sizeof(slot));
+        value = std::string_view(reinterpret_cast<const char*>(record) + slot.offset, slot.length);
+        return true;
+    }
+
+private:
+    uint32_t offset_;
+    uint32_t null_offset_;
+    uint8_t null_mask_;
+};
+
+template <typename V>
+class ConstantValue : public PredicateValue<V> {
+public:
+    explicit ConstantValue(V value) noexcept : value_(value) {}
+
+    bool Read(const uint8_t*, V& value) const noexcept override {
+        value = value_;
+        return true;
+    }
+
+private:
+    V value_;
+};
+
+class ToRealValue : public PredicateValue<double> {
+public:
+    explicit ToRealValue(std::unique_ptr<PredicateValue<int64_t>> operand) noexcept : operand_(std::move(operand)) {}
+
+    bool Read(const uint8_t* record, double& value) const noexcept override {
+        int64_t integer;
+        if (!operand_->Read(record, integer))
+            return false;
+        value = static_cast<double>(integer);
+        return true;
+    }
+
+private:
+    std::unique_ptr<PredicateValue<int64_t>> operand_;
+};
+
+template <typename V>
+class NegateValue : public PredicateValue<V> {
+public:
+    explicit NegateValue(std::unique_ptr<PredicateValue<V>> operand) noexcept : operand_(std::move(operand)) {}
+
+    bool Read(const uint8_t* record, V& value) const noexcept override {
+        if (!operand_->Read(record, value))
+            return false;
+        value = Minus::Apply(V(0), value);
+        return true;
+    }
+
+private:
+    std::unique_ptr<PredicateValue<V>> operand_;
+};
+
+template <typename V, typename Op>
+class ArithValue : public PredicateValue<V> {
+public:
+    ArithValue(std::unique_ptr<PredicateValue<V>> lhs, std::unique_ptr<PredicateValue<V>> rhs) noexcept
+    : lhs_(std::move(lhs)), rhs_(std::move(rhs)) {}
+
+    bool Read(const uint8_t* record, V& value) const noexcept override {
+        V rhs;
+        if (!lhs_->Read(record, value) || !rhs_->Read(record, rhs))
+            return false;
+        value = Op::Apply(value, rhs);
+        return true;
+    }
+
+private:
+    std::unique_ptr<PredicateValue<V>> lhs_;
+    std::unique_ptr<PredicateValue<V>> rhs_;
+};
+
+/**
+ * @brief A condition used as a bool value, never null
+ */
+class ConditionValue : public PredicateValue<int64_t> {
+public:
+    explicit ConditionValue(std::unique_ptr<PredicateClosure> condition) noexcept : condition_(std::move(condition)) {}
+
+    bool Read(const uint8_t* record, int64_t& value) const noexcept override {
+        value = condition_->Test(record) ? 1 : 0;
+        return true;
+    }
+
+private:
+    std::unique_ptr<PredicateClosure> condition_;
+};
+
+/**
+ * @brief field op constant, the most common leaf of a scan
+ */
+template <typename T, typename V, typename Cmp>
+class CompareField : public PredicateClosure {
+public:
+    CompareField(const FieldLayout& field, V constant) noexcept
+    : offset_(field.offset), null_offset_(field.null_offset), null_mask_(NullMask(field)), constant_(constant) {}
+
+    bool Test(const uint8_t* record) const noexcept override {
+        if (record[null_offset_] & null_mask_)
+            return false;
+        T raw;
+        memcpy(&raw, record + offset_, sizeof(T));
+        return Cmp::Apply(static_cast<V>(raw), constant_);
+    }
+
+private:
+    uint32_t offset_;
+    uint32_t null_offset_;
+    uint8_t null_mask_;
+    V constant_;
+};
+
+/**
+ * @brief A field between two constants, read once
+ */
+template <typename T, typename V, bool LOWER_INCLUSIVE, bool UPPER_INCLUSIVE>
+class RangeField : public PredicateClosure {
+public:
+    RangeField(const FieldLayout& field, V lower, V upper) noexcept
+    : offset_(field.offset), null_offset_(field.null_offset), null_mask_(NullMask(field)), lower_(lower),
+      upper_(upper) {}
+
+    bool Test(const uint8_t* record) const noexcept override {
+        if (record[null_offset_] & null_mask_)
+            return false;
+        T raw;
+        memcpy(&raw, record + offset_, sizeof(T));
+        V value = static_cast<V>(raw);
+        return (LOWER_INCLUSIVE ? value >= lower_ : value > lower_) &&
+               (UPPER_INCLUSIVE ? value <= upper_ : value < upper_);
+    }
+
+private:
+    uint32_t offset_;
+    uint32_t null_offset_;
+    uint8_t null_mask_;
+    V lower_;
+    V upper_;
+};
+
+template <typename V, typename Cmp>
+class CompareValues : public PredicateClosure {
+public:
+    CompareValues(std::unique_ptr<PredicateValue<V>> lhs, std::unique_ptr<PredicateValue<V>> rhs) noexcept
+    : lhs_(std::move(lhs)), rhs_(std::move(rhs)) {}
+
+    bool Test(const uint8_t* record) const noexcept override {
+        V lhs;
+        V rhs;
+        return lhs_->Read(record, lhs) && rhs_->Read(record, rhs) && Cmp::Apply(lhs, rhs);
+    }
+
+private:
+    std::unique_ptr<PredicateValue<V>> lhs_;
+    std::unique_ptr<PredicateValue<V>> rhs_;
+};
+
+template <typename V, bool LOWER_INCLUSIVE, bool UPPER_INCLUSIVE>
+class RangeValues : public PredicateClosure {
+public:
+    RangeValues(std::unique_ptr<PredicateValue<V>> target, V lower, V upper) noexcept
+    : target_(std::move(target)), lower_(lower), upper_(upper) {}
+
+    bool Test(const uint8_t* record) const noexcept override {
+        V value;
+        if (!target_->Read(record, value))
+            return false;
+        return (LOWER_INCLUSIVE ? value >= lower_ : value > lower_) &&
+               (UPPER_INCLUSIVE ? value <= upper_ : value < upper_);
+    }
+
+private:
+    std::unique_ptr<PredicateValue<V>> target_;
+    V lower_;
+    V upper_;
+};
+
+class ConstantClosure : public PredicateClosure {
+public:
+    explicit ConstantClosure(bool value) noexcept : value_(value) {}
+
+    bool Test(const uint8_t*) const noexcept override {
+        return value_;
+    }
+
+private:
+    bool value_;
+};
+
+class NotClosure : public PredicateClosure {
+public:
+    explicit NotClosure(std::unique_ptr<PredicateClosure> operand) noexcept : operand_(std::move(operand)) {}
+
+    bool Test(const uint8_t* record) const noexcept override {
+        return !operand_->Test(record);
+    }
+
+private:
+    std::unique_ptr<PredicateClosure> operand_;
+};
+
+template <bool IS_AND>
+class ChainClosure : public PredicateClosure {
+public:
+    explicit ChainClosure(std::vector<std::unique_ptr<PredicateClosure>> operands) noexcept
+    : operands_(std::move(operands)) {}
+
+    bool Test(const uint8_t* record) const noexcept override {
+        // && stops at the first false operand, || at the first true one
+        for (const auto& operand : operands_)
+            if (operand->Test(record) != IS_AND)
+                return !IS_AND;
+        return IS_AND;
+    }
+
+private:
+    std::vector<std::unique_ptr<PredicateClosure>> operands_;
+};
+
+template <bool LOWER_INCLUSIVE, bool UPPER_INCLUSIVE, typename F>
+static auto WithInclusive(F&& f) {
+    return f(std::integral_constant<bool, LOWER_INCLUSIVE>(), std::integral_constant<bool, UPPER_INCLUSIVE>());
+}
+
+/**
+ * @brief Call f with the inclusive flags of a range as compile time constants
+ */
+template <typename F>
+static auto WithRangeFlags(uint16_t flags, F&& f) {
+    if (flags & kAST_LOWER_INCLUSIVE)
+        return (flags & kAST_UPPER_INCLUSIVE) ? WithInclusive<true, true>(f) : WithInclusive<true, false>(f);
+    return (flags & kAST_UPPER_INCLUSIVE) ? WithInclusive<false, true>(f) : WithInclusive<false, false>(f);
+}
+
+/**
+ * Predicate
+ */
+Predicate::Predicate() noexcept
+: catalog_(nullptr), type_id_(NO_TYPE), arguments_(nullptr), terms_(), fields_(), root_(NO_TERM),
+  mode_(PredicateMode::kINTERPRET), closure_(), code_(), native_(nullptr)
+{}
+
+Predicate::~Predicate() noexcept {}
+
+void Predicate::Compile(const AstNode* expression, const SchemaCatalog& catalog, uint32_t type_id, PredicateMode mode,
+                        const std::vector<Argument>& arguments) {
+    catalog_ = &catalog;
+    type_id_ = type_id;
+    arguments_ = &arguments;
+    terms_.clear();
+    fields_.clear();
+    closure_.reset();
+    code_.Release();
+    native_ = nullptr;
+    mode_ = PredicateMode::kINTERPRET;
+    root_ = NO_TERM;
+
+    uint32_t root = ResolveCondition(expression);
+    arguments_ = nullptr;
+    root_ = root;
+    if (mode == PredicateMode::kINTERPRET)
+        return;
+
+#ifdef DT_PREDICATE_NATIVE
+    if (mode == PredicateMode::kNATIVE && SupportsNative(root_)) {
+        X64Emitter emitter;
+        X64Emitter::Label fail = emitter.NewLabel();
+        EmitCondition(emitter, root_, false, fail);
+        emitter.Return(1);
+        emitter.Bind(fail);
+        emitter.Return(0);
+        if (code_.Load(emitter.Finish())) {
+            native_ = reinterpret_cast<NativeFunction>(const_cast<void*>(code_.Entry()));
+            mode_ = PredicateMode::kNATIVE;
+            return;
+        }
+    }
+#endif
+    closure_ = BuildClosure(root_);
+    mode_ = PredicateMode::kCLOSURE;
+}
+
+PredicateMode Predicate::Mode() const noexcept {
+    return mode_;
+}
+
+bool Predicate::Matches(const uint8_t* record) const noexcept {
+    switch (mode_) {
+        case PredicateMode::kNATIVE: return native_(record);
+        case PredicateMode::kCLOSURE: return closure_->Test(record);
+        default: return Evaluate(root_, record);
+    }
+}
+
+size_t Predicate::Select(const uint8_t* const* records, size_t count, std::vector<uint32_t>& selected) const {
+    size_t before = selected.size();
+    // One loop per mode keeps the per record dispatch out of the loop
+    switch (mode_) {
+        case PredicateMode::kNATIVE: {
+            NativeFunction native = native_;
+            for (size_t i = 0; i < count; ++i)
+                if (native(records[i]))
+                    selected.push_back(static_cast<uint32_t>(i));
+            break;
+        }
+        case PredicateMode::kCLOSURE: {
+            const PredicateClosure* closure = closure_.get();
+            for (size_t i = 0; i < count; ++i)
+                if (closure->Test(records[i]))
+                    selected.push_back(static_cast<uint32_t>(i));
+            break;
+        }
+        default: {
+            for (size_t i = 0; i < count; ++i)
+                if (Evaluate(root_, records[i]))
+                    selected.push_back(static_cast<uint32_t>(i));
+            break;
+        }
+    }
+    return selected.size() - before;
+}
+
+size_t Predicate::Count(const uint8_t* const* records, size_t count) const noexcept {
+    size_t matches = 0;
+    switch (mode_) {
+        case PredicateMode::kNATIVE: {
+            NativeFunction native = native_;
+            for (size_t i = 0; i < count; ++i)
+                matches += native(records[i]);
+            break;
+        }
+        case PredicateMode::kCLOSURE: {
+            const PredicateClosure* closure = closure_.get();
+            for (size_t i = 0; i < count; ++i)
+                matches += closure->Test(records[i]);
+            break;
+        }
+        default: {
+            for (size_t i = 0; i < count; ++i)
+                matches += Evaluate(root_, records[i]);
+            break;
+        }
+    }
+    return matches;
+}
+
+size_t Predicate::CodeSize() const noexcept {
+    return code_.Size();
+}
+
+/**
+ * Resolution
+ */
+uint32_t Predicate::Resolve(const AstNode* node) {
+    switch (node->kind) {
+        case AstKind::kIDENTIFIER:
+        case AstKind::kMEMBER:
+            return ResolveField(node);
+        case AstKind::kINTEGER:
+        case AstKind::kREAL:
+        case AstKind::kSTRING:
+        case AstKind::kBOOL:
+            return ResolveLiteral(node, false);
+        case AstKind::kPARAMETER:
+            return ResolveParameter(node);
+        case AstKind::kUNARY:
+            return ResolveUnary(node);
+        case AstKind::kBINARY:
+            return ResolveBinary(node);
+        case AstKind::kRANGE:
+            return ResolveRange(node);
+        default:
+            Error(node, std::string("Predicates cannot use ") + AstKindName(node->kind));
+    }
+}
+
+uint32_t Predicate::ResolveCondition(const AstNode* node) {
+    uint32_t term = Resolve(node);
+    const Term& value = terms_[term];
+    switch (value.kind) {
+        case TermKind::kCOMPARE:
+        case TermKind::kRANGE:
+        case TermKind::kNOT:
+        case TermKind::kAND:
+        case TermKind::kOR:
+        case TermKind::kTEST:
+            return term;
+        default:
+            break;
+    }
+    if (value.type != ValueType::kBOOL && value.type != ValueType::kINT)
+        Error(node, std::string("Conditions must be bool or integer, found ") + TypeName(value.type));
+    if (value.kind == TermKind::kCONSTANT) {
+        uint32_t constant = AddTerm(TermKind::kCONSTANT, ValueType::kBOOL);
+        terms_[constant].integer = (terms_[term].integer != 0) ? 1 : 0;
+        return constant;
+    }
+    return AddTerm(TermKind::kTEST, ValueType::kBOOL, term);
+}
+
+uint32_t Predicate::ResolveField(const AstNode* node) {
+    std::string path;
+    const AstNode* member = node;
+    for (; member->kind == AstKind::kMEMBER; member = member->first_child)
+        path = path.empty() ? std::string(member->text) : std::string(member->text) + "." + path;
+    if (member->kind != AstKind::kIDENTIFIER)
+        Error(node, "Predicates can only read fields of the record");
+    path = path.empty() ? std::string(member->text) : std::string(member->text) + "." + path;
+
+    FieldLayout field;
+    try {
+        field = catalog_->Resolve(type_id_, path);
+    } catch (const SchemaException& e) {
+        Error(node, e.what());
+    }
+    ValueType type = FieldValueType(field);
+    if (type == ValueType::kVOID)
+        Error(node, field.name + " cannot be read by a predicate");
+    fields_.push_back(std::move(field));
+    uint32_t term = AddTerm(TermKind::kFIELD, type);
+    terms_[term].field = static_cast<uint32_t>(fields_.size() - 1);
+    return term;
+}
+
+uint32_t Predicate::ResolveLiteral(const AstNode* node, bool negate) {
+    switch (node->kind) {
+        case AstKind::kINTEGER: {
+            std::string digits(node->text);
+            errno = 0;
+            unsigned long long magnitude = strtoull(digits.c_str(), nullptr, 10);
+            // -9223372036854775808 is only reachable negated
+            if (errno == ERANGE || magnitude > static_cast<unsigned long long>(INT64_MAX) + (negate ? 1 : 0))
+                Error(node, "Integer " + digits + " does not fit in 64 bits");
+            uint32_t term = AddTerm(TermKind::kCONSTANT, ValueType::kINT);
+            terms_[term].integer = static_cast<int64_t>(negate ? 0 - magnitude : magnitude);
+            return term;
+        }
+        case AstKind::kREAL: {
+            std::string digits(node->text);
+            double value = strtod(digits.c_str(), nullptr);
+            uint32_t term = AddTerm(TermKind::kCONSTANT, ValueType::kREAL);
+            terms_[term].real = negate ? -value : value;
+            return term;
+        }
+        case AstKind::kSTRING: {
+            uint32_t term = AddTerm(TermKind::kCONSTANT, ValueType::kSTRING);
+            terms_[term].string = std::string(node->text);
+            return term;
+        }
+        default: {
+            uint32_t term = AddTerm(TermKind::kCONSTANT, ValueType::kBOOL);
+            terms_[term].integer = (node->op == TokenType::kTRUE) ? 1 : 0;
+            return term;
+        }
+    }
+}
+
+uint32_t Predicate::ResolveParameter(const AstNode* node) {
+    if (node->flags >= arguments_->size())
+        Error(node, "Parameter " + std::to_string(node->flags + 1) + " is not bound");
+    const Argument& argument = (*arguments_)[node->flags];
+    uint32_t term;
+    switch (argument.type) {
+        case ValueType::kINT:
+        case ValueType::kBOOL:
+            term = AddTerm(TermKind::kCONSTANT, argument.type);
+            terms_[term].integer = (argument.type == ValueType::kBOOL) ? (argument.integer != 0) : argument.integer;
+            return term;
+        case ValueType::kREAL:
+            term = AddTerm(TermKind::kCONSTANT, ValueType::kREAL);
+            terms_[term].real = argument.real;
+            return term;
+        case ValueType::kSTRING:
+            term = AddTerm(TermKind::kCONSTANT, ValueType::kSTRING);
+            terms_[term].string = argument.string;
+            return term;
+        default:
+            Error(node, "Parameter " + std::to_string(node->flags + 1) + " is not bound");
+    }
+}
+
+uint32_t Predicate::ResolveUnary(const AstNode* node) {
+    const AstNode* operand = node->first_child;
+    // Negative literals are one constant
+    if (node->op == TokenType::kMINUS && (operand->kind == AstKind::kINTEGER || operand->kind == AstKind::kREAL))
+        return ResolveLiteral(operand, true);
+    if (node->op == TokenType::kNOT) {
+        uint32_t condition = ResolveCondition(operand);
+        if (terms_[condition].kind == TermKind::kCONSTANT) {
+            terms_[condition].integer = !terms_[condition].integer;
+            return condition;
+        }
+        return AddTerm(TermKind::kNOT, ValueType::kBOOL, condition);
+    }
+
+    uint32_t value = Resolve(operand);
+    ValueType type = terms_[value].type;
+    if (!IsNumeric(type))
+        Error(node, std::string((node->op == TokenType::kMINUS) ? "Cannot negate " : "Cannot apply + to ") +
+                    TypeName(type));
+    if (node->op == TokenType::kPLUS)
+        return value;
+    return AddTerm(TermKind::kNEGATE, type, value);
+}
+
+uint32_t Predicate::ResolveBinary(const AstNode* node) {
+    if (node->op == TokenType::kBOOL_AND || node->op == TokenType::kBOOL_OR) {
+        // Chains flattened by the Optimizer have more than two operands
+        std::vector<uint32_t> operands;
+        for (const AstNode* operand = node->first_child; operand != nullptr; operand = operand->next_sibling)
+            operands.push_back(ResolveCondition(operand));
+        uint32_t term = AddTerm((node->op == TokenType::kBOOL_AND) ? TermKind::kAND : TermKind::kOR, ValueType::kBOOL);
+        terms_[term].operands = std::move(operands);
+        return term;
+    }
+
+    uint32_t lhs = Resolve(node->first_child);
+    uint32_t rhs = Resolve(node->first_child->next_sibling);
+    ValueType lhs_type = terms_[lhs].type;
+    ValueType rhs_type = terms_[rhs].type;
+    std::string mismatch = std::string("Cannot apply ") + TokenTypeName(node->op) + " to " + TypeName(lhs_type) +
+                           " and " + TypeName(rhs_type);
+
+    if (IsComparison(node->op)) {
+        bool equality = node->op == TokenType::kEQUALITY || node->op == TokenType::kDNE;
+        if (IsNumeric(lhs_type) && IsNumeric(rhs_type)) {
+            if (lhs_type == ValueType::kREAL || rhs_type == ValueType::kREAL) {
+                lhs = ToReal(lhs);
+                rhs = ToReal(rhs);
+            }
+        } else if (!(lhs_type == ValueType::kSTRING && rhs_type == ValueType::kSTRING) &&
+                   !(lhs_type == ValueType::kBOOL && rhs_type == ValueType::kBOOL && equality)) {
+            Error(node, mismatch);
+        }
+        uint32_t term = AddTerm(TermKind::kCOMPARE, ValueType::kBOOL, lhs, rhs);
+        terms_[term].op = node->op;
+        return term;
+    }
+
+    if (node->op == TokenType::kDIVIDE || node->op == TokenType::kMODULO)
+        Error(node, std::string(TokenTypeName(node->op)) + " is not supported by predicates");
+    if (!IsNumeric(lhs_type) || !IsNumeric(rhs_type))
+        Error(node, mismatch);
+    ValueType type = ValueType::kINT;
+    if (lhs_type == ValueType::kREAL || rhs_type == ValueType::kREAL) {
+        lhs = ToReal(lhs);
+        rhs = ToReal(rhs);
+        type = ValueType::kREAL;
+    }
+    uint32_t term = AddTerm(TermKind::kARITH, type, lhs, rhs);
+    terms_[term].op = node->op;
+    return term;
+}
+
+uint32_t Predicate::ResolveRange(const AstNode* node) {
+    const AstNode* lower = node->Child(1);
+    const AstNode* upper = node->Child(2);
+    uint32_t target = Resolve(node->first_child);
+    uint32_t bounds[2] = {NO_TERM, NO_TERM};
+    if (lower->kind != AstKind::kEMPTY)
+        bounds[0] = Resolve(lower);
+    if (upper->kind != AstKind::kEMPTY)
+        bounds[1] = Resolve(upper);
+
+    // Numbers compare as reals when any side is one, strings only with strings
+    ValueType type = terms_[target].type;
+    for (uint32_t bound : bounds) {
+        if (bound == NO_TERM)
+            continue;
+        ValueType bound_type = terms_[bound].type;
+        if (IsNumeric(type) && IsNumeric(bound_type)) {
+            if (bound_type == ValueType::kREAL)
+                type = ValueType::kREAL;
+        } else if (type != ValueType::kSTRING || bound_type != ValueType::kSTRING) {
+            Error(node, std::string("Cannot compare ") + TypeName(type) + " and " + TypeName(bound_type));
+        }
+        if (terms_[bound].kind != TermKind::kCONSTANT)
+            Error(node, "Range bounds must be constants");
+    }
+    if (type == ValueType::kREAL) {
+        target = ToReal(target);
+        for (uint32_t& bound : bounds)
+            if (bound != NO_TERM)
+                bound = ToReal(bound);
+    }
+    uint32_t term = AddTerm(TermKind::kRANGE, ValueType::kBOOL, target, bounds[0]);
+    terms_[term].upper = bounds[1];
+    terms_[term].flags = node->flags & (kAST_LOWER_INCLUSIVE | kAST_UPPER_INCLUSIVE);
+    return term;
+}
+
+uint32_t Predicate::ToReal(uint32_t term) {
+    if (terms_[term].type == ValueType::kREAL)
+        return term;
+    if (terms_[term].kind == TermKind::kCONSTANT) {
+        uint32_t constant = AddTerm(TermKind::kCONSTANT, ValueType::kREAL);
+        terms_[constant].real = static_cast<double>(terms_[term].integer);
+        return constant;
+    }
+    return AddTerm(TermKind::kTO_REAL, ValueType::kREAL, term);
+}
+
+uint32_t Predicate::AddTerm(TermKind kind, ValueType type, uint32_t lhs, uint32_t rhs) {
+    Term term;
+    term.kind = kind;
+    term.type = type;
+    term.op = TokenType::kERROR;
+    term.flags = 0;
+    term.lhs = lhs;
+    term.rhs = rhs;
+    term.upper = NO_TERM;
+    term.field = 0;
+    term.integer = 0;
+    term.real = 0.0;
+    terms_.push_back(std::move(term));
+    return static_cast<uint32_t>(terms_.size() - 1);
+}
+
+void Predicate::Error(const AstNode* node, const std::string& msg) const {
+    throw VmException("Line " + std::to_string(node->line) + ": " + msg);
+}
+
+/**
+ * Interpretation
+ */
+bool Predicate::Evaluate(uint32_t index, const uint8_t* record) const noexcept {
+    const Term& term = terms_[index];
+    switch (term.kind) {
+        case TermKind::kCOMPARE: {
+            switch (terms_[term.lhs].type) {
+                case ValueType::kREAL: {
+                    double lhs, rhs;
+                    return EvaluateReal(term.lhs, record, lhs) && EvaluateReal(term.rhs, record, rhs) &&
+                           Compare(term.op, lhs, rhs);
+                }
+                case ValueType::kSTRING: {
+                    std::string_view lhs, rhs;
+                    return EvaluateString(term.lhs, record, lhs) && EvaluateString(term.rhs, record, rhs) &&
+                           Compare(term.op, lhs, rhs);
+                }
+                default: {
+                    int64_t lhs, rhs;
+                    return EvaluateInteger(term.lhs, record, lhs) && EvaluateInteger(term.rhs, record, rhs) &&
+                           Compare(term.op, lhs, rhs);
+                }
+            }
+        }
+        case TermKind::kRANGE: {
+            TokenType lower_op = (term.flags & kAST_LOWER_INCLUSIVE) ? TokenType::kGTE : TokenType::kGT;
+            TokenType upper_op = (term.flags & kAST_UPPER_INCLUSIVE) ? TokenType::kLTE : TokenType::kLT;
+            switch (terms_[term.lhs].type) {
+                case ValueType::kREAL: {
+                    double value;
+                    if (!EvaluateReal(term.lhs, record, value))
+                        return false;
+                    return (term.rhs == NO_TERM || Compare(lower_op, value, terms_[term.rhs].real)) &&
+                           (term.upper == NO_TERM || Compare(upper_op, value, terms_[term.upper].real));
+                }
+                case ValueType::kSTRING: {
+                    std::string_view value;
+                    if (!EvaluateString(term.lhs, record, value))
+                        return false;
+                    return (term.rhs == NO_TERM || Compare(lower_op, value, std::string_view(terms_[term.rhs].string))) &&
+                           (term.upper == NO_TERM ||
+                            Compare(upper_op, value, std::string_view(terms_[term.upper].string)));
+                }
+                default: {
+                    int64_t value;
+                    if (!EvaluateInteger(term.lhs, record, value))
+                        return false;
+                    return (term.rhs == NO_TERM || Compare(lower_op, value, terms_[term.rhs].integer)) &&
+                           (term.upper == NO_TERM || Compare(upper_op, value, terms_[term.upper].integer));
+                }
+            }
+        }
+        case TermKind::kNOT:
+            return !Evaluate(term.lhs, record);
+        case TermKind::kAND:
+            for (uint32_t operand : term.operands)
+                if (!Evaluate(operand, record))
+                    return false;
+            return true;
+        case TermKind::kOR:
+            for (uint32_t operand : term.operands)
+                if (Evaluate(operand, record))
+                    return true;
+            return false;
+        case TermKind::kTEST: {
+            int64_t value;
+            return EvaluateInteger(term.lhs, record, value) && value != 0;
+        }
+        default:
+            return term.integer != 0;
+    }
+}
+
+bool Predicate::EvaluateInteger(uint32_t index, const uint8_t* record, int64_t& value) const noexcept {
+    const Term& term = terms_[index];
+    switch (term.kind) {
+        case TermKind::kFIELD: {
+            const FieldLayout& field = fields_[term.field];
+            if (record[field.null_offset] & NullMask(field))
+                return false;
+            value = ReadInteger(record, field);
+            return true;
+        }
+        case TermKind::kCONSTANT:
+            value = term.integer;
+            return true;
+        case TermKind::kNEGATE:
+            if (!EvaluateInteger(term.lhs, record, value))
+                return false;
+            value = WrapSub(0, value);
+            return true;
+        case TermKind::kARITH: {
+            int64_t rhs;
+            if (!EvaluateInteger(term.lhs, record, value) || !EvaluateInteger(term.rhs, record, rhs))
+                return false;
+            switch (term.op) {
+                case TokenType::kPLUS: value = WrapAdd(value, rhs); break;
+                case TokenType::kMINUS: value = WrapSub(value, rhs); break;
+                default: value = WrapMul(value, rhs); break;
+            }
+            return true;
+        }
+        default:
+            // A condition used as a bool value
+            value = Evaluate(index, record) ? 1 : 0;
+            return true;
+    }
+}
+
+bool Predicate::EvaluateReal(uint32_t index, const uint8_t* record, double& value) const noexcept {
+    const Term& term = terms_[index];
+    switch (term.kind) {
+        case TermKind::kFIELD: {
+            const FieldLayout& field = fields_[term.field];
+            if (record[field.null_offset] & NullMask(field))
+                return false;
+            value = ReadReal(record, field);
+            return true;
+        }
+        case TermKind::kCONSTANT:
+            value = term.real;
+            return true;
+        case TermKind::kTO_REAL: {
+            int64_t integer;
+            if (!EvaluateInteger(term.lhs, record, integer))
+                return false;
+            value = static_cast<double>(integer);
+            return true;
+        }
+        case TermKind::kNEGATE:
+            if (!EvaluateReal(term.lhs, record, value))
+                return false;
+            value = -value;
+            return true;
+        default: {
+            double rhs;
+            if (!EvaluateReal(term.lhs, record, value) || !EvaluateReal(term.rhs, record, rhs))
+                return false;
+            switch (term.op) {
+                case TokenType::kPLUS: value += rhs; break;
+                case TokenType::kMINUS: value -= rhs; break;
+                default: value *= rhs; break;
+            }
+            return true;
+        }
+    }
+}
+
+bool Predicate::EvaluateString(uint32_t index, const uint8_t* record, std::string_view& value) const noexcept {
+    const Term& term = terms_[index];
+    if (term.kind == TermKind::kCONSTANT) {
+        value = term.string;
+        return true;
+    }
+    const FieldLayout& field = fields_[term.field];
+    if (record[field.null_offset] & NullMask(field))
+        return false;
+    value = ReadVar(record, field);
+    return true;
+}
+
+/**
+ * Closures
+ */
+std::unique_ptr<PredicateClosure> Predicate::BuildClosure(uint32_t index) const {
+    const Term& term = terms_[index];
+    switch (term.kind) {
+        case TermKind::kCOMPARE:
+            return BuildCompare(term.op, term.lhs, term.rhs);
+        case TermKind::kRANGE:
+            return BuildRange(term);
+        case TermKind::kTEST: {
+            const FieldLayout* field = LeafField(term.lhs);
+            if (field != nullptr)
+                return WithFieldType(*field, [&](auto tag) -> std::unique_ptr<PredicateClosure> {
+                    using T = typename decltype(tag)::type;
+                    return std::make_unique<CompareField<T, int64_t, NotEqual>>(*field, 0);
+                });
+            return std::make_unique<CompareValues<int64_t, NotEqual>>(BuildValue<int64_t>(term.lhs),
+                                                                      std::make_unique<ConstantValue<int64_t>>(0));
+        }
+        case TermKind::kNOT:
+            return std::make_unique<NotClosure>(BuildClosure(term.lhs));
+        case TermKind::kAND:
+        case TermKind::kOR: {
+            std::vector<std::unique_ptr<PredicateClosure>> operands;
+            for (uint32_t operand : term.operands)
+                operands.push_back(BuildClosure(operand));
+            if (term.kind == TermKind::kAND)
+                return std::make_unique<ChainClosure<true>>(std::move(operands));
+            return std::make_unique<ChainClosure<false>>(std::move(operands));
+        }
+        default:
+            return std::make_unique<ConstantClosure>(term.integer != 0);
+    }
+}
+
+std::unique_ptr<PredicateClosure> Predicate::BuildCompare(TokenType op, uint32_t lhs, uint32_t rhs) const {
+    ValueType type = terms_[lhs].type;
+    const FieldLayout* field = LeafField(lhs);
+    const Term& constant = terms_[rhs];
+    return WithComparison(op, [&](auto cmp) -> std::unique_ptr<PredicateClosure> {
+        using Cmp = decltype(cmp);
+        if (type == ValueType::kSTRING) {
+            return std::make_unique<CompareValues<std::string_view, Cmp>>(BuildValue<std::string_view>(lhs),
+                                                                          BuildValue<std::string_view>(rhs));
+        }
+        auto build = [&](auto value_tag) -> std::unique_ptr<PredicateClosure> {
+            using V = typename decltype(value_tag)::type;
+            if (field == nullptr || constant.kind != TermKind::kCONSTANT)
+                return std::make_unique<CompareValues<V, Cmp>>(BuildValue<V>(lhs), BuildValue<V>(rhs));
+            V value = ConstantOf<V>(constant.integer, constant.real);
+            return WithFieldType(*field, [&](auto tag) -> std::unique_ptr<PredicateClosure> {
+                using T = typename decltype(tag)::type;
+                return std::make_unique<CompareField<T, V, Cmp>>(*field, value);
+            });
+        };
+        return (type == ValueType::kREAL) ? build(TypeTag<double>()) : build(TypeTag<int64_t>());
+    });
+}
+
+std::unique_ptr<PredicateClosure> Predicate::BuildRange(const Term& term) const {
+    TokenType lower_op = (term.flags & kAST_LOWER_INCLUSIVE) ? TokenType::kGTE : TokenType::kGT;
+    TokenType upper_op = (term.flags & kAST_UPPER_INCLUSIVE) ? TokenType::kLTE : TokenType::kLT;
+    ValueType type = terms_[term.lhs].type;
+    if (term.rhs == NO_TERM || term.upper == NO_TERM) {
+        // One sided, the same as a comparison
+        if (term.rhs != NO_TERM)
+            return BuildCompare(lower_op, term.lhs, term.rhs);
+        return BuildCompare(upper_op, term.lhs, term.upper);
+    }
+    if (type == ValueType::kSTRING) {
+        std::vector<std::unique_ptr<PredicateClosure>> bounds;
+        bounds.push_back(BuildCompare(lower_op, term.lhs, term.rhs));
+        bounds.push_back(BuildCompare(upper_op, term.lhs, term.upper));
+        return std::make_unique<ChainClosure<true>>(std::move(bounds));
+    }
+
+    const FieldLayout* field = LeafField(term.lhs);
+    const Term& lower_bound = terms_[term.rhs];
+    const Term& upper_bound = terms_[term.upper];
+    auto build = [&](auto value_tag) -> std::unique_ptr<PredicateClosure> {
+        using V = typename decltype(value_tag)::type;
+        V lower = ConstantOf<V>(lower_bound.integer, lower_bound.real);
+        V upper = ConstantOf<V>(upper_bound.integer, upper_bound.real);
+        return WithRangeFlags(term.flags, [&](auto lower_inclusive, auto upper_inclusive)
+                                              -> std::unique_ptr<PredicateClosure> {
+            constexpr bool LOWER = decltype(lower_inclusive)::value;
+            constexpr bool UPPER = decltype(upper_inclusive)::value;
+            if (field == nullptr)
+                return std::make_unique<RangeValues<V, LOWER, UPPER>>(BuildValue<V>(term.lhs), lower, upper);
+            return WithFieldType(*field, [&](auto tag) -> std::unique_ptr<PredicateClosure> {
+                using T = typename decltype(tag)::type;
+                return std::make_unique<RangeField<T, V, LOWER, UPPER>>(*field, lower, upper);
+            });
+        });
+    };
+    return (type == ValueType::kREAL) ? build(TypeTag<double>()) : build(TypeTag<int64_t>());
+}
+
+template <typename V>
+std::unique_ptr<PredicateValue<V>> Predicate::BuildValue(uint32_t index) const {
+    const Term& term = terms_[index];
+    if constexpr (std::is_same<V, std::string_view>::value) {
+        // Strings are only fields and constants, the view of a constant points into terms_
+        if (term.kind == TermKind::kCONSTANT)
+            return std::make_unique<ConstantValue<std::string_view>>(term.string);
+        return std::make_unique<StringFieldValue>(fields_[term.field]);
+    } else {
+        switch (term.kind) {
+            case TermKind::kFIELD: {
+                const FieldLayout& field = fields_[term.field];
+                return WithFieldType(field, [&](auto tag) -> std::unique_ptr<PredicateValue<V>> {
+                    using T = typename decltype(tag)::type;
+                    return std::make_unique<FieldValue<T, V>>(field);
+                });
+            }
+            case TermKind::kCONSTANT:
+                return std::make_unique<ConstantValue<V>>(ConstantOf<V>(term.integer, term.real));
+            case TermKind::kNEGATE:
+                return std::make_unique<NegateValue<V>>(BuildValue<V>(term.lhs));
+            case TermKind::kARITH: {
+                std::unique_ptr<PredicateValue<V>> lhs = BuildValue<V>(term.lhs);
+                std::unique_ptr<PredicateValue<V>> rhs = BuildValue<V>(term.rhs);
+                switch (term.op) {
+                    case TokenType::kPLUS: return std::make_unique<ArithValue<V, Plus>>(std::move(lhs), std::move(rhs));
+                    case TokenType::kMINUS: return std::make_unique<ArithValue<V, Minus>>(std::move(lhs), std::move(rhs));
+                    default: return std::make_unique<ArithValue<V, Times>>(std::move(lhs), std::move(rhs));
+                }
+            }
+            default:
+                break;
+        }
+        if constexpr (std::is_same<V, double>::value)
+            return std::make_unique<ToRealValue>(BuildValue<int64_t>(term.lhs));
+        else
+            return std::make_unique<ConditionValue>(BuildClosure(index));
+    }
+}
+
+const FieldLayout* Predicate::LeafField(uint32_t index) const noexcept {
+    // The field a comparison reads directly, through a conversion to real or not
+    if (terms_[index].kind == TermKind::kTO_REAL)
+        index = terms_[index].lhs;
+    const Term& term = terms_[index];
+    if (term.kind != TermKind::kFIELD || term.type == ValueType::kSTRING)
+        return nullptr;
+    return &fields_[term.field];
+}
+
+/**
+ * Native code
+ *
+ * Conditions compile to branches like the Compiler's jump lists: a condition
+ * jumps to target when its value is jump_when and falls through otherwise.
+ * Integers are computed in rax and reals in xmm0, a leaf on the right of an
+ * operator loads straight into rcx or xmm1, anything else spills the left
+ * side to the red zone first. A null field jumps to the label that makes its
+ * comparison false.
+ */
+bool Predicate::SupportsNative(uint32_t index) const noexcept {
+    const Term& term = terms_[index];
+    switch (term.kind) {
+        case TermKind::kCOMPARE: {
+            if (terms_[term.lhs].type == ValueType::kSTRING || !SupportsNativeValue(term.lhs, 0))
+                return false;
+            return IsLeaf(term.rhs) ? SupportsNativeValue(term.rhs, 0) : SupportsNativeValue(term.rhs, 1);
+        }
+        case TermKind::kRANGE:
+            return terms_[term.lhs].type != ValueType::kSTRING && SupportsNativeValue(term.lhs, 0);
+        case TermKind::kTEST:
+            return SupportsNativeValue(term.lhs, 0);
+        case TermKind::kNOT:
+            return SupportsNative(term.lhs);
+        case TermKind::kAND:
+        case TermKind::kOR:
+            for (uint32_t operand : term.operands)
+                if (!SupportsNative(operand))
+                    return false;
+            return true;
+        default:
+            return term.kind == TermKind::kCONSTANT;
+    }
+}
+
+bool Predicate::SupportsNativeValue(uint32_t index, uint32_t slot) const noexcept {
+    const Term& term = terms_[index];
+    if (slot >= X64Emitter::MAX_SLOTS || term.type == ValueType::kSTRING)
+        return false;
+    switch (term.kind) {
+        case TermKind::kFIELD:
+        case TermKind::kCONSTANT:
+            return true;
+        case TermKind::kTO_REAL:
+        case TermKind::kNEGATE:
+            return SupportsNativeValue(term.lhs, slot);
+        case TermKind::kARITH:
+            if (!SupportsNativeValue(term.lhs, slot))
+                return false;
+            return IsLeaf(term.rhs) ? SupportsNativeValue(term.rhs, slot) : SupportsNativeValue(term.rhs, slot + 1);
+        default:
+            // Conditions used as values are left to the closures
+            return false;
+    }
+}
+
+bool Predicate::IsLeaf(uint32_t index) const noexcept {
+    const Term& term = terms_[index];
+    if (term.kind == TermKind::kTO_REAL)
+        return IsLeaf(term.lhs);
+    return term.kind == TermKind::kFIELD || term.kind == TermKind::kCONSTANT;
+}
+
+void Predicate::EmitCondition(X64Emitter& emitter, uint32_t index, bool jump_when, X64Emitter::Label target) const {
+    const Term& term = terms_[index];
+    switch (term.kind) {
+        case TermKind::kAND:
+        case TermKind::kOR: {
+            // a && b jumps when false as soon as either is false, a || b jumps when true as soon as either is true
+            bool short_circuit = term.kind == TermKind::kOR;
+            if (jump_when == short_circuit) {
+                for (uint32_t operand : term.operands)
+                    EmitCondition(emitter, operand, jump_when, target);
+            } else {
+                X64Emitter::Label skip = emitter.NewLabel();
+                for (size_t i = 0; i + 1 < term.operands.size(); ++i)
+                    EmitCondition(emitter, term.operands[i], short_circuit, skip);
+                EmitCondition(emitter, term.operands.back(), jump_when, target);
+                emitter.Bind(skip);
+            }
+            return;
+        }
+        case TermKind::kNOT:
+            EmitCondition(emitter, term.lhs, !jump_when, target);
+            return;
+        case TermKind::kCONSTANT:
+            if ((term.integer != 0) == jump_when)
+                emitter.Jump(target);
+            return;
+        default:
+            break;
+    }
+
+    // A null read makes the condition false
+    X64Emitter::Label skip = emitter.NewLabel();
+    X64Emitter::Label null = jump_when ? skip : target;
+    ValueType type = terms_[term.lhs].type;
+    if (term.kind == TermKind::kTEST) {
+        EmitInteger(emitter, term.lhs, kRAX, 0, null);
+        emitter.Test(kRAX, kRAX);
+        emitter.JumpIf(jump_when ? X64Cond::kNE : X64Cond::kE, target);
+    } else if (term.kind == TermKind::kCOMPARE) {
+        if (type == ValueType::kREAL) {
+            EmitReal(emitter, term.lhs, kXMM0, 0, null);
+            if (IsLeaf(term.rhs)) {
+                EmitReal(emitter, term.rhs, kXMM1, 0, null);
+            } else {
+                emitter.SpillDouble(kXMM0, 0);
+                EmitReal(emitter, term.rhs, kXMM0, 1, null);
+                emitter.MoveDouble(kXMM1, kXMM0);
+                emitter.ReloadDouble(kXMM0, 0);
+            }
+        } else {
+            EmitInteger(emitter, term.lhs, kRAX, 0, null);
+            const Term& rhs = terms_[term.rhs];
+            if (rhs.kind == TermKind::kCONSTANT && rhs.integer >= INT32_MIN && rhs.integer <= INT32_MAX) {
+                emitter.CompareImmediate(kRAX, static_cast<int32_t>(rhs.integer));
+            } else if (IsLeaf(term.rhs)) {
+                EmitInteger(emitter, term.rhs, kRCX, 0, null);
+                emitter.Compare(kRAX, kRCX);
+            } else {
+                emitter.Spill(kRAX, 0);
+                EmitInteger(emitter, term.rhs, kRAX, 1, null);
+                emitter.Reload(kRCX, 0);
+                emitter.Compare(kRCX, kRAX);
+            }
+        }
+        EmitCompareJump(emitter, term.op, type, jump_when, target);
+    } else {
+        // A range loads its target once and compares it against each constant bound
+        TokenType lower_op = (term.flags & kAST_LOWER_INCLUSIVE) ? TokenType::kGTE : TokenType::kGT;
+        TokenType upper_op = (term.flags & kAST_UPPER_INCLUSIVE) ? TokenType::kLTE : TokenType::kLT;
+        if (type == ValueType::kREAL)
+            EmitReal(emitter, term.lhs, kXMM0, 0, null);
+        else
+            EmitInteger(emitter, term.lhs, kRAX, 0, null);
+        auto bound = [&](uint32_t bound, TokenType op, bool bound_jump_when, X64Emitter::Label bound_target) {
+            const Term& constant = terms_[bound];
+            if (type == ValueType::kREAL) {
+                EmitReal(emitter, bound, kXMM1, 0, null);
+            } else if (constant.integer >= INT32_MIN && constant.integer <= INT32_MAX) {
+                emitter.CompareImmediate(kRAX, static_cast<int32_t>(constant.integer));
+            } else {
+                emitter.MoveImmediate(kRCX, constant.integer);
+                emitter.Compare(kRAX, kRCX);
+            }
+            EmitCompareJump(emitter, op, type, bound_jump_when, bound_target);
+        };
+        if (jump_when) {
+            if (term.rhs != NO_TERM && term.upper != NO_TERM) {
+                bound(term.rhs, lower_op, false, skip);
+                bound(term.upper, upper_op, true, target);
+            } else if (term.rhs != NO_TERM) {
+                bound(term.rhs, lower_op, true, target);
+            } else {
+                bound(term.upper, upper_op, true, target);
+            }
+        } else {
+            if (term.rhs != NO_TERM)
+                bound(term.rhs, lower_op, false, target);
+            if (term.upper != NO_TERM)
+                bound(term.upper, upper_op, false, target);
+        }
+    }
+    emitter.Bind(skip);
+}
+
+void Predicate::EmitCompareJump(X64Emitter& emitter, TokenType op, ValueType type, bool jump_when,
+                                X64Emitter::Label target) const {
+    if (type != ValueType::kREAL) {
+        // The flags are already set from lhs - rhs
+        X64Cond cond;
+        switch (jump_when ? op : NegateComparison(op)) {
+            case TokenType::kEQUALITY: cond = X64Cond::kE; break;
+            case TokenType::kDNE: cond = X64Cond::kNE; break;
+            case TokenType::kLT: cond = X64Cond::kL; break;
+            case TokenType::kLTE: cond = X64Cond::kLE; break;
+            case TokenType::kGT: cond = X64Cond::kG; break;
+            default: cond = X64Cond::kGE; break;
+        }
+        emitter.JumpIf(cond, target);
+        return;
+    }
+
+    // xmm0 op xmm1. Unordered sets ZF, PF and CF, so every ordered test is written as "above" on the
+    // operands it needs and is false for NaN, and its inverse is true for NaN like !(a < b) in the VM.
+    switch (op) {
+        case TokenType::kGT:
+        case TokenType::kGTE:
+        case TokenType::kLT:
+        case TokenType::kLTE: {
+            bool greater = op == TokenType::kGT || op == TokenType::kGTE;
+            bool inclusive = op == TokenType::kGTE || op == TokenType::kLTE;
+            if (greater)
+                emitter.CompareDouble(kXMM0, kXMM1);
+            else
+                emitter.CompareDouble(kXMM1, kXMM0);
+            if (jump_when)
+                emitter.JumpIf(inclusive ? X64Cond::kAE : X64Cond::kA, target);
+            else
+                emitter.JumpIf(inclusive ? X64Cond::kB : X64Cond::kBE, target);
+            return;
+        }
+        default: {
+            emitter.CompareDouble(kXMM0, kXMM1);
+            bool equal = (op == TokenType::kEQUALITY) == jump_when;
+            if (equal) {
+                // Jump when ordered and equal
+                X64Emitter::Label skip = emitter.NewLabel();
+                emitter.JumpIf(X64Cond::kP, skip);
+                emitter.JumpIf(X64Cond::kE, target);
+                emitter.Bind(skip);
+            } else {
+                emitter.JumpIf(X64Cond::kP, target);
+                emitter.JumpIf(X64Cond::kNE, target);
+            }
+            return;
+        }
+    }
+}
+
+void Predicate::EmitInteger(X64Emitter& emitter, uint32_t index, X64Reg dst, uint32_t slot,
+                            X64Emitter::Label null) const {
+    const Term& term = terms_[index];
+    switch (term.kind) {
+        case TermKind::kFIELD: {
+            const FieldLayout& field = fields_[term.field];
+            EmitNullCheck(emitter, field, null);
+            switch (field.type) {
+                case FieldType::kBYTE:
+                    if (field.is_signed)
+                        emitter.LoadSigned8(dst, field.offset);
+                    else
+                        emitter.LoadUnsigned8(dst, field.offset);
+                    break;
+                case FieldType::kSHORT:
+                    if (field.is_signed)
+                        emitter.LoadSigned16(dst, field.offset);
+                    else
+                        emitter.LoadUnsigned16(dst, field.offset);
+                    break;
+                case FieldType::kINT:
+                    if (field.is_signed)
+                        emitter.LoadSigned32(dst, field.offset);
+                    else
+                        emitter.LoadUnsigned32(dst, field.offset);
+                    break;
+                case FieldType::kBOOL:
+                    emitter.LoadUnsigned8(dst, field.offset);
+                    break;
+                default:
+                    emitter.Load64(dst, field.offset);
+                    break;
+            }
+            return;
+        }
+        case TermKind::kCONSTANT:
+            emitter.MoveImmediate(dst, term.integer);
+            return;
+        case TermKind::kNEGATE:
+            EmitInteger(emitter, term.lhs, kRAX, slot, null);
+            emitter.Neg(kRAX);
+            return;
+        default:
+            break;
+    }
+
+    // lhs in rax, rhs in rcx
+    EmitInteger(emitter, term.lhs, kRAX, slot, null);
+    if (IsLeaf(term.rhs)) {
+        EmitInteger(emitter, term.rhs, kRCX, slot, null);
+    } else {
+        emitter.Spill(kRAX, slot);
+        EmitInteger(emitter, term.rhs, kRAX, slot + 1, null);
+        emitter.Move(kRCX, kRAX);
+        emitter.Reload(kRAX, slot);
+    }
+    switch (term.op) {
+        case TokenType::kPLUS: emitter.Add(kRAX, kRCX); break;
+        case TokenType::kMINUS: emitter.Sub(kRAX, kRCX); break;
+        default: emitter.Mul(kRAX, kRCX); break;
+    }
+}
+
+void Predicate::EmitReal(X64Emitter& emitter, uint32_t index, X64Reg dst, uint32_t slot, X64Emitter::Label null) const {
+    const Term& term = terms_[index];
+    // Leaves loading into xmm1 keep off rax and xmm0, which may hold the left side
+    X64Reg scratch = (dst == kXMM0) ? kRAX : kRCX;
+    switch (term.kind) {
+        case TermKind::kFIELD: {
+            const FieldLayout& field = fields_[term.field];
+            EmitNullCheck(emitter, field, null);
+            if (field.type == FieldType::kFLOAT)
+                emitter.LoadFloat(dst, field.offset);
+            else
+                emitter.LoadDouble(dst, field.offset);
+            return;
+        }
+        case TermKind::kCONSTANT: {
+            int64_t bits;
+            memcpy(&bits, &term.real, sizeof(bits));
+            emitter.MoveImmediate(scratch, bits);
+            emitter.MoveToXmm(dst, scratch);
+            return;
+        }
+        case TermKind::kTO_REAL:
+            EmitInteger(emitter, term.lhs, scratch, slot, null);
+            emitter.IntToDouble(dst, scratch);
+            return;
+        case TermKind::kNEGATE:
+            EmitReal(emitter, term.lhs, kXMM0, slot, null);
+            emitter.MoveImmediate(kRAX, INT64_MIN);
+            emitter.MoveToXmm(kXMM1, kRAX);
+            emitter.XorDouble(kXMM0, kXMM1);
+            return;
+        default:
+            break;
+    }
+
+    // lhs in xmm0, rhs in xmm1
+    EmitReal(emitter, term.lhs, kXMM0, slot, null);
+    if (IsLeaf(term.rhs)) {
+        EmitReal(emitter, term.rhs, kXMM1, slot, null);
+    } else {
+        emitter.SpillDouble(kXMM0, slot);
+        EmitReal(emitter, term.rhs, kXMM0, slot + 1, null);
+        emitter.MoveDouble(kXMM1, kXMM0);
+        emitter.ReloadDouble(kXMM0, slot);
+    }
+    switch (term.op) {
+        case TokenType::kPLUS: emitter.AddDouble(kXMM0, kXMM1); break;
+        case TokenType::kMINUS: emitter.SubDouble(kXMM0, kXMM1); break;
+        default: emitter.MulDouble(kXMM0, kXMM1); break;
+    }
+}
+
+void Predicate::EmitNullCheck(X64Emitter& emitter, const FieldLayout& field, X64Emitter::Label null) const {
+    uint8_t mask = NullMask(field);
+    if (mask == 0)
+        return;
+    emitter.TestByte(field.null_offset, mask);
+    emitter.JumpIf(X64Cond::kNE, null);
+}
@@ -0,0 +1,190 @@
+#ifndef DT_SRC_VM_PREDICATE_H
+#define DT_SRC_VM_PREDICATE_H
+
+// C++ Includes
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Local Includes
+#include "parser/ast.h"
+#include "schema/catalog.h"
+#include "vm/bytecode.h"
+#include "vm/vm.h"
+#include "vm/x64emitter.h"
+
+/**
+ * @brief How a Predicate evaluates a record
+ */
+enum class PredicateMode : uint8_t {
+    kINTERPRET,     // Walk the resolved tree, switching on every node and field type
+    kCLOSURE,       // A tree of closures specialized to each field's type and offset
+    kNATIVE         // x86-64 machine code, kCLOSURE where the platform or the predicate is not supported
+};
+
+// Closures of kCLOSURE, see predicate.cpp
+class PredicateClosure;
+template <typename V>
+class PredicateValue;
+
+/**
+ * @brief A filter over the records of one layout for scans of non-indexed fields
+ *
+ * The expression is resolved once against the layout: identifiers and member
+ * paths become field offsets, parameters become constants and every operator
+ * gets its static type, following the VM's rules. Comparisons reading a null
+ * field are false. The supported expressions are field reads, literals,
+ * parameters, + - * and unary minus, comparisons, !, && and || and the
+ * optimizer's ranges; / and % are left out so a row can never fail.
+ *
+ * A record is the bytes RecordBuilder::Finish() lays out, a record of a
+ * derived struct matches like one of the predicate's layout since it starts
+ * with it byte for byte.
+ */
+class Predicate {
+public:
+    /**
+     * Tors
+     */
+    Predicate() noexcept;
+    ~Predicate() noexcept;
+
+    /**
+     * NON-COPYABLE
+     */
+    Predicate(const Predicate&) = delete;
+    Predicate(Predicate&&) = delete;
+    Predicate& operator=(const Predicate&) = delete;
+
+    /**
+     * @brief Compile a boolean expression over the fields of a layout, replacing any previous one
+     * @param expression Usually run through the Optimizer first, which folds constants and builds ranges
+     * @param arguments Values of the expression's kPARAMETER nodes by index
+     * @throws VmException for unknown fields, type errors and unsupported expressions
+     */
+    void Compile(const AstNode* expression, const SchemaCatalog& catalog, uint32_t type_id, PredicateMode mode,
+                 const std::vector<Argument>& arguments = {});
+
+    /**
+     * @brief The mode records are evaluated with, kNATIVE falls back to kCLOSURE
+     */
+    PredicateMode Mode() const noexcept;
+
+    /**
+     * @brief Whether a record passes the predicate
+     */
+    bool Matches(const uint8_t* record) const noexcept;
+
+    /**
+     * @brief Append the index of every matching record to selected
+     * @return Records that matched
+     */
+    size_t Select(const uint8_t* const* records, size_t count, std::vector<uint32_t>& selected) const;
+
+    /**
+     * @brief Count the matching records
+     */
+    size_t Count(const uint8_t* const* records, size_t count) const noexcept;
+
+    /**
+     * @brief Bytes of machine code, 0 unless the mode is kNATIVE
+     */
+    size_t CodeSize() const noexcept;
+
+private:
+    using NativeFunction = bool (*)(const uint8_t* record);
+
+    enum class TermKind : uint8_t {
+        kFIELD,     // field
+        kCONSTANT,  // integer, real or string
+        kTO_REAL,   // lhs converted to a real
+        kNEGATE,    // -lhs
+        kARITH,     // lhs op rhs, + - or *
+        kCOMPARE,   // lhs op rhs
+        kRANGE,     // lower <(=) lhs <(=) upper, bounds are constants or NO_TERM
+        kNOT,       // !lhs
+        kAND,       // every operand
+        kOR,        // any operand
+        kTEST       // lhs != 0, an integer or bool used as a condition
+    };
+
+    /**
+     * @brief One resolved, statically typed node, children are indexes into terms_
+     */
+    struct Term {
+        TermKind kind;
+        ValueType type;         // kINT, kREAL, kBOOL or kSTRING
+        TokenType op;
+        uint16_t flags;         // kAST_*_INCLUSIVE of a kRANGE
+        uint32_t lhs;
+        uint32_t rhs;
+        uint32_t upper;
+        uint32_t field;         // Index into fields_
+        int64_t integer;        // Also 0 or 1 for a kBOOL constant
+        double real;
+        std::string string;
+        std::vector<uint32_t> operands;
+    };
+
+    /**
+     * Resolution
+     */
+    uint32_t Resolve(const AstNode* node);
+    uint32_t ResolveCondition(const AstNode* node);
+    uint32_t ResolveField(const AstNode* node);
+    uint32_t ResolveLiteral(const AstNode* node, bool negate);
+    uint32_t ResolveParameter(const AstNode* node);
+    uint32_t ResolveUnary(const AstNode* node);
+    uint32_t ResolveBinary(const AstNode* node);
+    uint32_t ResolveRange(const AstNode* node);
+    uint32_t ToReal(uint32_t term);
+    uint32_t AddTerm(TermKind kind, ValueType type, uint32_t lhs = NO_TERM, uint32_t rhs = NO_TERM);
+    [[noreturn]] void Error(const AstNode* node, const std::string& msg) const;
+
+    /**
+     * Interpretation, false when a field read is null
+     */
+    bool Evaluate(uint32_t term, const uint8_t* record) const noexcept;
+    bool EvaluateInteger(uint32_t term, const uint8_t* record, int64_t& value) const noexcept;
+    bool EvaluateReal(uint32_t term, const uint8_t* record, double& value) const noexcept;
+    bool EvaluateString(uint32_t term, const uint8_t* record, std::string_view& value) const noexcept;
+
+    /**
+     * Closures
+     */
+    std::unique_ptr<PredicateClosure> BuildClosure(uint32_t term) const;
+    std::unique_ptr<PredicateClosure> BuildCompare(TokenType op, uint32_t lhs, uint32_t rhs) const;
+    std::unique_ptr<PredicateClosure> BuildRange(const Term& term) const;
+    template <typename V>
+    std::unique_ptr<PredicateValue<V>> BuildValue(uint32_t term) const;
+    const FieldLayout* LeafField(uint32_t term) const noexcept;
+
+    /**
+     * Native code
+     */
+    bool SupportsNative(uint32_t term) const noexcept;
+    bool SupportsNativeValue(uint32_t term, uint32_t slot) const noexcept;
+    bool IsLeaf(uint32_t term) const noexcept;
+    void EmitCondition(X64Emitter& emitter, uint32_t term, bool jump_when, X64Emitter::Label target) const;
+    void EmitCompareJump(X64Emitter& emitter, TokenType op, ValueType type, bool jump_when, X64Emitter::Label target) const;
+    void EmitInteger(X64Emitter& emitter, uint32_t term, X64Reg dst, uint32_t slot, X64Emitter::Label null) const;
+    void EmitReal(X64Emitter& emitter, uint32_t term, X64Reg dst, uint32_t slot, X64Emitter::Label null) const;
+    void EmitNullCheck(X64Emitter& emitter, const FieldLayout& field, X64Emitter::Label null) const;
+
+    static constexpr uint32_t NO_TERM = UINT32_MAX;
+
+    const SchemaCatalog* catalog_;
+    uint32_t type_id_;
+    const std::vector<Argument>* arguments_;
+    std::vector<Term> terms_;
+    std::vector<FieldLayout> fields_;
+    uint32_t root_;
+    PredicateMode mode_;
+    std::unique_ptr<PredicateClosure> closure_;
+    NativeCode code_;
+    NativeFunction native_;
+};
+
+#endif
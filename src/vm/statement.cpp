@@ -0,0 +1,94 @@
+// C++ Includes
+#include <cstdint>
+#include <string>
+#include <utility>
+
+// Local Includes
+#include "exception/vm_exception.h"
+#include "compiler.h"
+#include "statement.h"
+
+PreparedStatement::PreparedStatement(std::shared_ptr<StatementPlan> plan)
+: plan_(std::move(plan)), arguments_(plan_->parameters.size(), Argument{ValueType::kVOID, 0, 0.0, std::string()}),
+  program_(nullptr)
+{}
+
+PreparedStatement::~PreparedStatement() noexcept {}
+
+/**
+ * Parameters
+ */
+size_t PreparedStatement::ParameterCount() const noexcept {
+    return arguments_.size();
+}
+
+size_t PreparedStatement::ParameterIndex(std::string_view name) const {
+    if (!name.empty() && name.front() == '$')
+        name.remove_prefix(1);
+    for (size_t i = 0; i < plan_->parameters.size(); ++i) {
+        if (!name.empty() && plan_->parameters[i] == name)
+            return i;
+    }
+    throw VmException("Unknown parameter $" + std::string(name));
+}
+
+void PreparedStatement::BindInteger(size_t index, int64_t value) {
+    Bind(index, ValueType::kINT).integer = value;
+}
+
+void PreparedStatement::BindReal(size_t index, double value) {
+    Bind(index, ValueType::kREAL).real = value;
+}
+
+void PreparedStatement::BindBool(size_t index, bool value) {
+    Bind(index, ValueType::kBOOL).integer = value ? 1 : 0;
+}
+
+void PreparedStatement::BindString(size_t index, std::string_view value) {
+    Bind(index, ValueType::kSTRING).string.assign(value.data(), value.size());
+}
+
+void PreparedStatement::ClearBindings() noexcept {
+    for (Argument& arg : arguments_)
+        arg.type = ValueType::kVOID;
+    program_ = nullptr;
+}
+
+Argument& PreparedStatement::Bind(size_t index, ValueType type) {
+    if (index >= arguments_.size())
+        throw VmException("Parameter " + std::to_string(index) + " is out of range, the statement has " +
+                          std::to_string(arguments_.size()));
+    Argument& arg = arguments_[index];
+    if (arg.type != type) {
+        arg.type = type;
+        program_ = nullptr;
+    }
+    return arg;
+}
+
+/**
+ * Execution
+ */
+void PreparedStatement::Execute(Vm& vm) {
+    if (program_ == nullptr) {
+        std::string key(arguments_.size(), '\0');
+        std::vector<ValueType> types(arguments_.size());
+        for (size_t i = 0; i < arguments_.size(); ++i) {
+            if (arguments_[i].type == ValueType::kVOID)
+                throw VmException("Parameter " + std::to_string(i) + " is not bound");
+            types[i] = arguments_[i].type;
+            key[i] = static_cast<char>(types[i]);
+        }
+        auto it = plan_->programs.find(key);
+        if (it == plan_->programs.end()) {
+            Compiler compiler;
+            it = plan_->programs.emplace(std::move(key), compiler.Compile(plan_->root, *plan_->catalog, types)).first;
+        }
+        program_ = &it->second;
+    }
+    vm.Run(*program_, arguments_);
+}
+
+const StatementPlan& PreparedStatement::Plan() const noexcept {
+    return *plan_;
+}
@@ -0,0 +1,106 @@
+#ifndef DT_SRC_VM_STATEMENT_H
+#define DT_SRC_VM_STATEMENT_H
+
+// C++ Includes
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Local Includes
+#include "parser/arena.h"
+#include "parser/ast.h"
+#include "schema/catalog.h"
+#include "vm/bytecode.h"
+#include "vm/vm.h"
+
+/**
+ * @brief A parsed statement shared by every PreparedStatement made from the same text
+ *
+ * The tree is parsed once, a Program is compiled for each combination of bound
+ * types the first time it runs, so "x = ?" bound to an int and to a double
+ * each get typed opcodes instead of a conversion at run time.
+ */
+struct StatementPlan {
+    std::string text;                                   // Normalized text, the cache key
+    Arena arena;                                        // Owns root and parameters
+    const AstNode* root;
+    std::vector<std::string_view> parameters;           // Names by index, empty for ?
+    const SchemaCatalog* catalog;
+    std::unordered_map<std::string, Program> programs;  // Keyed by the bound types, one byte each
+
+    StatementPlan() noexcept : text(), arena(4096), root(nullptr), parameters(), catalog(nullptr), programs() {}
+};
+
+/**
+ * @brief A compiled statement with its own parameter bindings
+ *
+ * Binding stores a typed value in place, nothing is lexed or parsed again.
+ * Parameters are numbered from 0 in order of first appearance, a $name used
+ * twice is one parameter. Copies share the plan but not the bindings.
+ */
+class PreparedStatement {
+public:
+    /**
+     * Tors
+     */
+    explicit PreparedStatement(std::shared_ptr<StatementPlan> plan);
+    ~PreparedStatement() noexcept;
+
+    PreparedStatement(const PreparedStatement&) = default;
+    PreparedStatement(PreparedStatement&&) noexcept = default;
+    PreparedStatement& operator=(const PreparedStatement&) = default;
+    PreparedStatement& operator=(PreparedStatement&&) noexcept = default;
+
+    /**
+     * Parameters
+     */
+    size_t ParameterCount() const noexcept;
+
+    /**
+     * @brief Index of a $name parameter
+     * @throws VmException when the statement has no parameter of that name
+     */
+    size_t ParameterIndex(std::string_view name) const;
+
+    /**
+     * @brief Bind a value to a parameter, replacing any earlier binding
+     * @throws VmException when index is out of range
+     */
+    void BindInteger(size_t index, int64_t value);
+    void BindReal(size_t index, double value);
+    void BindBool(size_t index, bool value);
+    void BindString(size_t index, std::string_view value);
+
+    /**
+     * @brief Unbind every parameter
+     */
+    void ClearBindings() noexcept;
+
+    /**
+     * Execution
+     */
+
+    /**
+     * @brief Run the statement with the current bindings
+     * @throws VmException when a parameter is unbound, the statement does not compile for the bound types, or on a
+     *         runtime error
+     */
+    void Execute(Vm& vm);
+
+    /**
+     * @brief The shared plan, its programs are compiled as Execute() needs them
+     */
+    const StatementPlan& Plan() const noexcept;
+
+private:
+    Argument& Bind(size_t index, ValueType type);
+
+    std::shared_ptr<StatementPlan> plan_;
+    std::vector<Argument> arguments_;   // kVOID while unbound
+    const Program* program_;            // Program of the bound types, null after a binding changes type
+};
+
+#endif
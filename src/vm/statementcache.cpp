@@ -0,0 +1,142 @@
+// C++ Includes
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <utility>
+
+// Local Includes
+#include "exception/vm_exception.h"
+#include "statementcache.h"
+
+// Exact texts remembered per plan, past this only the normalized text finds it
+#define MAX_ALIASES 4
+
+StatementCache::StatementCache(const SchemaCatalog& catalog, size_t capacity)
+: catalog_(catalog), capacity_((capacity == 0) ? 1 : capacity), entries_(), index_(), alias_index_(), tokenizer_(),
+  tokens_(), parser_(), optimizer_(), hits_(0), misses_(0), evictions_(0)
+{}
+
+StatementCache::~StatementCache() noexcept {}
+
+PreparedStatement StatementCache::Prepare(std::string_view text) {
+    // Fast path, this exact text was prepared before
+    auto alias = alias_index_.find(text);
+    if (alias != alias_index_.end()) {
+        ++hits_;
+        Touch(alias->second);
+        return PreparedStatement(alias->second->plan);
+    }
+
+    tokenizer_.OpenView(text);
+    tokenizer_.Tokenize(tokens_);
+    std::string normalized = Normalize(tokens_);
+    auto found = index_.find(normalized);
+    if (found != index_.end()) {
+        ++hits_;
+        Touch(found->second);
+        AddAlias(found->second, text);
+        return PreparedStatement(found->second->plan);
+    }
+
+    ++misses_;
+    auto plan = std::make_shared<StatementPlan>();
+    plan->text = std::move(normalized);
+    plan->catalog = &catalog_;
+    plan->root = optimizer_.Optimize(parser_.Parse(tokens_, plan->arena), plan->arena);
+    for (const AstNode* child = plan->root->first_child; child != nullptr; child = child->next_sibling) {
+        if (child->kind == AstKind::kSTRUCT_DECL)
+            throw VmException("Line " + std::to_string(child->line) + ": Statements cannot declare structs");
+    }
+    plan->parameters = parser_.Parameters();
+
+    if (entries_.size() >= capacity_)
+        Evict();
+    entries_.push_front({plan, {}});
+    entries_.front().aliases.reserve(MAX_ALIASES);
+    index_.emplace(plan->text, entries_.begin());
+    AddAlias(entries_.begin(), text);
+    return PreparedStatement(std::move(plan));
+}
+
+void StatementCache::Clear() noexcept {
+    entries_.clear();
+    index_.clear();
+    alias_index_.clear();
+}
+
+/**
+ * Stats
+ */
+uint64_t StatementCache::Hits() const noexcept {
+    return hits_;
+}
+
+uint64_t StatementCache::Misses() const noexcept {
+    return misses_;
+}
+
+uint64_t StatementCache::Evictions() const noexcept {
+    return evictions_;
+}
+
+size_t StatementCache::Size() const noexcept {
+    return entries_.size();
+}
+
+size_t StatementCache::Capacity() const noexcept {
+    return capacity_;
+}
+
+void StatementCache::Touch(EntryList::iterator entry) noexcept {
+    // Splicing keeps every iterator in the indexes valid
+    entries_.splice(entries_.begin(), entries_, entry);
+}
+
+void StatementCache::AddAlias(EntryList::iterator entry, std::string_view text) {
+    if (entry->aliases.size() >= MAX_ALIASES)
+        return;
+    entry->aliases.emplace_back(text);
+    alias_index_.emplace(entry->aliases.back(), entry);
+}
+
+void StatementCache::Evict() {
+    EntryList::iterator victim = std::prev(entries_.end());
+    for (const std::string& text : victim->aliases)
+        alias_index_.erase(text);
+    index_.erase(victim->plan->text);
+    entries_.erase(victim);
+    ++evictions_;
+}
+
+std::string StatementCache::Normalize(const TokenBuffer& tokens) {
+    std::string out;
+    for (size_t i = 0; i < tokens.Size() && tokens.Type(i) != TokenType::kEOF; ++i) {
+        if (!out.empty())
+            out += ' ';
+        std::string_view value = tokens.Value(i);
+        switch (tokens.Type(i)) {
+            case TokenType::kSTRING_LITERAL: {
+                // Values are decoded, escape them again so the key stays unambiguous
+                out += '"';
+                for (char c : value) {
+                    if (c == '"' || c == '\\')
+                        out += '\\';
+                    out += c;
+                }
+                out += '"';
+            } break;
+            case TokenType::kPLACEHOLDER: {
+                if (value.empty()) {
+                    out += '?';
+                } else {
+                    out += '$';
+                    out += value;
+                }
+            } break;
+            default: {
+                out += value;
+            }
+        }
+    }
+    return out;
+}
@@ -0,0 +1,107 @@
+#ifndef DT_SRC_VM_STATEMENTCACHE_H
+#define DT_SRC_VM_STATEMENTCACHE_H
+
+// C++ Includes
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Local Includes
+#include "parser/optimizer.h"
+#include "parser/parser.h"
+#include "parser/tokenbuffer.h"
+#include "parser/tokenizer.h"
+#include "schema/catalog.h"
+#include "vm/statement.h"
+
+/**
+ * @brief LRU cache of statement plans keyed by normalized statement text
+ *
+ * Texts differing only in whitespace and comments normalize to
+ * the same key and share a plan. The exact texts already seen map straight to
+ * their plan, so a repeated Prepare() does not lex at all. Evicted plans stay
+ * alive for the PreparedStatements still holding them. Not thread safe.
+ */
+class StatementCache {
+public:
+    /**
+     * Tors
+     */
+
+    /**
+     * @param catalog Layouts the statements are compiled against, it must outlive the cache
+     * @param capacity Plans kept before the least recently used one is evicted
+     */
+    explicit StatementCache(const SchemaCatalog& catalog, size_t capacity = 256);
+    ~StatementCache() noexcept;
+
+    /**
+     * NON-COPYABLE
+     */
+    StatementCache(const StatementCache&) = delete;
+    StatementCache(StatementCache&&) = delete;
+    StatementCache& operator=(const StatementCache&) = delete;
+
+    /**
+     * @brief A statement for text with no parameters bound, parsed on a miss
+     * @throws TokenException or ParseException when text does not parse
+     * @throws VmException when text declares a struct
+     */
+    PreparedStatement Prepare(std::string_view text);
+
+    /**
+     * @brief Drop every plan, needed after the catalog changes
+     */
+    void Clear() noexcept;
+
+    /**
+     * Stats
+     */
+    uint64_t Hits() const noexcept;
+    uint64_t Misses() const noexcept;
+    uint64_t Evictions() const noexcept;
+    size_t Size() const noexcept;
+    size_t Capacity() const noexcept;
+
+private:
+    struct Entry {
+        std::shared_ptr<StatementPlan> plan;
+        std::vector<std::string> aliases;   // Exact texts in alias_index_, reserved up front so keys never move
+    };
+    using EntryList = std::list<Entry>;
+
+    /**
+     * @brief Mark entry most recently used
+     */
+    void Touch(EntryList::iterator entry) noexcept;
+
+    /**
+     * @brief Map an exact text to entry, up to a few per entry so variants cannot grow the index without bound
+     */
+    void AddAlias(EntryList::iterator entry, std::string_view text);
+    void Evict();
+
+    /**
+     * @brief Join the tokens with single spaces, strings quoted again
+     */
+    static std::string Normalize(const TokenBuffer& tokens);
+
+    const SchemaCatalog& catalog_;
+    size_t capacity_;
+    EntryList entries_;                                                 // Most recently used first
+    std::unordered_map<std::string_view, EntryList::iterator> index_;   // Keys view their plan's text
+    std::unordered_map<std::string_view, EntryList::iterator> alias_index_;
+    Tokenizer tokenizer_;
+    TokenBuffer tokens_;
+    Parser parser_;
+    Optimizer optimizer_;
+    uint64_t hits_;
+    uint64_t misses_;
+    uint64_t evictions_;
+};
+
+#endif
@@ -0,0 +1,477 @@
+// C++ Includes
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// Local Includes
+#include "exception/schema_exception.h"
+#include "exception/vm_exception.h"
+#include "vm.h"
+
+// Most registers of all live frames together, runaway recursion stops here instead of exhausting memory
+#define MAX_STACK (1u << 22)
+
+// Most live frames, a call whose result lands in register 0 reuses the caller's base and would never reach MAX_STACK
+#define MAX_DEPTH (1u << 20)
+
+// Computed goto gives every opcode its own indirect branch, which predicts far better than one shared switch
+#if defined(__GNUC__) && !defined(DT_VM_NO_COMPUTED_GOTO)
+#define DT_VM_COMPUTED_GOTO
+#endif
+
+/**
+ * Integer arithmetic wraps like the hardware instead of being undefined
+ */
+static inline int64_t WrapAdd(int64_t x, int64_t y) noexcept {
+    return static_cast<int64_t>(static_cast<uint64_t>(x) + static_cast<uint64_t>(y));
+}
+
+static inline int64_t WrapSub(int64_t x, int64_t y) noexcept {
+    return static_cast<int64_t>(static_cast<uint64_t>(x) - static_cast<uint64_t>(y));
+}
+
+static inline int64_t WrapMul(int64_t x, int64_t y) noexcept {
+    return static_cast<int64_t>(static_cast<uint64_t>(x) * static_cast<uint64_t>(y));
+}
+
+Vm::Vm(std::ostream& out)
+: out_(out), values_(), strings_(), records_(), frames_(), calls_(0)
+{}
+
+Vm::~Vm() noexcept {}
+
+void Vm::Run(const Program& program) {
+    Run(program, {});
+}
+
+void Vm::Run(const Program& program, const std::vector<Argument>& arguments) {
+    if (arguments.size() != program.parameters.size())
+        throw VmException("Expected " + std::to_string(program.parameters.size()) + " arguments, got " +
+                          std::to_string(arguments.size()));
+    // Records of an earlier program may point at layouts that are gone
+    values_.clear();
+    strings_.clear();
+    records_.clear();
+    frames_.clear();
+    calls_ = 0;
+    Reserve(static_cast<uint32_t>(arguments.size()));
+    for (size_t i = 0; i < arguments.size(); ++i) {
+        const Argument& arg = arguments[i];
+        if (arg.type != program.parameters[i])
+            throw VmException("Argument " + std::to_string(i + 1) + " does not match its parameter's type");
+        switch (arg.type) {
+            case ValueType::kREAL: {
+                values_[i].r = arg.real;
+            } break;
+            case ValueType::kSTRING: {
+                strings_[i] = arg.string;
+            } break;
+            case ValueType::kBOOL: {
+                values_[i].i = (arg.integer != 0) ? 1 : 0;
+            } break;
+            default: {
+                values_[i].i = arg.integer;
+            }
+        }
+    }
+    Execute(program, 0, 0);
+    if (program.main >= 0)
+        Execute(program, static_cast<uint32_t>(program.main), 0);
+}
+
+uint64_t Vm::Calls() const noexcept {
+    return calls_;
+}
+
+void Vm::Reserve(uint32_t size) {
+    if (size <= values_.size())
+        return;
+    size_t capacity = std::max<size_t>(std::max<size_t>(size, values_.size() * 2), 256);
+    values_.resize(capacity);
+    strings_.resize(capacity);
+    records_.resize(capacity);
+}
+
+void Vm::Error(const Function& function, const Instruction* pc, const std::string& msg) {
+    uint32_t line = function.lines[pc - function.code.data()];
+    throw VmException("Line " + std::to_string(line) + ": " + msg);
+}
+
+void Vm::Execute(const Program& program, uint32_t index, uint32_t base) {
+    const Function* function = &program.functions[index];
+    const Instruction* pc = function->code.data();
+    Reserve(base + function->registers);
+    Value* regs = values_.data() + base;
+    std::string* strs = strings_.data() + base;
+    std::unique_ptr<RecordBuilder>* recs = records_.data() + base;
+    size_t depth = frames_.size();
+    ++calls_;
+
+#ifdef DT_VM_COMPUTED_GOTO
+#define DT_OPCODE_LABEL(name) &&op_##name,
+    static const void* const labels[] = {
+        DT_OPCODES(DT_OPCODE_LABEL)
+    };
+#undef DT_OPCODE_LABEL
+#define OP(name) op_##name:
+#define DISPATCH() goto *labels[static_cast<uint8_t>(pc->op)]
+#define NEXT() do { ++pc; DISPATCH(); } while (0)
+#define JUMP() do { pc = function->code.data() + pc->c; DISPATCH(); } while (0)
+#else
+// No do-while here, continue has to reach the dispatch loop
+#define OP(name) case Opcode::name:
+#define DISPATCH() continue
+#define NEXT() { ++pc; continue; }
+#define JUMP() { pc = function->code.data() + pc->c; continue; }
+#endif
+#define FIELD(operand) program.fields[pc->operand]
+
+    try {
+#ifdef DT_VM_COMPUTED_GOTO
+        DISPATCH();
+#else
+        for (;;) switch (pc->op) {
+#endif
+        OP(kMOVE) {
+            regs[pc->a] = regs[pc->b];
+            NEXT();
+        }
+        OP(kMOVE_STR) {
+            strs[pc->a] = strs[pc->b];
+            NEXT();
+        }
+        OP(kMOVE_REC) {
+            recs[pc->a] = std::make_unique<RecordBuilder>(*recs[pc->b]);
+            NEXT();
+        }
+        OP(kLOAD_INT) {
+            regs[pc->a].i = program.integers[pc->b];
+            NEXT();
+        }
+        OP(kLOAD_SMALL) {
+            regs[pc->a].i = static_cast<int16_t>(pc->b);
+            NEXT();
+        }
+        OP(kLOAD_REAL) {
+            regs[pc->a].r = program.reals[pc->b];
+            NEXT();
+        }
+        OP(kLOAD_STR) {
+            strs[pc->a] = program.strings[pc->b];
+            NEXT();
+        }
+        OP(kADD_I) {
+            regs[pc->a].i = WrapAdd(regs[pc->b].i, regs[pc->c].i);
+            NEXT();
+        }
+        OP(kSUB_I) {
+            regs[pc->a].i = WrapSub(regs[pc->b].i, regs[pc->c].i);
+            NEXT();
+        }
+        OP(kMUL_I) {
+            regs[pc->a].i = WrapMul(regs[pc->b].i, regs[pc->c].i);
+            NEXT();
+        }
+        OP(kDIV_I) {
+            int64_t divisor = regs[pc->c].i;
+            if (divisor == 0)
+                Error(*function, pc, "Division by zero");
+            // INT64_MIN / -1 overflows, negating wraps instead
+            regs[pc->a].i = (divisor == -1) ? WrapSub(0, regs[pc->b].i) : regs[pc->b].i / divisor;
+            NEXT();
+        }
+        OP(kMOD_I) {
+            int64_t divisor = regs[pc->c].i;
+            if (divisor == 0)
+                Error(*function, pc, "Division by zero");
+            regs[pc->a].i = (divisor == -1) ? 0 : regs[pc->b].i % divisor;
+            NEXT();
+        }
+        OP(kADDK_I) {
+            regs[pc->a].i = WrapAdd(regs[pc->b].i, static_cast<int16_t>(pc->c));
+            NEXT();
+        }
+        OP(kNEG_I) {
+            regs[pc->a].i = WrapSub(0, regs[pc->b].i);
+            NEXT();
+        }
+        OP(kADD_R) {
+            regs[pc->a].r = regs[pc->b].r + regs[pc->c].r;
+            NEXT();
+        }
+        OP(kSUB_R) {
+            regs[pc->a].r = regs[pc->b].r - regs[pc->c].r;
+            NEXT();
+        }
+        OP(kMUL_R) {
+            regs[pc->a].r = regs[pc->b].r * regs[pc->c].r;
+            NEXT();
+        }
+        OP(kDIV_R) {
+            regs[pc->a].r = regs[pc->b].r / regs[pc->c].r;
+            NEXT();
+        }
+        OP(kNEG_R) {
+            regs[pc->a].r = -regs[pc->b].r;
+            NEXT();
+        }
+        OP(kNOT) {
+            regs[pc->a].i = regs[pc->b].i == 0;
+            NEXT();
+        }
+        OP(kI2R) {
+            regs[pc->a].r = static_cast<double>(regs[pc->b].i);
+            NEXT();
+        }
+        OP(kR2I) {
+            double value = regs[pc->b].r;
+            if (!(value >= -9223372036854775808.0 && value < 9223372036854775808.0))
+                Error(*function, pc, std::to_string(value) + " does not fit in an integer");
+            regs[pc->a].i = static_cast<int64_t>(value);
+            NEXT();
+        }
+        OP(kEQ_I) {
+            regs[pc->a].i = regs[pc->b].i == regs[pc->c].i;
+            NEXT();
+        }
+        OP(kNE_I) {
+            regs[pc->a].i = regs[pc->b].i != regs[pc->c].i;
+            NEXT();
+        }
+        OP(kLT_I) {
+            regs[pc->a].i = regs[pc->b].i < regs[pc->c].i;
+            NEXT();
+        }
+        OP(kLE_I) {
+            regs[pc->a].i = regs[pc->b].i <= regs[pc->c].i;
+            NEXT();
+        }
+        OP(kEQ_R) {
+            regs[pc->a].i = regs[pc->b].r == regs[pc->c].r;
+            NEXT();
+        }
+        OP(kNE_R) {
+            regs[pc->a].i = regs[pc->b].r != regs[pc->c].r;
+            NEXT();
+        }
+        OP(kLT_R) {
+            regs[pc->a].i = regs[pc->b].r < regs[pc->c].r;
+            NEXT();
+        }
+        OP(kLE_R) {
+            regs[pc->a].i = regs[pc->b].r <= regs[pc->c].r;
+            NEXT();
+        }
+        OP(kEQ_S) {
+            regs[pc->a].i = strs[pc->b] == strs[pc->c];
+            NEXT();
+        }
+        OP(kNE_S) {
+            regs[pc->a].i = strs[pc->b] != strs[pc->c];
+            NEXT();
+        }
+        OP(kLT_S) {
+            regs[pc->a].i = strs[pc->b] < strs[pc->c];
+            NEXT();
+        }
+        OP(kLE_S) {
+            regs[pc->a].i = strs[pc->b] <= strs[pc->c];
+            NEXT();
+        }
+        OP(kCONCAT) {
+            if (pc->a == pc->b) {
+                strs[pc->a] += strs[pc->c];
+            } else if (pc->a == pc->c) {
+                strs[pc->a].insert(0, strs[pc->b]);
+            } else {
+                strs[pc->a] = strs[pc->b];
+                strs[pc->a] += strs[pc->c];
+            }
+            NEXT();
+        }
+        OP(kJUMP) {
+            JUMP();
+        }
+        OP(kJUMP_FALSE) {
+            if (regs[pc->a].i == 0)
+                JUMP();
+            NEXT();
+        }
+        OP(kJUMP_TRUE) {
+            if (regs[pc->a].i != 0)
+                JUMP();
+            NEXT();
+        }
+        OP(kJUMP_EQ_I) {
+            if (regs[pc->a].i == regs[pc->b].i)
+                JUMP();
+            NEXT();
+        }
+        OP(kJUMP_NE_I) {
+            if (regs[pc->a].i != regs[pc->b].i)
+                JUMP();
+            NEXT();
+        }
+        OP(kJUMP_LT_I) {
+            if (regs[pc->a].i < regs[pc->b].i)
+                JUMP();
+            NEXT();
+        }
+        OP(kJUMP_LE_I) {
+            if (regs[pc->a].i <= regs[pc->b].i)
+                JUMP();
+            NEXT();
+        }
+        OP(kJUMP_EQ_K) {
+            if (regs[pc->a].i == static_cast<int16_t>(pc->b))
+                JUMP();
+            NEXT();
+        }
+        OP(kJUMP_NE_K) {
+            if (regs[pc->a].i != static_cast<int16_t>(pc->b))
+                JUMP();
+            NEXT();
+        }
+        OP(kJUMP_LT_K) {
+            if (regs[pc->a].i < static_cast<int16_t>(pc->b))
+                JUMP();
+            NEXT();
+        }
+        OP(kJUMP_LE_K) {
+            if (regs[pc->a].i <= static_cast<int16_t>(pc->b))
+                JUMP();
+            NEXT();
+        }
+        OP(kJUMP_GT_K) {
+            if (regs[pc->a].i > static_cast<int16_t>(pc->b))
+                JUMP();
+            NEXT();
+        }
+        OP(kJUMP_GE_K) {
+            if (regs[pc->a].i >= static_cast<int16_t>(pc->b))
+                JUMP();
+            NEXT();
+        }
+        OP(kCALL) {
+            const Function* callee = &program.functions[pc->b];
+            uint32_t callee_base = base + pc->a;
+            if (callee_base + callee->registers > MAX_STACK || frames_.size() >= MAX_DEPTH)
+                Error(*function, pc, "Stack overflow calling " + callee->name + "()");
+            frames_.push_back({function, pc + 1, base});
+            Reserve(callee_base + callee->registers);
+            function = callee;
+            pc = callee->code.data();
+            base = callee_base;
+            regs = values_.data() + base;
+            strs = strings_.data() + base;
+            recs = records_.data() + base;
+            ++calls_;
+            DISPATCH();
+        }
+        OP(kRETURN) {
+            // The result is already in register 0, the caller's register a
+            if (frames_.size() == depth)
+                return;
+            Frame frame = frames_.back();
+            frames_.pop_back();
+            function = frame.function;
+            pc = frame.pc;
+            base = frame.base;
+            regs = values_.data() + base;
+            strs = strings_.data() + base;
+            recs = records_.data() + base;
+            DISPATCH();
+        }
+        OP(kNO_RETURN) {
+            Error(*function, pc, function->name + "() ended without returning a value");
+        }
+        OP(kPRINT_I) {
+            out_ << regs[pc->a].i;
+            NEXT();
+        }
+        OP(kPRINT_R) {
+            out_ << regs[pc->a].r;
+            NEXT();
+        }
+        OP(kPRINT_B) {
+            out_ << (regs[pc->a].i ? "true" : "false");
+            NEXT();
+        }
+        OP(kPRINT_S) {
+            out_ << strs[pc->a];
+            NEXT();
+        }
+        OP(kPRINT_SPACE) {
+            out_ << ' ';
+            NEXT();
+        }
+        OP(kPRINT_LINE) {
+            out_ << '\n';
+            NEXT();
+        }
+        OP(kNEW_REC) {
+            const RecordLayout& layout = program.catalog->Get(pc->b);
+            std::unique_ptr<RecordBuilder>& record = recs[pc->a];
+            // A loop declaring a record reuses the last iteration's
+            if (record != nullptr && &record->Layout() == &layout)
+                record->Reset();
+            else
+                record = std::make_unique<RecordBuilder>(layout);
+            NEXT();
+        }
+        OP(kGET_I) {
+            const FieldLayout& field = FIELD(c);
+            const uint8_t* fixed = recs[pc->b]->Fixed();
+            if (FieldIsNull(fixed, field))
+                Error(*function, pc, field.name + " is null");
+            regs[pc->a].i = ReadInteger(fixed, field);
+            NEXT();
+        }
+        OP(kGET_R) {
+            const FieldLayout& field = FIELD(c);
+            const uint8_t* fixed = recs[pc->b]->Fixed();
+            if (FieldIsNull(fixed, field))
+                Error(*function, pc, field.name + " is null");
+            regs[pc->a].r = ReadReal(fixed, field);
+            NEXT();
+        }
+        OP(kGET_S) {
+            const FieldLayout& field = FIELD(c);
+            if (FieldIsNull(recs[pc->b]->Fixed(), field))
+                Error(*function, pc, field.name + " is null");
+            strs[pc->a] = recs[pc->b]->Var(field);
+            NEXT();
+        }
+        OP(kSET_I) {
+            recs[pc->a]->SetInteger(FIELD(b), regs[pc->c].i);
+            NEXT();
+        }
+        OP(kSET_B) {
+            recs[pc->a]->SetBool(FIELD(b), regs[pc->c].i != 0);
+            NEXT();
+        }
+        OP(kSET_R) {
+            recs[pc->a]->SetReal(FIELD(b), regs[pc->c].r);
+            NEXT();
+        }
+        OP(kSET_S) {
+            recs[pc->a]->SetString(FIELD(b), strs[pc->c]);
+            NEXT();
+        }
+#ifndef DT_VM_COMPUTED_GOTO
+        default:
+            Error(*function, pc, "Invalid opcode");
+        }
+#endif
+    } catch (const SchemaException& e) {
+        // Stores that do not fit their field
+        Error(*function, pc, e.what());
+    }
+
+#undef OP
+#undef DISPATCH
+#undef NEXT
+#undef JUMP
+#undef FIELD
+}
@@ -0,0 +1,102 @@
+#ifndef DT_SRC_VM_VM_H
+#define DT_SRC_VM_VM_H
+
+// C++ Includes
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Local Includes
+#include "schema/record.h"
+#include "vm/bytecode.h"
+
+/**
+ * @brief A value bound to a statement parameter, the member matching type is used
+ */
+struct Argument {
+    ValueType type;
+    int64_t integer;        // kINT and kBOOL
+    double real;
+    std::string string;
+};
+
+/**
+ * @brief Register machine running compiled Programs
+ *
+ * Every frame is a window of registers on one stack, a call's arguments are
+ * the caller's top registers and become the callee's first ones, so calls
+ * copy nothing. Registers hold 8 byte integers, reals and bools; strings and
+ * records live in side stacks indexed by the same register number. Dispatch
+ * threads through a computed goto table where the compiler supports it.
+ */
+class Vm {
+public:
+    /**
+     * Tors
+     */
+    explicit Vm(std::ostream& out = std::cout);
+    ~Vm() noexcept;
+
+    /**
+     * NON-COPYABLE
+     */
+    Vm(const Vm&) = delete;
+    Vm(Vm&&) = delete;
+    Vm& operator=(const Vm&) = delete;
+
+    /**
+     * @brief Run the top level statements, then main() when the program has one
+     * @throws VmException on a runtime error, with its line number
+     */
+    void Run(const Program& program);
+
+    /**
+     * @brief Run a compiled statement with its parameters bound to arguments
+     * @throws VmException when the arguments do not match Program::parameters, or on a runtime error
+     */
+    void Run(const Program& program, const std::vector<Argument>& arguments);
+
+    /**
+     * Stats
+     */
+
+    /**
+     * @brief Calls made by the last Run(), the top level and main() included
+     */
+    uint64_t Calls() const noexcept;
+
+private:
+    union Value {
+        int64_t i;
+        double r;
+    };
+
+    struct Frame {
+        const Function* function;
+        const Instruction* pc;      // Where to resume the caller
+        uint32_t base;
+    };
+
+    /**
+     * @brief Run function with its frame at base until it returns
+     */
+    void Execute(const Program& program, uint32_t function, uint32_t base);
+
+    /**
+     * @brief Grow the register stacks to hold at least size registers
+     */
+    void Reserve(uint32_t size);
+
+    [[noreturn]] static void Error(const Function& function, const Instruction* pc, const std::string& msg);
+
+    std::ostream& out_;
+    std::vector<Value> values_;
+    std::vector<std::string> strings_;
+    std::vector<std::unique_ptr<RecordBuilder>> records_;
+    std::vector<Frame> frames_;
+    uint64_t calls_;
+};
+
+#endif
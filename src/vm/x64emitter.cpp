@@ -0,0 +1,328 @@
+// C++ Includes
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// C Includes
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Local Includes
+#include "x64emitter.h"
+
+// A label that has not been bound yet
+#define UNBOUND SIZE_MAX
+
+/**
+ * NativeCode
+ */
+NativeCode::NativeCode() noexcept
+: memory_(nullptr), mapped_(0), size_(0)
+{}
+
+NativeCode::~NativeCode() noexcept {
+    Release();
+}
+
+bool NativeCode::Load(const std::vector<uint8_t>& code) noexcept {
+    Release();
+    if (code.empty())
+        return false;
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t mapped = (code.size() + page - 1) / page * page;
+    void* memory = mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED)
+        return false;
+    memcpy(memory, code.data(), code.size());
+    // Never writable and executable at once
+    if (mprotect(memory, mapped, PROT_READ | PROT_EXEC) != 0) {
+        munmap(memory, mapped);
+        return false;
+    }
+    memory_ = memory;
+    mapped_ = mapped;
+    size_ = code.size();
+    return true;
+}
+
+void NativeCode::Release() noexcept {
+    if (memory_ != nullptr)
+        munmap(memory_, mapped_);
+    memory_ = nullptr;
+    mapped_ = 0;
+    size_ = 0;
+}
+
+const void* NativeCode::Entry() const noexcept {
+    return memory_;
+}
+
+size_t NativeCode::Size() const noexcept {
+    return size_;
+}
+
+/**
+ * X64Emitter
+ */
+X64Emitter::X64Emitter() noexcept
+: code_(), labels_(), fixups_()
+{}
+
+X64Emitter::~X64Emitter() noexcept {}
+
+/**
+ * Labels
+ */
+X64Emitter::Label X64Emitter::NewLabel() {
+    labels_.push_back(UNBOUND);
+    return static_cast<Label>(labels_.size() - 1);
+}
+
+void X64Emitter::Bind(Label label) noexcept {
+    labels_[label] = code_.size();
+}
+
+void X64Emitter::Jump(Label label) {
+    Byte(0xE9);
+    fixups_.push_back({code_.size(), label});
+    Imm32(0);
+}
+
+void X64Emitter::JumpIf(X64Cond cond, Label label) {
+    Bytes({0x0F, static_cast<uint8_t>(0x80 | static_cast<uint8_t>(cond))});
+    fixups_.push_back({code_.size(), label});
+    Imm32(0);
+}
+
+/**
+ * Integer loads
+ */
+void X64Emitter::LoadSigned8(X64Reg dst, uint32_t offset) {
+    Bytes({0x48, 0x0F, 0xBE});      // movsx r64, m8
+    RecordOperand(dst, offset);
+}
+
+void X64Emitter::LoadUnsigned8(X64Reg dst, uint32_t offset) {
+    Bytes({0x0F, 0xB6});            // movzx r32, m8, the upper half is cleared
+    RecordOperand(dst, offset);
+}
+
+void X64Emitter::LoadSigned16(X64Reg dst, uint32_t offset) {
+    Bytes({0x48, 0x0F, 0xBF});      // movsx r64, m16
+    RecordOperand(dst, offset);
+}
+
+void X64Emitter::LoadUnsigned16(X64Reg dst, uint32_t offset) {
+    Bytes({0x0F, 0xB7});            // movzx r32, m16
+    RecordOperand(dst, offset);
+}
+
+void X64Emitter::LoadSigned32(X64Reg dst, uint32_t offset) {
+    Bytes({0x48, 0x63});            // movsxd r64, m32
+    RecordOperand(dst, offset);
+}
+
+void X64Emitter::LoadUnsigned32(X64Reg dst, uint32_t offset) {
+    Byte(0x8B);                     // mov r32, m32
+    RecordOperand(dst, offset);
+}
+
+void X64Emitter::Load64(X64Reg dst, uint32_t offset) {
+    Bytes({0x48, 0x8B});            // mov r64, m64
+    RecordOperand(dst, offset);
+}
+
+/**
+ * Integer operations
+ */
+void X64Emitter::Move(X64Reg dst, X64Reg src) {
+    Bytes({0x48, 0x89});
+    Registers(src, dst);
+}
+
+void X64Emitter::MoveImmediate(X64Reg dst, int64_t value) {
+    if (value >= INT32_MIN && value <= INT32_MAX) {
+        Bytes({0x48, 0xC7});        // mov r/m64, imm32 sign extended
+        Registers(0, dst);
+        Imm32(static_cast<uint32_t>(value));
+        return;
+    }
+    Bytes({0x48, static_cast<uint8_t>(0xB8 + dst)});   // mov r64, imm64
+    uint64_t bits = static_cast<uint64_t>(value);
+    for (int i = 0; i < 8; ++i)
+        Byte(static_cast<uint8_t>(bits >> (8 * i)));
+}
+
+void X64Emitter::Add(X64Reg dst, X64Reg src) {
+    Bytes({0x48, 0x01});
+    Registers(src, dst);
+}
+
+void X64Emitter::Sub(X64Reg dst, X64Reg src) {
+    Bytes({0x48, 0x29});
+    Registers(src, dst);
+}
+
+void X64Emitter::Mul(X64Reg dst, X64Reg src) {
+    Bytes({0x48, 0x0F, 0xAF});      // imul r64, r/m64
+    Registers(dst, src);
+}
+
+void X64Emitter::Neg(X64Reg dst) {
+    Bytes({0x48, 0xF7});
+    Registers(3, dst);
+}
+
+void X64Emitter::Compare(X64Reg lhs, X64Reg rhs) {
+    Bytes({0x48, 0x39});            // cmp r/m64, r64 sets the flags of lhs - rhs
+    Registers(rhs, lhs);
+}
+
+void X64Emitter::CompareImmediate(X64Reg lhs, int32_t value) {
+    Bytes({0x48, 0x81});
+    Registers(7, lhs);
+    Imm32(static_cast<uint32_t>(value));
+}
+
+void X64Emitter::Test(X64Reg lhs, X64Reg rhs) {
+    Bytes({0x48, 0x85});
+    Registers(rhs, lhs);
+}
+
+void X64Emitter::TestByte(uint32_t offset, uint8_t mask) {
+    Byte(0xF6);
+    RecordOperand(0, offset);
+    Byte(mask);
+}
+
+/**
+ * Real operations
+ */
+void X64Emitter::LoadDouble(X64Reg dst, uint32_t offset) {
+    Bytes({0xF2, 0x0F, 0x10});      // movsd xmm, m64
+    RecordOperand(dst, offset);
+}
+
+void X64Emitter::LoadFloat(X64Reg dst, uint32_t offset) {
+    Bytes({0xF3, 0x0F, 0x5A});      // cvtss2sd xmm, m32
+    RecordOperand(dst, offset);
+}
+
+void X64Emitter::MoveToXmm(X64Reg dst, X64Reg src) {
+    Bytes({0x66, 0x48, 0x0F, 0x6E});    // movq xmm, r64
+    Registers(dst, src);
+}
+
+void X64Emitter::IntToDouble(X64Reg dst, X64Reg src) {
+    Bytes({0xF2, 0x48, 0x0F, 0x2A});    // cvtsi2sd xmm, r64
+    Registers(dst, src);
+}
+
+void X64Emitter::AddDouble(X64Reg dst, X64Reg src) {
+    Bytes({0xF2, 0x0F, 0x58});
+    Registers(dst, src);
+}
+
+void X64Emitter::SubDouble(X64Reg dst, X64Reg src) {
+    Bytes({0xF2, 0x0F, 0x5C});
+    Registers(dst, src);
+}
+
+void X64Emitter::MulDouble(X64Reg dst, X64Reg src) {
+    Bytes({0xF2, 0x0F, 0x59});
+    Registers(dst, src);
+}
+
+void X64Emitter::XorDouble(X64Reg dst, X64Reg src) {
+    Bytes({0x66, 0x0F, 0x57});      // xorpd
+    Registers(dst, src);
+}
+
+void X64Emitter::MoveDouble(X64Reg dst, X64Reg src) {
+    Bytes({0x66, 0x0F, 0x28});      // movapd
+    Registers(dst, src);
+}
+
+void X64Emitter::CompareDouble(X64Reg lhs, X64Reg rhs) {
+    Bytes({0x66, 0x0F, 0x2E});      // ucomisd
+    Registers(lhs, rhs);
+}
+
+/**
+ * Spills
+ */
+void X64Emitter::Spill(X64Reg src, uint32_t slot) {
+    Bytes({0x48, 0x89});
+    SlotOperand(src, slot);
+}
+
+void X64Emitter::Reload(X64Reg dst, uint32_t slot) {
+    Bytes({0x48, 0x8B});
+    SlotOperand(dst, slot);
+}
+
+void X64Emitter::SpillDouble(X64Reg src, uint32_t slot) {
+    Bytes({0xF2, 0x0F, 0x11});
+    SlotOperand(src, slot);
+}
+
+void X64Emitter::ReloadDouble(X64Reg dst, uint32_t slot) {
+    Bytes({0xF2, 0x0F, 0x10});
+    SlotOperand(dst, slot);
+}
+
+void X64Emitter::Return(uint32_t value) {
+    Byte(0xB8);                     // mov eax, imm32
+    Imm32(value);
+    Byte(0xC3);
+}
+
+std::vector<uint8_t> X64Emitter::Finish() {
+    for (const Fixup& fixup : fixups_) {
+        int32_t rel = static_cast<int32_t>(static_cast<int64_t>(labels_[fixup.label]) -
+                                           static_cast<int64_t>(fixup.at + 4));
+        memcpy(code_.data() + fixup.at, &rel, sizeof(rel));
+    }
+    fixups_.clear();
+    labels_.clear();
+    std::vector<uint8_t> code;
+    code.swap(code_);
+    return code;
+}
+
+size_t X64Emitter::Size() const noexcept {
+    return code_.size();
+}
+
+/**
+ * Encoding
+ */
+void X64Emitter::Byte(uint8_t value) {
+    code_.push_back(value);
+}
+
+void X64Emitter::Bytes(std::initializer_list<uint8_t> values) {
+    code_.insert(code_.end(), values);
+}
+
+void X64Emitter::Imm32(uint32_t value) {
+    for (int i = 0; i < 4; ++i)
+        Byte(static_cast<uint8_t>(value >> (8 * i)));
+}
+
+void X64Emitter::RecordOperand(uint8_t reg, uint32_t offset) {
+    // mod 10 is a 32 bit displacement, rm 111 is rdi
+    Byte(static_cast<uint8_t>(0x80 | (reg << 3) | kRDI));
+    Imm32(offset);
+}
+
+void X64Emitter::SlotOperand(uint8_t reg, uint32_t slot) {
+    // rm 100 needs a SIB byte, 0x24 is rsp with no index
+    Byte(static_cast<uint8_t>(0x80 | (reg << 3) | kRSP));
+    Byte(0x24);
+    Imm32(static_cast<uint32_t>(-8 * static_cast<int32_t>(slot + 1)));
+}
+
+void X64Emitter::Registers(uint8_t reg, uint8_t rm) {
+    Byte(static_cast<uint8_t>(0xC0 | (reg << 3) | rm));
+}
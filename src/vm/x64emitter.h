@@ -0,0 +1,210 @@
+#ifndef DT_SRC_VM_X64EMITTER_H
+#define DT_SRC_VM_X64EMITTER_H
+
+// C++ Includes
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+
+/**
+ * @brief The general purpose and xmm registers the emitter uses, by encoding
+ */
+enum X64Reg : uint8_t {
+    kRAX = 0,
+    kRCX = 1,
+    kRSP = 4,
+    kRDI = 7,
+    kXMM0 = 0,
+    kXMM1 = 1
+};
+
+/**
+ * @brief Condition codes of jcc, the low nibble of its opcode
+ */
+enum class X64Cond : uint8_t {
+    kB = 0x2,       // Below, unsigned or unordered <
+    kAE = 0x3,
+    kE = 0x4,
+    kNE = 0x5,
+    kBE = 0x6,
+    kA = 0x7,
+    kP = 0xA,       // Parity, set by an unordered ucomisd
+    kL = 0xC,       // Signed <
+    kGE = 0xD,
+    kLE = 0xE,
+    kG = 0xF
+};
+
+/**
+ * @brief Machine code mapped executable, released with the object
+ */
+class NativeCode {
+public:
+    /**
+     * Tors
+     */
+    NativeCode() noexcept;
+    ~NativeCode() noexcept;
+
+    /**
+     * NON-COPYABLE
+     */
+    NativeCode(const NativeCode&) = delete;
+    NativeCode(NativeCode&&) = delete;
+    NativeCode& operator=(const NativeCode&) = delete;
+
+    /**
+     * @brief Copy code into fresh pages and make them executable, replacing any previous code
+     * @return false when the system refuses executable memory
+     */
+    bool Load(const std::vector<uint8_t>& code) noexcept;
+
+    /**
+     * @brief Unmap the code
+     */
+    void Release() noexcept;
+
+    const void* Entry() const noexcept;
+    size_t Size() const noexcept;
+
+private:
+    void* memory_;
+    size_t mapped_;
+    size_t size_;
+};
+
+/**
+ * @brief Assembles the few x86-64 instructions compiled predicates need
+ *
+ * Memory operands are [rdi + offset] for the record, the function's only
+ * argument, and [rsp - 8 * (slot + 1)] for spills into the System V red zone,
+ * so leaf code never moves the stack pointer. Jumps go to labels that may be
+ * bound later, Finish() patches their rel32 displacements.
+ */
+class X64Emitter {
+public:
+    using Label = uint32_t;
+
+    // Spill slots that fit the 128 byte red zone
+    static constexpr uint32_t MAX_SLOTS = 16;
+
+    /**
+     * Tors
+     */
+    X64Emitter() noexcept;
+    ~X64Emitter() noexcept;
+
+    /**
+     * NON-COPYABLE
+     */
+    X64Emitter(const X64Emitter&) = delete;
+    X64Emitter(X64Emitter&&) = delete;
+    X64Emitter& operator=(const X64Emitter&) = delete;
+
+    /**
+     * Labels
+     */
+    Label NewLabel();
+    void Bind(Label label) noexcept;
+    void Jump(Label label);
+    void JumpIf(X64Cond cond, Label label);
+
+    /**
+     * Integer loads from [rdi + offset], widened to 64 bits
+     */
+    void LoadSigned8(X64Reg dst, uint32_t offset);
+    void LoadUnsigned8(X64Reg dst, uint32_t offset);
+    void LoadSigned16(X64Reg dst, uint32_t offset);
+    void LoadUnsigned16(X64Reg dst, uint32_t offset);
+    void LoadSigned32(X64Reg dst, uint32_t offset);
+    void LoadUnsigned32(X64Reg dst, uint32_t offset);
+    void Load64(X64Reg dst, uint32_t offset);
+
+    /**
+     * Integer operations on 64 bit registers
+     */
+    void Move(X64Reg dst, X64Reg src);
+    void MoveImmediate(X64Reg dst, int64_t value);
+    void Add(X64Reg dst, X64Reg src);
+    void Sub(X64Reg dst, X64Reg src);
+    void Mul(X64Reg dst, X64Reg src);
+    void Neg(X64Reg dst);
+    void Compare(X64Reg lhs, X64Reg rhs);
+    void CompareImmediate(X64Reg lhs, int32_t value);
+    void Test(X64Reg lhs, X64Reg rhs);
+
+    /**
+     * @brief Set the flags from [rdi + offset] & mask, a null bitmap test
+     */
+    void TestByte(uint32_t offset, uint8_t mask);
+
+    /**
+     * Real operations, doubles in the low lane of xmm registers
+     */
+    void LoadDouble(X64Reg dst, uint32_t offset);
+    void LoadFloat(X64Reg dst, uint32_t offset);
+    void MoveToXmm(X64Reg dst, X64Reg src);
+    void IntToDouble(X64Reg dst, X64Reg src);
+    void AddDouble(X64Reg dst, X64Reg src);
+    void SubDouble(X64Reg dst, X64Reg src);
+    void MulDouble(X64Reg dst, X64Reg src);
+    void XorDouble(X64Reg dst, X64Reg src);
+    void MoveDouble(X64Reg dst, X64Reg src);
+
+    /**
+     * @brief Set the flags from an unordered compare of lhs with rhs, NaN sets ZF, PF and CF
+     */
+    void CompareDouble(X64Reg lhs, X64Reg rhs);
+
+    /**
+     * Spills into the red zone
+     */
+    void Spill(X64Reg src, uint32_t slot);
+    void Reload(X64Reg dst, uint32_t slot);
+    void SpillDouble(X64Reg src, uint32_t slot);
+    void ReloadDouble(X64Reg dst, uint32_t slot);
+
+    /**
+     * @brief Return value in eax
+     */
+    void Return(uint32_t value);
+
+    /**
+     * @brief Patch every jump and hand the code over
+     */
+    std::vector<uint8_t> Finish();
+
+    size_t Size() const noexcept;
+
+private:
+    struct Fixup {
+        size_t at;          // The rel32 to patch, relative to the end of it
+        Label label;
+    };
+
+    void Byte(uint8_t value);
+    void Bytes(std::initializer_list<uint8_t> values);
+    void Imm32(uint32_t value);
+
+    /**
+     * @brief ModRM and displacement of [rdi + offset]
+     */
+    void RecordOperand(uint8_t reg, uint32_t offset);
+
+    /**
+     * @brief ModRM, SIB and displacement of a red zone slot
+     */
+    void SlotOperand(uint8_t reg, uint32_t slot);
+
+    /**
+     * @brief ModRM of a register to register operation
+     */
+    void Registers(uint8_t reg, uint8_t rm);
+
+    std::vector<uint8_t> code_;
+    std::vector<size_t> labels_;
+    std::vector<Fixup> fixups_;
+};
+
+#endif